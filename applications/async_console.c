@@ -0,0 +1,317 @@
+#include "async_console.h"
+#include <rthw.h>
+#include <rtdevice.h>
+#include <finsh.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+#include "timebase.h"
+
+#define DBG_TAG "acon"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 异步控制台：rt_kprintf 经 rt_console_set_device 切到本设备后，写入只在关中断下拷贝进环形缓冲
+ * （多生产者），由发送线程按连续块交给串口。DMA 模式下同一时刻只有一个块在途，块发完由
+ * tx_complete 唤醒发送线程；轮询模式下阻塞发送只发生在发送线程中。
+ * 本内核版本的 rt_kprintf 不是弱符号，格式化仍在其静态缓冲中完成，但持有时间只剩一次拷贝。 */
+
+static async_console_stats_t s_stats;
+
+#if ASYNC_CONSOLE_ENABLE
+
+#if (ASYNC_CONSOLE_RING_SIZE & (ASYNC_CONSOLE_RING_SIZE - 1)) != 0
+#error "ASYNC_CONSOLE_RING_SIZE must be a power of 2"
+#endif
+
+#define ACON_MASK           (ASYNC_CONSOLE_RING_SIZE - 1U)
+#define ACON_EVT_DATA       (1U << 0)
+/* 应急路径等待在途 DMA 块的自旋上限（约为 115200bps 下一个块的发送时间） */
+#define ACON_EMERG_SPIN     400000U
+
+static rt_uint8_t s_ring[ASYNC_CONSOLE_RING_SIZE];
+static volatile rt_uint32_t s_head = 0;
+static volatile rt_uint32_t s_tail = 0;
+static volatile rt_uint32_t s_inflight = 0;    /* 已交给串口、尚未确认发完的字节 */
+static volatile rt_uint8_t s_dma_busy = 0;
+static volatile rt_uint8_t s_panic = 0;        /* 断言后全部走轮询 */
+
+static struct rt_device s_acon;
+static rt_device_t s_uart = RT_NULL;
+static struct rt_event s_acon_evt;
+static struct rt_semaphore s_tx_done;
+static rt_thread_t s_thread = RT_NULL;
+
+static void poll_out(const rt_uint8_t *p, rt_size_t n, rt_bool_t crlf)
+{
+    struct rt_serial_device *serial = (struct rt_serial_device *)s_uart;
+    while (n--)
+    {
+        if (crlf && *p == '\n') serial->ops->putc(serial, '\r');
+        serial->ops->putc(serial, *p++);
+    }
+}
+
+/* 中断/异常/断言上下文：等在途 DMA 块发完（有界），冲刷缓冲中的待发数据，再轮询输出本次内容 */
+static void emergency_write(const rt_uint8_t *p, rt_size_t size, rt_bool_t crlf)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    for (rt_uint32_t spin = ACON_EMERG_SPIN; s_dma_busy && spin; spin--)
+    {
+    }
+    rt_uint32_t from = s_tail + s_inflight;
+    for (rt_uint32_t i = from; i != s_head; i++)
+    {
+        poll_out(&s_ring[i & ACON_MASK], 1, RT_FALSE);
+    }
+    s_head = from;  /* 已输出，发送线程确认在途块后 tail 追上 head */
+    poll_out(p, size, crlf);
+    s_stats.emergency++;
+    rt_hw_interrupt_enable(level);
+}
+
+static rt_size_t acon_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    (void)pos;
+    const rt_uint8_t *p = (const rt_uint8_t *)buffer;
+    rt_bool_t crlf = (dev->open_flag & RT_DEVICE_FLAG_STREAM) != 0;
+
+    if (size == 0) return 0;
+    if (s_panic || __get_IPSR() != 0)
+    {
+        emergency_write(p, size, crlf);
+        return size;
+    }
+
+    rt_size_t need = size;
+    if (crlf)
+    {
+        for (rt_size_t i = 0; i < size; i++)
+        {
+            if (p[i] == '\n') need++;
+        }
+    }
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint32_t h = s_head;
+    if (need > ASYNC_CONSOLE_RING_SIZE - (h - s_tail))
+    {
+        /* 整次丢弃，避免半行/半帧 */
+        s_stats.dropped_writes++;
+        s_stats.dropped_bytes += size;
+        rt_hw_interrupt_enable(level);
+        return size;
+    }
+    for (rt_size_t i = 0; i < size; i++)
+    {
+        if (crlf && p[i] == '\n') s_ring[h++ & ACON_MASK] = '\r';
+        s_ring[h++ & ACON_MASK] = p[i];
+    }
+    s_head = h;
+    s_stats.bytes_in += need;
+    if (h - s_tail > s_stats.max_fill) s_stats.max_fill = h - s_tail;
+    rt_hw_interrupt_enable(level);
+
+    rt_event_send(&s_acon_evt, ACON_EVT_DATA);
+    return size;
+}
+
+#ifdef RT_SERIAL_USING_DMA
+static rt_err_t acon_tx_done(rt_device_t dev, void *buffer)
+{
+    (void)dev;
+    const rt_uint8_t *b = (const rt_uint8_t *)buffer;
+    if (b >= s_ring && b < s_ring + ASYNC_CONSOLE_RING_SIZE)
+    {
+        s_dma_busy = 0;
+        rt_sem_release(&s_tx_done);
+    }
+    return RT_EOK;
+}
+#endif
+
+static void acon_thread_entry(void *parameter)
+{
+    (void)parameter;
+    rt_uint32_t recved;
+
+    while (1)
+    {
+        rt_event_recv(&s_acon_evt, ACON_EVT_DATA, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_FOREVER, &recved);
+
+        while (s_tail != s_head)
+        {
+            rt_base_t level = rt_hw_interrupt_disable();
+            rt_uint32_t t = s_tail;
+            rt_uint32_t off = t & ACON_MASK;
+            rt_uint32_t n = s_head - t;
+            if (n > ASYNC_CONSOLE_RING_SIZE - off) n = ASYNC_CONSOLE_RING_SIZE - off;   /* 只发连续段 */
+            if (n > ASYNC_CONSOLE_CHUNK) n = ASYNC_CONSOLE_CHUNK;
+            s_inflight = n;
+            s_dma_busy = s_stats.dma;
+            rt_hw_interrupt_enable(level);
+
+            if (s_stats.dma)
+            {
+                rt_device_write(s_uart, 0, &s_ring[off], n);
+                rt_sem_take(&s_tx_done, RT_WAITING_FOREVER);
+            }
+            else
+            {
+                /* \r 已在入缓冲时扩展，串口侧不再转换 */
+                rt_uint16_t old_flag = s_uart->open_flag;
+                s_uart->open_flag &= ~RT_DEVICE_FLAG_STREAM;
+                rt_device_write(s_uart, 0, &s_ring[off], n);
+                s_uart->open_flag = old_flag;
+            }
+
+            level = rt_hw_interrupt_disable();
+            s_tail = t + n;
+            s_inflight = 0;
+            rt_hw_interrupt_enable(level);
+            s_stats.bytes_out += n;
+            s_stats.chunks++;
+        }
+    }
+}
+
+#ifdef RT_DEBUG
+static void acon_assert_hook(const char *ex, const char *func, rt_size_t line)
+{
+    volatile char dummy = 0;
+    s_panic = 1;
+    rt_kprintf("(%s) assertion failed at function:%s, line number:%d \n", ex, func, line);
+    while (dummy == 0);
+}
+#endif
+
+rt_err_t async_console_init(void)
+{
+    if (s_thread) return RT_EOK;
+
+    s_uart = rt_device_find(ASYNC_CONSOLE_UART_NAME);
+    if (!s_uart) return -RT_EEMPTY;
+
+#ifdef RT_USING_FINSH
+    /* shell 线程尚未运行时会取控制台设备作输入，先把输入绑定到真实串口（本设备只写） */
+    finsh_set_device(ASYNC_CONSOLE_UART_NAME);
+#endif
+
+#ifdef RT_SERIAL_USING_DMA
+    /* 保留已打开的中断接收/流模式标志，只追加 DMA 发送 */
+    if (rt_device_open(s_uart, s_uart->open_flag | RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_DMA_TX) == RT_EOK)
+    {
+        s_stats.dma = 1;
+        rt_device_set_tx_complete(s_uart, acon_tx_done);
+    }
+    else
+#endif
+    if (rt_device_open(s_uart, s_uart->open_flag | RT_DEVICE_OFLAG_RDWR) != RT_EOK)
+    {
+        return -RT_EIO;
+    }
+
+    rt_event_init(&s_acon_evt, "acon", RT_IPC_FLAG_FIFO);
+    rt_sem_init(&s_tx_done, "acontx", 0, RT_IPC_FLAG_FIFO);
+
+    rt_memset(&s_acon, 0, sizeof(s_acon));
+    s_acon.type = RT_Device_Class_Char;
+#ifdef RT_USING_DEVICE_OPS
+    static const struct rt_device_ops acon_ops = { RT_NULL, RT_NULL, RT_NULL, RT_NULL, acon_write, RT_NULL };
+    s_acon.ops = &acon_ops;
+#else
+    s_acon.write = acon_write;
+#endif
+    if (rt_device_register(&s_acon, ASYNC_CONSOLE_DEVICE_NAME, RT_DEVICE_FLAG_RDWR) != RT_EOK)
+    {
+        goto fail;
+    }
+
+    s_thread = rt_thread_create("acon", acon_thread_entry, RT_NULL, 512, ASYNC_CONSOLE_PRIORITY, 10);
+    if (!s_thread)
+    {
+        rt_device_unregister(&s_acon);
+        goto fail;
+    }
+    rt_thread_startup(s_thread);
+
+    rt_console_set_device(ASYNC_CONSOLE_DEVICE_NAME);
+#ifdef RT_DEBUG
+    rt_assert_set_hook(acon_assert_hook);
+#endif
+    LOG_D("async console on %s, dma=%d", ASYNC_CONSOLE_UART_NAME, s_stats.dma);
+    return RT_EOK;
+
+fail:
+    rt_event_detach(&s_acon_evt);
+    rt_sem_detach(&s_tx_done);
+    return -RT_ERROR;
+}
+
+#else /* !ASYNC_CONSOLE_ENABLE */
+
+rt_err_t async_console_init(void)
+{
+    return RT_EOK;
+}
+
+#endif /* ASYNC_CONSOLE_ENABLE */
+
+void async_console_get_stats(async_console_stats_t *out)
+{
+    *out = s_stats;
+}
+
+void async_console_printf(const char *fmt, ...)
+{
+    char buf[ASYNC_CONSOLE_LINE_MAX];
+    va_list args;
+
+    va_start(args, fmt);
+    rt_size_t n = rt_vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n > sizeof(buf) - 1) n = sizeof(buf) - 1;
+    buf[n] = '\0';
+    rt_kputs(buf);
+}
+
+/* ================== 命令 ================== */
+static int cmd_sw_con(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    async_console_stats_t st;
+    async_console_get_stats(&st);
+#if ASYNC_CONSOLE_ENABLE
+    rt_kprintf("mode=async tx=%s ring=%u fill=%u max_fill=%u\n", st.dma ? "dma" : "poll",
+               (unsigned)ASYNC_CONSOLE_RING_SIZE, (unsigned)(s_head - s_tail), (unsigned)st.max_fill);
+    rt_kprintf("in=%u out=%u chunks=%u dropped=%u/%uB emergency=%u\n", (unsigned)st.bytes_in,
+               (unsigned)st.bytes_out, (unsigned)st.chunks, (unsigned)st.dropped_writes,
+               (unsigned)st.dropped_bytes, (unsigned)st.emergency);
+#else
+    rt_kprintf("mode=sync (ASYNC_CONSOLE_ENABLE=0)\n");
+#endif
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_con, sw_con, Async_console_stats);
+
+/* 测调用方在 rt_kprintf 中停留的时间：同步控制台约等于整行移位时间，异步控制台只剩格式化+拷贝 */
+static int cmd_sw_con_bench(int argc, char **argv)
+{
+    int n = (argc >= 2) ? atoi(argv[1]) : 8;
+    if (n < 1) n = 1;
+    rt_uint32_t max_us = 0;
+    rt_uint64_t sum_us = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        rt_uint64_t t0 = timebase_get_us();
+        rt_kprintf("sw_con_bench %02d: 0123456789abcdefghijklmnopqrstuvwxyz\n", i);
+        rt_uint32_t d = (rt_uint32_t)(timebase_get_us() - t0);
+        sum_us += d;
+        if (d > max_us) max_us = d;
+    }
+    rt_kprintf("rt_kprintf x%d: avg=%u us max=%u us\n", n, (unsigned)(sum_us / (rt_uint32_t)n), (unsigned)max_us);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_con_bench, sw_con_bench, Console_write_latency_bench);
@@ -0,0 +1,60 @@
+#ifndef APPLICATIONS_ASYNC_CONSOLE_H_
+#define APPLICATIONS_ASYNC_CONSOLE_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1：注册只写控制台设备并接管 rt_kprintf 输出。写入只拷贝进发送环形缓冲，
+ * 由发送线程整块写串口（开启 RT_SERIAL_USING_DMA 与 BSP_UART1_TX_USING_DMA 时走 DMA）。
+ * 中断/异常上下文与断言走轮询应急路径（先冲刷缓冲中的待发数据）。 */
+#ifndef ASYNC_CONSOLE_ENABLE
+#define ASYNC_CONSOLE_ENABLE        0
+#endif
+#ifndef ASYNC_CONSOLE_DEVICE_NAME
+#define ASYNC_CONSOLE_DEVICE_NAME   "acon"
+#endif
+/* 实际输出串口 */
+#ifndef ASYNC_CONSOLE_UART_NAME
+#define ASYNC_CONSOLE_UART_NAME     RT_CONSOLE_DEVICE_NAME
+#endif
+/* 发送环形缓冲（2 的幂）；放不下的整次写入被丢弃并计数 */
+#ifndef ASYNC_CONSOLE_RING_SIZE
+#define ASYNC_CONSOLE_RING_SIZE     1024
+#endif
+/* 单次 DMA/轮询发送的最大字节数 */
+#ifndef ASYNC_CONSOLE_CHUNK
+#define ASYNC_CONSOLE_CHUNK         128
+#endif
+/* async_console_printf 的栈上格式化缓冲 */
+#ifndef ASYNC_CONSOLE_LINE_MAX
+#define ASYNC_CONSOLE_LINE_MAX      128
+#endif
+#ifndef ASYNC_CONSOLE_PRIORITY
+#define ASYNC_CONSOLE_PRIORITY      15
+#endif
+
+typedef struct
+{
+    rt_uint32_t bytes_in;       /* 进入缓冲的字节（含 \r 扩展） */
+    rt_uint32_t bytes_out;      /* 已交给串口的字节 */
+    rt_uint32_t dropped_writes; /* 缓冲放不下而丢弃的写入次数 */
+    rt_uint32_t dropped_bytes;
+    rt_uint32_t chunks;         /* 串口写入次数 */
+    rt_uint32_t max_fill;       /* 缓冲占用峰值 */
+    rt_uint32_t emergency;      /* 应急轮询输出次数 */
+    rt_uint8_t  dma;
+} async_console_stats_t;
+
+rt_err_t async_console_init(void);
+void     async_console_get_stats(async_console_stats_t *out);
+/* 格式化到调用者栈上再写控制台，不占用 rt_kprintf 的静态缓冲 */
+void     async_console_printf(const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_ASYNC_CONSOLE_H_ */
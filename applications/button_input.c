@@ -0,0 +1,460 @@
+#include "button_input.h"
+#include <rtdevice.h>
+#include <rthw.h>
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+#include "timebase.h"
+#include "stopwatch.h"
+#include "event_bus.h"
+#include "ui_oled.h"
+
+#define DBG_TAG "btn"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 物理按键：EXTI 双沿中断内用 timebase 打点并完成去抖判定，
+ * 被接受的沿经消息队列交给按键线程识别单击/双击/长按并映射为秒表动作。
+ * 记录时间一律取按下沿的 ISR 时间戳，与线程调度和串口延迟无关。 */
+
+enum
+{
+    PHASE_IDLE = 0,
+    PHASE_PRESSED,      /* 首次按下，等待松开或长按 */
+    PHASE_LONG_HELD,    /* 长按已触发，等待松开 */
+    PHASE_WAIT_DOUBLE,  /* 已松开，等待双击窗口 */
+    PHASE_SECOND_HELD,  /* 双击已触发，等待松开 */
+};
+
+typedef struct
+{
+    rt_base_t       pin;
+    button_action_t on_click;
+    button_action_t on_double;
+    button_action_t on_long;
+    button_fsm_t    fsm;
+} button_t;
+
+typedef struct
+{
+    rt_uint8_t  id;
+    rt_uint8_t  level;
+    rt_uint64_t t_us;
+} button_msg_t;
+
+#define BUTTON_MQ_DEPTH 16
+
+static button_t s_buttons[BUTTON_COUNT] =
+{
+    { BUTTON_START_PIN, BUTTON_ACTION_START_STOP, BUTTON_ACTION_NONE, BUTTON_ACTION_RESET },
+    { BUTTON_LAP_PIN,   BUTTON_ACTION_LAP,        BUTTON_ACTION_PAGE, BUTTON_ACTION_CLEAR_LAPS },
+};
+
+static struct rt_messagequeue s_btn_mq;
+static rt_uint8_t s_btn_mq_pool[BUTTON_MQ_DEPTH * (RT_ALIGN(sizeof(button_msg_t), RT_ALIGN_SIZE) + sizeof(void *))];
+static rt_thread_t s_btn_thread;
+static rt_uint32_t s_mq_overflow = 0;
+static rt_uint8_t s_page = 0;
+
+/* ================== 纯逻辑：去抖 + 手势 ================== */
+int button_fsm_edge(button_fsm_t *b, rt_uint8_t level, rt_uint64_t t_us)
+{
+    b->raw = level;
+    b->raw_us = t_us;
+    if (b->seen && (t_us - b->accept_us) < BUTTON_DEBOUNCE_US)
+    {
+        b->bounces++;
+        return 0;
+    }
+    if (level == b->stable)
+    {
+        return 0;
+    }
+    b->stable = level;
+    b->accept_us = t_us;
+    b->seen = 1;
+    return 1;
+}
+
+button_gesture_t button_fsm_gesture(button_fsm_t *b, rt_uint8_t level, rt_uint64_t t_us, rt_uint64_t *out_t_us)
+{
+    switch (b->phase)
+    {
+    case PHASE_IDLE:
+        if (level)
+        {
+            b->press_us = t_us;
+            b->phase = PHASE_PRESSED;
+        }
+        break;
+    case PHASE_PRESSED:
+        if (!level)
+        {
+            if (b->double_enabled)
+            {
+                b->release_us = t_us;
+                b->phase = PHASE_WAIT_DOUBLE;
+            }
+            else
+            {
+                b->phase = PHASE_IDLE;
+                *out_t_us = b->press_us;
+                return BUTTON_GESTURE_CLICK;
+            }
+        }
+        break;
+    case PHASE_WAIT_DOUBLE:
+        if (level)
+        {
+            b->phase = PHASE_SECOND_HELD;
+            *out_t_us = b->press_us;
+            return BUTTON_GESTURE_DOUBLE;
+        }
+        break;
+    case PHASE_LONG_HELD:
+    case PHASE_SECOND_HELD:
+    default:
+        if (!level)
+        {
+            b->phase = PHASE_IDLE;
+        }
+        break;
+    }
+    return BUTTON_GESTURE_NONE;
+}
+
+button_gesture_t button_fsm_poll(button_fsm_t *b, rt_uint64_t now_us, rt_uint8_t level_now, rt_uint64_t *out_t_us)
+{
+    /* 窗口内最后一个沿被当作抖动滤掉、而电平已稳定在另一侧：按该沿时间补记 */
+    if (b->raw != b->stable && level_now == b->raw && (now_us - b->raw_us) >= BUTTON_DEBOUNCE_US)
+    {
+        b->stable = b->raw;
+        b->accept_us = b->raw_us;
+        button_gesture_t g = button_fsm_gesture(b, b->stable, b->raw_us, out_t_us);
+        if (g != BUTTON_GESTURE_NONE)
+        {
+            return g;
+        }
+    }
+
+    if (b->phase == PHASE_PRESSED && (now_us - b->press_us) >= BUTTON_LONG_US)
+    {
+        b->phase = PHASE_LONG_HELD;
+        *out_t_us = b->press_us;
+        return BUTTON_GESTURE_LONG;
+    }
+    if (b->phase == PHASE_WAIT_DOUBLE && (now_us - b->release_us) >= BUTTON_DOUBLE_US)
+    {
+        b->phase = PHASE_IDLE;
+        *out_t_us = b->press_us;
+        return BUTTON_GESTURE_CLICK;
+    }
+    return BUTTON_GESTURE_NONE;
+}
+
+rt_uint64_t button_fsm_deadline(const button_fsm_t *b)
+{
+    rt_uint64_t d = 0;
+    if (b->raw != b->stable)
+    {
+        d = b->raw_us + BUTTON_DEBOUNCE_US;
+    }
+    if (b->phase == PHASE_PRESSED)
+    {
+        rt_uint64_t l = b->press_us + BUTTON_LONG_US;
+        if (d == 0 || l < d) d = l;
+    }
+    else if (b->phase == PHASE_WAIT_DOUBLE)
+    {
+        rt_uint64_t w = b->release_us + BUTTON_DOUBLE_US;
+        if (d == 0 || w < d) d = w;
+    }
+    return d;
+}
+
+/* ================== 硬件与动作映射 ================== */
+static rt_uint8_t button_level(const button_t *btn)
+{
+    return rt_pin_read(btn->pin) ? 0 : 1; /* 低电平按下 */
+}
+
+static void button_isr(void *args)
+{
+    rt_uint8_t id = (rt_uint8_t)(rt_ubase_t)args;
+    button_t *btn = &s_buttons[id];
+    rt_uint64_t t_us = timebase_get_us();
+    rt_uint8_t level = button_level(btn);
+
+    if (button_fsm_edge(&btn->fsm, level, t_us))
+    {
+        button_msg_t msg = { id, level, t_us };
+        if (rt_mq_send(&s_btn_mq, &msg, sizeof(msg)) != RT_EOK)
+        {
+            s_mq_overflow++;
+        }
+    }
+}
+
+static const char *action_name(button_action_t a)
+{
+    switch (a)
+    {
+    case BUTTON_ACTION_START_STOP: return "start/stop";
+    case BUTTON_ACTION_LAP:        return "lap";
+    case BUTTON_ACTION_RESET:      return "reset";
+    case BUTTON_ACTION_CLEAR_LAPS: return "clear_laps";
+    case BUTTON_ACTION_PAGE:       return "page";
+    default:                       return "none";
+    }
+}
+
+static void button_dispatch(button_action_t action, rt_uint64_t t_us)
+{
+    switch (action)
+    {
+    case BUTTON_ACTION_START_STOP:
+        if (stopwatch_get_state() == STOPWATCH_STATE_RUNNING)
+        {
+            stopwatch_stop_at(t_us);
+        }
+        else
+        {
+            stopwatch_start_at(t_us);
+        }
+        break;
+    case BUTTON_ACTION_LAP:
+        stopwatch_lap_at(t_us, RT_NULL);
+        break;
+    case BUTTON_ACTION_RESET:
+        stopwatch_reset();
+        break;
+    case BUTTON_ACTION_CLEAR_LAPS:
+        stopwatch_clear_laps();
+        break;
+    case BUTTON_ACTION_PAGE:
+        s_page = (rt_uint8_t)((s_page + 1) % UI_PAGE_COUNT);
+        event_bus_post(EVT_SETTINGS_CHANGED, EVT_SET_PAGE, s_page);
+        break;
+    default:
+        break;
+    }
+}
+
+static void button_handle(button_t *btn, button_gesture_t g, rt_uint64_t t_us)
+{
+    button_action_t a = BUTTON_ACTION_NONE;
+    if (g == BUTTON_GESTURE_CLICK) a = btn->on_click;
+    else if (g == BUTTON_GESTURE_DOUBLE) a = btn->on_double;
+    else if (g == BUTTON_GESTURE_LONG) a = btn->on_long;
+    LOG_D("key%d gesture=%d action=%s t=%u us", (int)(btn - s_buttons), (int)g, action_name(a), (unsigned)t_us);
+    button_dispatch(a, t_us);
+}
+
+static rt_int32_t us_to_ticks(rt_uint64_t us)
+{
+    rt_uint64_t ticks = (us * RT_TICK_PER_SECOND + 999999ULL) / 1000000ULL;
+    if (ticks == 0) ticks = 1;
+    return (rt_int32_t)ticks;
+}
+
+static void button_thread_entry(void *parameter)
+{
+    (void)parameter;
+    button_msg_t msg;
+    while (1)
+    {
+        rt_int32_t timeout = RT_WAITING_FOREVER;
+        rt_uint64_t now_us = timebase_get_us();
+        for (int i = 0; i < BUTTON_COUNT; i++)
+        {
+            rt_uint64_t d = button_fsm_deadline(&s_buttons[i].fsm);
+            if (d == 0) continue;
+            rt_int32_t t = (d > now_us) ? us_to_ticks(d - now_us) : 1;
+            if (timeout == RT_WAITING_FOREVER || t < timeout) timeout = t;
+        }
+
+        if (rt_mq_recv(&s_btn_mq, &msg, sizeof(msg), timeout) == RT_EOK && msg.id < BUTTON_COUNT)
+        {
+            button_t *btn = &s_buttons[msg.id];
+            rt_uint64_t t_us = 0;
+            button_gesture_t g = button_fsm_gesture(&btn->fsm, msg.level, msg.t_us, &t_us);
+            if (g != BUTTON_GESTURE_NONE)
+            {
+                button_handle(btn, g, t_us);
+            }
+        }
+
+        now_us = timebase_get_us();
+        for (int i = 0; i < BUTTON_COUNT; i++)
+        {
+            button_t *btn = &s_buttons[i];
+            rt_uint64_t t_us = 0;
+            button_gesture_t g;
+            /* 补记电平会改写去抖字段，需与 ISR 互斥 */
+            rt_base_t level = rt_hw_interrupt_disable();
+            g = button_fsm_poll(&btn->fsm, now_us, button_level(btn), &t_us);
+            rt_hw_interrupt_enable(level);
+            if (g != BUTTON_GESTURE_NONE)
+            {
+                button_handle(btn, g, t_us);
+            }
+        }
+    }
+}
+
+rt_err_t button_input_init(void)
+{
+    rt_err_t ret = rt_mq_init(&s_btn_mq, "btn", s_btn_mq_pool, sizeof(button_msg_t),
+                              sizeof(s_btn_mq_pool), RT_IPC_FLAG_FIFO);
+    if (ret != RT_EOK)
+    {
+        return ret;
+    }
+
+    for (int i = 0; i < BUTTON_COUNT; i++)
+    {
+        button_t *btn = &s_buttons[i];
+        memset(&btn->fsm, 0, sizeof(btn->fsm));
+        btn->fsm.double_enabled = (btn->on_double != BUTTON_ACTION_NONE);
+        rt_pin_mode(btn->pin, PIN_MODE_INPUT_PULLUP);
+        btn->fsm.stable = btn->fsm.raw = button_level(btn);
+        rt_pin_attach_irq(btn->pin, PIN_IRQ_MODE_RISING_FALLING, button_isr, (void *)(rt_ubase_t)i);
+        rt_pin_irq_enable(btn->pin, PIN_IRQ_ENABLE);
+    }
+
+    s_btn_thread = rt_thread_create("button", button_thread_entry, RT_NULL, 768, 12, 10);
+    if (!s_btn_thread)
+    {
+        return -RT_ENOMEM;
+    }
+    rt_thread_startup(s_btn_thread);
+    return RT_EOK;
+}
+
+/* ================== 模拟器：注入抖动序列 ==================
+ * 以虚拟时间驱动与实机相同的 button_fsm_*，打印被接受的沿与识别出的手势。
+ * 用法：sw_btn_sim clean|bounce|long|double|glitch [dbl]
+ *       sw_btn_sim 1@0 0@300 1@700 ... [dbl]   （电平@微秒，1=按下） */
+typedef struct
+{
+    rt_uint8_t  level;
+    rt_uint32_t t_us;
+} sim_edge_t;
+
+static const sim_edge_t sim_clean[]  = { {1, 0}, {0, 120000} };
+static const sim_edge_t sim_bounce[] = { {1, 0}, {0, 300}, {1, 700}, {0, 1100}, {1, 1500},
+                                         {0, 150000}, {1, 150400}, {0, 150900}, {1, 151300}, {0, 151800} };
+static const sim_edge_t sim_long[]   = { {1, 0}, {0, 500}, {1, 900}, {0, 1200000}, {1, 1200300}, {0, 1200700} };
+static const sim_edge_t sim_double[] = { {1, 0}, {0, 400}, {1, 800}, {0, 100000}, {1, 250000}, {0, 250600},
+                                         {1, 251000}, {0, 350000} };
+static const sim_edge_t sim_glitch[] = { {1, 0}, {0, 5000} };
+
+#define SIM_MAX_EDGES 16
+
+static const char *gesture_name(button_gesture_t g)
+{
+    switch (g)
+    {
+    case BUTTON_GESTURE_CLICK:  return "click";
+    case BUTTON_GESTURE_DOUBLE: return "double";
+    case BUTTON_GESTURE_LONG:   return "long";
+    default:                    return "none";
+    }
+}
+
+static void sim_poll_until(button_fsm_t *b, rt_uint64_t t_us)
+{
+    rt_uint64_t d;
+    while ((d = button_fsm_deadline(b)) != 0 && d <= t_us)
+    {
+        rt_uint64_t at = 0;
+        button_gesture_t g = button_fsm_poll(b, d, b->raw, &at);
+        if (g != BUTTON_GESTURE_NONE)
+        {
+            rt_kprintf("  %8u us: %s (t=%u us)\n", (unsigned)d, gesture_name(g), (unsigned)at);
+        }
+    }
+}
+
+static int cmd_sw_btn_sim(int argc, char **argv)
+{
+    sim_edge_t custom[SIM_MAX_EDGES];
+    const sim_edge_t *edges = RT_NULL;
+    rt_size_t n = 0;
+    rt_uint8_t dbl = 0;
+
+    if (argc < 2)
+    {
+        rt_kprintf("usage: sw_btn_sim clean|bounce|long|double|glitch [dbl]\n");
+        rt_kprintf("       sw_btn_sim <level@us> ... [dbl]\n");
+        return -RT_ERROR;
+    }
+    if (!strcmp(argv[argc - 1], "dbl"))
+    {
+        dbl = 1;
+        argc--;
+    }
+    if (!strcmp(argv[1], "clean"))       { edges = sim_clean;  n = sizeof(sim_clean) / sizeof(sim_clean[0]); }
+    else if (!strcmp(argv[1], "bounce")) { edges = sim_bounce; n = sizeof(sim_bounce) / sizeof(sim_bounce[0]); }
+    else if (!strcmp(argv[1], "long"))   { edges = sim_long;   n = sizeof(sim_long) / sizeof(sim_long[0]); }
+    else if (!strcmp(argv[1], "double")) { edges = sim_double; n = sizeof(sim_double) / sizeof(sim_double[0]); dbl = 1; }
+    else if (!strcmp(argv[1], "glitch")) { edges = sim_glitch; n = sizeof(sim_glitch) / sizeof(sim_glitch[0]); }
+    else
+    {
+        for (int i = 1; i < argc && n < SIM_MAX_EDGES; i++)
+        {
+            char *at = strchr(argv[i], '@');
+            if (!at)
+            {
+                rt_kprintf("sw_btn_sim: bad edge '%s'\n", argv[i]);
+                return -RT_ERROR;
+            }
+            custom[n].level = (atoi(argv[i]) != 0);
+            custom[n].t_us = (rt_uint32_t)atoi(at + 1);
+            n++;
+        }
+        edges = custom;
+    }
+
+    button_fsm_t b;
+    memset(&b, 0, sizeof(b));
+    b.double_enabled = dbl;
+    rt_kprintf("sw_btn_sim: %u edges, debounce=%u us, double=%s\n",
+               (unsigned)n, (unsigned)BUTTON_DEBOUNCE_US, dbl ? "on" : "off");
+
+    for (rt_size_t i = 0; i < n; i++)
+    {
+        sim_poll_until(&b, edges[i].t_us);
+        if (button_fsm_edge(&b, edges[i].level, edges[i].t_us))
+        {
+            rt_uint64_t at = 0;
+            rt_kprintf("  %8u us: edge %u accepted\n", (unsigned)edges[i].t_us, (unsigned)edges[i].level);
+            button_gesture_t g = button_fsm_gesture(&b, edges[i].level, edges[i].t_us, &at);
+            if (g != BUTTON_GESTURE_NONE)
+            {
+                rt_kprintf("  %8u us: %s (t=%u us)\n", (unsigned)edges[i].t_us, gesture_name(g), (unsigned)at);
+            }
+        }
+    }
+    sim_poll_until(&b, (rt_uint64_t)-1);
+    rt_kprintf("sw_btn_sim: bounces filtered=%u, final=%s\n",
+               (unsigned)b.bounces, b.stable ? "pressed" : "released");
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_btn_sim, sw_btn_sim, Inject_button_bounce_pattern);
+
+static int cmd_sw_btn(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    for (int i = 0; i < BUTTON_COUNT; i++)
+    {
+        const button_t *btn = &s_buttons[i];
+        rt_kprintf("key%d: click=%s double=%s long=%s level=%u bounces=%u\n", i,
+                   action_name(btn->on_click), action_name(btn->on_double), action_name(btn->on_long),
+                   (unsigned)btn->fsm.stable, (unsigned)btn->fsm.bounces);
+    }
+    rt_kprintf("queue overflow: %u\n", (unsigned)s_mq_overflow);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_btn, sw_btn, Show_button_mapping_and_counters);
@@ -0,0 +1,85 @@
+#ifndef APPLICATIONS_BUTTON_INPUT_H_
+#define APPLICATIONS_BUTTON_INPUT_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 按键引脚（低电平按下，内部上拉）；如与实际连线不符可在编译宏重定义 */
+#ifndef BUTTON_START_PIN
+#define BUTTON_START_PIN        GET_PIN(A, 1)
+#endif
+#ifndef BUTTON_LAP_PIN
+#define BUTTON_LAP_PIN          GET_PIN(A, 2)
+#endif
+
+/* 去抖窗口：与上一次被接受沿间隔小于该值的沿视为抖动 */
+#ifndef BUTTON_DEBOUNCE_US
+#define BUTTON_DEBOUNCE_US      20000U
+#endif
+/* 长按判定阈值 */
+#ifndef BUTTON_LONG_US
+#define BUTTON_LONG_US          800000U
+#endif
+/* 双击判定窗口（第一次松开到第二次按下） */
+#ifndef BUTTON_DOUBLE_US
+#define BUTTON_DOUBLE_US        300000U
+#endif
+
+#define BUTTON_COUNT            2
+
+typedef enum
+{
+    BUTTON_GESTURE_NONE = 0,
+    BUTTON_GESTURE_CLICK,
+    BUTTON_GESTURE_DOUBLE,
+    BUTTON_GESTURE_LONG,
+} button_gesture_t;
+
+typedef enum
+{
+    BUTTON_ACTION_NONE = 0,
+    BUTTON_ACTION_START_STOP,   /* 运行中则暂停，否则开始 */
+    BUTTON_ACTION_LAP,
+    BUTTON_ACTION_RESET,
+    BUTTON_ACTION_CLEAR_LAPS,
+    BUTTON_ACTION_PAGE,         /* OLED 主界面/圈速页/排行页轮换 */
+} button_action_t;
+
+/* 单个按键的去抖 + 手势状态（纯逻辑，不访问硬件，供 ISR/线程与模拟器共用）
+ * 去抖字段由 ISR 写入，手势字段只在按键线程中访问 */
+typedef struct
+{
+    /* 去抖 */
+    rt_uint8_t  stable;         /* 去抖后的电平：1=按下 */
+    rt_uint8_t  raw;            /* 最近一次原始电平 */
+    rt_uint8_t  seen;           /* 是否已接受过沿 */
+    rt_uint64_t accept_us;      /* 最近一次被接受沿的时间戳 */
+    rt_uint64_t raw_us;         /* 最近一次原始沿的时间戳 */
+    rt_uint32_t bounces;        /* 被滤除的抖动沿计数 */
+
+    /* 手势 */
+    rt_uint8_t  phase;
+    rt_uint8_t  double_enabled; /* 未映射双击时单击在松开时立即确认 */
+    rt_uint64_t press_us;       /* 手势首次按下时间戳（即记录时间） */
+    rt_uint64_t release_us;     /* 首次松开时间戳（双击窗口起点） */
+} button_fsm_t;
+
+rt_err_t button_input_init(void);
+
+/* 去抖（ISR 中调用）：返回 1 表示该沿被接受（稳定电平发生变化） */
+int button_fsm_edge(button_fsm_t *b, rt_uint8_t level, rt_uint64_t t_us);
+/* 将已接受的沿送入手势状态机；识别出手势时返回手势并通过 out_t_us 给出按下时刻 */
+button_gesture_t button_fsm_gesture(button_fsm_t *b, rt_uint8_t level, rt_uint64_t t_us, rt_uint64_t *out_t_us);
+/* 推进超时（长按/双击窗口）并补偿窗口内被滤掉的最终电平；level_now 为当前引脚电平 */
+button_gesture_t button_fsm_poll(button_fsm_t *b, rt_uint64_t now_us, rt_uint8_t level_now, rt_uint64_t *out_t_us);
+/* 下一次需要 poll 的时刻（无待定事件返回 0） */
+rt_uint64_t button_fsm_deadline(const button_fsm_t *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_BUTTON_INPUT_H_ */
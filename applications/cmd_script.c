@@ -0,0 +1,398 @@
+#include "cmd_script.h"
+#include <rthw.h>
+#include <finsh.h>
+#include <msh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timebase.h"
+
+#define DBG_TAG "script"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 命令批处理与定时脚本：
+ * - sw_batch：在 shell 线程内按 ';' 顺序执行，"wait N" 推进计划时刻（相对批处理起点累加，不随命令耗时漂移）；
+ * - 定时脚本：逐条上传（偏移 ms + 命令），由 "swscr" 线程（首次 run 时创建）按 timebase 偏移派发，
+ *   硬定时器按 tick 向上取整唤醒，不忙等，派发最多晚一个 tick；每条命令记录实际开始时刻与耗时。 */
+
+typedef struct
+{
+    rt_uint32_t offset_ms;
+    rt_uint16_t pos;            /* 命令文本在 s_pool 中的起点 */
+} script_entry_t;
+
+typedef struct
+{
+    rt_uint32_t runs;
+    rt_uint32_t cmds;
+    rt_uint32_t max_late_us;
+    rt_uint64_t sum_late_us;
+} script_stats_t;
+
+static script_entry_t s_entry[CMD_SCRIPT_MAX];
+static rt_uint8_t s_count = 0;
+static char s_pool[CMD_SCRIPT_POOL_SIZE];
+static rt_uint16_t s_pool_used = 0;
+
+static cmd_script_log_t s_log[CMD_SCRIPT_MAX];
+static rt_uint8_t s_log_n = 0;
+static script_stats_t s_stats;
+
+static rt_thread_t s_thread = RT_NULL;
+static struct rt_semaphore s_start_sem;
+static struct rt_semaphore s_wake;
+static struct rt_timer s_timer;
+static volatile rt_uint8_t s_running = 0;
+static volatile rt_uint8_t s_stop = 0;
+static rt_uint16_t s_loops = 1;
+static char s_exec_buf[CMD_SCRIPT_CMD_MAX + 1];
+
+static void timer_timeout(void *parameter)
+{
+    (void)parameter;
+    rt_sem_release(&s_wake);
+}
+
+/* 距截止时刻的 tick 数，向上取整：醒来时不早于截止时刻（当前 tick 已过去的部分使个别情况需再等一个 tick） */
+static rt_tick_t ticks_until(rt_uint64_t deadline, rt_uint64_t now)
+{
+    rt_tick_t t = (rt_tick_t)(((deadline - now) * RT_TICK_PER_SECOND + 999999ULL) / 1000000ULL);
+    return t ? t : 1;
+}
+
+/* 执行线程内等待到截止时刻；被 cmd_script_stop 打断返回 RT_FALSE。
+ * 不忙等：本线程优先级高于 shell/UI 等，忙等会在窗口内饿死所有低优先级线程 */
+static rt_bool_t wait_until(rt_uint64_t deadline)
+{
+    for (;;)
+    {
+        if (s_stop) return RT_FALSE;
+        rt_uint64_t now = timebase_get_us();
+        if (now >= deadline) return RT_TRUE;
+        rt_tick_t t = ticks_until(deadline, now);
+        rt_timer_control(&s_timer, RT_TIMER_CTRL_SET_TIME, &t);
+        rt_timer_start(&s_timer);
+        rt_sem_take(&s_wake, RT_WAITING_FOREVER);
+        rt_timer_stop(&s_timer);
+    }
+}
+
+/* 执行一条命令并记录；t0/planned 为 timebase 绝对时刻 */
+static void exec_logged(const char *cmd, rt_uint8_t entry, rt_uint64_t t0, rt_uint64_t planned)
+{
+    rt_strncpy(s_exec_buf, cmd, CMD_SCRIPT_CMD_MAX);
+    s_exec_buf[CMD_SCRIPT_CMD_MAX] = '\0';
+
+    rt_uint64_t start = timebase_get_us();
+    int ret = msh_exec(s_exec_buf, strlen(s_exec_buf));
+    rt_uint64_t end = timebase_get_us();
+
+    rt_uint32_t late = (start > planned) ? (rt_uint32_t)(start - planned) : 0;
+    if (s_log_n < CMD_SCRIPT_MAX)
+    {
+        cmd_script_log_t *l = &s_log[s_log_n++];
+        l->at_us = (rt_uint32_t)(start - t0);
+        l->late_us = (rt_int32_t)late;
+        l->dur_us = (rt_uint32_t)(end - start);
+        l->ret = (rt_int16_t)ret;
+        l->entry = entry;
+    }
+    s_stats.cmds++;
+    s_stats.sum_late_us += late;
+    if (late > s_stats.max_late_us) s_stats.max_late_us = late;
+}
+
+static void script_thread_entry(void *parameter)
+{
+    (void)parameter;
+    for (;;)
+    {
+        rt_sem_take(&s_start_sem, RT_WAITING_FOREVER);
+
+        for (rt_uint16_t loop = 0; loop < s_loops && !s_stop; loop++)
+        {
+            /* 每轮在上一轮最后一条命令结束后重新取起点 */
+            rt_uint64_t t0 = timebase_get_us();
+            s_log_n = 0;
+            for (rt_uint8_t i = 0; i < s_count; i++)
+            {
+                rt_uint64_t deadline = t0 + (rt_uint64_t)s_entry[i].offset_ms * 1000ULL;
+                if (!wait_until(deadline)) break;
+                exec_logged(&s_pool[s_entry[i].pos], i, t0, deadline);
+            }
+            s_stats.runs++;
+        }
+        s_running = 0;
+        LOG_I("script done, runs=%u cmds=%u", (unsigned)s_stats.runs, (unsigned)s_stats.cmds);
+    }
+}
+
+rt_err_t cmd_script_init(void)
+{
+    if (s_thread) return RT_EOK;
+    timebase_init();
+    rt_sem_init(&s_start_sem, "scrgo", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&s_wake, "scrwk", 0, RT_IPC_FLAG_FIFO);
+    /* 硬定时器：在 tick 中断中释放信号量，不经过软定时器线程 */
+    rt_timer_init(&s_timer, "scrtm", timer_timeout, RT_NULL, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    s_thread = rt_thread_create("swscr", script_thread_entry, RT_NULL, CMD_SCRIPT_STACK_SIZE, CMD_SCRIPT_PRIORITY, 10);
+    if (!s_thread)
+    {
+        LOG_E("create script thread failed");
+        return -RT_ENOMEM;
+    }
+    rt_thread_startup(s_thread);
+    return RT_EOK;
+}
+
+/* 按偏移插入（同偏移保持上传顺序） */
+rt_err_t cmd_script_add(rt_uint32_t offset_ms, const char *cmd)
+{
+    rt_size_t len = strlen(cmd);
+    if (s_running) return -RT_EBUSY;
+    if (len == 0 || len > CMD_SCRIPT_CMD_MAX || offset_ms > CMD_SCRIPT_OFFSET_MAX_MS) return -RT_EINVAL;
+    if (s_count >= CMD_SCRIPT_MAX || s_pool_used + len + 1 > CMD_SCRIPT_POOL_SIZE) return -RT_EFULL;
+
+    rt_memcpy(&s_pool[s_pool_used], cmd, len + 1);
+    rt_uint8_t i = s_count;
+    while (i > 0 && s_entry[i - 1].offset_ms > offset_ms)
+    {
+        s_entry[i] = s_entry[i - 1];
+        i--;
+    }
+    s_entry[i].offset_ms = offset_ms;
+    s_entry[i].pos = s_pool_used;
+    s_pool_used += (rt_uint16_t)(len + 1);
+    s_count++;
+    return RT_EOK;
+}
+
+void cmd_script_clear(void)
+{
+    if (s_running) return;
+    s_count = 0;
+    s_pool_used = 0;
+}
+
+rt_err_t cmd_script_run(rt_uint16_t loops)
+{
+    if (cmd_script_init() != RT_EOK) return -RT_ERROR;
+    if (s_running) return -RT_EBUSY;
+    if (s_count == 0) return -RT_EEMPTY;
+
+    rt_memset(&s_stats, 0, sizeof(s_stats));
+    s_loops = loops ? loops : 1;
+    s_stop = 0;
+    s_running = 1;
+    rt_sem_release(&s_start_sem);
+    return RT_EOK;
+}
+
+void cmd_script_stop(void)
+{
+    if (!s_running) return;
+    s_stop = 1;
+    rt_sem_release(&s_wake);
+}
+
+/* ================== 命令 ================== */
+static void print_log(void)
+{
+    rt_kprintf("idx at_us late_us dur_us ret\n");
+    for (rt_uint8_t i = 0; i < s_log_n; i++)
+    {
+        const cmd_script_log_t *l = &s_log[i];
+        rt_kprintf("%3u %9u %7d %7u %3d\n", (unsigned)l->entry, (unsigned)l->at_us,
+                   (int)l->late_us, (unsigned)l->dur_us, (int)l->ret);
+    }
+    rt_kprintf("runs=%u cmds=%u max_late=%u us avg_late=%u us\n",
+               (unsigned)s_stats.runs, (unsigned)s_stats.cmds, (unsigned)s_stats.max_late_us,
+               (unsigned)(s_stats.cmds ? s_stats.sum_late_us / s_stats.cmds : 0));
+}
+
+/* shell 线程内睡眠到截止时刻（按 tick 向上取整，不忙等） */
+static void batch_sleep_until(rt_uint64_t deadline)
+{
+    rt_uint64_t now;
+    while ((now = timebase_get_us()) < deadline)
+    {
+        rt_thread_delay(ticks_until(deadline, now));
+    }
+}
+
+static char *trim(char *s)
+{
+    while (*s == ' ' || *s == '\t') s++;
+    char *e = s + strlen(s);
+    while (e > s && (e[-1] == ' ' || e[-1] == '\t')) *--e = '\0';
+    return s;
+}
+
+/* sw_batch "sw_start; wait 1000; sw_lap; wait 500; sw_stop" —— 也可不加引号，参数以空格拼接 */
+static int cmd_sw_batch(int argc, char **argv)
+{
+    static char line[FINSH_CMD_SIZE + 1];
+    if (argc < 2)
+    {
+        rt_kprintf("usage: sw_batch \"cmd; wait <ms>; cmd; ...\"\n");
+        return -RT_ERROR;
+    }
+    if (s_running)
+    {
+        rt_kprintf("sw_batch: script running\n");
+        return -RT_EBUSY;
+    }
+
+    rt_size_t n = 0;
+    line[0] = '\0';
+    for (int i = 1; i < argc; i++)
+    {
+        rt_size_t len = strlen(argv[i]);
+        if (n + len + 1 > FINSH_CMD_SIZE) break;
+        if (n) line[n++] = ' ';
+        rt_memcpy(&line[n], argv[i], len);
+        n += len;
+        line[n] = '\0';
+    }
+
+    rt_memset(&s_stats, 0, sizeof(s_stats));
+    s_log_n = 0;
+    rt_uint64_t t0 = timebase_get_us();
+    rt_uint64_t planned = t0;
+    rt_uint8_t idx = 0;
+    char *p = line;
+    while (p)
+    {
+        char *sep = strchr(p, ';');
+        if (sep) *sep = '\0';
+        char *cmd = trim(p);
+        p = sep ? sep + 1 : RT_NULL;
+        if (*cmd == '\0') continue;
+
+        if (!strncmp(cmd, "wait", 4) && (cmd[4] == ' ' || cmd[4] == '\0'))
+        {
+            long ms = atol(cmd + 4);
+            if (ms < 0 || (unsigned long)ms > CMD_SCRIPT_OFFSET_MAX_MS)
+            {
+                rt_kprintf("sw_batch: skip '%s' (0..%lu ms)\n", cmd, (unsigned long)CMD_SCRIPT_OFFSET_MAX_MS);
+                continue;
+            }
+            planned += (rt_uint64_t)ms * 1000ULL;
+            continue;
+        }
+        /* 批内不允许嵌套批处理或启动脚本（共用执行缓冲与记录） */
+        if (!strncmp(cmd, "sw_batch", 8) || !strncmp(cmd, "sw_script", 9))
+        {
+            rt_kprintf("sw_batch: skip '%s'\n", cmd);
+            continue;
+        }
+        batch_sleep_until(planned);
+        /* 行时间戳属于 sw_batch 本行，批内命令按实际执行时刻打点 */
+        msh_clear_line_timestamp();
+        exec_logged(cmd, idx++, t0, planned);
+    }
+    s_stats.runs = 1;
+    print_log();
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_batch, sw_batch, Run_commands_separated_by_semicolon);
+
+static void script_usage(void)
+{
+    rt_kprintf("usage: sw_script add <offset_ms> <cmd...>|clear|list|run [loops]|stop|log\n");
+}
+
+static int cmd_sw_script(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        script_usage();
+        return -RT_ERROR;
+    }
+    if (!strcmp(argv[1], "add"))
+    {
+        static char cmd[CMD_SCRIPT_CMD_MAX + 1];
+        rt_size_t n = 0;
+        if (argc < 4)
+        {
+            script_usage();
+            return -RT_ERROR;
+        }
+        cmd[0] = '\0';
+        for (int i = 3; i < argc; i++)
+        {
+            rt_size_t len = strlen(argv[i]);
+            if (n + len + 1 > CMD_SCRIPT_CMD_MAX) break;
+            if (n) cmd[n++] = ' ';
+            rt_memcpy(&cmd[n], argv[i], len);
+            n += len;
+            cmd[n] = '\0';
+        }
+        long offset = atol(argv[2]);
+        if (offset < 0 || (unsigned long)offset > CMD_SCRIPT_OFFSET_MAX_MS)
+        {
+            rt_kprintf("sw_script: offset must be 0..%lu ms\n", (unsigned long)CMD_SCRIPT_OFFSET_MAX_MS);
+            return -RT_ERROR;
+        }
+        rt_err_t r = cmd_script_add((rt_uint32_t)offset, cmd);
+        if (r != RT_EOK)
+        {
+            rt_kprintf("sw_script: add failed (%d)\n", (int)r);
+            return -RT_ERROR;
+        }
+        rt_kprintf("sw_script: %u entries, pool %u/%u\n", (unsigned)s_count,
+                   (unsigned)s_pool_used, (unsigned)CMD_SCRIPT_POOL_SIZE);
+        return 0;
+    }
+    else if (!strcmp(argv[1], "clear"))
+    {
+        if (s_running)
+        {
+            rt_kprintf("sw_script: running\n");
+            return -RT_EBUSY;
+        }
+        cmd_script_clear();
+        rt_kprintf("sw_script: cleared\n");
+        return 0;
+    }
+    else if (!strcmp(argv[1], "list"))
+    {
+        for (rt_uint8_t i = 0; i < s_count; i++)
+        {
+            rt_kprintf("%2u +%u ms: %s\n", (unsigned)i, (unsigned)s_entry[i].offset_ms, &s_pool[s_entry[i].pos]);
+        }
+        rt_kprintf("%u entries, running=%u\n", (unsigned)s_count, (unsigned)s_running);
+        return 0;
+    }
+    else if (!strcmp(argv[1], "run"))
+    {
+        rt_err_t r = cmd_script_run((argc >= 3) ? (rt_uint16_t)atoi(argv[2]) : 1);
+        if (r != RT_EOK)
+        {
+            rt_kprintf("sw_script: run failed (%d)\n", (int)r);
+            return -RT_ERROR;
+        }
+        rt_kprintf("sw_script: running %u entries\n", (unsigned)s_count);
+        return 0;
+    }
+    else if (!strcmp(argv[1], "stop"))
+    {
+        cmd_script_stop();
+        rt_kprintf("sw_script: stop\n");
+        return 0;
+    }
+    else if (!strcmp(argv[1], "log"))
+    {
+        if (s_running)
+        {
+            rt_kprintf("sw_script: running\n");
+            return -RT_EBUSY;
+        }
+        print_log();
+        return 0;
+    }
+    script_usage();
+    return -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_script, sw_script, Timed_command_script);
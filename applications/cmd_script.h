@@ -0,0 +1,58 @@
+#ifndef APPLICATIONS_CMD_SCRIPT_H_
+#define APPLICATIONS_CMD_SCRIPT_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 定时脚本最多条目数 */
+#ifndef CMD_SCRIPT_MAX
+#define CMD_SCRIPT_MAX          16
+#endif
+/* 脚本命令文本池（所有条目共用，含结尾 '\0'） */
+#ifndef CMD_SCRIPT_POOL_SIZE
+#define CMD_SCRIPT_POOL_SIZE    384
+#endif
+/* 执行单条命令的拷贝缓冲（msh_exec 会就地切分参数） */
+#ifndef CMD_SCRIPT_CMD_MAX
+#define CMD_SCRIPT_CMD_MAX      FINSH_CMD_SIZE
+#endif
+/* 单条命令的最大偏移 / sw_batch 单次 wait（ms）：保证换算出的 tick 数远小于 RT_TICK_MAX / 2 */
+#ifndef CMD_SCRIPT_OFFSET_MAX_MS
+#define CMD_SCRIPT_OFFSET_MAX_MS 86400000UL
+#endif
+/* 执行线程栈：脚本经 msh_exec 执行任意 shell 命令，需与 shell 线程同样大小（如 sw_hist show 单帧约 800B） */
+#ifndef CMD_SCRIPT_STACK_SIZE
+#define CMD_SCRIPT_STACK_SIZE   FINSH_THREAD_STACK_SIZE
+#endif
+/* 执行线程优先级：高于 main 与 shell，低于秒表服务与定时器线程 */
+#ifndef CMD_SCRIPT_PRIORITY
+#define CMD_SCRIPT_PRIORITY     8
+#endif
+
+/* 一条执行记录（sw_batch 与定时脚本共用） */
+typedef struct
+{
+    rt_uint32_t at_us;          /* 实际开始时刻相对本次运行起点 */
+    rt_int32_t  late_us;        /* 相对计划时刻的延迟 */
+    rt_uint32_t dur_us;         /* msh_exec 执行耗时 */
+    rt_int16_t  ret;            /* 命令返回值，-1 为未找到 */
+    rt_uint8_t  entry;          /* 对应脚本条目/批处理第几条 */
+} cmd_script_log_t;
+
+/* 创建执行线程；首次 cmd_script_run 时自动调用，无需在启动时调用 */
+rt_err_t cmd_script_init(void);
+/* offset_ms 超过 CMD_SCRIPT_OFFSET_MAX_MS 返回 -RT_EINVAL */
+rt_err_t cmd_script_add(rt_uint32_t offset_ms, const char *cmd);
+void     cmd_script_clear(void);
+/* loops=0 视为 1；脚本在执行线程中按 timebase 偏移逐条派发 */
+rt_err_t cmd_script_run(rt_uint16_t loops);
+void     cmd_script_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_CMD_SCRIPT_H_ */
@@ -0,0 +1,325 @@
+#include "console_rx.h"
+#include <rthw.h>
+#include <finsh.h>
+#include <msh.h>
+#include <string.h>
+#include "timebase.h"
+#include "stopwatch.h"
+
+#define DBG_TAG "conrx"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 控制台接收：可选 DMA + 空闲线检测（serial 框架的 _serial_dma_rx 路径），
+ * 并在 shell 的 rx_indicate 之前插入钩子：统计唤醒次数与最近一次到达时刻，
+ * 原始控制模式下扫描新到字节，识别控制字节后直接投递秒表命令，应答由 "rawack" 线程发出。 */
+
+#if !STOPWATCH_USING_SERVICE
+#warning "raw control bytes need STOPWATCH_USING_SERVICE (ISR-safe submit); sw_raw is disabled"
+#endif
+
+typedef struct
+{
+    rt_uint8_t  cmd;
+    rt_uint8_t  status;
+    rt_uint8_t  seq;
+    rt_uint32_t t_us;
+} raw_ack_t;
+
+static rt_device_t s_dev = RT_NULL;
+static rt_err_t (*s_next_ind)(rt_device_t dev, rt_size_t size) = RT_NULL;
+static console_rx_stats_t s_stats;
+static volatile rt_uint64_t s_last_us = 0;
+static rt_uint16_t s_scan_idx = 0;          /* 已扫描到的接收缓冲位置 */
+static rt_uint8_t s_raw_seq = 0;
+static rt_uint8_t s_prev_cr = 0;            /* 上一字节是 \r：紧随的 \n 不再计行 */
+static rt_uint32_t s_char_us = 87;          /* 一个字符（10 位）的传输时间 */
+
+#define LTS_MASK    (CONSOLE_RX_LINE_TS_DEPTH - 1U)
+#if (CONSOLE_RX_LINE_TS_DEPTH & (CONSOLE_RX_LINE_TS_DEPTH - 1)) != 0
+#error "CONSOLE_RX_LINE_TS_DEPTH must be a power of 2"
+#endif
+static rt_uint64_t s_lts[CONSOLE_RX_LINE_TS_DEPTH];   /* 行结束符到达时刻（ISR 写 head，shell 线程写 tail） */
+static volatile rt_uint32_t s_lts_head = 0;
+static volatile rt_uint32_t s_lts_tail = 0;
+
+static struct rt_messagequeue s_ack_mq;
+static rt_uint8_t s_ack_pool[CONSOLE_RX_RAW_ACK_DEPTH * (RT_ALIGN(sizeof(raw_ack_t), RT_ALIGN_SIZE) + sizeof(void *))];
+static rt_thread_t s_ack_thread = RT_NULL;
+
+static void raw_handle(rt_uint8_t c, rt_uint64_t t_us)
+{
+    raw_ack_t ack;
+    rt_err_t r = RT_EOK;
+
+    switch (c)
+    {
+    case CONSOLE_RX_RAW_START: stopwatch_start_at(t_us); break;
+    case CONSOLE_RX_RAW_STOP:  stopwatch_stop_at(t_us); break;
+    case CONSOLE_RX_RAW_LAP:   r = stopwatch_lap_at(t_us, RT_NULL); break;
+    default:                   stopwatch_reset(); break;
+    }
+    s_stats.raw_cmds++;
+    if (r != RT_EOK) s_stats.raw_rejected++;
+
+    ack.cmd = c;
+    ack.status = (r == RT_EOK) ? 0 : 1;
+    ack.seq = s_raw_seq++;
+    ack.t_us = (rt_uint32_t)t_us;
+    if (rt_mq_send(&s_ack_mq, &ack, sizeof(ack)) != RT_EOK) s_stats.ack_dropped++;
+}
+
+static void line_ts_push(rt_uint64_t t_us)
+{
+    if (s_lts_head - s_lts_tail >= CONSOLE_RX_LINE_TS_DEPTH)
+    {
+        s_stats.line_ts_dropped++;
+        return;
+    }
+    s_lts[s_lts_head & LTS_MASK] = t_us;
+    s_lts_head++;
+}
+
+static rt_size_t rx_pending(void)
+{
+    struct rt_serial_device *serial = (struct rt_serial_device *)s_dev;
+    struct rt_serial_rx_fifo *fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
+    rt_uint16_t bufsz = serial->config.bufsz;
+    if (!fifo || bufsz == 0) return 0;
+    if (fifo->is_full) return bufsz;
+    return (fifo->put_index >= fifo->get_index) ? (fifo->put_index - fifo->get_index)
+                                                : (bufsz - fifo->get_index + fifo->put_index);
+}
+
+/* 扫描上次位置到 put_index 之间的新字节（中断接收与 DMA 接收共用 rt_serial_rx_fifo）。
+ * 钩子在一批字节之后才被调用，按其后还有几个字节回推每个字节的到达时刻；
+ * 空闲中断在末字节后再空一个字符时间才触发，多回推一个字符。
+ * 行结束符记入行时间戳队列；原始控制模式下识别控制字节 */
+static void rx_scan(rt_device_t dev, rt_uint64_t now_us)
+{
+    struct rt_serial_device *serial = (struct rt_serial_device *)dev;
+    struct rt_serial_rx_fifo *fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
+    rt_uint16_t bufsz = serial->config.bufsz;
+    if (!fifo || bufsz == 0) return;
+
+    rt_uint16_t put = fifo->put_index;
+    rt_uint16_t i = (s_scan_idx < bufsz) ? s_scan_idx : 0;
+    s_scan_idx = put;
+
+    rt_uint16_t n = (put >= i) ? (put - i) : (bufsz - i + put);
+    for (rt_uint16_t k = 0; k < n; k++)
+    {
+        rt_uint8_t c = fifo->buffer[i];
+        rt_uint64_t t = now_us - (rt_uint32_t)(n - 1 - k + (s_stats.dma ? 1 : 0)) * s_char_us;
+        if (c == '\r' || c == '\n')
+        {
+            line_ts_push(t);
+            if (c == '\r' || !s_prev_cr) s_stats.lines++;
+        }
+        else if (s_stats.raw && c >= CONSOLE_RX_RAW_START && c <= CONSOLE_RX_RAW_RESET)
+        {
+            fifo->buffer[i] = 0x00;
+            raw_handle(c, t);
+        }
+        s_prev_cr = (c == '\r');
+        if (++i >= bufsz) i = 0;
+    }
+}
+
+/* 覆盖 msh.c 中的弱函数：shell 每处理一个行结束符取一条（与接收顺序一一对应） */
+rt_uint64_t msh_line_timestamp_pop(void)
+{
+    rt_uint64_t t = 0;
+    if (!s_dev) return 0;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    if (s_lts_tail != s_lts_head)
+    {
+        t = s_lts[s_lts_tail & LTS_MASK];
+        s_lts_tail++;
+    }
+    /* 接收缓冲已读空时剩余记录不可能再被对应（溢出丢字节等），丢弃以免后续错位 */
+    if (rx_pending() == 0 && s_lts_tail != s_lts_head)
+    {
+        s_stats.line_ts_dropped += s_lts_head - s_lts_tail;
+        s_lts_tail = s_lts_head;
+    }
+    rt_hw_interrupt_enable(level);
+    return t;
+}
+
+static rt_err_t console_rx_ind(rt_device_t dev, rt_size_t size)
+{
+    rt_uint64_t now = timebase_get_us();
+    s_stats.indicates++;
+    if (size > s_stats.max_pending) s_stats.max_pending = size;
+    s_last_us = now;
+    rx_scan(dev, now);
+    return s_next_ind ? s_next_ind(dev, size) : RT_EOK;
+}
+
+static void raw_ack_entry(void *parameter)
+{
+    (void)parameter;
+    raw_ack_t ack;
+    rt_uint8_t frame[CONSOLE_RX_ACK_SIZE];
+
+    while (1)
+    {
+        if (rt_mq_recv(&s_ack_mq, &ack, sizeof(ack), RT_WAITING_FOREVER) != RT_EOK) continue;
+
+        frame[0] = CONSOLE_RX_ACK_MAGIC;
+        frame[1] = ack.cmd;
+        frame[2] = ack.status;
+        frame[3] = ack.seq;
+        frame[4] = (rt_uint8_t)ack.t_us;
+        frame[5] = (rt_uint8_t)(ack.t_us >> 8);
+        frame[6] = (rt_uint8_t)(ack.t_us >> 16);
+        frame[7] = (rt_uint8_t)(ack.t_us >> 24);
+
+        rt_device_t con = rt_console_get_device();
+        if (!con) continue;
+        /* 二进制应答不做 \n → \r\n 转换 */
+        rt_uint16_t old_flag = con->open_flag;
+        con->open_flag &= ~RT_DEVICE_FLAG_STREAM;
+        rt_device_write(con, 0, frame, sizeof(frame));
+        con->open_flag = old_flag;
+    }
+}
+
+rt_err_t console_rx_set_raw(rt_bool_t on)
+{
+#if STOPWATCH_USING_SERVICE
+    if (on && s_ack_thread == RT_NULL)
+    {
+        rt_mq_init(&s_ack_mq, "rawack", s_ack_pool, sizeof(raw_ack_t), sizeof(s_ack_pool), RT_IPC_FLAG_FIFO);
+        s_ack_thread = rt_thread_create("rawack", raw_ack_entry, RT_NULL, 512, 13, 10);
+        if (!s_ack_thread)
+        {
+            rt_mq_detach(&s_ack_mq);
+            return -RT_ENOMEM;
+        }
+        rt_thread_startup(s_ack_thread);
+    }
+    s_stats.raw = on ? 1 : 0;
+    return RT_EOK;
+#else
+    (void)on;
+    return -RT_ENOSYS;
+#endif
+}
+
+rt_err_t console_rx_init(void)
+{
+    if (s_dev) return RT_EOK;
+
+    rt_device_t dev = rt_device_find(CONSOLE_RX_UART_NAME);
+    if (!dev) return -RT_EEMPTY;
+
+#if CONSOLE_RX_USING_DMA
+    /* 接收缓冲在首次带接收标志打开时建立，须先于 shell 的 INT_RX 打开 */
+    if (!(dev->open_flag & RT_DEVICE_FLAG_INT_RX) &&
+        rt_device_open(dev, dev->open_flag | RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_DMA_RX) == RT_EOK)
+    {
+        s_stats.dma = 1;
+    }
+    else
+    {
+        LOG_W("%s: DMA RX unavailable, using per-byte interrupts", CONSOLE_RX_UART_NAME);
+    }
+#endif
+
+#ifdef RT_USING_FINSH
+    finsh_set_device(CONSOLE_RX_UART_NAME);
+#endif
+
+#if CONSOLE_RX_USING_DMA
+    if (s_stats.dma)
+    {
+        /* shell 以 INT_RX 重新打开时 open_flag 被覆盖，读路径须按 DMA 缓冲走 */
+        dev->open_flag = (dev->open_flag & ~RT_DEVICE_FLAG_INT_RX) | RT_DEVICE_FLAG_DMA_RX;
+    }
+#endif
+
+    struct rt_serial_device *serial = (struct rt_serial_device *)dev;
+    if (serial->config.baud_rate) s_char_us = 10000000UL / serial->config.baud_rate;
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    s_next_ind = dev->rx_indicate;
+    dev->rx_indicate = console_rx_ind;
+    rt_hw_interrupt_enable(level);
+
+    s_dev = dev;
+    return RT_EOK;
+}
+
+void console_rx_get_stats(console_rx_stats_t *out)
+{
+    *out = s_stats;
+}
+
+rt_uint64_t console_rx_last_us(void)
+{
+    return s_last_us;
+}
+
+/* ================== 命令 ================== */
+static int cmd_sw_rx(int argc, char **argv)
+{
+    if (argc >= 2 && !strcmp(argv[1], "reset"))
+    {
+        s_stats.indicates = 0;
+        s_stats.max_pending = 0;
+        s_stats.lines = 0;
+    }
+    rt_kprintf("rx=%s indicates=%u max_pending=%u bufsz=%u line_ts_dropped=%u\n", s_stats.dma ? "dma+idle" : "int",
+               (unsigned)s_stats.indicates, (unsigned)s_stats.max_pending, (unsigned)RT_SERIAL_RB_BUFSZ,
+               (unsigned)s_stats.line_ts_dropped);
+    /* 每次接收通知即一次 USART/DMA 接收中断 */
+    if (s_stats.lines)
+    {
+        rt_uint32_t x100 = (rt_uint32_t)((rt_uint64_t)s_stats.indicates * 100U / s_stats.lines);
+        rt_kprintf("lines=%u irq_per_line=%u.%02u\n", (unsigned)s_stats.lines, (unsigned)(x100 / 100U),
+                   (unsigned)(x100 % 100U));
+    }
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_rx, sw_rx, Console_RX_stats);
+
+/* sw_raw on|off|stat：0x01 开始 0x02 暂停 0x03 圈速 0x04 复位 */
+static int cmd_sw_raw(int argc, char **argv)
+{
+    if (argc >= 2 && (!strcmp(argv[1], "on") || !strcmp(argv[1], "off")))
+    {
+        rt_err_t r = console_rx_set_raw(!strcmp(argv[1], "on"));
+        if (r != RT_EOK)
+        {
+            rt_kprintf("sw_raw: failed (%d)\n", (int)r);
+            return r;
+        }
+        rt_kprintf("sw_raw: %s\n", s_stats.raw ? "on" : "off");
+        return 0;
+    }
+    if (argc >= 2 && !strcmp(argv[1], "stat"))
+    {
+        rt_kprintf("raw=%s cmds=%u rejected=%u ack_dropped=%u char_us=%u\n", s_stats.raw ? "on" : "off",
+                   (unsigned)s_stats.raw_cmds, (unsigned)s_stats.raw_rejected, (unsigned)s_stats.ack_dropped,
+                   (unsigned)s_char_us);
+        return 0;
+    }
+    rt_kprintf("usage: sw_raw on|off|stat\n");
+    return -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_raw, sw_raw, Raw_control_byte_mode);
+
+/* 本命令行结束符到达（无行时间戳时取最近一次接收通知）到命令开始执行的时间 */
+static int cmd_sw_rx_ping(int argc, char **argv)
+{
+    (void)argc; (void)argv;
+    rt_uint64_t now = timebase_get_us();
+    rt_uint64_t t = msh_get_line_timestamp();
+    if (t == 0) t = s_last_us;
+    rt_kprintf("rx_to_exec=%u us\n", (unsigned)(now - t));
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_rx_ping, sw_rx_ping, RX_to_exec_latency);
@@ -0,0 +1,68 @@
+#ifndef APPLICATIONS_CONSOLE_RX_H_
+#define APPLICATIONS_CONSOLE_RX_H_
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "board.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 控制台接收串口 */
+#ifndef CONSOLE_RX_UART_NAME
+#define CONSOLE_RX_UART_NAME        RT_CONSOLE_DEVICE_NAME
+#endif
+/* 1：以 DMA 循环缓冲 + USART 空闲中断接收，整段突发只唤醒一次 shell。
+ * 需 RT_SERIAL_USING_DMA 与 board.h 中 BSP_UART1_RX_USING_DMA；缓冲大小即 RT_SERIAL_RB_BUFSZ，
+ * 批量粘贴命令时建议调大到 256 */
+#ifndef CONSOLE_RX_USING_DMA
+#if defined(RT_SERIAL_USING_DMA) && defined(BSP_UART1_RX_USING_DMA)
+#define CONSOLE_RX_USING_DMA        1
+#else
+#define CONSOLE_RX_USING_DMA        0
+#endif
+#endif
+
+/* 原始控制字节：在接收回调（中断上下文）中识别并打时间戳，直接投递给秒表服务，不经 msh 解析；
+ * 识别后的字节在接收缓冲中改写为 0x00（shell 忽略），普通命令输入不受影响。
+ * 应答为二进制帧：CONSOLE_RX_ACK_MAGIC, 控制字节, 状态(0=成功), 序号(u8), 捕获时刻 t_us 低 32 位(小端) */
+#ifndef CONSOLE_RX_RAW_ACK_DEPTH
+#define CONSOLE_RX_RAW_ACK_DEPTH    8
+#endif
+/* 行时间戳队列深度（2 的幂）：shell 尚未处理的行结束符个数上限 */
+#ifndef CONSOLE_RX_LINE_TS_DEPTH
+#define CONSOLE_RX_LINE_TS_DEPTH    8
+#endif
+#define CONSOLE_RX_RAW_START        0x01
+#define CONSOLE_RX_RAW_STOP         0x02
+#define CONSOLE_RX_RAW_LAP          0x03
+#define CONSOLE_RX_RAW_RESET        0x04
+#define CONSOLE_RX_ACK_MAGIC        0xAC
+#define CONSOLE_RX_ACK_SIZE         8
+
+typedef struct
+{
+    rt_uint32_t indicates;      /* 接收通知次数（中断接收为每字节一次，DMA 为每段突发一次） */
+    rt_uint32_t max_pending;    /* 通知时缓冲中待读字节的最大值 */
+    rt_uint32_t lines;          /* 收到的命令行数（\r、\n 或 \r\n 各计一行） */
+    rt_uint32_t raw_cmds;       /* 已处理的原始控制字节 */
+    rt_uint32_t raw_rejected;   /* 秒表队满被拒绝 */
+    rt_uint32_t ack_dropped;    /* 应答队列满丢弃 */
+    rt_uint32_t line_ts_dropped;/* 行时间戳队列溢出/失配丢弃 */
+    rt_uint8_t  dma;
+    rt_uint8_t  raw;            /* 原始控制模式是否开启 */
+} console_rx_stats_t;
+
+/* 须在 shell 线程首次运行前调用（main 开头），之后 shell 输入绑定到该串口 */
+rt_err_t    console_rx_init(void);
+void        console_rx_get_stats(console_rx_stats_t *out);
+/* 最近一次接收通知的时刻（timebase us） */
+rt_uint64_t console_rx_last_us(void);
+rt_err_t    console_rx_set_raw(rt_bool_t on);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_CONSOLE_RX_H_ */
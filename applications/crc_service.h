@@ -0,0 +1,54 @@
+#ifndef APPLICATIONS_CRC_SERVICE_H_
+#define APPLICATIONS_CRC_SERVICE_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 校验服务：存储记录用 CRC-32/MPEG-2（多项式 0x04C11DB7，初值 0xFFFFFFFF，不反射、无结果异或，
+ * 与 STM32 CRC 单元一致），遥测帧用 CRC-16/CCITT-FALSE。
+ * CRC-32 有两个后端：hwcrypto 框架下的片上 CRC 单元（drv_crypto.c），以及 slice-by-4 查表的软件实现
+ * （模拟器/主机/中断上下文/短数据），两者结果逐位一致，可分段累加。 */
+
+#define CRC32_INIT              0xFFFFFFFFUL
+
+/* 片上 CRC 单元经 hwcrypto 框架注册时启用硬件后端 */
+#if defined(RT_USING_HWCRYPTO) && defined(RT_HWCRYPTO_USING_CRC)
+#define CRC_SERVICE_USING_HW    1
+#else
+#define CRC_SERVICE_USING_HW    0
+#endif
+
+/* 短于该长度走软件：硬件路径有加锁与预置初值的固定开销（以 sw_crc 基准为准调整） */
+#ifndef CRC_SERVICE_HW_MIN
+#define CRC_SERVICE_HW_MIN      32
+#endif
+
+typedef enum
+{
+    CRC_BACKEND_BITWISE = 0,    /* 逐位参考实现，仅用于对拍 */
+    CRC_BACKEND_SLICE4,         /* slice-by-4 查表（4×256 项常量表） */
+    CRC_BACKEND_HW,             /* hwcrypto 片上 CRC 单元 */
+    CRC_BACKEND_NUM,
+} crc_backend_t;
+
+/* 绑定默认 hwcrypto 设备并用标准向量自检，失败则只用软件；须在线程上下文调用，早于其他模块的存储初始化 */
+rt_err_t crc_service_init(void);
+rt_bool_t crc_service_hw_ready(void);
+
+/* 从 crc 继续累加 n 字节（首段传 CRC32_INIT），自动选择后端，任意上下文可调用 */
+rt_uint32_t crc32_update(rt_uint32_t crc, const void *data, rt_size_t n);
+rt_uint32_t crc32_calc(const void *data, rt_size_t n);
+/* 指定后端（基准/对拍用）；硬件不可用或处于中断上下文时 CRC_BACKEND_HW 退回 slice-by-4 */
+rt_uint32_t crc32_update_with(crc_backend_t backend, rt_uint32_t crc, const void *data, rt_size_t n);
+
+/* CRC-16/CCITT-FALSE（多项式 0x1021，初值 0xFFFF），半字节查表 */
+rt_uint16_t crc16_ccitt(const rt_uint8_t *data, rt_size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_CRC_SERVICE_H_ */
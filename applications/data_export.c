@@ -0,0 +1,280 @@
+#include "data_export.h"
+#include <finsh.h>
+#include <rtdevice.h>
+#include <string.h>
+#include "crc_service.h"
+#include "session_archive.h"
+#include "stopwatch.h"
+#include "telemetry_stream.h"
+#ifdef RT_USING_RYM
+#include <ymodem.h>
+#endif
+#ifdef RT_USING_DFS
+#include <dfs_posix.h>
+#define DATA_EXPORT_USING_DFS   1
+#else
+#define DATA_EXPORT_USING_DFS   0
+#endif
+
+#ifdef RT_USING_RYM
+
+/* 表头 + 每圈一行（三个十进制数最长 32 字符） */
+#define LAPS_CSV_MAX    (24 + STOPWATCH_MAX_LAPS * 36)
+
+typedef struct
+{
+    struct rym_ctx parent;      /* 须为首成员，协议回调直接强转 */
+    export_src_t src;
+    char name[32];
+    rt_uint32_t size;
+    rt_uint32_t off;
+    rt_uint32_t crc;
+    rt_uint32_t blocks;
+    rt_tick_t t0;
+    rt_uint8_t begun;           /* 已收到接收端 'C' */
+    rt_err_t err;               /* 数据源读取失败 */
+    int fd;
+    char *text;
+} export_ctx_t;
+
+/* 快照只保留最近 lap_count 圈：末圈结束于 last_lap_total_ms，由此倒推首圈之前的分段时刻 */
+static char *laps_csv(rt_uint32_t *size)
+{
+    stopwatch_snapshot_t snap;
+    rt_uint32_t split, first;
+    rt_size_t n;
+    char *p = rt_malloc(LAPS_CSV_MAX);
+
+    if (!p) return RT_NULL;
+    stopwatch_get_snapshot(&snap);
+    first = snap.lap_total - snap.lap_count + 1;
+    split = snap.last_lap_total_ms;
+    for (rt_uint16_t i = 0; i < snap.lap_count; i++) split -= snap.lap_durations_ms[i];
+
+    n = rt_snprintf(p, LAPS_CSV_MAX, "lap,lap_ms,split_ms\n");
+    for (rt_uint16_t i = 0; i < snap.lap_count; i++)
+    {
+        split += snap.lap_durations_ms[i];
+        n += rt_snprintf(p + n, LAPS_CSV_MAX - n, "%u,%u,%u\n", (unsigned)(first + i),
+                         (unsigned)snap.lap_durations_ms[i], (unsigned)split);
+    }
+    *size = (rt_uint32_t)n;
+    return p;
+}
+
+static int src_read(export_ctx_t *x, rt_uint8_t *buf, rt_size_t len)
+{
+    switch (x->src)
+    {
+    case EXPORT_SRC_ARCHIVE:
+        return (session_archive_read_image(x->off, buf, len) == RT_EOK) ? (int)len : -1;
+    case EXPORT_SRC_LAPS:
+        rt_memcpy(buf, x->text + x->off, len);
+        return (int)len;
+#if DATA_EXPORT_USING_DFS
+    case EXPORT_SRC_FILE:
+    {
+        int got = 0, r;
+        while (got < (int)len && (r = read(x->fd, buf + got, len - got)) > 0) got += r;
+        return got;
+    }
+#endif
+    default:
+        return -1;
+    }
+}
+
+/* 包 0：文件名 NUL 十进制长度，其余补 0 */
+static enum rym_code export_on_begin(struct rym_ctx *ctx, rt_uint8_t *buf, rt_size_t len)
+{
+    export_ctx_t *x = (export_ctx_t *)ctx;
+    rt_size_t n = rt_strlen(x->name) + 1;
+
+    rt_memset(buf, 0, len);
+    rt_memcpy(buf, x->name, n);
+    rt_snprintf((char *)buf + n, len - n, "%u", (unsigned)x->size);
+    x->t0 = rt_tick_get();
+    x->begun = 1;
+    return RYM_CODE_SOH;
+}
+
+/* len 为 1K；剩余不超过 128 字节时改发短包，少发约 900 字节填充 */
+static enum rym_code export_on_data(struct rym_ctx *ctx, rt_uint8_t *buf, rt_size_t len)
+{
+    export_ctx_t *x = (export_ctx_t *)ctx;
+    rt_uint32_t left = x->size - x->off;
+    enum rym_code code = (left > 128) ? RYM_CODE_STX : RYM_CODE_SOH;
+    rt_size_t pkt = (code == RYM_CODE_STX) ? len : 128;
+    rt_size_t n = (left < pkt) ? left : pkt;
+
+    if (n && src_read(x, buf, n) != (int)n)
+    {
+        x->err = -RT_EIO;
+        return RYM_CODE_CAN;
+    }
+    x->crc = crc32_update(x->crc, buf, n);
+    /* 末包以 CPMEOF 填充，接收端按包 0 的长度截断 */
+    rt_memset(buf + n, 0x1A, pkt - n);
+    x->off += n;
+    x->blocks++;
+    if (x->off >= x->size) ctx->stage = RYM_STAGE_FINISHING;
+    return code;
+}
+
+static enum rym_code export_on_end(struct rym_ctx *ctx, rt_uint8_t *buf, rt_size_t len)
+{
+    rt_memset(buf, 0, len);
+    return RYM_CODE_SOH;
+}
+
+static rt_err_t export_prepare(export_ctx_t *x, const char *path)
+{
+    rt_uint32_t probe;
+
+    switch (x->src)
+    {
+    case EXPORT_SRC_ARCHIVE:
+        /* 归档未挂载时不进入协议 */
+        if (session_archive_read_image(0, &probe, sizeof(probe)) != RT_EOK) return -RT_EEMPTY;
+        rt_strncpy(x->name, "ARCHIVE.SAR", sizeof(x->name) - 1);
+        x->size = SESSION_ARCHIVE_PAGES * SESSION_ARCHIVE_PAGE_SIZE;
+        return RT_EOK;
+    case EXPORT_SRC_LAPS:
+        x->text = laps_csv(&x->size);
+        if (!x->text) return -RT_ENOMEM;
+        rt_strncpy(x->name, "LAPS.CSV", sizeof(x->name) - 1);
+        return RT_EOK;
+    case EXPORT_SRC_FILE:
+#if DATA_EXPORT_USING_DFS
+    {
+        struct stat st;
+        const char *base;
+
+        if (!path || stat(path, &st) != 0) return -RT_EEMPTY;
+        x->fd = open(path, O_RDONLY, 0);
+        if (x->fd < 0) return -RT_EIO;
+        base = strrchr(path, '/');
+        rt_strncpy(x->name, base ? base + 1 : path, sizeof(x->name) - 1);
+        x->size = (rt_uint32_t)st.st_size;
+        return RT_EOK;
+    }
+#else
+        return -RT_ENOSYS;
+#endif
+    default:
+        return -RT_EINVAL;
+    }
+}
+
+rt_err_t data_export_send(export_src_t src, const char *path, export_result_t *out)
+{
+    /* 出错时通知接收端放弃，免得它等到超时 */
+    static const char cancel[] = "\x18\x18\x18\x18\x18\x18\x18";
+    export_ctx_t *x;
+    rt_device_t dev;
+    rt_err_t r;
+
+    if (telemetry_active()) return -RT_EBUSY;
+    dev = rt_device_find(DATA_EXPORT_UART_NAME);
+    if (!dev) return -RT_EEMPTY;
+    x = rt_calloc(1, sizeof(*x));
+    if (!x) return -RT_ENOMEM;
+    x->src = src;
+    x->fd = -1;
+    x->crc = CRC32_INIT;
+
+    r = export_prepare(x, path);
+    if (r == RT_EOK)
+    {
+        /* 保留原接收方式（中断/DMA），发送改为轮询：DMA 发送只登记缓冲指针，
+         * 而协议层在等 ACK 前就可能复用同一缓冲 */
+        rt_uint16_t oflag = RT_DEVICE_OFLAG_RDWR | (dev->open_flag & (RT_DEVICE_FLAG_INT_RX | RT_DEVICE_FLAG_DMA_RX));
+
+        r = rym_send_on_device(&x->parent, dev, oflag, export_on_begin, export_on_data, export_on_end,
+                               DATA_EXPORT_HANDSHAKE);
+        if (x->err) r = x->err;
+        if (r != RT_EOK && r != -RYM_ERR_CAN && x->begun) rt_device_write(dev, 0, cancel, sizeof(cancel) - 1);
+
+        if (out)
+        {
+            out->bytes = x->off;
+            out->blocks = x->blocks;
+            out->resends = x->parent.resend;
+            out->crc = x->crc;
+            out->ms = x->begun ? (rt_uint32_t)((rt_uint64_t)(rt_tick_get() - x->t0) * 1000U / RT_TICK_PER_SECOND) : 0;
+            out->baud = ((struct rt_serial_device *)dev)->config.baud_rate;
+        }
+    }
+
+#if DATA_EXPORT_USING_DFS
+    if (x->fd >= 0) close(x->fd);
+#endif
+    if (x->text) rt_free(x->text);
+    rt_free(x);
+    return r;
+}
+
+#else /* !RT_USING_RYM */
+
+rt_err_t data_export_send(export_src_t src, const char *path, export_result_t *out)
+{
+    (void)src;
+    (void)path;
+    (void)out;
+    return -RT_ENOSYS;
+}
+
+#endif /* RT_USING_RYM */
+
+/* ================== 命令 ================== */
+static const char *export_err_str(rt_err_t r)
+{
+    switch (r)
+    {
+    case -RT_EBUSY:  return "telemetry is streaming on the console, run sw_csv off first";
+    case -RT_ENOSYS: return "not supported in this build (needs RT_USING_RYM, files need RT_USING_DFS)";
+    case -RT_EEMPTY: return "source not found";
+    case -RT_EIO:    return "source read error";
+#ifdef RT_USING_RYM
+    case -RYM_ERR_TMO: return "no receiver (handshake timeout)";
+    case -RYM_ERR_ACK: return "receiver stopped answering (retries exhausted)";
+    case -RYM_ERR_CAN: return "cancelled by receiver";
+#endif
+    default:         return "failed";
+    }
+}
+
+static int cmd_sw_export(int argc, char **argv)
+{
+    export_result_t res;
+    export_src_t src;
+    const char *what = (argc >= 2) ? argv[1] : "archive";
+    rt_err_t r;
+
+    if (!strcmp(what, "archive")) src = EXPORT_SRC_ARCHIVE;
+    else if (!strcmp(what, "laps")) src = EXPORT_SRC_LAPS;
+    else if (what[0] == '/') src = EXPORT_SRC_FILE;
+    else
+    {
+        rt_kprintf("usage: sw_export [archive]|laps|<abs path>\n");
+        return -1;
+    }
+
+    rt_kprintf("sw_export: %s, start the YMODEM receiver now\n", what);
+    rt_memset(&res, 0, sizeof(res));
+    r = data_export_send(src, what, &res);
+    if (r != RT_EOK)
+    {
+        rt_kprintf("sw_export: %s (%d)\n", export_err_str(r), (int)r);
+        return -1;
+    }
+
+    /* 8N1：线路每字节 10 位，效率按文件字节相对线路极限计 */
+    rt_uint32_t bps = res.ms ? (rt_uint32_t)((rt_uint64_t)res.bytes * 1000U / res.ms) : 0;
+    rt_kprintf("sw_export: %u B in %u ms, %u B/s = %u%% of %u baud, %u blocks, %u resent, crc32 0x%08x\n",
+               (unsigned)res.bytes, (unsigned)res.ms, (unsigned)bps,
+               res.baud ? (unsigned)((rt_uint64_t)bps * 1000U / res.baud) : 0, (unsigned)res.baud,
+               (unsigned)res.blocks, (unsigned)res.resends, (unsigned)res.crc);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_export, sw_export, YMODEM_export_archive_laps_or_file);
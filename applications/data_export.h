@@ -0,0 +1,49 @@
+#ifndef APPLICATIONS_DATA_EXPORT_H_
+#define APPLICATIONS_DATA_EXPORT_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 批量导出：经控制台串口用 YMODEM（1K 包 + CRC16，NAK/超时重发）把历史归档映像、当前会话圈速
+ * 或 SD 卡上的记录文件发给主机。主机端可用 testtools/ymodem_receiver.py，或任意 YMODEM 接收程序
+ * （Tera Term、SecureCRT、rb）。传输期间 shell 阻塞在命令里，串口发送改为轮询；
+ * 其他线程的 rt_kprintf 会打坏正在发送的包，由接收端校验失败 NAK、发送端重发兜底。 */
+
+/* 导出串口（须与 shell 同一串口，命令从这里发起） */
+#ifndef DATA_EXPORT_UART_NAME
+#define DATA_EXPORT_UART_NAME       RT_CONSOLE_DEVICE_NAME
+#endif
+/* 等待接收端 'C' 的次数，每次 RYM_CHD_INTV_TICK（默认 3 s） */
+#ifndef DATA_EXPORT_HANDSHAKE
+#define DATA_EXPORT_HANDSHAKE       20
+#endif
+
+typedef enum
+{
+    EXPORT_SRC_ARCHIVE = 0,     /* 历史归档区原始映像 ARCHIVE.SAR，testtools/session_archive.py 解析 */
+    EXPORT_SRC_LAPS,            /* 当前会话保留的各圈 LAPS.CSV */
+    EXPORT_SRC_FILE,            /* DFS 上的文件（如 sw_rec 的 *.REC） */
+} export_src_t;
+
+typedef struct
+{
+    rt_uint32_t bytes;          /* 文件字节数（不含末包填充） */
+    rt_uint32_t blocks;         /* 数据包数 */
+    rt_uint32_t resends;        /* NAK/超时重发的包数 */
+    rt_uint32_t crc;            /* 文件内容的 CRC-32/MPEG-2，供主机端核对 */
+    rt_uint32_t ms;             /* 收到接收端 'C' 到传输结束 */
+    rt_uint32_t baud;
+} export_result_t;
+
+/* 阻塞直到传输结束；path 只用于 EXPORT_SRC_FILE。
+ * 未开启 RT_USING_RYM 返回 -RT_ENOSYS，遥测输出占用串口时返回 -RT_EBUSY，协议错误为负的 RYM_ERR_* */
+rt_err_t data_export_send(export_src_t src, const char *path, export_result_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_DATA_EXPORT_H_ */
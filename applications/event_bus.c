@@ -0,0 +1,209 @@
+#include "event_bus.h"
+#include <rthw.h>
+#include <finsh.h>
+#include <string.h>
+#include "board.h"
+#include "timebase.h"
+
+#define DBG_TAG "evt"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 模块间事件总线：静态订阅表 + 静态消息队列，发布路径无内存分配、可在 ISR 中调用。
+ * 同步订阅者在发布者上下文中回调；排队订阅者由总线线程 "evbus" 统一回调。 */
+
+typedef struct
+{
+    rt_uint32_t     mask;
+    event_handler_t handler;
+    void           *user;
+    rt_uint8_t      mode;
+} event_sub_t;
+
+static event_sub_t s_subs[EVENT_BUS_MAX_SUBS];
+static volatile rt_uint8_t s_sub_count = 0;
+static volatile rt_uint32_t s_queued_mask = 0;   /* 有排队订阅者的主题 */
+static event_bus_stats_t s_stats;
+static rt_uint8_t s_inited = 0;
+
+static struct rt_messagequeue s_evt_mq;
+static rt_uint8_t s_evt_mq_pool[EVENT_BUS_QUEUE_DEPTH * (RT_ALIGN(sizeof(event_t), RT_ALIGN_SIZE) + sizeof(void *))];
+static rt_thread_t s_evt_thread;
+
+static const char *topic_name(rt_uint8_t topic)
+{
+    switch (topic)
+    {
+    case EVT_STATE_CHANGED:    return "state";
+    case EVT_LAP_RECORDED:     return "lap";
+    case EVT_ENV_DARK:         return "dark";
+    case EVT_ENV_LIGHT:        return "light";
+    case EVT_SETTINGS_CHANGED: return "settings";
+    case EVT_TIMER_EXPIRED:    return "timer";
+    default:                   return "?";
+    }
+}
+
+static void event_bus_entry(void *parameter)
+{
+    (void)parameter;
+    event_t e;
+    while (1)
+    {
+        if (rt_mq_recv(&s_evt_mq, &e, sizeof(e), RT_WAITING_FOREVER) != RT_EOK)
+        {
+            continue;
+        }
+        rt_uint8_t n = s_sub_count;
+        for (rt_uint8_t i = 0; i < n; i++)
+        {
+            const event_sub_t *s = &s_subs[i];
+            if (s->mode == EVENT_DELIVER_QUEUED && (s->mask & EVT_MASK(e.topic)))
+            {
+                s->handler(&e, s->user);
+            }
+        }
+    }
+}
+
+rt_err_t event_bus_init(void)
+{
+    if (s_inited) return RT_EOK;
+
+    rt_err_t ret = rt_mq_init(&s_evt_mq, "evt", s_evt_mq_pool, sizeof(event_t),
+                              sizeof(s_evt_mq_pool), RT_IPC_FLAG_FIFO);
+    if (ret != RT_EOK) return ret;
+
+    s_evt_thread = rt_thread_create("evbus", event_bus_entry, RT_NULL, 768, EVENT_BUS_THREAD_PRIORITY, 10);
+    if (!s_evt_thread)
+    {
+        rt_mq_detach(&s_evt_mq);
+        return -RT_ENOMEM;
+    }
+    rt_thread_startup(s_evt_thread);
+    s_inited = 1;
+    return RT_EOK;
+}
+
+rt_err_t event_bus_subscribe(rt_uint32_t topic_mask, event_handler_t handler, void *user, event_deliver_t mode)
+{
+    if (!handler || topic_mask == 0) return -RT_EINVAL;
+    if (mode == EVENT_DELIVER_QUEUED)
+    {
+        rt_err_t r = event_bus_init();
+        if (r != RT_EOK) return r;
+    }
+
+    rt_base_t level = rt_hw_interrupt_disable();
+    if (s_sub_count >= EVENT_BUS_MAX_SUBS)
+    {
+        rt_hw_interrupt_enable(level);
+        LOG_E("subscriber table full");
+        return -RT_EFULL;
+    }
+    event_sub_t *s = &s_subs[s_sub_count];
+    s->mask = topic_mask;
+    s->handler = handler;
+    s->user = user;
+    s->mode = (rt_uint8_t)mode;
+    /* 表项写完再发布计数，发布者无锁遍历时看不到半写表项 */
+    __DMB();
+    s_sub_count++;
+    if (mode == EVENT_DELIVER_QUEUED) s_queued_mask |= topic_mask;
+    rt_hw_interrupt_enable(level);
+    return RT_EOK;
+}
+
+void event_bus_publish(const event_t *e)
+{
+    if (e->topic >= EVT_TOPIC_MAX) return;
+    s_stats.published[e->topic]++;
+
+    rt_uint8_t n = s_sub_count;
+    __DMB();
+    for (rt_uint8_t i = 0; i < n; i++)
+    {
+        const event_sub_t *s = &s_subs[i];
+        if (s->mode == EVENT_DELIVER_SYNC && (s->mask & EVT_MASK(e->topic)))
+        {
+            s->handler(e, s->user);
+        }
+    }
+
+    if (s_queued_mask & EVT_MASK(e->topic))
+    {
+        if (rt_mq_send(&s_evt_mq, (void *)e, sizeof(*e)) == RT_EOK)
+        {
+            s_stats.queued++;
+        }
+        else
+        {
+            s_stats.dropped++;
+        }
+    }
+}
+
+void event_bus_post(rt_uint8_t topic, rt_uint8_t code, rt_uint32_t value)
+{
+    event_t e;
+    e.topic = topic;
+    e.code = code;
+    e.index = 0;
+    e.value = value;
+    e.t_us = timebase_get_us();
+    event_bus_publish(&e);
+}
+
+void event_bus_get_stats(event_bus_stats_t *out)
+{
+    *out = s_stats;
+    out->subs = s_sub_count;
+}
+
+/* 事件跟踪：排队订阅者，在总线线程中打印，不占用发布者时间 */
+static rt_bool_t s_trace = 0;
+
+static void trace_handler(const event_t *e, void *user)
+{
+    (void)user;
+    if (!s_trace) return;
+    rt_kprintf("[evt] %s code=%u index=%u value=%u t=%u us\n", topic_name(e->topic),
+               (unsigned)e->code, (unsigned)e->index, (unsigned)e->value, (unsigned)e->t_us);
+}
+
+/* 用法：sw_evt [trace on|off] */
+static int cmd_sw_evt(int argc, char **argv)
+{
+    if (argc >= 3 && !strcmp(argv[1], "trace"))
+    {
+        static rt_bool_t subscribed = 0;
+        if (!subscribed)
+        {
+            if (event_bus_subscribe(EVT_MASK(EVT_TOPIC_MAX) - 1, trace_handler, RT_NULL, EVENT_DELIVER_QUEUED) != RT_EOK)
+            {
+                rt_kprintf("sw_evt: subscribe failed\n");
+                return -RT_ERROR;
+            }
+            subscribed = 1;
+        }
+        s_trace = !strcmp(argv[2], "on");
+        rt_kprintf("sw_evt trace: %s\n", s_trace ? "on" : "off");
+        return 0;
+    }
+    if (argc >= 2)
+    {
+        rt_kprintf("usage: sw_evt [trace on|off]\n");
+        return -RT_ERROR;
+    }
+
+    event_bus_stats_t st;
+    event_bus_get_stats(&st);
+    rt_kprintf("subscribers: %u/%u\n", (unsigned)st.subs, (unsigned)EVENT_BUS_MAX_SUBS);
+    for (rt_uint8_t t = 0; t < EVT_TOPIC_MAX; t++)
+    {
+        rt_kprintf("  %-8s published=%u\n", topic_name(t), (unsigned)st.published[t]);
+    }
+    rt_kprintf("queued: %u, dropped: %u\n", (unsigned)st.queued, (unsigned)st.dropped);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_evt, sw_evt, Event_bus_statistics_and_trace);
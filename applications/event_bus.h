@@ -0,0 +1,92 @@
+#ifndef APPLICATIONS_EVENT_BUS_H_
+#define APPLICATIONS_EVENT_BUS_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 订阅表容量（静态分配，运行期不释放） */
+#ifndef EVENT_BUS_MAX_SUBS
+#define EVENT_BUS_MAX_SUBS      16
+#endif
+/* 排队投递队列深度 */
+#ifndef EVENT_BUS_QUEUE_DEPTH
+#define EVENT_BUS_QUEUE_DEPTH   16
+#endif
+#ifndef EVENT_BUS_THREAD_PRIORITY
+#define EVENT_BUS_THREAD_PRIORITY   14
+#endif
+
+typedef enum
+{
+    EVT_STATE_CHANGED = 0,  /* 秒表状态变化：code=原因，value=新状态 */
+    EVT_LAP_RECORDED,       /* 记录一圈：index=圈序号(从1起)，value=圈时 ms */
+    EVT_ENV_DARK,           /* 环境变暗 */
+    EVT_ENV_LIGHT,          /* 环境变亮 */
+    EVT_SETTINGS_CHANGED,   /* 设置变更：code=设置项，value=新值 */
+    EVT_TIMER_EXPIRED,      /* 倒计时/间歇到期：code=TIMER_EVT_*，index=定时器号，value=轮次，t_us=截止时刻 */
+    EVT_TOPIC_MAX,
+} event_topic_t;
+
+#define EVT_MASK(topic)     (1UL << (topic))
+
+/* EVT_STATE_CHANGED 的原因 */
+enum
+{
+    EVT_CAUSE_START = 0,
+    EVT_CAUSE_STOP,
+    EVT_CAUSE_RESET,
+    EVT_CAUSE_CLEAR_LAPS,
+    EVT_CAUSE_RESTORE,      /* 开机从检查点恢复 */
+};
+
+/* EVT_SETTINGS_CHANGED 的设置项 */
+enum
+{
+    EVT_SET_BEEP = 0,       /* value: 0/1 */
+    EVT_SET_OLED_RATE,      /* value: 刷新周期 ms */
+    EVT_SET_PAGE,           /* value: 0=main 1=laps 2=best（UI_PAGE_*） */
+    EVT_SET_LIGHT,          /* value: 光敏联动 0/1 */
+    EVT_SET_LIGHT_INVERT,   /* value: 光敏极性 0/1 */
+};
+
+typedef struct
+{
+    rt_uint8_t  topic;
+    rt_uint8_t  code;
+    rt_uint16_t index;
+    rt_uint32_t value;
+    rt_uint64_t t_us;       /* 事件发生时刻（timebase us） */
+} event_t;
+
+typedef void (*event_handler_t)(const event_t *e, void *user);
+
+typedef enum
+{
+    EVENT_DELIVER_SYNC = 0, /* 在发布者上下文中直接回调（可能是 ISR，回调须短小且不阻塞） */
+    EVENT_DELIVER_QUEUED,   /* 拷贝入队，由总线线程回调（可阻塞/打印） */
+} event_deliver_t;
+
+typedef struct
+{
+    rt_uint32_t published[EVT_TOPIC_MAX];
+    rt_uint32_t queued;
+    rt_uint32_t dropped;    /* 队满丢弃 */
+    rt_uint8_t  subs;
+} event_bus_stats_t;
+
+rt_err_t event_bus_init(void);
+/* 订阅一个或多个主题（topic_mask 由 EVT_MASK 组合），通常在模块初始化时调用 */
+rt_err_t event_bus_subscribe(rt_uint32_t topic_mask, event_handler_t handler, void *user, event_deliver_t mode);
+/* 发布事件：不分配内存，可在中断中调用；队满时丢弃排队投递并计数 */
+void     event_bus_publish(const event_t *e);
+void     event_bus_post(rt_uint8_t topic, rt_uint8_t code, rt_uint32_t value);
+void     event_bus_get_stats(event_bus_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_EVENT_BUS_H_ */
@@ -0,0 +1,151 @@
+#include "flash_sim.h"
+#include <string.h>
+
+/* Flash 模拟器：内容保存在堆上，只在测试命令运行期间占用 RAM */
+
+static rt_uint8_t *s_mem = RT_NULL;
+static rt_uint32_t s_base = 0;
+static rt_uint16_t s_page_size = 0;
+static rt_uint8_t s_pages = 0;
+static rt_int32_t s_cut_after = -1;
+static rt_uint8_t s_dead = 0;
+static flash_sim_stats_t s_stats;
+
+rt_err_t flash_sim_create(rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages)
+{
+    flash_sim_destroy();
+    if (pages == 0 || pages > FLASH_SIM_MAX_PAGES || page_size == 0 || (page_size & 3)) return -RT_EINVAL;
+
+    s_mem = (rt_uint8_t *)rt_malloc((rt_size_t)page_size * pages);
+    if (!s_mem) return -RT_ENOMEM;
+    rt_memset(s_mem, 0xFF, (rt_size_t)page_size * pages);
+    s_base = base;
+    s_page_size = page_size;
+    s_pages = pages;
+    s_cut_after = -1;
+    s_dead = 0;
+    rt_memset(&s_stats, 0, sizeof(s_stats));
+    return RT_EOK;
+}
+
+void flash_sim_destroy(void)
+{
+    if (s_mem) rt_free(s_mem);
+    s_mem = RT_NULL;
+    s_pages = 0;
+}
+
+static rt_bool_t in_range(rt_uint32_t addr, rt_size_t size)
+{
+    return s_mem && addr >= s_base && addr + size <= s_base + (rt_uint32_t)s_page_size * s_pages;
+}
+
+/* 消耗一次操作配额；返回 1 表示本次操作应被截断 */
+static int consume_op(void)
+{
+    if (s_cut_after < 0) return 0;
+    if (s_cut_after == 0)
+    {
+        s_cut_after = -1;
+        s_dead = 1;
+        s_stats.cuts++;
+        return 1;
+    }
+    s_cut_after--;
+    return 0;
+}
+
+int flash_sim_read(rt_uint32_t addr, rt_uint8_t *buf, rt_size_t size)
+{
+    if (!in_range(addr, size)) return -RT_EINVAL;
+    rt_memcpy(buf, &s_mem[addr - s_base], size);
+    return (int)size;
+}
+
+static rt_bool_t program_half(rt_uint8_t *p, rt_uint16_t v)
+{
+    rt_uint16_t cur = (rt_uint16_t)(p[0] | (p[1] << 8));
+    /* F1：已编程半字只能再写 0x0000（PGERR） */
+    if (cur != 0xFFFF && v != 0x0000) return RT_FALSE;
+    p[0] = (rt_uint8_t)v;
+    p[1] = (rt_uint8_t)(v >> 8);
+    return RT_TRUE;
+}
+
+int flash_sim_write(rt_uint32_t addr, const rt_uint8_t *buf, rt_size_t size)
+{
+    if ((addr & 3) || !in_range(addr, size)) return -RT_EINVAL;
+    if (s_dead) return -RT_EIO;
+
+    for (rt_size_t i = 0; i < size; i += 4)
+    {
+        rt_uint8_t *p = &s_mem[addr - s_base + i];
+        rt_uint8_t w[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+        rt_memcpy(w, &buf[i], (size - i < 4) ? (size - i) : 4);
+
+        if (consume_op())
+        {
+            /* 掉电：只完成低半字 */
+            program_half(p, (rt_uint16_t)(w[0] | (w[1] << 8)));
+            return -RT_EIO;
+        }
+        if (!program_half(p, (rt_uint16_t)(w[0] | (w[1] << 8))) ||
+            !program_half(p + 2, (rt_uint16_t)(w[2] | (w[3] << 8))))
+        {
+            return -RT_ERROR;
+        }
+        s_stats.programs++;
+    }
+    return (int)size;
+}
+
+int flash_sim_erase(rt_uint32_t addr, rt_size_t size)
+{
+    if (!in_range(addr, size) || size == 0) return -RT_EINVAL;
+    if (s_dead) return -RT_EIO;
+    rt_uint32_t first = (addr - s_base) / s_page_size;
+    rt_uint32_t last = (addr - s_base + size - 1) / s_page_size;
+
+    for (rt_uint32_t pg = first; pg <= last; pg++)
+    {
+        rt_uint8_t *p = &s_mem[pg * s_page_size];
+        if (consume_op())
+        {
+            /* 掉电：只擦除前半页 */
+            rt_memset(p, 0xFF, s_page_size / 2);
+            return -RT_EIO;
+        }
+        rt_memset(p, 0xFF, s_page_size);
+        s_stats.erases++;
+        if (++s_stats.erase_count[pg] > s_stats.max_page_erases) s_stats.max_page_erases = s_stats.erase_count[pg];
+    }
+    return (int)size;
+}
+
+void flash_sim_cut_after(rt_int32_t ops)
+{
+    s_cut_after = ops;
+}
+
+void flash_sim_power_cycle(void)
+{
+    s_cut_after = -1;
+    s_dead = 0;
+}
+
+rt_bool_t flash_sim_is_cut(void)
+{
+    return s_dead ? RT_TRUE : RT_FALSE;
+}
+
+void flash_sim_get_stats(flash_sim_stats_t *out)
+{
+    if (out) *out = s_stats;
+}
+
+void flash_sim_reset_stats(void)
+{
+    rt_uint32_t cuts = s_stats.cuts;
+    rt_memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.cuts = cuts;
+}
@@ -0,0 +1,48 @@
+#ifndef APPLICATIONS_FLASH_SIM_H_
+#define APPLICATIONS_FLASH_SIM_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* RAM 模拟的片内 Flash，按 STM32F1 规则：擦除后全 0xFF，按字编程（两个半字），
+ * 已编程的半字只能再写 0x0000，否则编程失败。接口与 stm32_flash_read/write/erase 一致，
+ * 供存储模块在板上/主机上做掉电注入与擦写计数，不占用真实 Flash。 */
+#ifndef FLASH_SIM_MAX_PAGES
+#define FLASH_SIM_MAX_PAGES     8
+#endif
+
+typedef struct
+{
+    rt_uint32_t programs;       /* 编程字数 */
+    rt_uint32_t erases;         /* 页擦除次数 */
+    rt_uint32_t max_page_erases;/* 单页最大擦除次数 */
+    rt_uint32_t cuts;           /* 已注入的掉电次数 */
+    rt_uint32_t erase_count[FLASH_SIM_MAX_PAGES];
+} flash_sim_stats_t;
+
+/* 分配 pages 页模拟区（擦除状态），地址空间从 base 起；重复调用先释放旧区 */
+rt_err_t flash_sim_create(rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages);
+void     flash_sim_destroy(void);
+
+int flash_sim_read(rt_uint32_t addr, rt_uint8_t *buf, rt_size_t size);
+int flash_sim_write(rt_uint32_t addr, const rt_uint8_t *buf, rt_size_t size);
+int flash_sim_erase(rt_uint32_t addr, rt_size_t size);
+
+/* 掉电注入：再完成 ops 次操作（每字编程/每页擦除各计 1 次）后，下一次操作只做一半
+ * （字编程只写低半字，页擦除只擦前半页），之后所有写/擦返回 -RT_EIO，直到 flash_sim_power_cycle()。
+ * ops < 0 关闭注入 */
+void flash_sim_cut_after(rt_int32_t ops);
+void flash_sim_power_cycle(void);
+rt_bool_t flash_sim_is_cut(void);
+
+void flash_sim_get_stats(flash_sim_stats_t *out);
+void flash_sim_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_FLASH_SIM_H_ */
@@ -0,0 +1,557 @@
+#include "flash_writer.h"
+#include <finsh.h>
+#include <string.h>
+#include "stopwatch.h"
+#include "timebase.h"
+#ifdef BSP_USING_ON_CHIP_FLASH
+#include "drv_flash.h"
+#endif
+
+#define DBG_TAG "flsw"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifdef BSP_USING_ON_CHIP_FLASH
+
+#define FW_OP_WRITE     0
+#define FW_OP_ERASE     1
+
+#define FW_PAGES        (STM32_FLASH_SIZE / FLASH_WRITER_PAGE_SIZE)
+#define FW_PAGE_OF(a)   (((a) - STM32_FLASH_START_ADRESS) / FLASH_WRITER_PAGE_SIZE)
+
+#if FW_PAGES > 64
+#error "flash_writer page bitmaps hold 64 pages"
+#endif
+
+typedef struct
+{
+    rt_uint8_t  type;
+    rt_uint16_t off;            /* 写数据在暂存区内的偏移 */
+    rt_uint32_t addr;
+    rt_uint32_t len;
+    rt_uint32_t ticket;         /* 并入时更新为最新一条的票号 */
+} fw_op_t;
+
+static fw_op_t s_q[FLASH_WRITER_QUEUE];
+static rt_uint8_t s_head, s_count;
+static rt_uint8_t s_busy;       /* 队首正在执行，不能再并入 */
+static rt_uint8_t s_buf[FLASH_WRITER_BUF_SIZE];
+static rt_uint16_t s_used;      /* 暂存区按序分配，队列排空时复位 */
+static rt_uint32_t s_ticket, s_done;
+static rt_uint64_t s_spare;     /* 每页一位：已作废、待空闲预擦 */
+static rt_uint64_t s_fail;      /* 每页一位：有请求失败、尚未经 sync 报告 */
+static rt_uint64_t s_refused;   /* 每页一位：秒表运行中拒绝擦除、尚未经 sync 报告 */
+static rt_uint16_t s_waiters;
+static flash_writer_stats_t s_stats;
+static struct rt_mutex s_lock;
+static struct rt_semaphore s_work;  /* 唤醒写线程 */
+static struct rt_semaphore s_wake;  /* 唤醒等待完成的调用者 */
+static rt_uint8_t s_inited = 0;
+
+static rt_bool_t before(rt_uint32_t a, rt_uint32_t b)
+{
+    return (rt_int32_t)(a - b) < 0;
+}
+
+/* 区间触及的页 */
+static rt_uint64_t page_mask(rt_uint32_t addr, rt_size_t size)
+{
+    rt_uint64_t m = 0;
+    if (!size) return 0;
+    for (rt_uint32_t p = FW_PAGE_OF(addr); p <= FW_PAGE_OF(addr + size - 1); p++) m |= (rt_uint64_t)1 << p;
+    return m;
+}
+
+static rt_bool_t in_flash(rt_uint32_t addr, rt_size_t size)
+{
+    return addr >= STM32_FLASH_START_ADRESS && size <= STM32_FLASH_END_ADDRESS - addr;
+}
+
+static rt_bool_t page_blank(rt_uint32_t addr)
+{
+    const rt_uint32_t *w = (const rt_uint32_t *)addr;
+    for (rt_size_t i = 0; i < FLASH_WRITER_PAGE_SIZE / 4; i++)
+    {
+        if (w[i] != 0xFFFFFFFFUL) return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+static fw_op_t *tail_op(void)
+{
+    return s_count ? &s_q[(s_head + s_count - 1) % FLASH_WRITER_QUEUE] : RT_NULL;
+}
+
+/* 与区间重叠的最后一个未完成请求；调用者持锁 */
+static rt_bool_t overlap_ticket(rt_uint32_t addr, rt_size_t size, rt_uint32_t *ticket)
+{
+    rt_bool_t found = RT_FALSE;
+    for (rt_uint8_t i = 0; i < s_count; i++)
+    {
+        const fw_op_t *op = &s_q[(s_head + i) % FLASH_WRITER_QUEUE];
+        if (op->addr < addr + size && addr < op->addr + op->len)
+        {
+            *ticket = op->ticket;
+            found = RT_TRUE;
+        }
+    }
+    return found;
+}
+
+static void stall_max(rt_uint32_t *slot, rt_uint32_t us)
+{
+    if (us > *slot) *slot = us;
+}
+
+/* ================== 写线程 ================== */
+static rt_err_t exec_write(const fw_op_t *op)
+{
+    extern uint32_t SystemCoreClock;
+    rt_uint32_t busy = 0;
+    rt_uint32_t mhz = SystemCoreClock / 1000000U;
+    int r = stm32_flash_program(op->addr, s_buf + op->off, op->len, &busy);
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    s_stats.programs++;
+    s_stats.bytes += op->len;
+    if (mhz) stall_max(&s_stats.max_prog_stall_us, busy / mhz);
+    rt_mutex_release(&s_lock);
+    return (r < 0) ? -RT_EIO : RT_EOK;
+}
+
+static rt_err_t erase_page(rt_uint32_t addr, rt_uint32_t *counter)
+{
+    rt_uint64_t t0 = timebase_get_us();
+    int r = stm32_flash_erase(addr, FLASH_WRITER_PAGE_SIZE);
+    rt_uint32_t us = (rt_uint32_t)(timebase_get_us() - t0);
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    (*counter)++;
+    s_spare &= ~((rt_uint64_t)1 << FW_PAGE_OF(addr));
+    stall_max(&s_stats.max_erase_stall_us, us);
+    rt_mutex_release(&s_lock);
+    return (r < 0) ? -RT_EIO : RT_EOK;
+}
+
+/* 秒表运行中拒绝擦除未空白的页（-RT_EBUSY），页保持原样：调用者可能仍在使用其内容（如归档最旧页），
+ * 只有调用者已作废（discard）的页才留作备用页由空闲预擦；擦除或确认空白后页不再是备用页 */
+static rt_err_t exec_erase(const fw_op_t *op)
+{
+    rt_err_t r = RT_EOK;
+    for (rt_uint32_t a = op->addr; a < op->addr + op->len; a += FLASH_WRITER_PAGE_SIZE)
+    {
+        if (page_blank(a))
+        {
+            rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+            s_stats.erase_skipped++;
+            s_spare &= ~((rt_uint64_t)1 << FW_PAGE_OF(a));
+            rt_mutex_release(&s_lock);
+            continue;
+        }
+        if (stopwatch_get_state() == STOPWATCH_STATE_RUNNING)
+        {
+            rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+            s_stats.erase_refused++;
+            s_refused |= (rt_uint64_t)1 << FW_PAGE_OF(a);
+            rt_mutex_release(&s_lock);
+            if (r == RT_EOK) r = -RT_EBUSY;
+            continue;
+        }
+        if (erase_page(a, &s_stats.erases) != RT_EOK) r = -RT_EIO;
+    }
+    return r;
+}
+
+/* 空闲时擦一页备用页；与 exec_erase 一样秒表运行中不擦，页擦除的停顿只出现在未计时期间 */
+static void pre_erase(void)
+{
+    rt_uint32_t addr = 0;
+
+    if (stopwatch_get_state() == STOPWATCH_STATE_RUNNING) return;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    for (rt_uint32_t p = 0; p < FW_PAGES; p++)
+    {
+        if (s_spare & ((rt_uint64_t)1 << p))
+        {
+            s_spare &= ~((rt_uint64_t)1 << p);
+            addr = STM32_FLASH_START_ADRESS + p * FLASH_WRITER_PAGE_SIZE;
+            break;
+        }
+    }
+    rt_mutex_release(&s_lock);
+
+    if (addr && !page_blank(addr) && erase_page(addr, &s_stats.pre_erases) != RT_EOK)
+        LOG_W("pre-erase 0x%08x failed", (unsigned)addr);
+}
+
+static void writer_entry(void *parameter)
+{
+    (void)parameter;
+    for (;;)
+    {
+        rt_err_t w = rt_sem_take(&s_work, rt_tick_from_millisecond(FLASH_WRITER_IDLE_MS));
+
+        rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+        if (!s_count)
+        {
+            rt_bool_t spare = (s_spare != 0);
+            rt_mutex_release(&s_lock);
+            if (w == -RT_ETIMEOUT && spare) pre_erase();
+            continue;
+        }
+
+        /* 队首之后仍可并入新的写，执行中的队首不再变化 */
+        while (s_count)
+        {
+            fw_op_t op = s_q[s_head];
+            s_busy = 1;
+            rt_mutex_release(&s_lock);
+
+            rt_err_t r = (op.type == FW_OP_WRITE) ? exec_write(&op) : exec_erase(&op);
+
+            rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+            if (r != RT_EOK && r != -RT_EBUSY)
+            {
+                s_fail |= page_mask(op.addr, op.len);
+                s_stats.errors++;
+                LOG_W("%s 0x%08x+%u failed", (op.type == FW_OP_WRITE) ? "program" : "erase", (unsigned)op.addr,
+                      (unsigned)op.len);
+            }
+            s_head = (rt_uint8_t)((s_head + 1) % FLASH_WRITER_QUEUE);
+            s_count--;
+            s_busy = 0;
+            s_done = op.ticket;
+            if (!s_count) s_used = 0;
+
+            rt_uint16_t n = s_waiters;
+            s_waiters = 0;
+            rt_mutex_release(&s_lock);
+            while (n--) rt_sem_release(&s_wake);
+            rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+        }
+        rt_mutex_release(&s_lock);
+    }
+}
+
+/* ================== 接口 ================== */
+rt_err_t flash_writer_init(void)
+{
+    if (s_inited) return RT_EOK;
+    rt_mutex_init(&s_lock, "flsw", RT_IPC_FLAG_PRIO);
+    rt_sem_init(&s_work, "flsw", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&s_wake, "flswk", 0, RT_IPC_FLAG_FIFO);
+
+    rt_thread_t tid = rt_thread_create("swfls", writer_entry, RT_NULL, FLASH_WRITER_STACK_SIZE,
+                                       FLASH_WRITER_THREAD_PRIO, 10);
+    if (!tid)
+    {
+        LOG_E("create thread failed");
+        rt_sem_detach(&s_wake);
+        rt_sem_detach(&s_work);
+        rt_mutex_detach(&s_lock);
+        return -RT_ENOMEM;
+    }
+    s_inited = 1;
+    rt_thread_startup(tid);
+    return RT_EOK;
+}
+
+void flash_writer_wait(rt_uint32_t ticket)
+{
+    rt_uint64_t t0 = timebase_get_us();
+    rt_bool_t waited = RT_FALSE;
+
+    if (!s_inited) return;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    while (before(s_done, ticket))
+    {
+        s_waiters++;
+        waited = RT_TRUE;
+        rt_mutex_release(&s_lock);
+        rt_sem_release(&s_work);
+        rt_sem_take(&s_wake, RT_WAITING_FOREVER);
+        rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    }
+    if (waited) stall_max(&s_stats.max_wait_us, (rt_uint32_t)(timebase_get_us() - t0));
+    rt_mutex_release(&s_lock);
+}
+
+rt_bool_t flash_writer_done(rt_uint32_t ticket)
+{
+    return s_inited ? !before(s_done, ticket) : RT_TRUE;
+}
+
+/* 取一个队列槽（need 为写数据字节数），满时等待排空；调用者持锁，返回时仍持锁 */
+static fw_op_t *op_alloc(rt_size_t need)
+{
+    while (s_count == FLASH_WRITER_QUEUE || s_used + need > FLASH_WRITER_BUF_SIZE)
+    {
+        rt_uint32_t last = tail_op()->ticket;
+        rt_mutex_release(&s_lock);
+        flash_writer_wait(last);
+        rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    }
+    fw_op_t *op = &s_q[(s_head + s_count) % FLASH_WRITER_QUEUE];
+    s_count++;
+    return op;
+}
+
+static rt_uint32_t post_write(rt_uint32_t addr, const rt_uint8_t *data, rt_size_t len)
+{
+    fw_op_t *tail = tail_op();
+
+    /* 紧接上一条尚未开始的写：数据在暂存区也正好相接，直接延长 */
+    if (tail && tail->type == FW_OP_WRITE && !(s_busy && s_count == 1) && tail->addr + tail->len == addr &&
+        tail->off + tail->len == s_used && s_used + len <= FLASH_WRITER_BUF_SIZE)
+    {
+        s_stats.coalesced++;
+    }
+    else
+    {
+        tail = op_alloc(len);
+        tail->type = FW_OP_WRITE;
+        tail->addr = addr;
+        tail->len = 0;
+        tail->off = s_used;
+    }
+    rt_memcpy(s_buf + s_used, data, len);
+    s_used += (rt_uint16_t)len;
+    tail->len += len;
+    tail->ticket = ++s_ticket;
+    s_stats.posts++;
+    /* 重新写入的页不再是备用页 */
+    s_spare &= ~page_mask(addr, len);
+    return s_ticket;
+}
+
+rt_err_t flash_writer_write(rt_uint32_t addr, const void *data, rt_size_t len, rt_uint32_t *ticket)
+{
+    const rt_uint8_t *p = (const rt_uint8_t *)data;
+    rt_uint32_t t = 0;
+
+    if (!s_inited) return -RT_ENOSYS;
+    if (((addr | len) & 1) || !in_flash(addr, len) || (len && !data)) return -RT_EINVAL;
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    t = s_ticket;
+    while (len)
+    {
+        rt_size_t n = (len < FLASH_WRITER_BUF_SIZE) ? len : FLASH_WRITER_BUF_SIZE;
+        t = post_write(addr, p, n);
+        addr += n;
+        p += n;
+        len -= n;
+    }
+    rt_mutex_release(&s_lock);
+    if (ticket) *ticket = t;
+    return RT_EOK;
+}
+
+rt_err_t flash_writer_erase(rt_uint32_t addr, rt_size_t size, rt_uint32_t *ticket)
+{
+    if (!s_inited) return -RT_ENOSYS;
+    if ((addr % FLASH_WRITER_PAGE_SIZE) || !size || !in_flash(addr, size)) return -RT_EINVAL;
+    size = RT_ALIGN(size, FLASH_WRITER_PAGE_SIZE);
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    fw_op_t *op = op_alloc(0);
+    op->type = FW_OP_ERASE;
+    op->addr = addr;
+    op->len = size;
+    op->off = 0;
+    op->ticket = ++s_ticket;
+    s_fail &= ~page_mask(addr, size);
+    s_refused &= ~page_mask(addr, size);
+    if (ticket) *ticket = s_ticket;
+    rt_mutex_release(&s_lock);
+    return RT_EOK;
+}
+
+rt_err_t flash_writer_sync(rt_uint32_t addr, rt_size_t size)
+{
+    rt_uint32_t last;
+    rt_bool_t pending;
+    rt_uint64_t m = page_mask(addr, size);
+
+    if (!s_inited) return -RT_ENOSYS;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    pending = overlap_ticket(addr, size, &last);
+    rt_mutex_release(&s_lock);
+    if (pending) flash_writer_wait(last);
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    rt_err_t r = (s_fail & m) ? -RT_EIO : (s_refused & m) ? -RT_EBUSY : RT_EOK;
+    s_fail &= ~m;
+    s_refused &= ~m;
+    rt_mutex_release(&s_lock);
+    return r;
+}
+
+void flash_writer_discard(rt_uint32_t addr, rt_size_t size)
+{
+    rt_uint64_t m = 0;
+
+    if (!s_inited || !in_flash(addr, size)) return;
+    /* 只登记整页 */
+    for (rt_uint32_t a = RT_ALIGN(addr, FLASH_WRITER_PAGE_SIZE); a + FLASH_WRITER_PAGE_SIZE <= addr + size;
+         a += FLASH_WRITER_PAGE_SIZE)
+        m |= (rt_uint64_t)1 << FW_PAGE_OF(a);
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    s_spare |= m;
+    rt_mutex_release(&s_lock);
+}
+
+void flash_writer_get_stats(flash_writer_stats_t *out)
+{
+    if (!s_inited)
+    {
+        rt_memset(out, 0, sizeof(*out));
+        return;
+    }
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    *out = s_stats;
+    rt_mutex_release(&s_lock);
+}
+
+/* ================== kv_flash_ops_t 适配 ================== */
+static int ops_read(rt_uint32_t addr, rt_uint8_t *buf, rt_size_t size)
+{
+    rt_uint32_t last;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    rt_bool_t pending = overlap_ticket(addr, size, &last);
+    rt_mutex_release(&s_lock);
+    if (pending) flash_writer_wait(last);
+    return stm32_flash_read(addr, buf, size);
+}
+
+static int ops_write(rt_uint32_t addr, const rt_uint8_t *buf, rt_size_t size)
+{
+    rt_err_t r = flash_writer_write(addr, buf, size, RT_NULL);
+    return (r != RT_EOK) ? r : (int)size;
+}
+
+static int ops_erase(rt_uint32_t addr, rt_size_t size)
+{
+    rt_uint32_t t;
+    rt_err_t r = flash_writer_erase(addr, size, &t);
+    if (r != RT_EOK) return r;
+    r = flash_writer_sync(addr, size);
+    return (r != RT_EOK) ? r : (int)size;
+}
+
+static int ops_sync(rt_uint32_t addr, rt_size_t size)
+{
+    return (flash_writer_sync(addr, size) != RT_EOK) ? -RT_EIO : (int)size;
+}
+
+static int ops_discard(rt_uint32_t addr, rt_size_t size)
+{
+    flash_writer_discard(addr, size);
+    return (int)size;
+}
+
+static const kv_flash_ops_t s_ops = { ops_read, ops_write, ops_erase, ops_sync, ops_discard };
+
+const kv_flash_ops_t *flash_writer_ops(void)
+{
+    return (flash_writer_init() == RT_EOK) ? &s_ops : RT_NULL;
+}
+
+static rt_uint32_t spare_pages(void)
+{
+    rt_uint32_t n = 0;
+    for (rt_uint64_t m = s_spare; m; m &= m - 1) n++;
+    return n;
+}
+
+#else /* !BSP_USING_ON_CHIP_FLASH */
+
+rt_err_t flash_writer_init(void)
+{
+    return -RT_ENOSYS;
+}
+
+rt_err_t flash_writer_write(rt_uint32_t addr, const void *data, rt_size_t len, rt_uint32_t *ticket)
+{
+    (void)addr;
+    (void)data;
+    (void)len;
+    (void)ticket;
+    return -RT_ENOSYS;
+}
+
+rt_err_t flash_writer_erase(rt_uint32_t addr, rt_size_t size, rt_uint32_t *ticket)
+{
+    (void)addr;
+    (void)size;
+    (void)ticket;
+    return -RT_ENOSYS;
+}
+
+void flash_writer_wait(rt_uint32_t ticket)
+{
+    (void)ticket;
+}
+
+rt_bool_t flash_writer_done(rt_uint32_t ticket)
+{
+    (void)ticket;
+    return RT_TRUE;
+}
+
+rt_err_t flash_writer_sync(rt_uint32_t addr, rt_size_t size)
+{
+    (void)addr;
+    (void)size;
+    return -RT_ENOSYS;
+}
+
+void flash_writer_discard(rt_uint32_t addr, rt_size_t size)
+{
+    (void)addr;
+    (void)size;
+}
+
+void flash_writer_get_stats(flash_writer_stats_t *out)
+{
+    rt_memset(out, 0, sizeof(*out));
+}
+
+const kv_flash_ops_t *flash_writer_ops(void)
+{
+    return RT_NULL;
+}
+
+static rt_uint32_t spare_pages(void)
+{
+    return 0;
+}
+
+#endif /* BSP_USING_ON_CHIP_FLASH */
+
+/* ================== 命令 ================== */
+static int cmd_sw_flash(int argc, char **argv)
+{
+    flash_writer_stats_t st;
+
+    if (argc >= 2 && strcmp(argv[1], "stat"))
+    {
+        rt_kprintf("usage: sw_flash [stat]\n");
+        return -RT_ERROR;
+    }
+    if (flash_writer_init() != RT_EOK)
+    {
+        rt_kprintf("sw_flash: on-chip flash unavailable\n");
+        return -RT_ERROR;
+    }
+
+    flash_writer_get_stats(&st);
+    rt_kprintf("posts=%u coalesced=%u programs=%u bytes=%u errors=%u\n", (unsigned)st.posts,
+               (unsigned)st.coalesced, (unsigned)st.programs, (unsigned)st.bytes, (unsigned)st.errors);
+    rt_kprintf("erases=%u already_blank=%u pre_erased=%u refused_running=%u spare_pages=%u\n", (unsigned)st.erases,
+               (unsigned)st.erase_skipped, (unsigned)st.pre_erases, (unsigned)st.erase_refused, (unsigned)spare_pages());
+    rt_kprintf("max irq stall: program %u us, erase %u us; max caller wait %u us\n",
+               (unsigned)st.max_prog_stall_us, (unsigned)st.max_erase_stall_us, (unsigned)st.max_wait_us);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_flash, sw_flash, Flash_writer_stats_and_irq_stall);
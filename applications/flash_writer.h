@@ -0,0 +1,83 @@
+#ifndef APPLICATIONS_FLASH_WRITER_H_
+#define APPLICATIONS_FLASH_WRITER_H_
+
+#include <rtthread.h>
+#include "kv_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 片内 Flash 写入服务：所有编程/擦除由 swfls 线程串行执行。
+ *   - 写请求拷入暂存区后立即返回票号；紧接上一条未开始的写（地址首尾相接）时并入同一批，
+ *     一批只解锁/上锁一次、末尾整体校验一次，原顺序不变，掉电语义与逐条写相同；
+ *   - 投递不唤醒线程，等待完成（flash_writer_wait/sync）、暂存区满或空闲超时才开始编程，
+ *     调用者在两次提交点之间的写因此能合并；
+ *   - 存储把作废的页登记为备用页（discard），秒表未运行且队列空闲时预先擦除，
+ *     下次换页时页已空白，擦除的停顿不落在调用者身上；
+ *   - 秒表运行中不擦除：请求擦除未空白的页时拒绝（-RT_EBUSY），页内容不动（已作废的页仍按备用页在停表后预擦）；
+ *   - 统计每次编程/擦除的忙等时间：F1 单 bank，忙期间 CPU 取指停顿，中断同样无法进入。
+ *     页擦除按数据手册为 20~40 ms，max_erase_stall_us 应在 20000~40000 之间，且只出现在秒表未运行期间。
+ * 参数存储、检查点日志与历史归档经 kv_store_onchip_ops() 共用本服务。 */
+
+#ifndef FLASH_WRITER_QUEUE
+#define FLASH_WRITER_QUEUE          8
+#endif
+/* 写数据暂存区字节数（队列排空后复位）；更长的写按此切分 */
+#ifndef FLASH_WRITER_BUF_SIZE
+#define FLASH_WRITER_BUF_SIZE       256
+#endif
+/* 无请求多久算空闲（ms）：投递后无人等待的写在此时刷出，随后做一页预擦 */
+#ifndef FLASH_WRITER_IDLE_MS
+#define FLASH_WRITER_IDLE_MS        200
+#endif
+#ifndef FLASH_WRITER_THREAD_PRIO
+#define FLASH_WRITER_THREAD_PRIO    16
+#endif
+#ifndef FLASH_WRITER_STACK_SIZE
+#define FLASH_WRITER_STACK_SIZE     768
+#endif
+
+#define FLASH_WRITER_PAGE_SIZE      1024
+
+typedef struct
+{
+    rt_uint32_t posts;              /* 投递的写请求 */
+    rt_uint32_t coalesced;          /* 并入上一条的写请求 */
+    rt_uint32_t programs;           /* 实际编程批次 */
+    rt_uint32_t bytes;
+    rt_uint32_t erases;             /* 调用者请求并实际执行的页擦除 */
+    rt_uint32_t erase_skipped;      /* 请求擦除时页已空白（多为预擦命中） */
+    rt_uint32_t pre_erases;         /* 空闲时预擦的备用页 */
+    rt_uint32_t erase_refused;      /* 秒表运行中拒绝的页擦除 */
+    rt_uint32_t errors;
+    rt_uint32_t max_prog_stall_us;  /* 单个半字编程的最长忙等 */
+    rt_uint32_t max_erase_stall_us; /* 单页擦除的最长忙等 */
+    rt_uint32_t max_wait_us;        /* 调用者等待完成的最长时间 */
+} flash_writer_stats_t;
+
+/* 首次调用创建线程，须在线程上下文；未开启片内 Flash 返回 -RT_ENOSYS */
+rt_err_t flash_writer_init(void);
+
+/* 投递写（addr/len 为偶数），ticket 可为空；data 在返回后即可复用。暂存区满时先等待排空 */
+rt_err_t flash_writer_write(rt_uint32_t addr, const void *data, rt_size_t len, rt_uint32_t *ticket);
+/* 投递按页擦除；执行时已空白的页跳过，秒表运行中未空白的页拒绝，sync 返回 -RT_EBUSY */
+rt_err_t flash_writer_erase(rt_uint32_t addr, rt_size_t size, rt_uint32_t *ticket);
+/* 等待票号及之前的请求完成 */
+void     flash_writer_wait(rt_uint32_t ticket);
+rt_bool_t flash_writer_done(rt_uint32_t ticket);
+/* 等待与区间重叠的请求完成；区间内有请求失败时返回 -RT_EIO，有擦除被拒绝时返回 -RT_EBUSY（只报告一次） */
+rt_err_t flash_writer_sync(rt_uint32_t addr, rt_size_t size);
+/* 区间内整页内容已作废，空闲时擦除 */
+void     flash_writer_discard(rt_uint32_t addr, rt_size_t size);
+
+void     flash_writer_get_stats(flash_writer_stats_t *out);
+
+/* kv_flash_ops_t 适配（写为投递，读先等待重叠的写），供各日志存储共用；不可用时返回 RT_NULL */
+const kv_flash_ops_t *flash_writer_ops(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_FLASH_WRITER_H_ */
@@ -0,0 +1,235 @@
+#include "hot_state.h"
+#include <finsh.h>
+#include <string.h>
+#include "board.h"
+#include "crc_service.h"
+#include "event_bus.h"
+#include "rtc_backup.h"
+#include "stopwatch.h"
+#include "timebase.h"
+
+#define DBG_TAG "hot"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* BKP_DRx 为 32 位对齐、低 16 位有效；DR1 归 rtc_backup */
+#define HOT_REG(i)      ((&BKP->DR2)[i])
+
+static rt_uint8_t s_inited = 0;
+static rt_uint8_t s_restored = 0;
+static rt_err_t s_boot_ret = -RT_EEMPTY;
+static hot_state_t s_boot;              /* 开机读到的镜像 */
+static rt_int32_t s_downtime_ms = -1;   /* -1：未按 RTC 补偿 */
+static rt_uint32_t s_resume_us = 0;     /* 读寄存器到秒表恢复完成 */
+static rt_uint32_t s_writes = 0;
+static rt_uint32_t s_max_write_us = 0;
+
+void hot_state_pack(const hot_state_t *h, rt_uint16_t regs[HOT_STATE_REGS])
+{
+    rt_uint8_t b[(HOT_STATE_REGS - 1) * 2];
+
+    regs[0] = (rt_uint16_t)((HOT_STATE_VERSION << 13) | ((h->rtc_valid ? 1U : 0U) << 12) | ((h->state & 3U) << 10) |
+                            (h->rtc_ms & 0x3FFU));
+    regs[1] = (rt_uint16_t)h->total_ms;
+    regs[2] = (rt_uint16_t)(h->total_ms >> 16);
+    regs[3] = (rt_uint16_t)h->rtc_s;
+    regs[4] = (rt_uint16_t)(h->rtc_s >> 16);
+    regs[5] = (rt_uint16_t)((h->lap_total > 0xFFFF) ? 0xFFFF : h->lap_total);
+    regs[6] = (rt_uint16_t)h->last_lap_total_ms;
+    regs[7] = (rt_uint16_t)(h->last_lap_total_ms >> 16);
+    for (int i = 0; i < HOT_STATE_REGS - 1; i++)
+    {
+        b[2 * i] = (rt_uint8_t)regs[i];
+        b[2 * i + 1] = (rt_uint8_t)(regs[i] >> 8);
+    }
+    regs[HOT_STATE_REGS - 1] = crc16_ccitt(b, sizeof(b));
+}
+
+rt_err_t hot_state_unpack(const rt_uint16_t regs[HOT_STATE_REGS], hot_state_t *h)
+{
+    rt_uint8_t b[(HOT_STATE_REGS - 1) * 2];
+
+    if ((regs[0] >> 13) != HOT_STATE_VERSION) return -RT_EEMPTY;
+    for (int i = 0; i < HOT_STATE_REGS - 1; i++)
+    {
+        b[2 * i] = (rt_uint8_t)regs[i];
+        b[2 * i + 1] = (rt_uint8_t)(regs[i] >> 8);
+    }
+    if (crc16_ccitt(b, sizeof(b)) != regs[HOT_STATE_REGS - 1]) return -RT_ERROR;
+
+    h->rtc_valid = (rt_uint8_t)((regs[0] >> 12) & 1U);
+    h->state = (rt_uint8_t)((regs[0] >> 10) & 3U);
+    h->rtc_ms = (rt_uint16_t)(regs[0] & 0x3FFU);
+    h->total_ms = regs[1] | ((rt_uint32_t)regs[2] << 16);
+    h->rtc_s = regs[3] | ((rt_uint32_t)regs[4] << 16);
+    h->lap_total = regs[5];
+    h->last_lap_total_ms = regs[6] | ((rt_uint32_t)regs[7] << 16);
+    if (h->state > STOPWATCH_STATE_PAUSED || h->rtc_ms > 999) return -RT_ERROR;
+    return RT_EOK;
+}
+
+/* ================== 实机 ================== */
+static void bkp_read(rt_uint16_t regs[HOT_STATE_REGS])
+{
+    for (int i = 0; i < HOT_STATE_REGS; i++) regs[i] = (rt_uint16_t)(HOT_REG(i) & 0xFFFF);
+}
+
+/* 校验字最后写：中途复位时校验失败，开机退回 Flash 检查点 */
+static void bkp_write(const rt_uint16_t regs[HOT_STATE_REGS])
+{
+    for (int i = 0; i < HOT_STATE_REGS; i++) HOT_REG(i) = regs[i];
+}
+
+/* 在秒表服务线程中同步回调：读一次 RTC 与 timebase，写 9 个寄存器，约数微秒 */
+static void hot_on_event(const event_t *e, void *user)
+{
+    stopwatch_snapshot_t snap;
+    hot_state_t h;
+    rt_uint16_t regs[HOT_STATE_REGS];
+    (void)e;
+    (void)user;
+
+    rt_uint64_t t0 = timebase_get_us();
+    stopwatch_get_snapshot(&snap);
+    rt_memset(&h, 0, sizeof(h));
+    h.rtc_valid = (rtc_backup_now(&h.rtc_s, &h.rtc_ms) == RT_EOK);
+    h.state = (rt_uint8_t)snap.state;
+    h.total_ms = stopwatch_snapshot_total_ms(&snap, timebase_get_us());
+    h.last_lap_total_ms = snap.last_lap_total_ms;
+    h.lap_total = snap.lap_total;
+    hot_state_pack(&h, regs);
+    bkp_write(regs);
+
+    rt_uint32_t us = (rt_uint32_t)(timebase_get_us() - t0);
+    s_writes++;
+    if (us > s_max_write_us) s_max_write_us = us;
+}
+
+static void hot_restore(void)
+{
+    stopwatch_snapshot_t snap;
+    rt_uint16_t regs[HOT_STATE_REGS];
+    rt_uint64_t t0 = timebase_get_us();
+
+    bkp_read(regs);
+    s_boot_ret = hot_state_unpack(regs, &s_boot);
+    if (s_boot_ret != RT_EOK)
+    {
+        if (s_boot_ret == -RT_ERROR) LOG_W("bkp mirror checksum mismatch, fall back to flash journal");
+        return;
+    }
+    if (s_boot.state == STOPWATCH_STATE_IDLE && s_boot.total_ms == 0)
+    {
+        s_boot_ret = -RT_EEMPTY;
+        return;
+    }
+
+    rt_memset(&snap, 0, sizeof(snap));
+    snap.state = (stopwatch_state_t)s_boot.state;
+    snap.accumulated_ms = s_boot.total_ms;
+    snap.last_lap_total_ms = s_boot.last_lap_total_ms;
+    snap.lap_total = s_boot.lap_total;
+    if (snap.state == STOPWATCH_STATE_RUNNING)
+    {
+        rt_uint32_t now_s;
+        rt_uint16_t now_ms;
+        /* 寄存器仍在说明备份域未复位，rtc_backup_init 走快速路径（只等寄存器同步） */
+        if (s_boot.rtc_valid && rtc_backup_init() == RT_EOK && rtc_backup_continuous() &&
+            rtc_backup_now(&now_s, &now_ms) == RT_EOK && now_s >= s_boot.rtc_s)
+        {
+            rt_int64_t down = (rt_int64_t)(now_s - s_boot.rtc_s) * 1000 + now_ms - s_boot.rtc_ms;
+            if (down < 0) down = 0;
+            if (down > 0x7FFFFFFF) down = 0x7FFFFFFF;
+            s_downtime_ms = (rt_int32_t)down;
+            snap.accumulated_ms += (rt_uint32_t)down;
+        }
+        else
+        {
+            snap.state = STOPWATCH_STATE_PAUSED;
+            LOG_W("no rtc time for running session, resume paused");
+        }
+    }
+
+    s_boot_ret = stopwatch_restore(&snap);
+    s_resume_us = (rt_uint32_t)(timebase_get_us() - t0);
+    if (s_boot_ret == RT_EOK)
+    {
+        s_restored = 1;
+        LOG_I("resumed from bkp in %u us: state %d total %u ms, lap %u", (unsigned)s_resume_us, (int)snap.state,
+              (unsigned)snap.accumulated_ms, (unsigned)snap.lap_total);
+    }
+}
+
+rt_err_t hot_state_init(void)
+{
+    if (s_inited) return RT_EOK;
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN | RCC_APB1ENR_BKPEN;
+    PWR->CR |= PWR_CR_DBP;
+
+    hot_restore();
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED), hot_on_event, RT_NULL,
+                        EVENT_DELIVER_SYNC);
+    s_inited = 1;
+    return RT_EOK;
+}
+
+rt_bool_t hot_state_restored(void)
+{
+    return s_restored ? RT_TRUE : RT_FALSE;
+}
+
+/* ================== 命令 ================== */
+static const char *state_name(rt_uint8_t s)
+{
+    return (s == STOPWATCH_STATE_RUNNING) ? "running" : (s == STOPWATCH_STATE_PAUSED) ? "paused" : "idle";
+}
+
+static void print_state(const char *tag, const hot_state_t *h)
+{
+    rt_kprintf("%s: %s total=%u ms lap=%u last_lap_at=%u ms rtc=", tag, state_name(h->state), (unsigned)h->total_ms,
+               (unsigned)h->lap_total, (unsigned)h->last_lap_total_ms);
+    if (h->rtc_valid) rt_kprintf("%u.%03u\n", (unsigned)h->rtc_s, (unsigned)h->rtc_ms);
+    else rt_kprintf("none\n");
+}
+
+static int cmd_sw_hot(int argc, char **argv)
+{
+    rt_uint16_t regs[HOT_STATE_REGS];
+    hot_state_t h;
+
+    if (!s_inited)
+    {
+        rt_kprintf("sw_hot: not initialized\n");
+        return -RT_ERROR;
+    }
+    if (argc >= 2 && !strcmp(argv[1], "clear"))
+    {
+        /* 版本位清零即失效；下一次状态变化重新写入 */
+        HOT_REG(0) = 0;
+        rt_kprintf("sw_hot: mirror invalidated\n");
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "stat"))
+    {
+        rt_kprintf("usage: sw_hot [stat]|clear\n");
+        return -RT_ERROR;
+    }
+
+    bkp_read(regs);
+    rt_err_t r = hot_state_unpack(regs, &h);
+    if (r == RT_EOK) print_state("bkp", &h);
+    else rt_kprintf("bkp: %s\n", (r == -RT_EEMPTY) ? "empty" : "checksum mismatch");
+
+    if (s_restored)
+    {
+        print_state("boot", &s_boot);
+        rt_kprintf("boot: resumed in %u us, downtime %d ms\n", (unsigned)s_resume_us, (int)s_downtime_ms);
+    }
+    else
+    {
+        rt_kprintf("boot: not resumed from bkp (%d)\n", (int)s_boot_ret);
+    }
+    rt_kprintf("writes=%u max_write=%u us\n", (unsigned)s_writes, (unsigned)s_max_write_us);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_hot, sw_hot, BKP_hot_state_mirror);
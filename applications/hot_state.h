@@ -0,0 +1,44 @@
+#ifndef APPLICATIONS_HOT_STATE_H_
+#define APPLICATIONS_HOT_STATE_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 热状态镜像：秒表每次状态变化/记圈时，把状态、总用时及取值时的 RTC 时刻、上一圈结束时的总用时与圈数
+ * 写入备份域 BKP_DR2..DR10（VBAT 供电，复位/看门狗重启后保留，备份域复位时清零），末字为 CRC-16/CCITT。
+ * 开机先于 Flash 检查点恢复：只读 9 个寄存器，运行态按 RTC 补上停机时间；圈速环随后由检查点日志补上。
+ * 寄存器布局（每个 16 位）：
+ *   DR2  ver(3) rtc_valid(1) state(2) rtc_ms(10)
+ *   DR3/DR4 total_ms  DR5/DR6 rtc_s  DR7 lap_total（饱和到 0xFFFF）  DR8/DR9 last_lap_total_ms  DR10 crc16 */
+
+#define HOT_STATE_VERSION       1
+#define HOT_STATE_REGS          9
+
+typedef struct
+{
+    rt_uint8_t  state;              /* stopwatch_state_t */
+    rt_uint8_t  rtc_valid;          /* rtc_s/rtc_ms 有效 */
+    rt_uint16_t rtc_ms;
+    rt_uint32_t rtc_s;              /* 写入时刻 */
+    rt_uint32_t total_ms;           /* 写入时刻的总用时 */
+    rt_uint32_t last_lap_total_ms;
+    rt_uint32_t lap_total;
+} hot_state_t;
+
+/* 纯逻辑：打包为寄存器值 / 校验并解包（版本不符为 -RT_EEMPTY，校验失败为 -RT_ERROR） */
+void     hot_state_pack(const hot_state_t *h, rt_uint16_t regs[HOT_STATE_REGS]);
+rt_err_t hot_state_unpack(const rt_uint16_t regs[HOT_STATE_REGS], hot_state_t *h);
+
+/* 须在 stopwatch_init 之后、session_journal_init 之前调用：读取镜像并恢复秒表，再订阅事件开始镜像 */
+rt_err_t  hot_state_init(void);
+/* 本次开机已由备份寄存器恢复（检查点日志据此只补圈速环） */
+rt_bool_t hot_state_restored(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_HOT_STATE_H_ */
@@ -1,7 +1,11 @@
 #include "indicator_led.h"
 #include <rtdevice.h>
+#include <finsh.h>
+#include <stdlib.h>
 #include "board.h"
 #include "stopwatch.h"
+#include "timebase.h"
+#include "event_bus.h"
 
 /* 推荐引脚：PC13 运行闪烁；PB0 暂停常亮；PB1 错误（预留）
  * 如与实际连线不符，请在此调整或通过 Kconfig/宏重定义。 */
@@ -16,6 +20,18 @@
 #endif
 
 static rt_thread_t s_led_thread;
+/* 状态由事件推送，线程只在运行闪烁时周期唤醒 */
+static struct rt_mailbox s_led_mb;
+static rt_ubase_t s_led_mb_pool[4];
+/* 定时器到期时 ERR 灯（PB1）点亮一段时间，与秒表状态灯并行 */
+#define LED_MSG_TIMER_FLASH   0x100U
+#ifndef LED_TIMER_FLASH_MS
+#define LED_TIMER_FLASH_MS    200
+#endif
+
+/* 三路 LED 按端口归并：同一端口的亮灭合成一次 BSRR 写入（默认 PB0/PB1 同口） */
+static const rt_base_t s_led_pins[3] = { LED_RUN_PIN, LED_PAUSE_PIN, LED_ERR_PIN };
+static rt_bool_t s_led_mask_ok = 0;
 
 static void led_set(rt_base_t pin, int on)
 {
@@ -23,35 +39,97 @@ static void led_set(rt_base_t pin, int on)
     rt_pin_write(pin, on ? PIN_HIGH : PIN_LOW);
 }
 
+static void led_apply(int run, int pause, int err)
+{
+    const int on[3] = { run, pause, err };
+
+    if (!s_led_mask_ok)
+    {
+        for (int i = 0; i < 3; i++) led_set(s_led_pins[i], on[i]);
+        return;
+    }
+
+    rt_uint8_t done = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        if (done & (1U << i)) continue;
+        rt_base_t port = PIN_PORT(s_led_pins[i]);
+        rt_uint32_t set_mask = 0, clr_mask = 0;
+        for (int j = i; j < 3; j++)
+        {
+            if (PIN_PORT(s_led_pins[j]) != port) continue;
+            if (on[j]) set_mask |= PIN_MASK(s_led_pins[j]); else clr_mask |= PIN_MASK(s_led_pins[j]);
+            done |= (1U << j);
+        }
+        rt_pin_write_mask(port, set_mask, clr_mask);
+    }
+}
+
+static void led_on_event(const event_t *e, void *user)
+{
+    (void)user;
+    /* 邮箱满说明线程尚未取走前一状态，最终状态以线程读到的最后一封为准，丢弃无妨 */
+    if (e->topic == EVT_TIMER_EXPIRED)
+        rt_mb_send(&s_led_mb, LED_MSG_TIMER_FLASH);
+    else
+        rt_mb_send(&s_led_mb, (rt_ubase_t)e->value);
+}
+
 static void indicator_led_entry(void *parameter)
 {
     (void)parameter;
     int blink = 0;
+    rt_ubase_t s = (rt_ubase_t)stopwatch_get_state();
+    rt_tick_t flash_until = 0;
+    rt_bool_t flashing = 0;
+    rt_tick_t blink_at = rt_tick_get();
+    const rt_tick_t blink_ticks = rt_tick_from_millisecond(500);
     while (1)
     {
-        stopwatch_state_t s = stopwatch_get_state();
+        rt_tick_t now = rt_tick_get();
+        rt_int32_t timeout = RT_WAITING_FOREVER;
+        int run = 0, pause = 0;
+
+        if (flashing && (rt_int32_t)(now - flash_until) >= 0) flashing = 0;
         switch (s)
         {
         case STOPWATCH_STATE_RUNNING:
-            blink = !blink;
-            led_set(LED_RUN_PIN, blink);
-            led_set(LED_PAUSE_PIN, 0);
-            led_set(LED_ERR_PIN, 0);
-            rt_thread_mdelay(500);
+            if ((rt_int32_t)(now - blink_at) >= 0)
+            {
+                blink = !blink;
+                blink_at = now + blink_ticks;
+            }
+            run = blink;
+            timeout = (rt_int32_t)(blink_at - now);
             break;
         case STOPWATCH_STATE_PAUSED:
-            led_set(LED_RUN_PIN, 0);
-            led_set(LED_PAUSE_PIN, 1);
-            led_set(LED_ERR_PIN, 0);
-            rt_thread_mdelay(200);
+            pause = 1;
             break;
         default:
-            led_set(LED_RUN_PIN, 0);
-            led_set(LED_PAUSE_PIN, 0);
-            led_set(LED_ERR_PIN, 0);
-            rt_thread_mdelay(200);
             break;
         }
+        led_apply(run, pause, flashing);
+        if (flashing)
+        {
+            rt_int32_t left = (rt_int32_t)(flash_until - now);
+            if (timeout == RT_WAITING_FOREVER || left < timeout) timeout = left;
+        }
+
+        rt_ubase_t next;
+        while (rt_mb_recv(&s_led_mb, &next, timeout) == RT_EOK)
+        {
+            if (next == LED_MSG_TIMER_FLASH)
+            {
+                flashing = 1;
+                flash_until = rt_tick_get() + rt_tick_from_millisecond(LED_TIMER_FLASH_MS);
+            }
+            else
+            {
+                if (next == STOPWATCH_STATE_RUNNING && s != STOPWATCH_STATE_RUNNING) blink_at = rt_tick_get();
+                s = next;
+            }
+            timeout = 0; /* 取完积压的消息，只应用最新状态 */
+        }
     }
 }
 
@@ -60,9 +138,12 @@ rt_err_t indicator_led_init(void)
     rt_pin_mode(LED_RUN_PIN, PIN_MODE_OUTPUT);
     rt_pin_mode(LED_PAUSE_PIN, PIN_MODE_OUTPUT);
     rt_pin_mode(LED_ERR_PIN, PIN_MODE_OUTPUT);
-    led_set(LED_RUN_PIN, 0);
-    led_set(LED_PAUSE_PIN, 0);
-    led_set(LED_ERR_PIN, 0);
+    /* 驱动未实现端口写时退回逐个 rt_pin_write */
+    s_led_mask_ok = (rt_pin_write_mask(PIN_PORT(LED_RUN_PIN), 0, PIN_MASK(LED_RUN_PIN)) == RT_EOK);
+    led_apply(0, 0, 0);
+
+    rt_mb_init(&s_led_mb, "led", s_led_mb_pool, sizeof(s_led_mb_pool) / sizeof(s_led_mb_pool[0]), RT_IPC_FLAG_FIFO);
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_TIMER_EXPIRED), led_on_event, RT_NULL, EVENT_DELIVER_SYNC);
 
     s_led_thread = rt_thread_create("led_ind", indicator_led_entry, RT_NULL, 768, RT_THREAD_PRIORITY_MAX - 3, 10);
     if (!s_led_thread)
@@ -73,4 +154,54 @@ rt_err_t indicator_led_init(void)
     return RT_EOK;
 }
 
+/* GPIO 写入基准：同一引脚分别用 rt_pin_write、预解析句柄、端口掩码翻转 n 次，报告每秒调用数。
+ * 用法：sw_pin_bench [n]（默认 10000，使用 LED_ERR_PIN） */
+static rt_uint32_t bench_rate(rt_uint64_t us, rt_uint32_t n)
+{
+    return us ? (rt_uint32_t)(((rt_uint64_t)n * 1000000ULL) / us) : 0;
+}
+
+static int cmd_sw_pin_bench(int argc, char **argv)
+{
+    rt_uint32_t n = (argc >= 2) ? (rt_uint32_t)atoi(argv[1]) : 10000U;
+    rt_base_t pin = LED_ERR_PIN;
+    struct rt_pin_handle h;
+    rt_uint64_t t0, t1;
+
+    if (n == 0) n = 1;
+
+    t0 = timebase_get_us();
+    for (rt_uint32_t i = 0; i < n; i++) rt_pin_write(pin, i & 1);
+    t1 = timebase_get_us();
+    rt_kprintf("rt_pin_write:      %u calls/s\n", (unsigned)bench_rate(t1 - t0, n));
+
+    if (rt_pin_get_handle(pin, &h) == RT_EOK)
+    {
+        t0 = timebase_get_us();
+        for (rt_uint32_t i = 0; i < n; i++) rt_pin_handle_write(&h, i & 1);
+        t1 = timebase_get_us();
+        rt_kprintf("rt_pin_handle:     %u calls/s\n", (unsigned)bench_rate(t1 - t0, n));
+    }
+    else
+    {
+        rt_kprintf("rt_pin_handle:     not supported\n");
+    }
+
+    if (s_led_mask_ok)
+    {
+        rt_base_t port = PIN_PORT(pin);
+        rt_uint32_t mask = PIN_MASK(pin);
+        t0 = timebase_get_us();
+        for (rt_uint32_t i = 0; i < n; i++) rt_pin_write_mask(port, (i & 1) ? mask : 0, (i & 1) ? 0 : mask);
+        t1 = timebase_get_us();
+        rt_kprintf("rt_pin_write_mask: %u calls/s\n", (unsigned)bench_rate(t1 - t0, n));
+    }
+    else
+    {
+        rt_kprintf("rt_pin_write_mask: not supported\n");
+    }
 
+    rt_pin_write(pin, PIN_LOW);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_pin_bench, sw_pin_bench, GPIO_write_call_rate_benchmark);
@@ -0,0 +1,586 @@
+#include "kv_store.h"
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc_service.h"
+#include "flash_sim.h"
+#include "flash_writer.h"
+
+#define DBG_TAG "kv"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 页布局：
+ *   [magic][seq][~seq] 记录 记录 ... 0xFF...
+ * 换页时先在目标页写入有效记录，再写 ~seq、seq，最后写 magic 作为提交；旧页在提交后擦除。
+ * 挂载时取 magic 正确且 seq/~seq 互补、序号最新的页；残缺记录（CRC 错/长度非法）之后视为已写满，
+ * 下一次写入先换页。
+ * 底层写可能只是投递（flash_writer 合并），在追加末尾与换页提交后 sync 取得落盘结果；旧页交给 discard 空闲时擦除。 */
+
+#define KV_REC_MAX      KV_REC_SIZE(KV_VALUE_MAX)
+
+static void put_u32(rt_uint8_t *p, rt_uint32_t v)
+{
+    p[0] = (rt_uint8_t)v; p[1] = (rt_uint8_t)(v >> 8); p[2] = (rt_uint8_t)(v >> 16); p[3] = (rt_uint8_t)(v >> 24);
+}
+
+static rt_uint32_t get_u32(const rt_uint8_t *p)
+{
+    return (rt_uint32_t)p[0] | ((rt_uint32_t)p[1] << 8) | ((rt_uint32_t)p[2] << 16) | ((rt_uint32_t)p[3] << 24);
+}
+
+static rt_uint32_t page_addr(const kv_store_t *kv, rt_uint8_t page)
+{
+    return kv->base + (rt_uint32_t)page * kv->page_size;
+}
+
+static rt_bool_t page_blank(kv_store_t *kv, rt_uint8_t page)
+{
+    rt_uint8_t buf[32];
+    for (rt_uint16_t off = 0; off < kv->page_size; off += sizeof(buf))
+    {
+        if (kv->ops->read(page_addr(kv, page) + off, buf, sizeof(buf)) < 0) return RT_FALSE;
+        for (rt_size_t i = 0; i < sizeof(buf); i++)
+        {
+            if (buf[i] != 0xFF) return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+static rt_err_t page_erase(kv_store_t *kv, rt_uint8_t page)
+{
+    int r = kv->ops->erase(page_addr(kv, page), kv->page_size);
+    if (r == -RT_EBUSY) return -RT_EBUSY;
+    kv->stats.erases++;
+    return (r < 0) ? -RT_EIO : RT_EOK;
+}
+
+/* 作废页：后端支持时留到空闲再擦，下次换页到该页时多半已空白 */
+static void page_discard(kv_store_t *kv, rt_uint8_t page)
+{
+    if (kv->ops->discard) kv->ops->discard(page_addr(kv, page), kv->page_size);
+    /* 无登记接口时当场擦除；no_erase 期间不擦，留到下次换页（届时目标页未空白） */
+    else if (!kv->no_erase) page_erase(kv, page);
+}
+
+/* 等待此前投递的写落盘 */
+static rt_err_t store_sync(kv_store_t *kv)
+{
+    if (!kv->ops->sync) return RT_EOK;
+    return (kv->ops->sync(kv->base, (rt_uint32_t)kv->pages * kv->page_size) < 0) ? -RT_EIO : RT_EOK;
+}
+
+/* 读取页头，有效时返回 seq */
+static rt_bool_t page_header(kv_store_t *kv, rt_uint8_t page, rt_uint32_t *seq)
+{
+    rt_uint8_t h[KV_PAGE_HDR_SIZE];
+    if (kv->ops->read(page_addr(kv, page), h, sizeof(h)) < 0) return RT_FALSE;
+    if (get_u32(h) != KV_PAGE_MAGIC || (get_u32(h + 4) ^ get_u32(h + 8)) != 0xFFFFFFFFUL) return RT_FALSE;
+    *seq = get_u32(h + 4);
+    return RT_TRUE;
+}
+
+/* magic 最后写入，作为换页的提交点 */
+static rt_err_t page_commit(kv_store_t *kv, rt_uint8_t page, rt_uint32_t seq)
+{
+    rt_uint8_t h[8];
+    put_u32(h, seq);
+    put_u32(h + 4, ~seq);
+    if (kv->ops->write(page_addr(kv, page) + 4, h, 8) < 0) return -RT_EIO;
+    put_u32(h, KV_PAGE_MAGIC);
+    if (kv->ops->write(page_addr(kv, page), h, 4) < 0) return -RT_EIO;
+    return RT_EOK;
+}
+
+/* 读取并校验 off 处的记录；rec 至少 KV_REC_MAX 字节，返回记录总长，0 为空白，<0 为残缺 */
+static int read_record(kv_store_t *kv, rt_uint8_t page, rt_uint16_t off, rt_uint8_t *rec)
+{
+    if (off + KV_REC_HDR_SIZE > kv->page_size) return 0;
+    if (kv->ops->read(page_addr(kv, page) + off, rec, KV_REC_HDR_SIZE) < 0) return -1;
+    if (get_u32(rec) == 0xFFFFFFFFUL) return 0;
+
+    rt_uint8_t len = rec[2];
+    if (len > KV_VALUE_MAX) return -1;
+    rt_uint16_t size = (rt_uint16_t)KV_REC_SIZE(len);
+    if (off + size > kv->page_size) return -1;
+    if (kv->ops->read(page_addr(kv, page) + off + KV_REC_HDR_SIZE, rec + KV_REC_HDR_SIZE, size - KV_REC_HDR_SIZE) < 0)
+        return -1;
+    if (crc32_calc(rec, KV_REC_HDR_SIZE + len) != get_u32(rec + size - 4)) return -1;
+    return size;
+}
+
+static int build_record(rt_uint8_t *rec, rt_uint16_t key, const void *data, rt_size_t len, rt_uint8_t flags)
+{
+    rt_uint16_t size = (rt_uint16_t)KV_REC_SIZE(len);
+    rt_memset(rec, 0xFF, size);
+    rec[0] = (rt_uint8_t)key;
+    rec[1] = (rt_uint8_t)(key >> 8);
+    rec[2] = (rt_uint8_t)len;
+    rec[3] = flags;
+    if (len) rt_memcpy(rec + KV_REC_HDR_SIZE, data, len);
+    put_u32(rec + size - 4, crc32_calc(rec, KV_REC_HDR_SIZE + len));
+    return size;
+}
+
+static rt_err_t format_page(kv_store_t *kv, rt_uint8_t page, rt_uint32_t seq)
+{
+    if (!page_blank(kv, page) && page_erase(kv, page) != RT_EOK) return -RT_EIO;
+    if (page_commit(kv, page, seq) != RT_EOK || store_sync(kv) != RT_EOK) return -RT_EIO;
+    kv->active = page;
+    kv->seq = seq;
+    kv->wr = KV_PAGE_HDR_SIZE;
+    rt_memset(kv->idx, 0, sizeof(kv->idx));
+    return RT_EOK;
+}
+
+rt_err_t kv_mount(kv_store_t *kv, const kv_flash_ops_t *ops, rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages)
+{
+    rt_uint8_t rec[KV_REC_MAX];
+    rt_uint32_t seq = 0, best_seq = 0;
+    int best = -1;
+
+    if (!kv || !ops || pages < 2 || page_size < KV_PAGE_HDR_SIZE + KV_REC_MAX) return -RT_EINVAL;
+    rt_memset(kv, 0, sizeof(*kv));
+    kv->ops = ops;
+    kv->base = base;
+    kv->page_size = page_size;
+    kv->pages = pages;
+
+    for (rt_uint8_t p = 0; p < pages; p++)
+    {
+        if (page_header(kv, p, &seq) && (best < 0 || (rt_int32_t)(seq - best_seq) > 0))
+        {
+            best = p;
+            best_seq = seq;
+        }
+    }
+    if (best < 0)
+    {
+        LOG_I("no valid page, format");
+        return format_page(kv, 0, 1);
+    }
+
+    kv->active = (rt_uint8_t)best;
+    kv->seq = best_seq;
+    /* 其余页：换页中断留下的目标页或未擦除的旧页 */
+    for (rt_uint8_t p = 0; p < pages; p++)
+    {
+        if (p == kv->active || page_blank(kv, p)) continue;
+        kv->stats.recovered++;
+        page_discard(kv, p);
+    }
+
+    rt_uint16_t off = KV_PAGE_HDR_SIZE;
+    for (;;)
+    {
+        int size = read_record(kv, kv->active, off, rec);
+        if (size == 0) break;
+        if (size < 0)
+        {
+            /* 残缺记录：不再向本页追加，下次写入先换页 */
+            kv->stats.recovered++;
+            off = kv->page_size;
+            break;
+        }
+        rt_uint16_t key = (rt_uint16_t)(rec[0] | (rec[1] << 8));
+        if (key < KV_MAX_KEYS)
+            kv->idx[key] = (rec[3] & KV_FLAG_DELETED) ? off : 0;
+        off += (rt_uint16_t)size;
+    }
+    kv->wr = off;
+    return RT_EOK;
+}
+
+rt_err_t kv_gc(kv_store_t *kv)
+{
+    rt_uint8_t rec[KV_REC_MAX];
+    rt_uint16_t new_idx[KV_MAX_KEYS];
+    rt_uint8_t old = kv->active;
+    rt_uint8_t target = (rt_uint8_t)((old + 1) % kv->pages);
+    rt_uint16_t woff = KV_PAGE_HDR_SIZE;
+
+    if (!page_blank(kv, target))
+    {
+        if (kv->no_erase) return -RT_EBUSY;
+        rt_err_t r = page_erase(kv, target);
+        if (r != RT_EOK) return r;
+    }
+
+    rt_memset(new_idx, 0, sizeof(new_idx));
+    for (rt_uint16_t key = 0; key < KV_MAX_KEYS; key++)
+    {
+        if (!kv->idx[key]) continue;
+        int size = read_record(kv, old, kv->idx[key], rec);
+        if (size <= 0) continue;
+        if (woff + size > kv->page_size) return -RT_EFULL;
+        if (kv->ops->write(page_addr(kv, target) + woff, rec, size) < 0) return -RT_EIO;
+        new_idx[key] = woff;
+        woff += (rt_uint16_t)size;
+    }
+
+    if (page_commit(kv, target, kv->seq + 1) != RT_EOK || store_sync(kv) != RT_EOK) return -RT_EIO;
+    kv->active = target;
+    kv->seq++;
+    kv->wr = woff;
+    rt_memcpy(kv->idx, new_idx, sizeof(new_idx));
+    kv->stats.gcs++;
+
+    /* 提交后旧页即失效；擦除失败/掉电由下次挂载补擦 */
+    page_discard(kv, old);
+    return RT_EOK;
+}
+
+static rt_err_t append(kv_store_t *kv, const rt_uint8_t *rec, rt_uint16_t size)
+{
+    if (kv->wr + size > kv->page_size)
+    {
+        rt_err_t r = kv_gc(kv);
+        if (r != RT_EOK) return r;
+        if (kv->wr + size > kv->page_size) return -RT_EFULL;
+    }
+    if (kv->ops->write(page_addr(kv, kv->active) + kv->wr, rec, size) < 0 || store_sync(kv) != RT_EOK)
+    {
+        /* 该处可能已部分编程，不再向本页追加 */
+        kv->wr = kv->page_size;
+        return -RT_EIO;
+    }
+    kv->stats.writes++;
+    return RT_EOK;
+}
+
+int kv_get(kv_store_t *kv, rt_uint16_t key, void *buf, rt_size_t size)
+{
+    rt_uint8_t rec[KV_REC_MAX];
+    if (key >= KV_MAX_KEYS || !kv->idx[key]) return -RT_EEMPTY;
+    if (read_record(kv, kv->active, kv->idx[key], rec) <= 0) return -RT_EIO;
+    rt_uint8_t len = rec[2];
+    if (buf) rt_memcpy(buf, rec + KV_REC_HDR_SIZE, (len < size) ? len : size);
+    return len;
+}
+
+rt_err_t kv_set(kv_store_t *kv, rt_uint16_t key, const void *data, rt_size_t len)
+{
+    rt_uint8_t rec[KV_REC_MAX];
+    if (key >= KV_MAX_KEYS || len > KV_VALUE_MAX || (len && !data)) return -RT_EINVAL;
+
+    if (kv->idx[key] && read_record(kv, kv->active, kv->idx[key], rec) > 0 &&
+        rec[2] == len && rt_memcmp(rec + KV_REC_HDR_SIZE, data, len) == 0)
+    {
+        kv->stats.unchanged++;
+        return RT_EOK;
+    }
+
+    rt_uint16_t size = (rt_uint16_t)build_record(rec, key, data, len, 0xFF);
+    rt_err_t r = append(kv, rec, size);
+    if (r == RT_EOK)
+    {
+        kv->idx[key] = kv->wr;
+        kv->wr += size;
+    }
+    return r;
+}
+
+rt_err_t kv_del(kv_store_t *kv, rt_uint16_t key)
+{
+    rt_uint8_t rec[KV_REC_MAX];
+    if (key >= KV_MAX_KEYS) return -RT_EINVAL;
+    if (!kv->idx[key]) return RT_EOK;
+
+    rt_uint16_t size = (rt_uint16_t)build_record(rec, key, RT_NULL, 0, (rt_uint8_t)~KV_FLAG_DELETED);
+    rt_err_t r = append(kv, rec, size);
+    if (r == RT_EOK)
+    {
+        kv->idx[key] = 0;
+        kv->wr += size;
+    }
+    return r;
+}
+
+rt_size_t kv_free_bytes(const kv_store_t *kv)
+{
+    return (kv->wr < kv->page_size) ? (kv->page_size - kv->wr) : 0;
+}
+
+/* ================== 实机：片内 Flash ================== */
+static kv_store_t s_kv;
+static struct rt_mutex s_lock;
+static rt_uint8_t s_inited = 0;
+
+const kv_flash_ops_t *kv_store_onchip_ops(void)
+{
+    return flash_writer_ops();
+}
+
+rt_err_t kv_store_init(void)
+{
+#ifdef BSP_USING_ON_CHIP_FLASH
+    if (s_inited) return RT_EOK;
+    rt_mutex_init(&s_lock, "kv", RT_IPC_FLAG_PRIO);
+    rt_err_t r = kv_mount(&s_kv, kv_store_onchip_ops(), KV_STORE_BASE, KV_STORE_PAGE_SIZE, KV_STORE_PAGES);
+    if (r != RT_EOK)
+    {
+        LOG_E("mount failed (%d)", (int)r);
+        rt_mutex_detach(&s_lock);
+        return r;
+    }
+    s_inited = 1;
+    LOG_I("page %u seq %u, %u bytes free", (unsigned)s_kv.active, (unsigned)s_kv.seq, (unsigned)kv_free_bytes(&s_kv));
+    return RT_EOK;
+#else
+    LOG_W("BSP_USING_ON_CHIP_FLASH not defined, kv store disabled");
+    return -RT_ENOSYS;
+#endif
+}
+
+int kv_store_get(rt_uint16_t key, void *buf, rt_size_t size)
+{
+    if (!s_inited) return -RT_ENOSYS;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    int r = kv_get(&s_kv, key, buf, size);
+    rt_mutex_release(&s_lock);
+    return r;
+}
+
+rt_err_t kv_store_set(rt_uint16_t key, const void *data, rt_size_t len)
+{
+    if (!s_inited) return -RT_ENOSYS;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    rt_err_t r = kv_set(&s_kv, key, data, len);
+    rt_mutex_release(&s_lock);
+    return r;
+}
+
+rt_err_t kv_store_del(rt_uint16_t key)
+{
+    if (!s_inited) return -RT_ENOSYS;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    rt_err_t r = kv_del(&s_kv, key);
+    rt_mutex_release(&s_lock);
+    return r;
+}
+
+/* ================== 命令 ================== */
+static void print_value(rt_uint16_t key, const rt_uint8_t *v, int len)
+{
+    rt_kprintf("%2u [%2d] ", (unsigned)key, len);
+    for (int i = 0; i < len; i++) rt_kprintf("%02x", v[i]);
+    rt_kprintf("\n");
+}
+
+static void print_stats(const kv_store_t *kv)
+{
+    rt_kprintf("page=%u seq=%u free=%u writes=%u unchanged=%u gcs=%u erases=%u recovered=%u\n",
+               (unsigned)kv->active, (unsigned)kv->seq, (unsigned)kv_free_bytes(kv),
+               (unsigned)kv->stats.writes, (unsigned)kv->stats.unchanged, (unsigned)kv->stats.gcs,
+               (unsigned)kv->stats.erases, (unsigned)kv->stats.recovered);
+}
+
+static int cmd_sw_kv(int argc, char **argv)
+{
+    rt_uint8_t v[KV_VALUE_MAX];
+    if (argc < 2)
+    {
+        rt_kprintf("usage: sw_kv list|stat|gc|get <key>|set <key> <text>|del <key>\n");
+        return -RT_ERROR;
+    }
+    if (kv_store_init() != RT_EOK)
+    {
+        rt_kprintf("sw_kv: store unavailable\n");
+        return -RT_ERROR;
+    }
+
+    rt_err_t r = RT_EOK;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    if (!strcmp(argv[1], "list"))
+    {
+        for (rt_uint16_t k = 0; k < KV_MAX_KEYS; k++)
+        {
+            int len = kv_get(&s_kv, k, v, sizeof(v));
+            if (len >= 0) print_value(k, v, len);
+        }
+    }
+    else if (!strcmp(argv[1], "stat"))
+    {
+        print_stats(&s_kv);
+    }
+    else if (!strcmp(argv[1], "gc"))
+    {
+        r = kv_gc(&s_kv);
+        print_stats(&s_kv);
+    }
+    else if (!strcmp(argv[1], "get") && argc >= 3)
+    {
+        int len = kv_get(&s_kv, (rt_uint16_t)atoi(argv[2]), v, sizeof(v));
+        if (len >= 0) print_value((rt_uint16_t)atoi(argv[2]), v, len);
+        else r = len;
+    }
+    else if (!strcmp(argv[1], "set") && argc >= 4)
+    {
+        r = kv_set(&s_kv, (rt_uint16_t)atoi(argv[2]), argv[3], strlen(argv[3]));
+    }
+    else if (!strcmp(argv[1], "del") && argc >= 3)
+    {
+        r = kv_del(&s_kv, (rt_uint16_t)atoi(argv[2]));
+    }
+    else
+    {
+        r = -RT_EINVAL;
+    }
+    rt_mutex_release(&s_lock);
+
+    if (r != RT_EOK) rt_kprintf("sw_kv: %s failed (%d)\n", argv[1], (int)r);
+    return (r == RT_EOK) ? 0 : -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_kv, sw_kv, Parameter_kv_store);
+
+/* ================== 模拟器：擦写计数与掉电注入 ==================
+ * 用法：sw_kv_sim bench [saves]          对比单页整体重写方案的擦除次数
+ *       sw_kv_sim fault [rounds] [seed]  随机掉电后重新挂载，校验每个键为旧值或新值 */
+#define SIM_BASE        0x10000000UL
+#define SIM_KEYS        8
+#define SIM_VAL_MAX     8
+
+static const kv_flash_ops_t s_sim_ops = { flash_sim_read, flash_sim_write, flash_sim_erase, RT_NULL, RT_NULL };
+static rt_uint32_t s_rng = 1;
+
+static rt_uint32_t sim_rand(void)
+{
+    s_rng = s_rng * 1103515245UL + 12345UL;
+    return s_rng >> 8;
+}
+
+static rt_uint8_t sim_value(rt_uint8_t *v)
+{
+    rt_uint8_t len = (rt_uint8_t)(2 + sim_rand() % (SIM_VAL_MAX - 1));
+    for (rt_uint8_t i = 0; i < len; i++) v[i] = (rt_uint8_t)sim_rand();
+    return len;
+}
+
+static int sim_bench(rt_uint32_t saves)
+{
+    kv_store_t *kv = (kv_store_t *)rt_malloc(sizeof(kv_store_t));
+    if (!kv || flash_sim_create(SIM_BASE, KV_STORE_PAGE_SIZE, KV_STORE_PAGES) != RT_EOK ||
+        kv_mount(kv, &s_sim_ops, SIM_BASE, KV_STORE_PAGE_SIZE, KV_STORE_PAGES) != RT_EOK)
+    {
+        rt_kprintf("sw_kv_sim: no memory\n");
+        if (kv) rt_free(kv);
+        flash_sim_destroy();
+        return -RT_ENOMEM;
+    }
+
+    rt_uint8_t v[SIM_VAL_MAX];
+    for (rt_uint16_t k = 0; k < SIM_KEYS; k++) kv_set(kv, k, v, sim_value(v));
+    flash_sim_reset_stats();
+
+    /* 每次保存改动一个参数 */
+    for (rt_uint32_t i = 0; i < saves; i++)
+    {
+        rt_uint8_t len = sim_value(v);
+        kv_set(kv, (rt_uint16_t)(sim_rand() % SIM_KEYS), v, len);
+    }
+
+    flash_sim_stats_t st;
+    flash_sim_get_stats(&st);
+    rt_kprintf("saves=%u erases=%u (single-page rewrite: %u) words=%u gcs=%u\n",
+               (unsigned)saves, (unsigned)st.erases, (unsigned)saves, (unsigned)st.programs, (unsigned)kv->stats.gcs);
+    for (rt_uint8_t p = 0; p < KV_STORE_PAGES; p++)
+        rt_kprintf("page %u: %u erases\n", (unsigned)p, (unsigned)st.erase_count[p]);
+    if (st.max_page_erases)
+        rt_kprintf("saves per erase of the most worn page: %u (10k-cycle page lasts ~%u saves)\n",
+                   (unsigned)(saves / st.max_page_erases), (unsigned)(saves / st.max_page_erases * 10000U));
+
+    rt_free(kv);
+    flash_sim_destroy();
+    return 0;
+}
+
+static int sim_fault(rt_uint32_t rounds)
+{
+    rt_uint8_t committed[SIM_KEYS][SIM_VAL_MAX];
+    rt_uint8_t committed_len[SIM_KEYS];
+    rt_uint8_t v[SIM_VAL_MAX], got[SIM_VAL_MAX];
+    rt_uint32_t mismatches = 0, torn_new = 0, recovered = 0;
+    kv_store_t *kv = (kv_store_t *)rt_malloc(sizeof(kv_store_t));
+
+    if (!kv || flash_sim_create(SIM_BASE, KV_STORE_PAGE_SIZE, KV_STORE_PAGES) != RT_EOK ||
+        kv_mount(kv, &s_sim_ops, SIM_BASE, KV_STORE_PAGE_SIZE, KV_STORE_PAGES) != RT_EOK)
+    {
+        rt_kprintf("sw_kv_sim: no memory\n");
+        if (kv) rt_free(kv);
+        flash_sim_destroy();
+        return -RT_ENOMEM;
+    }
+    for (rt_uint16_t k = 0; k < SIM_KEYS; k++)
+    {
+        committed_len[k] = sim_value(committed[k]);
+        kv_set(kv, k, committed[k], committed_len[k]);
+    }
+
+    for (rt_uint32_t r = 0; r < rounds; r++)
+    {
+        rt_uint16_t key = 0;
+        rt_uint8_t len = 0;
+
+        /* 写若干次后在随机位置掉电（可能落在追加、换页拷贝、提交或擦除中） */
+        flash_sim_cut_after((rt_int32_t)(sim_rand() % 600));
+        while (!flash_sim_is_cut())
+        {
+            key = (rt_uint16_t)(sim_rand() % SIM_KEYS);
+            len = sim_value(v);
+            if (kv_set(kv, key, v, len) == RT_EOK && !flash_sim_is_cut())
+            {
+                rt_memcpy(committed[key], v, len);
+                committed_len[key] = len;
+            }
+        }
+
+        flash_sim_power_cycle();
+        if (kv_mount(kv, &s_sim_ops, SIM_BASE, KV_STORE_PAGE_SIZE, KV_STORE_PAGES) != RT_EOK)
+        {
+            mismatches++;
+            continue;
+        }
+        recovered += kv->stats.recovered;
+        for (rt_uint16_t k = 0; k < SIM_KEYS; k++)
+        {
+            int n = kv_get(kv, k, got, sizeof(got));
+            if (n == committed_len[k] && !rt_memcmp(got, committed[k], n)) continue;
+            /* 掉电时正在写入的键允许已是新值 */
+            if (k == key && n == len && !rt_memcmp(got, v, n))
+            {
+                rt_memcpy(committed[k], v, len);
+                committed_len[k] = len;
+                torn_new++;
+                continue;
+            }
+            mismatches++;
+            rt_kprintf("round %u key %u: len %d expect %u\n", (unsigned)r, (unsigned)k, n, (unsigned)committed_len[k]);
+        }
+    }
+
+    flash_sim_stats_t st;
+    flash_sim_get_stats(&st);
+    rt_kprintf("rounds=%u cuts=%u recovered=%u new_on_cut=%u mismatches=%u -> %s\n",
+               (unsigned)rounds, (unsigned)st.cuts, (unsigned)recovered, (unsigned)torn_new,
+               (unsigned)mismatches, mismatches ? "FAIL" : "PASS");
+    rt_free(kv);
+    flash_sim_destroy();
+    return mismatches ? -RT_ERROR : 0;
+}
+
+static int cmd_sw_kv_sim(int argc, char **argv)
+{
+    if (argc >= 2 && !strcmp(argv[1], "bench"))
+    {
+        return sim_bench((argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 1000);
+    }
+    if (argc >= 2 && !strcmp(argv[1], "fault"))
+    {
+        s_rng = (argc >= 4) ? (rt_uint32_t)atoi(argv[3]) : 1;
+        return sim_fault((argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 200);
+    }
+    rt_kprintf("usage: sw_kv_sim bench [saves]|fault [rounds] [seed]\n");
+    return -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_kv_sim, sw_kv_sim, Kv_store_flash_simulator);
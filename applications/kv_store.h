@@ -0,0 +1,104 @@
+#ifndef APPLICATIONS_KV_STORE_H_
+#define APPLICATIONS_KV_STORE_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 日志结构参数存储：若干页轮转，修改只追加一条带 CRC32（crc_service）的小记录，页满时把有效键拷到下一页（GC），
+ * RAM 索引记录每个键最新记录的位置，读取 O(1)。任意时刻掉电，重新挂载后每个键为最后一次完整写入的值。 */
+
+/* 键号 0..KV_MAX_KEYS-1 */
+#ifndef KV_MAX_KEYS
+#define KV_MAX_KEYS             32
+#endif
+/* 单个值最大字节数 */
+#ifndef KV_VALUE_MAX
+#define KV_VALUE_MAX            32
+#endif
+/* 轮转页数（≥2） */
+#ifndef KV_STORE_PAGES
+#define KV_STORE_PAGES          2
+#endif
+#ifndef KV_STORE_PAGE_SIZE
+#define KV_STORE_PAGE_SIZE      1024
+#endif
+/* 片内 Flash 末尾的参数区（链接脚本已从 ROM 中扣除） */
+#ifndef KV_STORE_BASE
+#define KV_STORE_BASE           (0x08000000UL + 64 * 1024 - KV_STORE_PAGES * KV_STORE_PAGE_SIZE)
+#endif
+
+#define KV_PAGE_MAGIC           0x31564B53UL    /* "SKV1" */
+/* 页头：magic(4) seq(4) ~seq(4)；记录：key(2) len(1) flags(1) data(len, 补齐到 4) crc32(4) */
+#define KV_PAGE_HDR_SIZE        12
+#define KV_REC_HDR_SIZE         4
+#define KV_REC_SIZE(len)        (KV_REC_HDR_SIZE + (((len) + 3U) & ~3U) + 4U)
+#define KV_FLAG_DELETED         0x01    /* flags 位清零有效：0xFE 为删除记录 */
+
+#if KV_STORE_PAGES < 2
+#error "KV_STORE_PAGES must be >= 2"
+#endif
+
+/* 底层 Flash 接口，与 stm32_flash_read/write/erase 同语义（成功返回字节数）；erase 返回 -RT_EBUSY 表示暂不能擦除
+ * （flash_writer 在秒表运行中拒绝），存储原样返回给调用者。
+ * sync/discard 可为空：sync 为空时 write 返回即已落盘；非空时 write 可以只是投递，
+ * 存储在提交点调用 sync(区间) 取得结果。discard 为空时作废页立即擦除 */
+typedef struct
+{
+    int (*read)(rt_uint32_t addr, rt_uint8_t *buf, rt_size_t size);
+    int (*write)(rt_uint32_t addr, const rt_uint8_t *buf, rt_size_t size);
+    int (*erase)(rt_uint32_t addr, rt_size_t size);
+    int (*sync)(rt_uint32_t addr, rt_size_t size);
+    int (*discard)(rt_uint32_t addr, rt_size_t size);
+} kv_flash_ops_t;
+
+typedef struct
+{
+    rt_uint32_t writes;         /* 追加记录数 */
+    rt_uint32_t unchanged;      /* 值未变化而跳过的写入 */
+    rt_uint32_t gcs;            /* 换页次数 */
+    rt_uint32_t erases;
+    rt_uint32_t recovered;      /* 挂载时发现的残缺记录/页 */
+} kv_stats_t;
+
+/* 存储实例（纯逻辑，实机与模拟器共用） */
+typedef struct
+{
+    const kv_flash_ops_t *ops;
+    rt_uint32_t base;
+    rt_uint16_t page_size;
+    rt_uint8_t  pages;
+    rt_uint8_t  active;         /* 当前写入页 */
+    rt_uint8_t  no_erase;       /* 置位时换页遇到未擦除的目标页返回 -RT_EBUSY，不在调用者路径上擦除 */
+    rt_uint32_t seq;            /* 当前页序号 */
+    rt_uint16_t wr;             /* 页内下一条记录偏移 */
+    rt_uint16_t idx[KV_MAX_KEYS];   /* 键最新记录的页内偏移，0 为不存在 */
+    kv_stats_t  stats;
+} kv_store_t;
+
+/* 纯逻辑接口 */
+rt_err_t kv_mount(kv_store_t *kv, const kv_flash_ops_t *ops, rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages);
+/* 返回值长度，<0 为不存在/错误 */
+int      kv_get(kv_store_t *kv, rt_uint16_t key, void *buf, rt_size_t size);
+rt_err_t kv_set(kv_store_t *kv, rt_uint16_t key, const void *data, rt_size_t len);
+rt_err_t kv_del(kv_store_t *kv, rt_uint16_t key);
+/* 强制换页（压缩）；no_erase 置位且目标页未空白时返回 -RT_EBUSY，记录原样保留 */
+rt_err_t kv_gc(kv_store_t *kv);
+rt_size_t kv_free_bytes(const kv_store_t *kv);
+
+/* 实机接口：片内 Flash（需 BSP_USING_ON_CHIP_FLASH），线程安全 */
+rt_err_t kv_store_init(void);
+int      kv_store_get(rt_uint16_t key, void *buf, rt_size_t size);
+rt_err_t kv_store_set(rt_uint16_t key, const void *data, rt_size_t len);
+rt_err_t kv_store_del(rt_uint16_t key);
+/* 片内 Flash 底层接口（经 flash_writer 线程串行、合并写），供其他日志实例复用；未开启片内 Flash 时返回 RT_NULL。
+ * 首次调用须在线程上下文，且早于使用它的线程创建 */
+const kv_flash_ops_t *kv_store_onchip_ops(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_KV_STORE_H_ */
@@ -0,0 +1,386 @@
+#include "lap_board.h"
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event_bus.h"
+
+#define DBG_TAG "board"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* ================== 堆 ==================
+ * 堆顶为榜上名次最后的一圈：父节点名次不先于子节点。新圈先于堆顶才入榜，替换堆顶后下沉。 */
+
+/* a 的名次先于 b：最快榜圈时小者在前，最慢榜圈时大者在前，同圈时序号小者在前 */
+static rt_bool_t ranks_before(const lap_board_entry_t *a, const lap_board_entry_t *b, rt_bool_t slow)
+{
+    if (a->lap_ms != b->lap_ms) return slow ? (a->lap_ms > b->lap_ms) : (a->lap_ms < b->lap_ms);
+    return (a->index < b->index) ? RT_TRUE : RT_FALSE;
+}
+
+static void heap_swap(lap_board_entry_t *h, rt_uint8_t i, rt_uint8_t j)
+{
+    lap_board_entry_t t = h[i];
+    h[i] = h[j];
+    h[j] = t;
+}
+
+static void heap_sift_up(lap_board_entry_t *h, rt_uint8_t i, rt_bool_t slow)
+{
+    while (i > 0)
+    {
+        rt_uint8_t p = (rt_uint8_t)((i - 1) / 2);
+        if (!ranks_before(&h[p], &h[i], slow)) break;
+        heap_swap(h, p, i);
+        i = p;
+    }
+}
+
+static void heap_sift_down(lap_board_entry_t *h, rt_uint8_t n, rt_uint8_t i, rt_bool_t slow)
+{
+    while (1)
+    {
+        rt_uint32_t l = 2U * i + 1, r = l + 1;
+        rt_uint8_t last = i;
+        if (l < n && ranks_before(&h[last], &h[l], slow)) last = (rt_uint8_t)l;
+        if (r < n && ranks_before(&h[last], &h[r], slow)) last = (rt_uint8_t)r;
+        if (last == i) break;
+        heap_swap(h, i, last);
+        i = last;
+    }
+}
+
+static rt_bool_t heap_offer(lap_board_entry_t *h, rt_uint8_t *n, const lap_board_entry_t *e, rt_bool_t slow)
+{
+    if (*n < LAP_BOARD_K)
+    {
+        h[*n] = *e;
+        heap_sift_up(h, *n, slow);
+        (*n)++;
+        return RT_TRUE;
+    }
+    if (!ranks_before(e, &h[0], slow)) return RT_FALSE;
+    h[0] = *e;
+    heap_sift_down(h, *n, 0, slow);
+    return RT_TRUE;
+}
+
+void lap_board_reset(lap_board_t *b)
+{
+    rt_memset(b, 0, sizeof(*b));
+}
+
+rt_bool_t lap_board_add(lap_board_t *b, const lap_board_entry_t *e)
+{
+    if (e->index <= b->upto) return RT_FALSE;
+    b->upto = e->index;
+    rt_bool_t f = heap_offer(b->fast, &b->n_fast, e, RT_FALSE);
+    rt_bool_t s = heap_offer(b->slow, &b->n_slow, e, RT_TRUE);
+    return (f || s) ? RT_TRUE : RT_FALSE;
+}
+
+rt_uint8_t lap_board_sorted(const lap_board_t *b, rt_bool_t slowest, lap_board_entry_t *out, rt_uint8_t k)
+{
+    lap_board_entry_t tmp[LAP_BOARD_K];
+    rt_uint8_t n = slowest ? b->n_slow : b->n_fast;
+
+    /* 只在读者侧排序，K 很小，插入排序即可 */
+    rt_memcpy(tmp, slowest ? b->slow : b->fast, sizeof(tmp[0]) * n);
+    for (rt_uint8_t i = 1; i < n; i++)
+    {
+        lap_board_entry_t e = tmp[i];
+        rt_uint8_t j = i;
+        while (j > 0 && ranks_before(&e, &tmp[j - 1], slowest))
+        {
+            tmp[j] = tmp[j - 1];
+            j--;
+        }
+        tmp[j] = e;
+    }
+    if (k > n) k = n;
+    rt_memcpy(out, tmp, sizeof(tmp[0]) * k);
+    return k;
+}
+
+void lap_board_add_ring(lap_board_t *b, const stopwatch_snapshot_t *s)
+{
+    lap_board_entry_t e;
+
+    if (s->lap_count == 0 || s->lap_count > STOPWATCH_MAX_LAPS || s->lap_count > s->lap_total) return;
+    /* 由最后一圈的结束时刻倒推环中第一圈的结束时刻 */
+    rt_uint32_t at = s->last_lap_total_ms;
+    for (rt_uint16_t i = 1; i < s->lap_count; i++) at -= s->lap_durations_ms[i];
+    for (rt_uint16_t i = 0; i < s->lap_count; i++)
+    {
+        if (i > 0) at += s->lap_durations_ms[i];
+        e.index = s->lap_total - s->lap_count + 1 + i;
+        e.lap_ms = s->lap_durations_ms[i];
+        e.at_ms = at;
+        lap_board_add(b, &e);
+    }
+}
+
+/* 把 src 中序号大于 dst->upto 的圈并入 dst：某圈若进入合并后的某个榜，必然也在 src 的同一个榜上 */
+static void board_merge(lap_board_t *dst, const lap_board_t *src)
+{
+    for (rt_uint8_t i = 0; i < src->n_fast; i++)
+        if (src->fast[i].index > dst->upto) heap_offer(dst->fast, &dst->n_fast, &src->fast[i], RT_FALSE);
+    for (rt_uint8_t i = 0; i < src->n_slow; i++)
+        if (src->slow[i].index > dst->upto) heap_offer(dst->slow, &dst->n_slow, &src->slow[i], RT_TRUE);
+    if (src->upto > dst->upto) dst->upto = src->upto;
+}
+
+/* ================== kv 编码 ==================
+ * 键 key0 为榜头（会话号、两榜项数、upto），其后每个键存一个榜的两个堆槽（原堆序，不排序）：
+ * 入榜只改动上浮/下沉路径上的槽，其余键值不变由 kv 跳过。保存按键序写槽、最后写榜头；
+ * 中途掉电时已写的槽或含新圈（序号大于旧榜头的 upto），或是旧圈移位后与未写的槽重复、或破坏堆序，读取时都能识别。 */
+typedef struct
+{
+    rt_uint16_t session;
+    rt_uint8_t  n_fast;
+    rt_uint8_t  n_slow;
+    rt_uint32_t upto;
+} board_hdr_t;
+
+#define BOARD_PARTS_PER_HEAP    ((LAP_BOARD_K + 1) / 2)
+
+#if KV_VALUE_MAX < 24
+#error "lap_board needs KV_VALUE_MAX >= 24"
+#endif
+
+rt_err_t lap_board_store(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session, const lap_board_t *b)
+{
+    lap_board_entry_t pair[2];
+    board_hdr_t hdr;
+
+    for (rt_uint8_t p = 0; p < 2 * BOARD_PARTS_PER_HEAP; p++)
+    {
+        rt_bool_t slow = (p >= BOARD_PARTS_PER_HEAP);
+        const lap_board_entry_t *h = slow ? b->slow : b->fast;
+        rt_uint8_t n = slow ? b->n_slow : b->n_fast;
+        rt_uint8_t j = (rt_uint8_t)((p % BOARD_PARTS_PER_HEAP) * 2);
+
+        /* 未用的槽不写：项数增长前其内容无意义 */
+        if (j >= n) continue;
+        rt_memset(pair, 0, sizeof(pair));
+        pair[0] = h[j];
+        if (j + 1 < n) pair[1] = h[j + 1];
+        rt_err_t r = kv_set(kv, (rt_uint16_t)(key0 + 1 + p), pair, sizeof(pair));
+        if (r != RT_EOK) return r;
+    }
+    hdr.session = session;
+    hdr.n_fast = b->n_fast;
+    hdr.n_slow = b->n_slow;
+    hdr.upto = b->upto;
+    return kv_set(kv, key0, &hdr, sizeof(hdr));
+}
+
+/* 槽内无重复序号、序号不超过 upto 且满足堆序 */
+static rt_bool_t heap_valid(const lap_board_entry_t *h, rt_uint8_t n, rt_uint32_t upto, rt_bool_t slow)
+{
+    for (rt_uint8_t i = 0; i < n; i++)
+    {
+        if (h[i].index == 0 || h[i].index > upto) return RT_FALSE;
+        if (i > 0 && ranks_before(&h[(i - 1) / 2], &h[i], slow)) return RT_FALSE;
+        for (rt_uint8_t j = 0; j < i; j++)
+            if (h[j].index == h[i].index) return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+rt_err_t lap_board_fetch(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session, lap_board_t *b)
+{
+    lap_board_entry_t pair[2];
+    board_hdr_t hdr;
+
+    lap_board_reset(b);
+    if (kv_get(kv, key0, &hdr, sizeof(hdr)) != (int)sizeof(hdr) || hdr.session != session ||
+        hdr.n_fast > LAP_BOARD_K || hdr.n_slow > LAP_BOARD_K)
+        return -RT_EEMPTY;
+    for (rt_uint8_t p = 0; p < 2 * BOARD_PARTS_PER_HEAP; p++)
+    {
+        rt_bool_t slow = (p >= BOARD_PARTS_PER_HEAP);
+        lap_board_entry_t *h = slow ? b->slow : b->fast;
+        rt_uint8_t n = slow ? hdr.n_slow : hdr.n_fast;
+        rt_uint8_t j = (rt_uint8_t)((p % BOARD_PARTS_PER_HEAP) * 2);
+
+        if (j >= n) continue;
+        if (kv_get(kv, (rt_uint16_t)(key0 + 1 + p), pair, sizeof(pair)) != (int)sizeof(pair)) break;
+        h[j] = pair[0];
+        if (j + 1 < n) h[j + 1] = pair[1];
+    }
+    b->n_fast = hdr.n_fast;
+    b->n_slow = hdr.n_slow;
+    b->upto = hdr.upto;
+    if (!heap_valid(b->fast, b->n_fast, b->upto, RT_FALSE) || !heap_valid(b->slow, b->n_slow, b->upto, RT_TRUE))
+    {
+        lap_board_reset(b);
+        return -RT_ERROR;
+    }
+    return RT_EOK;
+}
+
+/* ================== 实机 ================== */
+static lap_board_t s_board;
+static struct rt_mutex s_lock;
+static rt_uint8_t s_inited = 0;
+static rt_uint32_t s_entered = 0;       /* 入榜次数 */
+static rt_uint16_t s_saved_session = 0;
+static rt_uint32_t s_saved_upto = 0;    /* 已保存的榜（upto 为 0 时无需保存） */
+static rt_uint32_t s_saves = 0;
+static rt_int8_t s_restored = -1;       /* -1：未恢复；0：仅圈速环；1：含已保存的榜 */
+
+/* 本圈结束时的总用时：批内最后一圈即 last_lap_total_ms，更早的圈由圈速环倒推；不在环内时按事件时刻计算 */
+static rt_uint32_t lap_end_ms(const stopwatch_snapshot_t *s, rt_uint32_t index, rt_uint64_t t_us)
+{
+    rt_uint32_t later = s->lap_total - index;
+    if (later >= s->lap_count) return stopwatch_snapshot_total_ms(s, t_us);
+    rt_uint32_t at = s->last_lap_total_ms;
+    for (rt_uint32_t i = 0; i < later; i++) at -= s->lap_durations_ms[s->lap_count - 1 - i];
+    return at;
+}
+
+/* 在秒表服务线程中同步回调：读一次快照，两次堆操作 */
+static void board_on_event(const event_t *e, void *user)
+{
+    stopwatch_snapshot_t snap;
+    lap_board_entry_t ent;
+    (void)user;
+
+    if (e->topic == EVT_STATE_CHANGED)
+    {
+        if (e->code != EVT_CAUSE_RESET) return;
+        rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+        lap_board_reset(&s_board);
+        rt_mutex_release(&s_lock);
+        return;
+    }
+
+    stopwatch_get_snapshot(&snap);
+    /* 事件只带 16 位圈序号，按快照中的圈数还原 */
+    ent.index = snap.lap_total - (rt_uint16_t)((rt_uint16_t)snap.lap_total - e->index);
+    ent.lap_ms = e->value;
+    ent.at_ms = lap_end_ms(&snap, ent.index, e->t_us);
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    if (lap_board_add(&s_board, &ent)) s_entered++;
+    rt_mutex_release(&s_lock);
+}
+
+rt_err_t lap_board_init(void)
+{
+    if (s_inited) return RT_EOK;
+    rt_mutex_init(&s_lock, "board", RT_IPC_FLAG_PRIO);
+    lap_board_reset(&s_board);
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED), board_on_event, RT_NULL,
+                        EVENT_DELIVER_SYNC);
+    s_inited = 1;
+    return RT_EOK;
+}
+
+void lap_board_get(lap_board_t *out)
+{
+    if (!s_inited)
+    {
+        lap_board_reset(out);
+        return;
+    }
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    *out = s_board;
+    rt_mutex_release(&s_lock);
+}
+
+void lap_board_restore(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session, const stopwatch_snapshot_t *s)
+{
+    lap_board_t b;
+
+    if (!s_inited) return;
+    lap_board_reset(&b);
+    s_restored = 0;
+#if LAP_BOARD_PERSIST
+    if (lap_board_fetch(kv, key0, session, &b) == RT_EOK)
+    {
+        s_restored = 1;
+        s_saved_session = session;
+        s_saved_upto = b.upto;
+    }
+#else
+    (void)kv;
+    (void)key0;
+    (void)session;
+#endif
+    lap_board_add_ring(&b, s);
+
+    /* 恢复完成后到此处之间已记录的新圈 */
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    board_merge(&b, &s_board);
+    s_board = b;
+    rt_mutex_release(&s_lock);
+    LOG_I("restored %u/%u laps up to #%u%s", (unsigned)b.n_fast, (unsigned)b.n_slow, (unsigned)b.upto,
+          s_restored ? " (saved board)" : "");
+}
+
+rt_err_t lap_board_save(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session)
+{
+#if LAP_BOARD_PERSIST
+    lap_board_t b;
+
+    if (!s_inited) return RT_EOK;
+    lap_board_get(&b);
+    /* 空榜不写：旧会话的记录在读取时因会话号不符而作废 */
+    if (b.upto == 0 || (b.upto == s_saved_upto && session == s_saved_session)) return RT_EOK;
+    rt_err_t r = lap_board_store(kv, key0, session, &b);
+    if (r != RT_EOK) return r;
+    s_saved_session = session;
+    s_saved_upto = b.upto;
+    s_saves++;
+    return RT_EOK;
+#else
+    (void)kv;
+    (void)key0;
+    (void)session;
+    return RT_EOK;
+#endif
+}
+
+/* ================== 命令 ================== */
+static void print_entries(const char *title, const lap_board_entry_t *e, rt_uint8_t n)
+{
+    rt_kprintf("%s:\n", title);
+    for (rt_uint8_t i = 0; i < n; i++)
+        rt_kprintf("  %u. lap %-5u %5u.%03u s  at %6u.%03u s\n", (unsigned)(i + 1), (unsigned)e[i].index,
+                   (unsigned)(e[i].lap_ms / 1000), (unsigned)(e[i].lap_ms % 1000), (unsigned)(e[i].at_ms / 1000),
+                   (unsigned)(e[i].at_ms % 1000));
+    if (n == 0) rt_kprintf("  (none)\n");
+}
+
+static int cmd_sw_best(int argc, char **argv)
+{
+    lap_board_t b;
+    lap_board_entry_t out[LAP_BOARD_K];
+    int k = LAP_BOARD_K;
+
+    if (!s_inited)
+    {
+        rt_kprintf("sw_best: not initialized\n");
+        return -RT_ERROR;
+    }
+    if (argc >= 2)
+    {
+        k = atoi(argv[1]);
+        if (k < 1 || k > LAP_BOARD_K)
+        {
+            rt_kprintf("usage: sw_best [k]  (1..%d)\n", LAP_BOARD_K);
+            return -RT_ERROR;
+        }
+    }
+
+    lap_board_get(&b);
+    rt_kprintf("board: %u laps counted, K=%d\n", (unsigned)b.upto, LAP_BOARD_K);
+    print_entries("fastest", out, lap_board_sorted(&b, RT_FALSE, out, (rt_uint8_t)k));
+    print_entries("slowest", out, lap_board_sorted(&b, RT_TRUE, out, (rt_uint8_t)k));
+    rt_kprintf("entered=%u saves=%u", (unsigned)s_entered, (unsigned)s_saves);
+    if (s_restored >= 0) rt_kprintf(" boot=%s", s_restored ? "saved board + ring" : "ring only");
+    rt_kprintf("\n");
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_best, sw_best, Fastest_and_slowest_laps);
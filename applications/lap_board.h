@@ -0,0 +1,73 @@
+#ifndef APPLICATIONS_LAP_BOARD_H_
+#define APPLICATIONS_LAP_BOARD_H_
+
+#include <rtthread.h>
+#include "kv_store.h"
+#include "stopwatch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 圈速排行榜：本会话最快与最慢的各 LAP_BOARD_K 圈（圈序号、圈时、结束时刻），与圈速环独立，
+ * 圈被环覆盖或清圈后仍在榜上，复位时清空。两个 K 项二叉堆：最快榜为最大堆（堆顶是榜上最慢的一圈），
+ * 最慢榜为最小堆；新圈只与堆顶比较，入榜时替换堆顶并下沉，每圈 O(log K)。
+ * 读者（sw_best、OLED 排行页）拷贝整个榜后排序显示，不读圈速环。
+ * 持久化（LAP_BOARD_PERSIST）：随检查点日志写入其 kv 实例，只在秒表非运行时写，开机由日志恢复后再补上圈速环中更新的圈。 */
+
+#ifndef LAP_BOARD_K
+#define LAP_BOARD_K             6
+#endif
+#ifndef LAP_BOARD_PERSIST
+#define LAP_BOARD_PERSIST       1
+#endif
+
+#if LAP_BOARD_K < 1 || LAP_BOARD_K > 255
+#error "LAP_BOARD_K must be 1..255"
+#endif
+
+typedef struct
+{
+    rt_uint32_t index;              /* 圈序号，从 1 起（复位以来） */
+    rt_uint32_t lap_ms;
+    rt_uint32_t at_ms;              /* 本圈结束时的总用时 */
+} lap_board_entry_t;
+
+typedef struct
+{
+    lap_board_entry_t fast[LAP_BOARD_K];    /* 最大堆 */
+    lap_board_entry_t slow[LAP_BOARD_K];    /* 最小堆 */
+    rt_uint8_t  n_fast;
+    rt_uint8_t  n_slow;
+    rt_uint32_t upto;               /* 已计入的最大圈序号 */
+} lap_board_t;
+
+/* 纯逻辑接口 */
+void       lap_board_reset(lap_board_t *b);
+/* 计入一圈；序号不大于 upto 的圈视为已计入并忽略。返回是否进入任一榜 */
+rt_bool_t  lap_board_add(lap_board_t *b, const lap_board_entry_t *e);
+/* 取前 k 项：最快榜按快到慢、最慢榜按慢到快（同圈时序号小者在前），返回项数 */
+rt_uint8_t lap_board_sorted(const lap_board_t *b, rt_bool_t slowest, lap_board_entry_t *out, rt_uint8_t k);
+
+/* 榜头一个键，其后每个键存两项 */
+#define LAP_BOARD_KEYS          (1 + 2 * ((LAP_BOARD_K + 1) / 2))
+
+/* 写入 kv 的 key0 起 LAP_BOARD_KEYS 个键（值未变化的键由 kv 跳过），榜头最后写。
+ * 读取：无本会话的榜头返回 -RT_EEMPTY，保存中途掉电留下的不一致内容返回 -RT_ERROR */
+rt_err_t lap_board_store(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session, const lap_board_t *b);
+rt_err_t lap_board_fetch(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session, lap_board_t *b);
+/* 把快照圈速环中序号大于 upto 的圈计入（结束时刻由 last_lap_total_ms 倒推） */
+void       lap_board_add_ring(lap_board_t *b, const stopwatch_snapshot_t *s);
+
+/* 实机接口：订阅圈速事件（须在 event_bus_init、stopwatch_init 之后） */
+rt_err_t lap_board_init(void);
+void     lap_board_get(lap_board_t *out);
+/* 检查点日志线程调用：开机恢复时合并已保存的榜与恢复出的圈速环；非运行时保存有变化的榜 */
+void     lap_board_restore(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session, const stopwatch_snapshot_t *s);
+rt_err_t lap_board_save(kv_store_t *kv, rt_uint16_t key0, rt_uint16_t session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_LAP_BOARD_H_ */
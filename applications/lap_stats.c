@@ -0,0 +1,345 @@
+#include "lap_stats.h"
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event_bus.h"
+#include "timebase.h"
+
+#define DBG_TAG "stats"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* ================== 直方图 ================== */
+rt_uint16_t lap_stats_bucket(rt_uint32_t ms)
+{
+    if (ms >= LAP_STATS_MAX_MS) ms = LAP_STATS_MAX_MS - 1;
+    if (ms < 2 * LAP_STATS_SUB) return (rt_uint16_t)ms;
+
+    rt_uint8_t msb = 0;
+    for (rt_uint32_t v = ms; v > 1; v >>= 1) msb++;
+    rt_uint8_t shift = (rt_uint8_t)(msb - LAP_STATS_SUB_BITS);
+    return (rt_uint16_t)((shift + 1) * LAP_STATS_SUB + ((ms >> shift) - LAP_STATS_SUB));
+}
+
+rt_uint32_t lap_stats_bucket_low(rt_uint16_t b)
+{
+    if (b < 2 * LAP_STATS_SUB) return b;
+    rt_uint8_t shift = (rt_uint8_t)(b / LAP_STATS_SUB - 1);
+    return (rt_uint32_t)(LAP_STATS_SUB + b % LAP_STATS_SUB) << shift;
+}
+
+/* ================== P² ==================
+ * 期望位置 n'_i = 1 + (count-1) * dn_i，dn = {0, p/2, p, (1+p)/2, 1}；以 1/2000 为单位（p 为千分比）精确比较，不累积舍入 */
+static void p2_reset(lap_p2_t *p, rt_uint16_t p_permille)
+{
+    rt_memset(p, 0, sizeof(*p));
+    p->p_permille = p_permille;
+}
+
+static void p2_add(lap_p2_t *p, rt_uint32_t count, rt_uint32_t ms)
+{
+    rt_int64_t x = (rt_int64_t)ms << 4;
+    rt_int64_t *q = p->q;
+    rt_int32_t *n = p->n;
+    int k;
+
+    /* 前 5 圈：插入排序保存样本，第 5 圈后初始化标记位置 */
+    if (count < 5)
+    {
+        int i = (int)count;
+        while (i > 0 && q[i - 1] > x)
+        {
+            q[i] = q[i - 1];
+            i--;
+        }
+        q[i] = x;
+        if (count == 4)
+            for (i = 0; i < 5; i++) n[i] = i + 1;
+        return;
+    }
+
+    if (x < q[0])
+    {
+        q[0] = x;
+        k = 0;
+    }
+    else if (x >= q[4])
+    {
+        q[4] = x;
+        k = 3;
+    }
+    else
+    {
+        k = 0;
+        while (x >= q[k + 1]) k++;
+    }
+    for (int i = k + 1; i < 5; i++) n[i]++;
+
+    const rt_int64_t num[5] = { 0, p->p_permille, 2 * p->p_permille, 1000 + p->p_permille, 2000 };
+    for (int i = 1; i <= 3; i++)
+    {
+        rt_int64_t d = 2000 + (rt_int64_t)count * num[i] - 2000 * (rt_int64_t)n[i];
+        if (!((d >= 2000 && n[i + 1] - n[i] > 1) || (d <= -2000 && n[i - 1] - n[i] < -1))) continue;
+
+        rt_int32_t s = (d >= 0) ? 1 : -1;
+        rt_int64_t t1 = (rt_int64_t)(n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]);
+        rt_int64_t t2 = (rt_int64_t)(n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]);
+        rt_int64_t qp = q[i] + s * (t1 + t2) / (n[i + 1] - n[i - 1]);
+        if (q[i - 1] < qp && qp < q[i + 1]) q[i] = qp;
+        else q[i] += (q[i + s] - q[i]) * s / (n[i + s] - n[i]);
+        n[i] += s;
+    }
+}
+
+rt_uint32_t lap_p2_value(const lap_p2_t *p, rt_uint32_t count)
+{
+    if (count == 0) return 0;
+    if (count <= 5) return (rt_uint32_t)(p->q[((count - 1) * p->p_permille + 500) / 1000] >> 4);
+    return (rt_uint32_t)((p->q[2] + 8) >> 4);
+}
+
+/* ================== 汇总 ================== */
+void lap_stats_reset(lap_stats_t *s)
+{
+    rt_memset(s, 0, sizeof(*s));
+    p2_reset(&s->p50, 500);
+    p2_reset(&s->p90, 900);
+}
+
+void lap_stats_add(lap_stats_t *s, rt_uint32_t lap_ms)
+{
+    rt_uint32_t x = (lap_ms < LAP_STATS_MAX_MS) ? lap_ms : LAP_STATS_MAX_MS - 1;
+
+    if (s->n == 0 || lap_ms < s->min_ms) s->min_ms = lap_ms;
+    if (lap_ms > s->max_ms) s->max_ms = lap_ms;
+
+    /* Welford：均值取 Q8，(x - 旧均值)(x - 新均值) 为 Q16，四舍五入累加到 ms² */
+    rt_int64_t xq = (rt_int64_t)x << 8;
+    rt_int64_t mean_old = s->n ? (rt_int64_t)((s->sum_ms << 8) / s->n) : xq;
+    s->sum_ms += x;
+    rt_int64_t mean_new = (rt_int64_t)((s->sum_ms << 8) / (s->n + 1));
+    rt_int64_t prod = (xq - mean_old) * (xq - mean_new);
+    if (prod > 0) s->m2 += (rt_uint64_t)((prod + 32768) >> 16);
+
+    p2_add(&s->p50, s->n, x);
+    p2_add(&s->p90, s->n, x);
+    s->n++;
+
+    rt_uint16_t b = lap_stats_bucket(x);
+    if (s->hist[b] < 0xFFFF) s->hist[b]++;
+}
+
+static rt_uint32_t isqrt64(rt_uint64_t v)
+{
+    rt_uint64_t r = 0, bit = 1ULL << 62;
+
+    while (bit > v) bit >>= 2;
+    while (bit)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (rt_uint32_t)r;
+}
+
+void lap_stats_summarize(const lap_stats_t *s, lap_stats_summary_t *out)
+{
+    rt_memset(out, 0, sizeof(*out));
+    if (s->n == 0) return;
+    out->n = s->n;
+    out->min_ms = s->min_ms;
+    out->max_ms = s->max_ms;
+    out->mean_ms = (rt_uint32_t)((s->sum_ms + s->n / 2) / s->n);
+    /* 方差 ×100 后开方得 0.1 ms 单位；先除后乘避免 M2×100 溢出 */
+    rt_uint64_t var_x100 = (s->m2 / s->n) * 100 + (s->m2 % s->n) * 100 / s->n;
+    out->std_x10 = isqrt64(var_x100);
+    out->p50_ms = lap_p2_value(&s->p50, s->n);
+    out->p90_ms = lap_p2_value(&s->p90, s->n);
+}
+
+/* ================== 实机 ================== */
+static lap_stats_t s_stats;
+static struct rt_mutex s_lock;
+static rt_uint8_t s_inited = 0;
+static rt_uint32_t s_max_update_cycles = 0;
+static rt_uint32_t s_restored_skip = 0;     /* 恢复时已不在圈速环中、未计入的圈 */
+static rt_int8_t s_restored = -1;
+
+/* 在秒表服务线程中同步回调 */
+static void stats_on_event(const event_t *e, void *user)
+{
+    (void)user;
+    if (e->topic == EVT_STATE_CHANGED)
+    {
+        if (e->code != EVT_CAUSE_RESET) return;
+        rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+        lap_stats_reset(&s_stats);
+        s_restored = -1;
+        rt_mutex_release(&s_lock);
+        return;
+    }
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    rt_uint64_t c0 = timebase_get_cycles();
+    lap_stats_add(&s_stats, e->value);
+    rt_uint32_t c = (rt_uint32_t)(timebase_get_cycles() - c0);
+    if (c > s_max_update_cycles) s_max_update_cycles = c;
+    rt_mutex_release(&s_lock);
+}
+
+rt_err_t lap_stats_init(void)
+{
+    if (s_inited) return RT_EOK;
+    rt_mutex_init(&s_lock, "stats", RT_IPC_FLAG_PRIO);
+    lap_stats_reset(&s_stats);
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED), stats_on_event, RT_NULL,
+                        EVENT_DELIVER_SYNC);
+    s_inited = 1;
+    return RT_EOK;
+}
+
+void lap_stats_get(lap_stats_t *out)
+{
+    if (!s_inited)
+    {
+        lap_stats_reset(out);
+        return;
+    }
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    *out = s_stats;
+    rt_mutex_release(&s_lock);
+}
+
+void lap_stats_get_summary(lap_stats_summary_t *out)
+{
+    if (!s_inited)
+    {
+        rt_memset(out, 0, sizeof(*out));
+        return;
+    }
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    lap_stats_summarize(&s_stats, out);
+    rt_mutex_release(&s_lock);
+}
+
+void lap_stats_restore(const stopwatch_snapshot_t *s)
+{
+    if (!s_inited) return;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    /* 恢复后已有新圈时不再补：无法把更早的圈插到它们之前而不重复计入 */
+    if (s_stats.n == 0 && s->lap_count <= STOPWATCH_MAX_LAPS && s->lap_count <= s->lap_total)
+    {
+        for (rt_uint16_t i = 0; i < s->lap_count; i++) lap_stats_add(&s_stats, s->lap_durations_ms[i]);
+        s_restored_skip = s->lap_total - s->lap_count;
+        s_restored = 1;
+    }
+    else
+    {
+        s_restored = 0;
+    }
+    rt_mutex_release(&s_lock);
+}
+
+/* ================== 命令 ================== */
+static void print_stats(const lap_stats_t *s)
+{
+    lap_stats_summary_t sum;
+    rt_uint16_t peak = 0;
+
+    lap_stats_summarize(s, &sum);
+    rt_kprintf("laps=%u min=%u max=%u mean=%u std=%u.%u p50=%u p90=%u\n", (unsigned)sum.n, (unsigned)sum.min_ms,
+               (unsigned)sum.max_ms, (unsigned)sum.mean_ms, (unsigned)(sum.std_x10 / 10), (unsigned)(sum.std_x10 % 10),
+               (unsigned)sum.p50_ms, (unsigned)sum.p90_ms);
+    for (rt_uint16_t b = 0; b < LAP_STATS_BUCKETS; b++)
+        if (s->hist[b] > peak) peak = s->hist[b];
+    for (rt_uint16_t b = 0; b < LAP_STATS_BUCKETS; b++)
+    {
+        /* 条形先填进缓冲，整行一次输出 */
+        char bar[31];
+        rt_uint32_t w;
+
+        if (!s->hist[b]) continue;
+        w = (rt_uint32_t)(s->hist[b] * 30U + peak - 1) / peak;
+        rt_memset(bar, '#', w);
+        bar[w] = '\0';
+        rt_kprintf("  %7u..%-7u %5u %s\n", (unsigned)lap_stats_bucket_low(b), (unsigned)lap_stats_bucket_low(b + 1),
+                   (unsigned)s->hist[b], bar);
+    }
+}
+
+/* 与 testtools/lap_stats.py --sim 相同的圈时序列：约 60s 的圈，1/16 的圈带 0~15s 的额外耗时 */
+static rt_uint32_t s_rng = 1;
+
+static rt_uint32_t sim_rand(void)
+{
+    s_rng = s_rng * 1103515245UL + 12345UL;
+    return s_rng >> 8;
+}
+
+static int stats_sim(rt_uint32_t laps, rt_uint32_t seed)
+{
+    /* 独立的一份统计（约 0.5KB）只在命令期间从堆上分配，不常驻 RAM */
+    lap_stats_t *st = (lap_stats_t *)rt_malloc(sizeof(lap_stats_t));
+    rt_uint64_t cycles = 0;
+
+    if (!st)
+    {
+        rt_kprintf("no memory\n");
+        return -RT_ENOMEM;
+    }
+    s_rng = seed;
+    lap_stats_reset(st);
+    for (rt_uint32_t i = 0; i < laps; i++)
+    {
+        rt_uint32_t slow = (sim_rand() % 16 == 0);
+        rt_uint32_t ms = 58000 + sim_rand() % 4000;
+        if (slow) ms += sim_rand() % 15000;
+        rt_uint64_t c0 = timebase_get_cycles();
+        lap_stats_add(st, ms);
+        cycles += timebase_get_cycles() - c0;
+    }
+    rt_kprintf("sim: laps=%u seed=%u\n", (unsigned)laps, (unsigned)seed);
+    print_stats(st);
+    if (laps) rt_kprintf("update: avg %u cycles\n", (unsigned)(cycles / laps));
+    rt_free(st);
+    return 0;
+}
+
+static int cmd_sw_stats(int argc, char **argv)
+{
+    if (argc >= 2 && !strcmp(argv[1], "sim"))
+        return stats_sim((argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 1000, (argc >= 4) ? (rt_uint32_t)atoi(argv[3]) : 1);
+    if (argc >= 2)
+    {
+        rt_kprintf("usage: sw_stats [sim [laps] [seed]]\n");
+        return -RT_ERROR;
+    }
+    if (!s_inited)
+    {
+        rt_kprintf("sw_stats: not initialized\n");
+        return -RT_ERROR;
+    }
+
+    /* 持锁只做拷贝，串口输出在锁外：服务线程里的圈速更新不等打印；副本只在命令期间从堆上分配 */
+    lap_stats_t *st = (lap_stats_t *)rt_malloc(sizeof(lap_stats_t));
+    if (!st)
+    {
+        rt_kprintf("no memory\n");
+        return -RT_ENOMEM;
+    }
+    lap_stats_get(st);
+    print_stats(st);
+    rt_free(st);
+    rt_kprintf("update: max %u cycles\n", (unsigned)s_max_update_cycles);
+    if (s_restored > 0) rt_kprintf("boot: rebuilt from lap ring, %u earlier laps not included\n", (unsigned)s_restored_skip);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_stats, sw_stats, Streaming_lap_statistics);
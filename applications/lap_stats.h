@@ -0,0 +1,78 @@
+#ifndef APPLICATIONS_LAP_STATS_H_
+#define APPLICATIONS_LAP_STATS_H_
+
+#include <rtthread.h>
+#include "stopwatch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 圈速流式统计：本会话（复位以来）每圈 O(1) 更新、全整数运算（M3 无 FPU），不保存圈时、不排序：
+ *   - 均值/标准差：Welford 更新 M2 += (x - 旧均值)(x - 新均值)，均值由精确和除以圈数得到（Q8），误差不随圈数累积；
+ *   - 中位数/p90：P² 估计（Jain & Chlamtac），每个分位 5 个标记，高度 Q4 ms，期望位置按分数精确计算；
+ *   - 分布：对数-线性直方图，每个二进制数量级分 2^LAP_STATS_SUB_BITS 格，小于 2^(SUB_BITS+1) ms 的圈逐毫秒一格。
+ * 适用范围：圈时超过 LAP_STATS_MAX_MS（约 2.3 小时）按该值计入均值、方差、分位与直方图（最小/最大值不受限），
+ * 直方图每格计数饱和于 65535。P² 假设圈时分布平稳，整场持续变快/变慢时分位估计偏差较大（均值、方差、直方图不受影响）。
+ * testtools/lap_stats.py 以相同整数算法实现，并与精确值对照自测。 */
+
+#ifndef LAP_STATS_SUB_BITS
+#define LAP_STATS_SUB_BITS      3
+#endif
+#define LAP_STATS_MAX_MS        (1UL << 23)
+#define LAP_STATS_SUB           (1U << LAP_STATS_SUB_BITS)
+/* 最大值 2^23-1 的最高位为 22，末格序号 (22 - SUB_BITS + 1) * SUB + SUB - 1 */
+#define LAP_STATS_BUCKETS       ((23 - LAP_STATS_SUB_BITS + 1) * LAP_STATS_SUB)
+
+/* P² 标记：q 为高度（Q4 ms），n 为实际位置（从 1 起）；前 5 圈 q 保存排序后的样本 */
+typedef struct
+{
+    rt_int64_t  q[5];
+    rt_int32_t  n[5];
+    rt_uint16_t p_permille;
+} lap_p2_t;
+
+typedef struct
+{
+    rt_uint32_t n;
+    rt_uint32_t min_ms;
+    rt_uint32_t max_ms;
+    rt_uint64_t sum_ms;
+    rt_uint64_t m2;                 /* Σ(x - 均值)²，ms² */
+    lap_p2_t    p50;
+    lap_p2_t    p90;
+    rt_uint16_t hist[LAP_STATS_BUCKETS];
+} lap_stats_t;
+
+typedef struct
+{
+    rt_uint32_t n;
+    rt_uint32_t min_ms;
+    rt_uint32_t max_ms;
+    rt_uint32_t mean_ms;            /* 四舍五入 */
+    rt_uint32_t std_x10;            /* 总体标准差，0.1 ms */
+    rt_uint32_t p50_ms;
+    rt_uint32_t p90_ms;
+} lap_stats_summary_t;
+
+/* 纯逻辑接口 */
+void        lap_stats_reset(lap_stats_t *s);
+void        lap_stats_add(lap_stats_t *s, rt_uint32_t lap_ms);
+void        lap_stats_summarize(const lap_stats_t *s, lap_stats_summary_t *out);
+rt_uint32_t lap_p2_value(const lap_p2_t *p, rt_uint32_t count);
+/* 直方图格号与格下界（ms），格宽为下一格下界减本格下界 */
+rt_uint16_t lap_stats_bucket(rt_uint32_t ms);
+rt_uint32_t lap_stats_bucket_low(rt_uint16_t b);
+
+/* 实机接口：订阅圈速事件（须在 event_bus_init、stopwatch_init 之后），复位时清零 */
+rt_err_t lap_stats_init(void);
+void     lap_stats_get(lap_stats_t *out);
+void     lap_stats_get_summary(lap_stats_summary_t *out);
+/* 开机恢复后由检查点日志线程调用：尚无新圈时以恢复出的圈速环重建（更早的圈已不可得） */
+void     lap_stats_restore(const stopwatch_snapshot_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_LAP_STATS_H_ */
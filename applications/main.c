@@ -13,18 +13,47 @@
 #define DBG_TAG "main"
 #define DBG_LVL DBG_LOG
 #include <rtdbg.h>
+#include "console_rx.h"
+#include "async_console.h"
+#include "event_bus.h"
 #include "stopwatch.h"
 #include "indicator_led.h"
 #include "notifier_buzzer.h"
 #include "ui_oled.h"
 #include "sensor_light.h"
+#include "button_input.h"
+#include "timer_engine.h"
+#include "crc_service.h"
+#include "kv_store.h"
+#include "flash_writer.h"
+#include "session_journal.h"
+#include "session_archive.h"
+#include "session_recorder.h"
+#include "hot_state.h"
+#include "lap_board.h"
+#include "lap_stats.h"
 
 int main(void)
 {
     int count = 1;
 
+    /* 初始化控制台接收（须在 shell 线程首次运行前） */
+    console_rx_init();
+    /* 初始化异步控制台（须在其他模块输出之前） */
+    async_console_init();
+    /* 绑定硬件 CRC（存储记录校验在此之后可走 CRC 单元） */
+    crc_service_init();
+    /* 启动 Flash 写入服务（参数存储/检查点日志/归档共用） */
+    flash_writer_init();
+    /* 挂载参数存储（掉电恢复在此完成） */
+    kv_store_init();
+    /* 初始化事件总线（须在各订阅模块之前） */
+    event_bus_init();
     /* 初始化秒表服务 */
     stopwatch_init();
+    /* 初始化圈速排行榜与流式统计（早于热状态/检查点恢复，由检查点日志线程合并已保存的榜、重建统计） */
+    lap_board_init();
+    lap_stats_init();
     /* 初始化 LED 指示 */
     indicator_led_init();
     /* 初始化 蜂鸣器 */
@@ -33,6 +62,18 @@ int main(void)
     ui_oled_init();
     /* 初始化 光敏联动 */
     sensor_light_init();
+    /* 初始化 历史会话归档（须在检查点日志之前订阅，以收到开机恢复事件） */
+    session_archive_init();
+    /* 初始化 会话记录器订阅（默认不记录，sw_rec on 开启） */
+    session_recorder_init();
+    /* 从备份寄存器恢复热状态（须在各订阅模块之后、检查点日志之前，日志据此只补圈速环） */
+    hot_state_init();
+    /* 初始化 会话检查点日志（后台线程恢复上次会话，须在 LED/OLED 订阅之后） */
+    session_journal_init();
+    /* 初始化 物理按键 */
+    button_input_init();
+    /* 初始化 倒计时/间歇引擎 */
+    timer_engine_init();
 
     while (count++)
     {
@@ -1,6 +1,8 @@
 #include "notifier_buzzer.h"
 #include <rtdevice.h>
 #include "board.h"
+#include "event_bus.h"
+#include "timer_engine.h"
 
 /* 有源蜂鸣器，低电平触发；默认 PB12，可按需在编译宏重定义 */
 #ifndef BUZZER_PIN
@@ -8,6 +10,8 @@
 #endif
 
 static rt_bool_t s_beep_enabled = 1;
+static rt_bool_t s_env_muted = 0;   /* 光敏联动：黑暗静音，与用户开关相互独立 */
+static struct rt_timer s_beep_timer;
 
 static void buz_set(int on)
 {
@@ -15,11 +19,55 @@ static void buz_set(int on)
     rt_pin_write(BUZZER_PIN, on ? PIN_LOW : PIN_HIGH);
 }
 
+static void beep_timeout(void *parameter)
+{
+    (void)parameter;
+    buz_set(0);
+}
+
+/* 秒表事件 -> 提示音（在发布者上下文执行，只写引脚并启动单次定时器） */
+static void buzzer_on_event(const event_t *e, void *user)
+{
+    (void)user;
+    switch (e->topic)
+    {
+    case EVT_STATE_CHANGED:
+        if (e->code == EVT_CAUSE_START) notifier_beep_once(50);
+        else if (e->code == EVT_CAUSE_STOP) notifier_beep_once(100);
+        else if (e->code == EVT_CAUSE_RESET) notifier_beep_once(30);
+        break;
+    case EVT_LAP_RECORDED:
+        notifier_beep_once(40);
+        break;
+    case EVT_ENV_DARK:
+        s_env_muted = 1;
+        buz_set(0);
+        break;
+    case EVT_ENV_LIGHT:
+        s_env_muted = 0;
+        break;
+    case EVT_TIMER_EXPIRED:
+        /* 段切换短鸣，结束长鸣 */
+        notifier_beep_once((e->code == TIMER_EVT_DONE) ? 400 : 80);
+        break;
+    case EVT_SETTINGS_CHANGED:
+        if (e->code == EVT_SET_BEEP) notifier_beep_enable(e->value ? 1 : 0);
+        break;
+    default:
+        break;
+    }
+}
+
 rt_err_t notifier_buzzer_init(void)
 {
     rt_pin_mode(BUZZER_PIN, PIN_MODE_OUTPUT);
     buz_set(0);
-    return RT_EOK;
+    rt_timer_init(&s_beep_timer, "beep", beep_timeout, RT_NULL, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_SOFT_TIMER);
+    return event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED) |
+                               EVT_MASK(EVT_ENV_DARK) | EVT_MASK(EVT_ENV_LIGHT) |
+                               EVT_MASK(EVT_SETTINGS_CHANGED) | EVT_MASK(EVT_TIMER_EXPIRED),
+                               buzzer_on_event, RT_NULL, EVENT_DELIVER_SYNC);
 }
 
 void notifier_beep_enable(rt_bool_t enable)
@@ -33,20 +81,14 @@ rt_bool_t notifier_beep_is_enabled(void)
     return s_beep_enabled;
 }
 
+/* 非阻塞：拉低引脚后由单次软定时器关闭，重复调用以最后一次时长为准 */
 void notifier_beep_once(rt_uint16_t ms)
 {
-    if (!s_beep_enabled) return;
+    if (!s_beep_enabled || s_env_muted) return;
+    rt_tick_t ticks = rt_tick_from_millisecond(ms);
+    if (ticks == 0) ticks = 1;
+    rt_timer_stop(&s_beep_timer);
+    rt_timer_control(&s_beep_timer, RT_TIMER_CTRL_SET_TIME, &ticks);
     buz_set(1);
-    rt_thread_mdelay(ms);
-    buz_set(0);
+    rt_timer_start(&s_beep_timer);
 }
-
-
-
-
-
-
-
-
-
-
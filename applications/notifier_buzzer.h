@@ -8,6 +8,8 @@ extern "C" {
 #endif
 
 rt_err_t notifier_buzzer_init(void);
+/* 非阻塞短鸣（单次软定时器关闭），可在中断/事件回调中调用；
+ * 秒表状态/圈速提示音由模块订阅事件总线自动触发 */
 void notifier_beep_once(rt_uint16_t ms);
 void notifier_beep_enable(rt_bool_t enable);
 rt_bool_t notifier_beep_is_enabled(void);
@@ -0,0 +1,108 @@
+#include "rtc_backup.h"
+#include "board.h"
+
+#define DBG_TAG "rtc"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define RTC_PRESCALER   32768UL     /* LSE 32.768kHz -> 1Hz */
+
+static rt_uint8_t s_ready = 0;
+static rt_uint8_t s_continuous = 0;
+
+/* 寄存器写入须等待上一次写操作完成（RTOFF），耗时约一个 RTCCLK 周期 */
+static rt_bool_t rtc_wait_rtoff(void)
+{
+    for (rt_uint32_t i = 0; i < 100000UL; i++)
+    {
+        if (RTC->CRL & RTC_CRL_RTOFF) return RT_TRUE;
+    }
+    return RT_FALSE;
+}
+
+static rt_err_t rtc_configure(void)
+{
+    /* 复位备份域后重新选择时钟源 */
+    RCC->BDCR |= RCC_BDCR_BDRST;
+    RCC->BDCR &= ~RCC_BDCR_BDRST;
+    RCC->BDCR |= RCC_BDCR_LSEON;
+    for (rt_uint32_t t = 0; !(RCC->BDCR & RCC_BDCR_LSERDY); t += 10)
+    {
+        if (t >= RTC_BACKUP_LSE_TIMEOUT_MS) return -RT_ETIMEOUT;
+        rt_thread_mdelay(10);
+    }
+    RCC->BDCR |= RCC_BDCR_RTCSEL_LSE | RCC_BDCR_RTCEN;
+
+    if (!rtc_wait_rtoff()) return -RT_ETIMEOUT;
+    RTC->CRL |= RTC_CRL_CNF;
+    RTC->PRLH = (RTC_PRESCALER - 1) >> 16;
+    RTC->PRLL = (RTC_PRESCALER - 1) & 0xFFFF;
+    RTC->CNTH = 0;
+    RTC->CNTL = 0;
+    RTC->CRL &= ~RTC_CRL_CNF;
+    if (!rtc_wait_rtoff()) return -RT_ETIMEOUT;
+
+    BKP->DR1 = RTC_BACKUP_MAGIC;
+    return RT_EOK;
+}
+
+rt_err_t rtc_backup_init(void)
+{
+    if (s_ready) return RT_EOK;
+
+    RCC->APB1ENR |= RCC_APB1ENR_PWREN | RCC_APB1ENR_BKPEN;
+    PWR->CR |= PWR_CR_DBP;
+
+    if ((BKP->DR1 & 0xFFFF) == RTC_BACKUP_MAGIC && (RCC->BDCR & RCC_BDCR_RTCEN) && (RCC->BDCR & RCC_BDCR_LSERDY))
+    {
+        s_continuous = 1;
+    }
+    else
+    {
+        /* 首次上电或 VBAT 掉电：计数从 0 开始，旧时间戳作废 */
+        rt_err_t r = rtc_configure();
+        if (r != RT_EOK)
+        {
+            LOG_W("LSE not running, rtc unavailable");
+            return r;
+        }
+        LOG_I("backup domain reset, counter restarted");
+    }
+
+    /* 复位后 APB1 读到的 RTC 寄存器须先同步 */
+    RTC->CRL &= ~RTC_CRL_RSF;
+    for (rt_uint32_t i = 0; !(RTC->CRL & RTC_CRL_RSF); i++)
+    {
+        if (i >= 100000UL) return -RT_ETIMEOUT;
+    }
+    s_ready = 1;
+    return RT_EOK;
+}
+
+rt_bool_t rtc_backup_ready(void)
+{
+    return s_ready ? RT_TRUE : RT_FALSE;
+}
+
+rt_bool_t rtc_backup_continuous(void)
+{
+    return (s_ready && s_continuous) ? RT_TRUE : RT_FALSE;
+}
+
+rt_err_t rtc_backup_now(rt_uint32_t *sec, rt_uint16_t *ms)
+{
+    rt_uint32_t cnt, div;
+    if (!s_ready) return -RT_ENOSYS;
+
+    /* CNT 与 DIV 分两次读，秒进位时重读 */
+    do
+    {
+        cnt = ((rt_uint32_t)RTC->CNTH << 16) | (RTC->CNTL & 0xFFFF);
+        div = ((rt_uint32_t)(RTC->DIVH & 0xF) << 16) | (RTC->DIVL & 0xFFFF);
+    } while (cnt != (((rt_uint32_t)RTC->CNTH << 16) | (RTC->CNTL & 0xFFFF)));
+
+    if (sec) *sec = cnt;
+    /* DIV 从 PRL 递减到 0 */
+    if (ms) *ms = (rt_uint16_t)(((RTC_PRESCALER - 1 - div) * 1000UL) / RTC_PRESCALER);
+    return RT_EOK;
+}
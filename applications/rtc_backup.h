@@ -0,0 +1,33 @@
+#ifndef APPLICATIONS_RTC_BACKUP_H_
+#define APPLICATIONS_RTC_BACKUP_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 备份域 RTC：LSE 驱动的 32 位秒计数器（预分频 32768），VBAT 供电时掉电/复位后继续走时，
+ * 用于计算停机时间。直接操作寄存器，不依赖 RT_USING_RTC 设备框架。 */
+
+/* LSE 起振等待上限（ms），超时则 RTC 不可用 */
+#ifndef RTC_BACKUP_LSE_TIMEOUT_MS
+#define RTC_BACKUP_LSE_TIMEOUT_MS   3000
+#endif
+/* BKP_DR1 中的配置标志；备份域掉电后丢失，据此判断计数器是否连续 */
+#define RTC_BACKUP_MAGIC            0x5357U
+
+/* 可能等待 LSE 起振，须在线程上下文调用；重复调用直接返回 */
+rt_err_t  rtc_backup_init(void);
+/* 计数器可读 */
+rt_bool_t rtc_backup_ready(void);
+/* 计数器在本次上电之前已在运行（为 RT_FALSE 时，旧时间戳与当前计数无关） */
+rt_bool_t rtc_backup_continuous(void);
+/* 读取当前时刻：秒计数与秒内毫秒 */
+rt_err_t  rtc_backup_now(rt_uint32_t *sec, rt_uint16_t *ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_RTC_BACKUP_H_ */
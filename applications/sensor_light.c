@@ -1,8 +1,7 @@
 #include "sensor_light.h"
 #include <rtdevice.h>
 #include "board.h"
-#include "notifier_buzzer.h"
-#include "ui_oled.h"
+#include "event_bus.h"
 #define DBG_TAG "light"
 #define DBG_LVL DBG_INFO
 #include <rtdbg.h>
@@ -25,21 +24,19 @@ static rt_bool_t read_do(void)
     return dark;
 }
 
+/* 只发布环境事件，静音/降帧由蜂鸣器与 UI 各自订阅处理 */
 static void apply_state(rt_bool_t dark)
 {
     s_dark = dark ? 1 : 0;
-    if (s_dark)
-    {
-        notifier_beep_enable(0);
-        ui_oled_set_refresh_ms(300);
-        LOG_I("env=dark -> beep=off, oled=300ms");
-    }
-    else
-    {
-        notifier_beep_enable(1);
-        ui_oled_set_refresh_ms(10);
-        LOG_I("env=light -> beep=on, oled=10ms");
-    }
+    event_bus_post(s_dark ? EVT_ENV_DARK : EVT_ENV_LIGHT, 0, 0);
+    LOG_I("env=%s", s_dark ? "dark" : "light");
+}
+
+static void light_on_settings(const event_t *e, void *user)
+{
+    (void)user;
+    if (e->code == EVT_SET_LIGHT) sensor_light_enable(e->value ? 1 : 0);
+    else if (e->code == EVT_SET_LIGHT_INVERT) sensor_light_set_invert(e->value ? 1 : 0);
 }
 
 static void light_thread_entry(void *parameter)
@@ -79,6 +76,7 @@ static void light_thread_entry(void *parameter)
 rt_err_t sensor_light_init(void)
 {
     rt_pin_mode(LIGHT_DO_PIN, PIN_MODE_INPUT_PULLUP);
+    event_bus_subscribe(EVT_MASK(EVT_SETTINGS_CHANGED), light_on_settings, RT_NULL, EVENT_DELIVER_SYNC);
     /* 启动即读取当前环境并直接应用，避免上电时与真实环境不符 */
     apply_state(read_do());
     s_light_thread = rt_thread_create("light", light_thread_entry, RT_NULL, 768, RT_THREAD_PRIORITY_MAX - 3, 10);
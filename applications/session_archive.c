@@ -0,0 +1,852 @@
+#include "session_archive.h"
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc_service.h"
+#include "event_bus.h"
+#include "flash_sim.h"
+#include "rtc_backup.h"
+#include "stopwatch.h"
+#include "timebase.h"
+
+#define DBG_TAG "arc"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#if SESSION_ARCHIVE_ENABLE
+
+/* 页布局：[magic][seq][~seq] 记录 记录 ... 0xFF...；页按顺序环形使用，seq 最大的为当前页，
+ * 其后（环形顺序）的页依次更旧。换页时先擦除目标页并丢弃其索引，写 seq/~seq 后最后写 magic 提交。
+ * 记录：archive_hdr_t(36) + 圈数据(补齐到 4) + CRC32(头与圈数据)；残缺记录之后的内容视为无效。 */
+
+#define ARCHIVE_REC_MAX     ARCHIVE_REC_SIZE(SESSION_ARCHIVE_BLOB_MAX)
+
+/* ================== 圈数据编码 ================== */
+void archive_enc_reset(archive_enc_t *e)
+{
+    rt_memset(e, 0, sizeof(*e));
+    e->first_lap = 1;
+    e->min_ms = ARCHIVE_NO_LAP;
+}
+
+void archive_enc_lap(archive_enc_t *e, rt_uint32_t lap_ms)
+{
+    rt_uint8_t tmp[5];
+    rt_uint8_t n = 0;
+
+    e->lap_total++;
+    e->sum_ms += lap_ms;
+    if (lap_ms < e->min_ms) e->min_ms = lap_ms;
+    if (lap_ms > e->max_ms) e->max_ms = lap_ms;
+    if (e->flags & ARCHIVE_FLAG_TRUNCATED) return;
+
+    /* 与上一圈的差值 zigzag 后按 7 位一组编码，高位为续接标志 */
+    rt_int32_t d = (rt_int32_t)(lap_ms - e->prev_ms);
+    rt_uint32_t z = ((rt_uint32_t)d << 1) ^ (rt_uint32_t)(d >> 31);
+    do
+    {
+        tmp[n] = (rt_uint8_t)(z & 0x7F);
+        z >>= 7;
+        if (z) tmp[n] |= 0x80;
+        n++;
+    } while (z);
+
+    if (e->len + n > SESSION_ARCHIVE_BLOB_MAX || e->lap_count == 0xFFFF)
+    {
+        e->flags |= ARCHIVE_FLAG_TRUNCATED;
+        return;
+    }
+    rt_memcpy(&e->buf[e->len], tmp, n);
+    e->len += n;
+    e->lap_count++;
+    e->prev_ms = lap_ms;
+}
+
+int archive_decode(const rt_uint8_t *blob, rt_size_t len, rt_uint32_t *laps, rt_uint16_t count)
+{
+    rt_uint32_t prev = 0;
+    rt_size_t pos = 0;
+
+    for (rt_uint16_t i = 0; i < count; i++)
+    {
+        rt_uint32_t z = 0;
+        rt_uint8_t shift = 0, b;
+        do
+        {
+            if (pos >= len || shift > 28) return -1;
+            b = blob[pos++];
+            z |= (rt_uint32_t)(b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+        prev += (rt_uint32_t)((rt_int32_t)(z >> 1) ^ -(rt_int32_t)(z & 1));
+        laps[i] = prev;
+    }
+    return count;
+}
+
+/* ================== 页与记录 ================== */
+static void put_u32(rt_uint8_t *p, rt_uint32_t v)
+{
+    p[0] = (rt_uint8_t)v; p[1] = (rt_uint8_t)(v >> 8); p[2] = (rt_uint8_t)(v >> 16); p[3] = (rt_uint8_t)(v >> 24);
+}
+
+static rt_uint32_t get_u32(const rt_uint8_t *p)
+{
+    return (rt_uint32_t)p[0] | ((rt_uint32_t)p[1] << 8) | ((rt_uint32_t)p[2] << 16) | ((rt_uint32_t)p[3] << 24);
+}
+
+static rt_uint32_t page_addr(const archive_t *a, rt_uint8_t page)
+{
+    return a->base + (rt_uint32_t)page * a->page_size;
+}
+
+static rt_bool_t page_blank(archive_t *a, rt_uint8_t page)
+{
+    rt_uint8_t buf[32];
+    for (rt_uint16_t off = 0; off < a->page_size; off += sizeof(buf))
+    {
+        if (a->ops->read(page_addr(a, page) + off, buf, sizeof(buf)) < 0) return RT_FALSE;
+        for (rt_size_t i = 0; i < sizeof(buf); i++)
+        {
+            if (buf[i] != 0xFF) return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+static rt_err_t page_erase(archive_t *a, rt_uint8_t page)
+{
+    int r = a->ops->erase(page_addr(a, page), a->page_size);
+    if (r == -RT_EBUSY) return -RT_EBUSY;
+    a->stats.erases++;
+    return (r < 0) ? -RT_EIO : RT_EOK;
+}
+
+/* 底层写可能只是投递（flash_writer），提交点等待落盘 */
+static rt_err_t store_sync(archive_t *a)
+{
+    if (!a->ops->sync) return RT_EOK;
+    return (a->ops->sync(a->base, (rt_uint32_t)a->pages * a->page_size) < 0) ? -RT_EIO : RT_EOK;
+}
+
+static rt_bool_t page_header(archive_t *a, rt_uint8_t page, rt_uint32_t *seq)
+{
+    rt_uint8_t h[ARCHIVE_PAGE_HDR_SIZE];
+    if (a->ops->read(page_addr(a, page), h, sizeof(h)) < 0) return RT_FALSE;
+    if (get_u32(h) != ARCHIVE_PAGE_MAGIC || (get_u32(h + 4) ^ get_u32(h + 8)) != 0xFFFFFFFFUL) return RT_FALSE;
+    *seq = get_u32(h + 4);
+    return RT_TRUE;
+}
+
+static rt_err_t page_commit(archive_t *a, rt_uint8_t page, rt_uint32_t seq)
+{
+    rt_uint8_t h[8];
+    put_u32(h, seq);
+    put_u32(h + 4, ~seq);
+    if (a->ops->write(page_addr(a, page) + 4, h, 8) < 0) return -RT_EIO;
+    put_u32(h, ARCHIVE_PAGE_MAGIC);
+    if (a->ops->write(page_addr(a, page), h, 4) < 0) return -RT_EIO;
+    return RT_EOK;
+}
+
+/* 读取并校验归档区偏移 off 处的记录；rec 至少 ARCHIVE_REC_MAX 字节，返回记录长度，0 为空白，<0 为残缺 */
+static int read_record(archive_t *a, rt_uint16_t off, rt_uint8_t *rec)
+{
+    archive_hdr_t h;
+    rt_uint16_t in_page = off % a->page_size;
+
+    if (in_page + sizeof(h) > a->page_size) return 0;
+    if (a->ops->read(a->base + off, rec, sizeof(h)) < 0) return -1;
+    rt_memcpy(&h, rec, sizeof(h));
+    if (h.len == 0xFFFF) return 0;
+    if (h.blob_len > SESSION_ARCHIVE_BLOB_MAX || h.len != ARCHIVE_REC_SIZE(h.blob_len) || in_page + h.len > a->page_size)
+        return -1;
+    if (a->ops->read(a->base + off + sizeof(h), rec + sizeof(h), h.len - sizeof(h)) < 0) return -1;
+    if (crc32_calc(rec, sizeof(h) + h.blob_len) != get_u32(rec + h.len - 4)) return -1;
+    return h.len;
+}
+
+static void index_add(archive_t *a, rt_uint16_t id, rt_uint16_t off, rt_uint32_t best_ms)
+{
+    if (a->count >= SESSION_ARCHIVE_INDEX_MAX)
+    {
+        memmove(&a->index[0], &a->index[1], sizeof(a->index[0]) * (SESSION_ARCHIVE_INDEX_MAX - 1));
+        a->count--;
+        a->stats.unindexed++;
+    }
+    a->index[a->count].id = id;
+    a->index[a->count].off = off;
+    a->index[a->count].best_ms = best_ms;
+    a->count++;
+}
+
+static void index_drop_page(archive_t *a, rt_uint8_t page)
+{
+    rt_uint16_t n = 0;
+    for (rt_uint16_t i = 0; i < a->count; i++)
+    {
+        if (a->index[i].off / a->page_size == page)
+        {
+            a->stats.evicted++;
+            continue;
+        }
+        a->index[n++] = a->index[i];
+    }
+    a->count = n;
+}
+
+/* 扫描一页的记录建立索引，返回下一条记录的页内偏移（遇残缺记录返回页大小） */
+static rt_uint16_t scan_page(archive_t *a, rt_uint8_t page, rt_uint8_t *rec)
+{
+    rt_uint16_t off = ARCHIVE_PAGE_HDR_SIZE;
+    for (;;)
+    {
+        rt_uint16_t pos = (rt_uint16_t)(page * a->page_size + off);
+        int size = read_record(a, pos, rec);
+        if (size == 0) return off;
+        if (size < 0)
+        {
+            a->stats.recovered++;
+            return a->page_size;
+        }
+        archive_hdr_t h;
+        rt_memcpy(&h, rec, sizeof(h));
+        index_add(a, h.id, pos, h.min_ms);
+        if ((rt_int16_t)(h.id - a->next_id) >= 0) a->next_id = (rt_uint16_t)(h.id + 1);
+        off += (rt_uint16_t)size;
+    }
+}
+
+rt_err_t archive_mount(archive_t *a, const kv_flash_ops_t *ops, rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages)
+{
+    rt_uint8_t rec[ARCHIVE_REC_MAX];
+    rt_uint8_t valid[ARCHIVE_MAX_PAGES];
+    rt_uint32_t seq = 0;
+    int newest = -1;
+
+    if (!a || !ops || pages < 2 || pages > ARCHIVE_MAX_PAGES || page_size < ARCHIVE_PAGE_HDR_SIZE + ARCHIVE_REC_MAX ||
+        (rt_uint32_t)page_size * pages > 0x10000UL)
+        return -RT_EINVAL;
+    rt_memset(a, 0, sizeof(*a));
+    a->ops = ops;
+    a->base = base;
+    a->page_size = page_size;
+    a->pages = pages;
+    a->next_id = 1;
+
+    for (rt_uint8_t p = 0; p < pages; p++)
+    {
+        valid[p] = page_header(a, p, &seq) ? 1 : 0;
+        if (valid[p])
+        {
+            if (newest < 0 || (rt_int32_t)(seq - a->seq) > 0)
+            {
+                newest = p;
+                a->seq = seq;
+            }
+        }
+        else if (!page_blank(a, p))
+        {
+            /* 换页擦除/提交中断留下的页 */
+            a->stats.recovered++;
+            page_erase(a, p);
+        }
+    }
+    if (newest < 0)
+    {
+        LOG_I("no valid page, format");
+        if (page_commit(a, 0, 1) != RT_EOK || store_sync(a) != RT_EOK) return -RT_EIO;
+        a->active = 0;
+        a->seq = 1;
+        a->wr = ARCHIVE_PAGE_HDR_SIZE;
+        return RT_EOK;
+    }
+
+    /* 从最旧的页开始，索引按写入顺序排列 */
+    a->active = (rt_uint8_t)newest;
+    for (rt_uint8_t k = 1; k <= pages; k++)
+    {
+        rt_uint8_t p = (rt_uint8_t)((newest + k) % pages);
+        if (!valid[p]) continue;
+        rt_uint16_t end = scan_page(a, p, rec);
+        if (p == a->active) a->wr = end;
+    }
+    return RT_EOK;
+}
+
+static rt_err_t rotate(archive_t *a)
+{
+    rt_uint8_t target = (rt_uint8_t)((a->active + 1) % a->pages);
+
+    /* 目标页是最旧的页：擦除后才从索引中去掉。秒表运行中被拒绝（-RT_EBUSY）时页未动，
+     * 其上的会话仍可查询与导出；擦除出错则页内容已不可信，照样丢弃 */
+    if (!page_blank(a, target))
+    {
+        rt_err_t r = page_erase(a, target);
+        if (r == -RT_EBUSY) return r;
+        if (r != RT_EOK)
+        {
+            index_drop_page(a, target);
+            return r;
+        }
+    }
+    index_drop_page(a, target);
+    if (page_commit(a, target, a->seq + 1) != RT_EOK || store_sync(a) != RT_EOK) return -RT_EIO;
+    a->active = target;
+    a->seq++;
+    a->wr = ARCHIVE_PAGE_HDR_SIZE;
+    return RT_EOK;
+}
+
+int archive_append(archive_t *a, rt_uint32_t start_rtc, rt_uint32_t total_ms, const archive_enc_t *e)
+{
+    rt_uint8_t rec[ARCHIVE_REC_MAX];
+    archive_hdr_t h;
+    rt_uint16_t size = (rt_uint16_t)ARCHIVE_REC_SIZE(e->len);
+
+    if (a->wr + size > a->page_size)
+    {
+        rt_err_t r = rotate(a);
+        if (r != RT_EOK) return r;
+    }
+
+    rt_memset(&h, 0, sizeof(h));
+    h.len = size;
+    h.id = a->next_id;
+    h.start_rtc = start_rtc;
+    h.total_ms = total_ms;
+    rt_uint32_t lap_total = e->first_lap - 1 + e->lap_total;
+    h.lap_total = (lap_total > 0xFFFF) ? 0xFFFF : (rt_uint16_t)lap_total;
+    h.first_lap = (e->first_lap > 0xFFFF) ? 0xFFFF : (rt_uint16_t)e->first_lap;
+    h.lap_count = e->lap_count;
+    h.blob_len = e->len;
+    h.flags = e->flags;
+    h.min_ms = e->min_ms;
+    h.max_ms = e->max_ms;
+    h.avg_ms = e->lap_total ? (e->sum_ms / e->lap_total) : 0;
+
+    rt_memset(rec, 0xFF, size);
+    rt_memcpy(rec, &h, sizeof(h));
+    rt_memcpy(rec + sizeof(h), e->buf, e->len);
+    put_u32(rec + size - 4, crc32_calc(rec, sizeof(h) + e->len));
+
+    rt_uint16_t pos = (rt_uint16_t)(a->active * a->page_size + a->wr);
+    if (a->ops->write(a->base + pos, rec, size) < 0 || store_sync(a) != RT_EOK)
+    {
+        /* 该处可能已部分编程，不再向本页追加 */
+        a->wr = a->page_size;
+        return -RT_EIO;
+    }
+    index_add(a, h.id, pos, h.min_ms);
+    a->wr += size;
+    a->next_id++;
+    a->stats.appends++;
+    a->stats.raw_bytes += (rt_uint32_t)e->lap_count * 4;
+    a->stats.blob_bytes += e->len;
+    return h.id;
+}
+
+int archive_find(const archive_t *a, rt_uint16_t id)
+{
+    int lo = 0, hi = (int)a->count - 1;
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        rt_int16_t d = (rt_int16_t)(a->index[mid].id - id);
+        if (d == 0) return mid;
+        if (d < 0) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+int archive_best(const archive_t *a)
+{
+    int best = -1;
+    for (rt_uint16_t i = 0; i < a->count; i++)
+    {
+        if (a->index[i].best_ms == ARCHIVE_NO_LAP) continue;
+        if (best < 0 || a->index[i].best_ms < a->index[best].best_ms) best = i;
+    }
+    return best;
+}
+
+rt_err_t archive_read(archive_t *a, int pos, archive_hdr_t *hdr, rt_uint8_t *blob)
+{
+    rt_uint8_t rec[ARCHIVE_REC_MAX];
+    if (pos < 0 || pos >= a->count) return -RT_EINVAL;
+    if (read_record(a, a->index[pos].off, rec) <= 0) return -RT_EIO;
+    rt_memcpy(hdr, rec, sizeof(*hdr));
+    if (blob) rt_memcpy(blob, rec + sizeof(*hdr), hdr->blob_len);
+    return RT_EOK;
+}
+
+/* ================== 实机：事件跟踪与后台写入 ================== */
+static archive_t s_arc;
+static struct rt_mutex s_lock;
+static struct rt_semaphore s_sem;
+static rt_uint8_t s_inited = 0;
+
+/* 当前会话，只在秒表服务线程的同步回调中修改 */
+static archive_enc_t s_enc;
+static rt_uint8_t s_started = 0;
+static rt_uint8_t s_running = 0;
+static rt_uint64_t s_seg_us = 0;
+static rt_uint32_t s_total_ms = 0;
+static rt_uint32_t s_start_rtc = 0;
+
+/* 已结束、待写入的会话 */
+static archive_enc_t s_pending;
+static rt_uint32_t s_pending_total = 0;
+static rt_uint32_t s_pending_rtc = 0;
+static volatile rt_uint8_t s_pending_busy = 0;
+static rt_uint32_t s_lost = 0;
+
+static rt_uint32_t rtc_seconds(void)
+{
+    rt_uint32_t s = 0;
+    rtc_backup_now(&s, RT_NULL);
+    return s;
+}
+
+/* 与秒表相同的计时口径：每个运行段按 (结束-起点)/1000 累加 */
+static rt_uint32_t seg_ms(rt_uint64_t t_us)
+{
+    return (t_us > s_seg_us) ? (rt_uint32_t)((t_us - s_seg_us) / 1000ULL) : 0;
+}
+
+static void session_begin(void)
+{
+    archive_enc_reset(&s_enc);
+    s_started = 0;
+    s_total_ms = 0;
+    s_start_rtc = 0;
+}
+
+static void session_seal(void)
+{
+    if (s_pending_busy)
+    {
+        s_lost++;
+        return;
+    }
+    rt_memcpy(&s_pending, &s_enc, sizeof(s_pending));
+    s_pending_total = s_total_ms;
+    s_pending_rtc = s_start_rtc;
+    s_pending_busy = 1;
+    rt_sem_release(&s_sem);
+}
+
+/* 开机恢复的会话：只知道快照中的最近若干圈，圈序号从圈速环中最早的一圈接着编 */
+static void session_resume(void)
+{
+    stopwatch_snapshot_t snap;
+    stopwatch_get_snapshot(&snap);
+    session_begin();
+    s_enc.first_lap = snap.lap_total - snap.lap_count + 1;
+    for (rt_uint16_t i = 0; i < snap.lap_count; i++) archive_enc_lap(&s_enc, snap.lap_durations_ms[i]);
+    if (s_enc.first_lap > 1) s_enc.flags |= ARCHIVE_FLAG_PARTIAL;
+    s_started = (snap.state != STOPWATCH_STATE_IDLE || snap.lap_total) ? 1 : 0;
+    s_running = (snap.state == STOPWATCH_STATE_RUNNING) ? 1 : 0;
+    s_seg_us = snap.state_start_us;
+    s_total_ms = snap.accumulated_ms;
+}
+
+static void archive_on_event(const event_t *e, void *user)
+{
+    (void)user;
+    if (e->topic == EVT_LAP_RECORDED)
+    {
+        archive_enc_lap(&s_enc, e->value);
+        return;
+    }
+    switch (e->code)
+    {
+    case EVT_CAUSE_START:
+        if (!s_started)
+        {
+            s_started = 1;
+            s_start_rtc = rtc_seconds();
+        }
+        s_running = 1;
+        s_seg_us = e->t_us;
+        break;
+    case EVT_CAUSE_STOP:
+        if (s_running) s_total_ms += seg_ms(e->t_us);
+        s_running = 0;
+        break;
+    case EVT_CAUSE_RESET:
+        if (s_running) s_total_ms += seg_ms(e->t_us);
+        if (s_started) session_seal();
+        session_begin();
+        if (s_running)
+        {
+            /* 运行中复位：新会话从复位时刻继续计时 */
+            s_started = 1;
+            s_start_rtc = rtc_seconds();
+            s_seg_us = e->t_us;
+        }
+        break;
+    case EVT_CAUSE_RESTORE:
+        session_resume();
+        break;
+    default:
+        break;
+    }
+}
+
+static void archive_thread_entry(void *parameter)
+{
+    (void)parameter;
+    while (1)
+    {
+        rt_sem_take(&s_sem, RT_WAITING_FOREVER);
+        if (!s_pending_busy) continue;
+        int id;
+        for (;;)
+        {
+            rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+            id = archive_append(&s_arc, s_pending_rtc, s_pending_total, &s_pending);
+            rt_mutex_release(&s_lock);
+            if (id != -RT_EBUSY) break;
+            /* 换页的擦除被拒绝（秒表运行中）：停表后再写，其间结束的会话计入 lost */
+            rt_thread_mdelay(SESSION_ARCHIVE_RETRY_MS);
+        }
+        s_pending_busy = 0;
+        if (id < 0) LOG_W("append failed (%d)", id);
+        else LOG_I("session #%d archived: %u laps, %u bytes", id, (unsigned)s_pending.lap_count, (unsigned)s_pending.len);
+    }
+}
+
+rt_err_t session_archive_init(void)
+{
+    if (s_inited) return RT_EOK;
+    const kv_flash_ops_t *ops = kv_store_onchip_ops();
+    if (!ops)
+    {
+        LOG_W("BSP_USING_ON_CHIP_FLASH not defined, session archive disabled");
+        return -RT_ENOSYS;
+    }
+    /* 程序映像（代码 + .data 初值）伸入归档区说明链接脚本 ROM 未扣除归档区，挂载会擦掉代码 */
+    extern const char _sidata[], _sdata[], _edata[];
+    rt_ubase_t image_end = (rt_ubase_t)_sidata + (rt_ubase_t)(_edata - _sdata);
+    if (image_end > SESSION_ARCHIVE_BASE)
+    {
+        LOG_E("image ends at 0x%08x, above archive base 0x%08x, session archive disabled",
+              (unsigned)image_end, (unsigned)SESSION_ARCHIVE_BASE);
+        return -RT_EFULL;
+    }
+    rt_err_t r = archive_mount(&s_arc, ops, SESSION_ARCHIVE_BASE, SESSION_ARCHIVE_PAGE_SIZE, SESSION_ARCHIVE_PAGES);
+    if (r != RT_EOK)
+    {
+        LOG_E("mount failed (%d)", (int)r);
+        return r;
+    }
+    rt_mutex_init(&s_lock, "arc", RT_IPC_FLAG_PRIO);
+    rt_sem_init(&s_sem, "arc", 0, RT_IPC_FLAG_FIFO);
+    session_begin();
+
+    rt_thread_t tid = rt_thread_create("swarc", archive_thread_entry, RT_NULL, 1024, SESSION_ARCHIVE_PRIORITY, 10);
+    if (!tid)
+    {
+        rt_sem_detach(&s_sem);
+        rt_mutex_detach(&s_lock);
+        return -RT_ENOMEM;
+    }
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED), archive_on_event, RT_NULL,
+                        EVENT_DELIVER_SYNC);
+    s_inited = 1;
+    rt_thread_startup(tid);
+    LOG_I("%u sessions, next #%u", (unsigned)s_arc.count, (unsigned)s_arc.next_id);
+    return RT_EOK;
+}
+
+rt_err_t session_archive_read_image(rt_uint32_t off, void *buf, rt_size_t len)
+{
+    rt_err_t r;
+
+    if (!s_inited) return -RT_ENOSYS;
+    if (off + len > (rt_uint32_t)s_arc.page_size * s_arc.pages) return -RT_EINVAL;
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    r = (s_arc.ops->read(s_arc.base + off, (rt_uint8_t *)buf, len) < 0) ? -RT_EIO : RT_EOK;
+    rt_mutex_release(&s_lock);
+    return r;
+}
+
+/* ================== 命令 ================== */
+static void print_ms(rt_uint32_t ms)
+{
+    if (ms == ARCHIVE_NO_LAP) rt_kprintf("        -");
+    else rt_kprintf(" %5u.%03u", (unsigned)(ms / 1000), (unsigned)(ms % 1000));
+}
+
+static void print_summary(const archive_hdr_t *h)
+{
+    rt_kprintf("#%-5u %10u", (unsigned)h->id, (unsigned)h->start_rtc);
+    print_ms(h->total_ms);
+    rt_kprintf(" %5u", (unsigned)h->lap_total);
+    print_ms(h->min_ms);
+    print_ms((h->min_ms != ARCHIVE_NO_LAP) ? h->avg_ms : ARCHIVE_NO_LAP);
+    rt_kprintf(" %4u%s\n", (unsigned)h->len, (h->flags & (ARCHIVE_FLAG_TRUNCATED | ARCHIVE_FLAG_PARTIAL)) ? " *" : "");
+}
+
+static void print_laps(const archive_hdr_t *h, const rt_uint8_t *blob, rt_uint16_t best_only)
+{
+    rt_uint32_t laps[SESSION_ARCHIVE_BLOB_MAX];     /* 每圈至少 1 字节 */
+    int n = archive_decode(blob, h->blob_len, laps, (h->lap_count < SESSION_ARCHIVE_BLOB_MAX) ? h->lap_count : SESSION_ARCHIVE_BLOB_MAX);
+    rt_uint16_t first = h->first_lap;
+
+    if (n < 0)
+    {
+        rt_kprintf("lap data corrupted\n");
+        return;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        if (best_only && laps[i] != h->min_ms) continue;
+        rt_kprintf("  lap %3u", (unsigned)(first + i));
+        print_ms(laps[i]);
+        rt_kprintf("\n");
+        if (best_only) break;
+    }
+    if (!best_only && n < h->lap_total)
+        rt_kprintf("  (%u of %u laps stored)\n", (unsigned)n, (unsigned)h->lap_total);
+}
+
+static int cmd_sw_hist(int argc, char **argv)
+{
+    rt_uint8_t blob[SESSION_ARCHIVE_BLOB_MAX];
+    archive_hdr_t h;
+    rt_err_t r = RT_EOK;
+    const char *sub = (argc >= 2) ? argv[1] : "list";
+
+    if (!s_inited)
+    {
+        rt_kprintf("sw_hist: archive unavailable\n");
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    if (!strcmp(sub, "list"))
+    {
+        rt_kprintf("id     start_rtc     total  laps      best       avg  len\n");
+        for (rt_uint16_t i = 0; i < s_arc.count; i++)
+        {
+            if (archive_read(&s_arc, i, &h, RT_NULL) == RT_EOK) print_summary(&h);
+        }
+    }
+    else if ((!strcmp(sub, "show") && argc >= 3) || !strcmp(sub, "best"))
+    {
+        int best = !strcmp(sub, "best");
+        int pos = best ? archive_best(&s_arc) : archive_find(&s_arc, (rt_uint16_t)atoi(argv[2]));
+        r = (pos < 0) ? -RT_EEMPTY : archive_read(&s_arc, pos, &h, blob);
+        if (r == RT_EOK)
+        {
+            print_summary(&h);
+            print_laps(&h, blob, (rt_uint16_t)best);
+        }
+    }
+    else if (!strcmp(sub, "stat"))
+    {
+        const archive_stats_t *st = &s_arc.stats;
+        rt_kprintf("sessions=%u next=#%u page=%u free=%u appends=%u erases=%u evicted=%u unindexed=%u recovered=%u lost=%u\n",
+                   (unsigned)s_arc.count, (unsigned)s_arc.next_id, (unsigned)s_arc.active,
+                   (unsigned)(s_arc.page_size - s_arc.wr), (unsigned)st->appends, (unsigned)st->erases,
+                   (unsigned)st->evicted, (unsigned)st->unindexed, (unsigned)st->recovered, (unsigned)s_lost);
+        if (st->blob_bytes)
+            rt_kprintf("laps: %u bytes raw -> %u bytes encoded (x%u.%02u)\n", (unsigned)st->raw_bytes,
+                       (unsigned)st->blob_bytes, (unsigned)(st->raw_bytes / st->blob_bytes),
+                       (unsigned)(st->raw_bytes * 100U / st->blob_bytes % 100U));
+    }
+    else if (!strcmp(sub, "dump"))
+    {
+        /* 供 testtools/session_archive.py 离线解析 */
+        rt_uint8_t line[32];
+        for (rt_uint32_t off = 0; off < (rt_uint32_t)s_arc.page_size * s_arc.pages; off += sizeof(line))
+        {
+            if (s_arc.ops->read(s_arc.base + off, line, sizeof(line)) < 0) break;
+            rt_kprintf("%04x:", (unsigned)off);
+            for (rt_size_t i = 0; i < sizeof(line); i++) rt_kprintf("%02x", line[i]);
+            rt_kprintf("\n");
+        }
+    }
+    else
+    {
+        r = -RT_EINVAL;
+    }
+    rt_mutex_release(&s_lock);
+
+    if (r == -RT_EINVAL) rt_kprintf("usage: sw_hist [list]|show <id>|best|stat|dump\n");
+    else if (r != RT_EOK) rt_kprintf("sw_hist: %s failed (%d)\n", sub, (int)r);
+    return (r == RT_EOK) ? 0 : -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_hist, sw_hist, Session_history_archive);
+
+/* ================== 模拟器：压缩率与查询耗时 ==================
+ * 用法：sw_hist_sim [sessions] [laps] [seed]
+ * 在模拟 Flash 上归档若干会话（圈时围绕一个基准随机抖动），重新挂载后逐个解码核对，
+ * 报告每圈字节数、挂载（建索引）耗时与按会话号查询+解码的平均耗时。 */
+#define SIM_BASE        0x10000000UL
+
+static rt_uint8_t s_sim_busy = 0;
+
+/* 置位 s_sim_busy 时像秒表运行中的 flash_writer 一样拒绝擦除 */
+static int sim_erase(rt_uint32_t addr, rt_size_t size)
+{
+    if (s_sim_busy) return -RT_EBUSY;
+    return flash_sim_erase(addr, size);
+}
+
+static const kv_flash_ops_t s_sim_ops = { flash_sim_read, flash_sim_write, sim_erase, RT_NULL, RT_NULL };
+static rt_uint32_t s_rng = 1;
+
+static rt_uint32_t sim_rand(void)
+{
+    s_rng = s_rng * 1103515245UL + 12345UL;
+    return s_rng >> 8;
+}
+
+/* 会话 id 的圈时序列由 (seed, id) 决定，核对时重新生成 */
+static rt_uint32_t sim_lap(rt_uint32_t *state, rt_uint32_t base_ms)
+{
+    *state = *state * 1103515245UL + 12345UL;
+    return base_ms - 1500 + ((*state >> 8) % 3000);
+}
+
+static int sim_bench(rt_uint32_t sessions, rt_uint32_t laps, rt_uint32_t seed)
+{
+    typedef struct
+    {
+        archive_t     arc;
+        archive_enc_t enc;
+        archive_hdr_t h;
+        rt_uint8_t    blob[SESSION_ARCHIVE_BLOB_MAX];
+        rt_uint32_t   out[SESSION_ARCHIVE_BLOB_MAX];
+    } sim_ctx_t;
+    rt_uint32_t mismatches = 0, checked = 0, refused = 0;
+    sim_ctx_t *x = (sim_ctx_t *)rt_malloc(sizeof(sim_ctx_t));
+
+    if (!x || flash_sim_create(SIM_BASE, SESSION_ARCHIVE_PAGE_SIZE, SESSION_ARCHIVE_PAGES) != RT_EOK ||
+        archive_mount(&x->arc, &s_sim_ops, SIM_BASE, SESSION_ARCHIVE_PAGE_SIZE, SESSION_ARCHIVE_PAGES) != RT_EOK)
+    {
+        rt_kprintf("sw_hist_sim: no memory\n");
+        if (x) rt_free(x);
+        flash_sim_destroy();
+        return -RT_ENOMEM;
+    }
+
+    for (rt_uint32_t s = 0; s < sessions; s++)
+    {
+        rt_uint32_t st = seed ^ (x->arc.next_id * 2654435761UL);
+        rt_uint32_t base_ms = 20000 + (st % 60000), total = 0;
+        archive_enc_reset(&x->enc);
+        /* 每 5 个会话模拟一次开机恢复：圈数据从第 id+1 圈开始 */
+        if (x->arc.next_id % 5 == 0)
+        {
+            x->enc.first_lap = 1U + x->arc.next_id;
+            x->enc.flags |= ARCHIVE_FLAG_PARTIAL;
+        }
+        for (rt_uint32_t i = 0; i < laps; i++)
+        {
+            rt_uint32_t ms = sim_lap(&st, base_ms);
+            archive_enc_lap(&x->enc, ms);
+            total += ms;
+        }
+        /* 约 1/3 的会话在“运行中”复位：换页被拒绝时索引与各会话须原样可读，停表后重试成功 */
+        s_sim_busy = (sim_rand() % 3 == 0);
+        rt_uint16_t kept = x->arc.count;
+        int id = archive_append(&x->arc, s * 600, total, &x->enc);
+        if (id == -RT_EBUSY)
+        {
+            refused++;
+            if (x->arc.count != kept) mismatches++;
+            for (rt_uint16_t i = 0; i < x->arc.count; i++)
+            {
+                if (archive_read(&x->arc, i, &x->h, RT_NULL) != RT_EOK || x->h.id != x->arc.index[i].id)
+                {
+                    mismatches++;
+                    break;
+                }
+            }
+            s_sim_busy = 0;
+            id = archive_append(&x->arc, s * 600, total, &x->enc);
+        }
+        s_sim_busy = 0;
+        if (id < 0) mismatches++;
+    }
+    archive_stats_t written = x->arc.stats;
+
+    rt_uint64_t t0 = timebase_get_us();
+    archive_mount(&x->arc, &s_sim_ops, SIM_BASE, SESSION_ARCHIVE_PAGE_SIZE, SESSION_ARCHIVE_PAGES);
+    rt_uint64_t t_mount = timebase_get_us() - t0;
+
+    t0 = timebase_get_us();
+    for (rt_uint16_t i = 0; i < x->arc.count; i++)
+    {
+        rt_uint16_t id = x->arc.index[i].id;
+        int pos = archive_find(&x->arc, id);
+        if (pos < 0 || archive_read(&x->arc, pos, &x->h, x->blob) != RT_EOK ||
+            archive_decode(x->blob, x->h.blob_len, x->out, x->h.lap_count) != x->h.lap_count)
+        {
+            mismatches++;
+            continue;
+        }
+        rt_uint32_t first = (id % 5 == 0) ? 1U + id : 1U;
+        if (x->h.first_lap != first || x->h.lap_total != first - 1 + laps)
+        {
+            mismatches++;
+            continue;
+        }
+        rt_uint32_t st = seed ^ (id * 2654435761UL);
+        rt_uint32_t base_ms = 20000 + (st % 60000);
+        for (rt_uint16_t k = 0; k < x->h.lap_count; k++)
+        {
+            if (x->out[k] != sim_lap(&st, base_ms)) { mismatches++; break; }
+        }
+        checked++;
+    }
+    rt_uint64_t t_query = timebase_get_us() - t0;
+
+    rt_kprintf("sessions=%u laps=%u kept=%u evicted=%u truncated_laps=%u erase_refused=%u\n", (unsigned)sessions,
+               (unsigned)laps, (unsigned)x->arc.count, (unsigned)written.evicted,
+               (unsigned)(laps > x->enc.lap_count ? laps - x->enc.lap_count : 0), (unsigned)refused);
+    if (written.blob_bytes)
+        rt_kprintf("lap data: %u bytes raw -> %u bytes (%u.%02u bytes/lap), record overhead %u bytes\n",
+                   (unsigned)written.raw_bytes, (unsigned)written.blob_bytes,
+                   (unsigned)(written.blob_bytes * 4U / written.raw_bytes),
+                   (unsigned)(written.blob_bytes * 400U / written.raw_bytes % 100U),
+                   (unsigned)(sizeof(archive_hdr_t) + 4));
+    rt_kprintf("mount+index %u us, query+decode %u us/session, checked=%u mismatches=%u -> %s\n",
+               (unsigned)t_mount, (unsigned)(checked ? t_query / checked : 0), (unsigned)checked,
+               (unsigned)mismatches, mismatches ? "FAIL" : "PASS");
+    rt_free(x);
+    flash_sim_destroy();
+    return mismatches ? -RT_ERROR : 0;
+}
+
+static int cmd_sw_hist_sim(int argc, char **argv)
+{
+    rt_uint32_t sessions = (argc >= 2) ? (rt_uint32_t)atoi(argv[1]) : 40;
+    rt_uint32_t laps = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 20;
+    s_rng = (argc >= 4) ? (rt_uint32_t)atoi(argv[3]) : 1;
+    return sim_bench(sessions, laps, sim_rand());
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_hist_sim, sw_hist_sim, Session_archive_simulator);
+
+#else /* !SESSION_ARCHIVE_ENABLE */
+
+rt_err_t session_archive_init(void)
+{
+    LOG_I("SESSION_ARCHIVE_ENABLE is 0, session archive not built");
+    return -RT_ENOSYS;
+}
+
+rt_err_t session_archive_read_image(rt_uint32_t off, void *buf, rt_size_t len)
+{
+    (void)off;
+    (void)buf;
+    (void)len;
+    return -RT_ENOSYS;
+}
+
+#endif /* SESSION_ARCHIVE_ENABLE */
@@ -0,0 +1,146 @@
+#ifndef APPLICATIONS_SESSION_ARCHIVE_H_
+#define APPLICATIONS_SESSION_ARCHIVE_H_
+
+#include <rtthread.h>
+#include "kv_store.h"
+#include "session_journal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 历史会话归档：每个结束的会话（复位时）追加一条记录——固定头（开始 RTC、总用时、圈数、最快/最慢/平均）
+ * + 圈时序列（相邻圈差值 zigzag 后按 7 位变长编码，常见 1~2 字节/圈）+ CRC32。
+ * 若干页环形使用，写满后擦除最旧一页；挂载时建立 RAM 索引（会话号、记录位置、最快圈），查询只读所需记录。 */
+
+/* 归档开关：为 0 时不编译归档（sw_hist 不可用，sw_export archive 报告无数据），归档区不再占用，
+ * 链接脚本 ROM 可由 56K 改回 60K */
+#ifndef SESSION_ARCHIVE_ENABLE
+#define SESSION_ARCHIVE_ENABLE          1
+#endif
+#ifndef SESSION_ARCHIVE_PAGES
+#define SESSION_ARCHIVE_PAGES           4
+#endif
+#ifndef SESSION_ARCHIVE_PAGE_SIZE
+#define SESSION_ARCHIVE_PAGE_SIZE       1024
+#endif
+/* 紧挨检查点日志之下（链接脚本已从 ROM 中扣除） */
+#ifndef SESSION_ARCHIVE_BASE
+#define SESSION_ARCHIVE_BASE            (SESSION_JOURNAL_BASE - SESSION_ARCHIVE_PAGES * SESSION_ARCHIVE_PAGE_SIZE)
+#endif
+/* 单个会话压缩圈数据上限（字节），超出的圈只计入统计不保存 */
+#ifndef SESSION_ARCHIVE_BLOB_MAX
+#define SESSION_ARCHIVE_BLOB_MAX        128
+#endif
+/* RAM 索引条数，超出时最旧会话不再可查 */
+#ifndef SESSION_ARCHIVE_INDEX_MAX
+#define SESSION_ARCHIVE_INDEX_MAX       48
+#endif
+#ifndef SESSION_ARCHIVE_PRIORITY
+#define SESSION_ARCHIVE_PRIORITY        19
+#endif
+/* 运行中复位需要换页时，秒表运行期间不擦除，按此间隔（ms）重试直到停表 */
+#ifndef SESSION_ARCHIVE_RETRY_MS
+#define SESSION_ARCHIVE_RETRY_MS        1000
+#endif
+
+#define ARCHIVE_PAGE_MAGIC              0x32524153UL    /* "SAR2"：记录头含 first_lap */
+#define ARCHIVE_PAGE_HDR_SIZE           12              /* magic seq ~seq */
+#define ARCHIVE_REC_SIZE(blob)          (sizeof(archive_hdr_t) + (((blob) + 3U) & ~3U) + 4U)
+#define ARCHIVE_FLAG_TRUNCATED          0x0001          /* 圈数据超出 BLOB_MAX，只保存了前 lap_count 圈 */
+#define ARCHIVE_FLAG_PARTIAL            0x0002          /* 开机恢复的会话，恢复前只知道最近的若干圈 */
+#define ARCHIVE_MAX_PAGES               8
+#define ARCHIVE_NO_LAP                  0xFFFFFFFFUL
+
+/* 记录头（Flash 上的格式，小端） */
+typedef struct
+{
+    rt_uint16_t len;                /* 记录总长：头 + 圈数据（补齐到 4） + CRC32 */
+    rt_uint16_t id;                 /* 会话号，递增 */
+    rt_uint32_t start_rtc;          /* 会话开始时的 RTC 秒计数，0 为未知 */
+    rt_uint32_t total_ms;
+    rt_uint16_t lap_total;          /* 会话的总圈数（含开机恢复前已移出圈速环的圈） */
+    rt_uint16_t lap_count;          /* 圈数据中保存的圈数 */
+    rt_uint16_t blob_len;
+    rt_uint16_t flags;
+    rt_uint32_t min_ms;             /* 无圈为 ARCHIVE_NO_LAP */
+    rt_uint32_t max_ms;
+    rt_uint32_t avg_ms;             /* 已知各圈的平均 */
+    rt_uint16_t first_lap;          /* 圈数据第一圈的序号，恢复的会话大于 1 */
+    rt_uint16_t rsv;
+} archive_hdr_t;
+
+/* 圈数据编码器（会话进行中逐圈追加） */
+typedef struct
+{
+    rt_uint8_t  buf[SESSION_ARCHIVE_BLOB_MAX];
+    rt_uint16_t len;
+    rt_uint16_t lap_count;
+    rt_uint32_t lap_total;          /* 已编码（计入统计）的圈数 */
+    rt_uint32_t first_lap;          /* 第一圈的序号，reset 后为 1 */
+    rt_uint32_t prev_ms;
+    rt_uint32_t min_ms;
+    rt_uint32_t max_ms;
+    rt_uint32_t sum_ms;
+    rt_uint16_t flags;              /* ARCHIVE_FLAG_* */
+} archive_enc_t;
+
+typedef struct
+{
+    rt_uint16_t id;
+    rt_uint16_t off;                /* 记录在归档区内的偏移 */
+    rt_uint32_t best_ms;
+} archive_index_t;
+
+typedef struct
+{
+    rt_uint32_t appends;
+    rt_uint32_t erases;
+    rt_uint32_t evicted;            /* 换页擦除掉的会话 */
+    rt_uint32_t recovered;          /* 挂载时发现的残缺记录/页 */
+    rt_uint32_t unindexed;          /* 索引已满而不可查的旧会话 */
+    rt_uint32_t raw_bytes;          /* 已归档圈按 4 字节/圈计的大小 */
+    rt_uint32_t blob_bytes;         /* 已归档圈的压缩后大小 */
+} archive_stats_t;
+
+/* 归档实例（纯逻辑，实机与模拟器共用） */
+typedef struct
+{
+    const kv_flash_ops_t *ops;
+    rt_uint32_t base;
+    rt_uint16_t page_size;
+    rt_uint8_t  pages;
+    rt_uint8_t  active;
+    rt_uint32_t seq;
+    rt_uint16_t wr;
+    rt_uint16_t next_id;
+    rt_uint16_t count;
+    archive_index_t index[SESSION_ARCHIVE_INDEX_MAX];     /* 按会话号（写入顺序）排列 */
+    archive_stats_t stats;
+} archive_t;
+
+void archive_enc_reset(archive_enc_t *e);
+void archive_enc_lap(archive_enc_t *e, rt_uint32_t lap_ms);
+/* 解码 count 圈到 laps，返回解出的圈数，数据残缺返回 <0 */
+int  archive_decode(const rt_uint8_t *blob, rt_size_t len, rt_uint32_t *laps, rt_uint16_t count);
+
+rt_err_t archive_mount(archive_t *a, const kv_flash_ops_t *ops, rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages);
+/* 追加一个会话，返回分配的会话号（>=0）或错误码 */
+int      archive_append(archive_t *a, rt_uint32_t start_rtc, rt_uint32_t total_ms, const archive_enc_t *e);
+/* 按会话号查索引位置，不存在返回 -1 */
+int      archive_find(const archive_t *a, rt_uint16_t id);
+/* 最快单圈所在的索引位置，无圈返回 -1 */
+int      archive_best(const archive_t *a);
+/* 读取索引位置 pos 的记录头与圈数据（blob 至少 SESSION_ARCHIVE_BLOB_MAX 字节，可为 RT_NULL 只读头） */
+rt_err_t archive_read(archive_t *a, int pos, archive_hdr_t *hdr, rt_uint8_t *blob);
+
+/* 实机接口：挂载归档并开始记录（会话在复位时归档）；SESSION_ARCHIVE_ENABLE 为 0 或程序映像伸入归档区时返回错误 */
+rt_err_t session_archive_init(void);
+/* 读取归档区原始映像（sw_export 导出用），与后台写入互斥；off + len 不超过 PAGES * PAGE_SIZE */
+rt_err_t session_archive_read_image(rt_uint32_t off, void *buf, rt_size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_SESSION_ARCHIVE_H_ */
@@ -0,0 +1,694 @@
+#include "session_journal.h"
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event_bus.h"
+#include "flash_sim.h"
+#include "hot_state.h"
+#include "lap_stats.h"
+#include "rtc_backup.h"
+#include "timebase.h"
+
+#define DBG_TAG "jnl"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 写入顺序保证任意时刻掉电都能恢复到一致状态：
+ *   1. 复位开启新会话时，先写一条不含圈的新会话检查点，之后的圈记录才会覆盖旧会话的圈槽；
+ *   2. 新圈先于检查点写入，掉电时检查点之后已完整写入的圈（会话号、序号连续）在恢复时补上；
+ *   3. 圈槽按序号轮转，被后续圈覆盖的旧圈在恢复时丢弃，与秒表圈速环的行为一致。
+ * 擦除只发生在 kv_store 换页（由后台线程触发），秒表服务与按键路径不接触 Flash。
+ * 运行中照常逐圈追加圈记录与周期检查点，只是换页不擦除：目标页未空白时（未被预擦）该次写入返回
+ * -RT_EBUSY，已写入的圈保留，其余推迟到下次同步或停表，其间由 hot_state 备份寄存器兜底。 */
+
+rt_err_t journal_open(journal_t *j, const kv_flash_ops_t *ops, rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages)
+{
+    if (!j) return -RT_EINVAL;
+    rt_memset(j, 0, sizeof(*j));
+    return kv_mount(&j->kv, ops, base, page_size, pages);
+}
+
+static rt_bool_t read_lap(journal_t *j, rt_uint16_t session, rt_uint32_t index, journal_lap_t *lap)
+{
+    if (index == 0) return RT_FALSE;
+    if (kv_get(&j->kv, JOURNAL_KEY_LAP(index), lap, sizeof(*lap)) != (int)sizeof(*lap)) return RT_FALSE;
+    return (lap->session == session && lap->index == index) ? RT_TRUE : RT_FALSE;
+}
+
+static void push_lap(stopwatch_snapshot_t *s, rt_uint32_t lap_ms)
+{
+    if (s->lap_count < STOPWATCH_MAX_LAPS)
+    {
+        s->lap_durations_ms[s->lap_count++] = lap_ms;
+        return;
+    }
+    memmove(&s->lap_durations_ms[0], &s->lap_durations_ms[1], sizeof(rt_uint32_t) * (STOPWATCH_MAX_LAPS - 1));
+    s->lap_durations_ms[STOPWATCH_MAX_LAPS - 1] = lap_ms;
+}
+
+rt_err_t journal_load(journal_t *j, stopwatch_snapshot_t *out, journal_ckpt_t *ckpt)
+{
+    journal_ckpt_t c;
+    journal_lap_t lap;
+
+    rt_memset(out, 0, sizeof(*out));
+    if (kv_get(&j->kv, JOURNAL_KEY_CKPT, &c, sizeof(c)) != (int)sizeof(c)) return -RT_EEMPTY;
+
+    out->state = (c.state <= STOPWATCH_STATE_PAUSED) ? (stopwatch_state_t)c.state : STOPWATCH_STATE_PAUSED;
+    out->accumulated_ms = c.total_ms;
+    out->last_lap_total_ms = c.last_lap_total_ms;
+    out->lap_total = c.lap_total;
+
+    /* 检查点包含的圈 (lap_total - lap_count, lap_total]；某圈已被覆盖时只保留其后的圈 */
+    rt_uint32_t n = c.lap_count;
+    if (n > STOPWATCH_MAX_LAPS) n = STOPWATCH_MAX_LAPS;
+    if (n > c.lap_total) n = c.lap_total;
+    for (rt_uint32_t i = c.lap_total - n + 1; i <= c.lap_total; i++)
+    {
+        if (!read_lap(j, c.session, i, &lap))
+        {
+            out->lap_count = 0;
+            continue;
+        }
+        push_lap(out, lap.lap_ms);
+    }
+
+    /* 检查点之后已写入的圈 */
+    while (read_lap(j, c.session, out->lap_total + 1, &lap))
+    {
+        push_lap(out, lap.lap_ms);
+        out->lap_total = lap.index;
+        out->last_lap_total_ms = lap.total_ms;
+        if (lap.total_ms > out->accumulated_ms) out->accumulated_ms = lap.total_ms;
+    }
+
+    j->session = c.session;
+    j->written_laps = out->lap_total;
+    j->last = c;
+    j->has_ckpt = 1;
+    if (ckpt) *ckpt = c;
+    return RT_EOK;
+}
+
+static rt_err_t write_ckpt(journal_t *j, const journal_ckpt_t *c)
+{
+    rt_err_t r = kv_set(&j->kv, JOURNAL_KEY_CKPT, c, sizeof(*c));
+    if (r == -RT_EBUSY)
+    {
+        j->stats.deferred++;
+        return r;
+    }
+    if (r != RT_EOK)
+    {
+        j->stats.errors++;
+        return r;
+    }
+    j->last = *c;
+    j->has_ckpt = 1;
+    j->stats.ckpts++;
+    return RT_EOK;
+}
+
+/* 快照中序号为 index 的圈用时（调用方保证该圈仍在圈速环内） */
+static rt_uint32_t snap_lap_ms(const stopwatch_snapshot_t *s, rt_uint32_t index)
+{
+    return s->lap_durations_ms[s->lap_count - (s->lap_total - index) - 1];
+}
+
+rt_err_t journal_sync(journal_t *j, const stopwatch_snapshot_t *s, rt_uint32_t total_ms,
+                      rt_uint8_t flags, rt_uint32_t rtc_s, rt_uint16_t rtc_ms, rt_bool_t new_session)
+{
+    journal_ckpt_t c;
+    rt_err_t r;
+
+    j->stats.syncs++;
+    j->kv.no_erase = (s->state == STOPWATCH_STATE_RUNNING) ? 1 : 0;
+    rt_memset(&c, 0, sizeof(c));
+    c.state = (rt_uint8_t)s->state;
+    c.total_ms = total_ms;
+    if (flags & JOURNAL_CKPT_RTC)
+    {
+        c.flags = JOURNAL_CKPT_RTC;
+        c.rtc_s = rtc_s;
+        c.rtc_ms = rtc_ms;
+    }
+
+    /* 起点检查点写成后才切换会话号：推迟时旧会话的检查点与圈原样保留，下次同步再写 */
+    if (new_session || s->lap_total < j->written_laps) j->new_pending = 1;
+    if (j->new_pending)
+    {
+        c.session = (rt_uint16_t)(j->session + 1);
+        r = write_ckpt(j, &c);
+        if (r != RT_EOK) return r;
+        j->session = c.session;
+        j->written_laps = 0;
+        j->new_pending = 0;
+    }
+    c.session = j->session;
+
+    /* 缺口（已移出圈速环、来不及写入的圈）只由越过它的检查点确认；检查点推迟时下次同步重新计算 */
+    rt_uint32_t skipped = 0;
+    if (s->lap_total > j->written_laps)
+    {
+        rt_uint32_t first = j->written_laps + 1;
+        rt_uint32_t oldest = s->lap_total - s->lap_count + 1;
+        rt_bool_t gap = RT_FALSE;
+        if (first < oldest)
+        {
+            skipped = oldest - first;
+            first = oldest;
+            gap = RT_TRUE;
+        }
+
+        /* 由最后一圈的结束时刻倒推 first 圈的结束时刻 */
+        rt_uint32_t t = s->last_lap_total_ms;
+        for (rt_uint32_t i = first + 1; i <= s->lap_total; i++) t -= snap_lap_ms(s, i);
+
+        /* 圈序号不连续时先把检查点移到缺口之后：恢复只向后接连续的圈，不会在更早的检查点后接上残留的旧圈 */
+        if (gap && first <= s->lap_total)
+        {
+            c.lap_total = first - 1;
+            c.last_lap_total_ms = t - snap_lap_ms(s, first);
+            r = write_ckpt(j, &c);
+            if (r != RT_EOK) return r;
+            j->written_laps = first - 1;
+            j->stats.skipped += skipped;
+            skipped = 0;
+        }
+
+        for (rt_uint32_t i = first; i <= s->lap_total; i++)
+        {
+            journal_lap_t lap;
+            rt_memset(&lap, 0, sizeof(lap));
+            if (i > first) t += snap_lap_ms(s, i);
+            lap.session = j->session;
+            lap.index = i;
+            lap.lap_ms = snap_lap_ms(s, i);
+            lap.total_ms = t;
+            r = kv_set(&j->kv, JOURNAL_KEY_LAP(i), &lap, sizeof(lap));
+            if (r == -RT_EBUSY)
+            {
+                /* 运行中换页需擦除：已写入的圈由恢复时接在检查点之后，余下的圈与检查点下次再写 */
+                j->stats.deferred++;
+                return r;
+            }
+            if (r != RT_EOK)
+            {
+                j->stats.errors++;
+                return r;
+            }
+            j->written_laps = i;
+            j->stats.laps++;
+        }
+    }
+
+    c.lap_count = s->lap_count;
+    c.last_lap_total_ms = s->last_lap_total_ms;
+    c.lap_total = s->lap_total;
+
+    /* 非运行态总用时不变，仅 RTC 时刻不同的检查点不必再写 */
+    if (j->has_ckpt && s->state != STOPWATCH_STATE_RUNNING &&
+        j->last.session == c.session && j->last.state == c.state && j->last.lap_count == c.lap_count &&
+        j->last.total_ms == c.total_ms && j->last.last_lap_total_ms == c.last_lap_total_ms &&
+        j->last.lap_total == c.lap_total)
+    {
+        return RT_EOK;
+    }
+    r = write_ckpt(j, &c);
+    if (r != RT_EOK) return r;
+    j->written_laps = c.lap_total;
+    j->stats.skipped += skipped;
+    return RT_EOK;
+}
+
+/* ================== 实机：后台线程 ================== */
+#define JNL_EV_CHANGED      0x01
+#define JNL_EV_RESET        0x02
+
+static journal_t s_jnl;
+static struct rt_mutex s_lock;
+static struct rt_event s_evt;
+static rt_uint8_t s_inited = 0;
+static rt_uint8_t s_running = 0;
+static rt_err_t s_restore_ret = -RT_EEMPTY;
+static stopwatch_state_t s_restore_state = STOPWATCH_STATE_IDLE;
+static rt_uint32_t s_restore_total_ms = 0;
+static rt_int32_t s_downtime_ms = -1;   /* -1：未按 RTC 补偿 */
+static rt_int8_t s_laps_merged = -1;    /* 已由备份寄存器恢复时：检查点圈速是否补上 */
+
+/* 在秒表服务线程中同步回调，只置标志 */
+static void journal_on_event(const event_t *e, void *user)
+{
+    rt_uint32_t set = JNL_EV_CHANGED;
+    (void)user;
+    if (e->topic == EVT_STATE_CHANGED && e->code == EVT_CAUSE_RESET) set |= JNL_EV_RESET;
+    rt_event_send(&s_evt, set);
+}
+
+static stopwatch_state_t journal_sync_now(rt_bool_t new_session)
+{
+    stopwatch_snapshot_t snap;
+    rt_uint32_t rtc_s = 0;
+    rt_uint16_t rtc_ms = 0;
+    rt_uint8_t flags = 0;
+
+    stopwatch_get_snapshot(&snap);
+    if (rtc_backup_now(&rtc_s, &rtc_ms) == RT_EOK) flags |= JOURNAL_CKPT_RTC;
+    rt_uint32_t total_ms = stopwatch_snapshot_total_ms(&snap, timebase_get_us());
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    rt_err_t r = journal_sync(&s_jnl, &snap, total_ms, flags, rtc_s, rtc_ms, new_session);
+    /* 排行榜只在停表后写，运行中入榜不增加写入 */
+    if (r == RT_EOK && snap.state != STOPWATCH_STATE_RUNNING)
+        r = lap_board_save(&s_jnl.kv, JOURNAL_KEY_BOARD, s_jnl.session);
+    rt_mutex_release(&s_lock);
+    if (r != RT_EOK && r != -RT_EBUSY) LOG_W("sync failed (%d)", (int)r);
+    return snap.state;
+}
+
+/* 恢复成功后：排行榜取本会话已保存的榜，再补上恢复出的圈速环；流式统计只能由圈速环重建 */
+static void restore_board(rt_uint16_t session, const stopwatch_snapshot_t *snap)
+{
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    lap_board_restore(&s_jnl.kv, JOURNAL_KEY_BOARD, session, snap);
+    rt_mutex_release(&s_lock);
+    lap_stats_restore(snap);
+}
+
+static void journal_restore(void)
+{
+    stopwatch_snapshot_t snap;
+    journal_ckpt_t c;
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    rt_err_t r = journal_load(&s_jnl, &snap, &c);
+    rt_mutex_release(&s_lock);
+    if (hot_state_restored())
+    {
+        /* 状态与总用时已由备份寄存器恢复（比检查点新），检查点只补圈速环；随后同步一次让检查点追上 */
+        s_laps_merged = (r == RT_EOK && stopwatch_restore(&snap) == RT_EOK) ? 1 : 0;
+        if (s_laps_merged) restore_board(c.session, &snap);
+        LOG_I("state from bkp, laps %s", s_laps_merged ? "merged from journal" : "not in journal");
+        rt_event_send(&s_evt, JNL_EV_CHANGED);
+        return;
+    }
+    if (r != RT_EOK)
+    {
+        LOG_I("no checkpoint");
+        s_restore_ret = r;
+        return;
+    }
+
+    if (snap.state == STOPWATCH_STATE_RUNNING)
+    {
+        rt_uint32_t now_s;
+        rt_uint16_t now_ms;
+        /* 停机期间继续计时：检查点时刻的总用时加上 RTC 走过的时间 */
+        if ((c.flags & JOURNAL_CKPT_RTC) && rtc_backup_continuous() && rtc_backup_now(&now_s, &now_ms) == RT_EOK &&
+            now_s >= c.rtc_s)
+        {
+            rt_int64_t down = (rt_int64_t)(now_s - c.rtc_s) * 1000 + now_ms - c.rtc_ms;
+            if (down < 0) down = 0;
+            if (down > 0x7FFFFFFF) down = 0x7FFFFFFF;
+            s_downtime_ms = (rt_int32_t)down;
+            if (c.total_ms + (rt_uint32_t)down > snap.accumulated_ms) snap.accumulated_ms = c.total_ms + (rt_uint32_t)down;
+        }
+        else
+        {
+            /* 无可信 RTC 时刻：停机时长未知，停在检查点时刻 */
+            snap.state = STOPWATCH_STATE_PAUSED;
+            LOG_W("no rtc time for running session, resume paused");
+        }
+    }
+
+    s_restore_state = snap.state;
+    s_restore_total_ms = snap.accumulated_ms;
+    s_restore_ret = stopwatch_restore(&snap);
+    if (s_restore_ret == RT_EOK) restore_board(c.session, &snap);
+    if (s_restore_ret == RT_EOK)
+        LOG_I("restored session %u: state %d total %u ms, %u laps", (unsigned)c.session, (int)snap.state,
+              (unsigned)snap.accumulated_ms, (unsigned)snap.lap_total);
+    else
+        LOG_W("restore skipped (%d)", (int)s_restore_ret);
+}
+
+static void journal_thread_entry(void *parameter)
+{
+    (void)parameter;
+    /* 等待 LSE 起振可能耗时数秒，放在本线程而不是 main */
+    rtc_backup_init();
+    journal_restore();
+
+    while (1)
+    {
+        rt_uint32_t set = 0;
+        rt_int32_t timeout = s_running ? (rt_int32_t)rt_tick_from_millisecond(SESSION_JOURNAL_PERIOD_MS) : RT_WAITING_FOREVER;
+        rt_err_t r = rt_event_recv(&s_evt, JNL_EV_CHANGED | JNL_EV_RESET, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                                   timeout, &set);
+        if (r != RT_EOK && r != -RT_ETIMEOUT) continue;
+        s_running = (journal_sync_now((set & JNL_EV_RESET) ? RT_TRUE : RT_FALSE) == STOPWATCH_STATE_RUNNING);
+    }
+}
+
+rt_err_t session_journal_init(void)
+{
+    if (s_inited) return RT_EOK;
+    const kv_flash_ops_t *ops = kv_store_onchip_ops();
+    if (!ops)
+    {
+        LOG_W("BSP_USING_ON_CHIP_FLASH not defined, session journal disabled");
+        return -RT_ENOSYS;
+    }
+    rt_err_t r = journal_open(&s_jnl, ops, SESSION_JOURNAL_BASE, SESSION_JOURNAL_PAGE_SIZE, SESSION_JOURNAL_PAGES);
+    if (r != RT_EOK)
+    {
+        LOG_E("mount failed (%d)", (int)r);
+        return r;
+    }
+    rt_mutex_init(&s_lock, "jnl", RT_IPC_FLAG_PRIO);
+    rt_event_init(&s_evt, "jnl", RT_IPC_FLAG_FIFO);
+
+    rt_thread_t tid = rt_thread_create("swjnl", journal_thread_entry, RT_NULL, 1024, SESSION_JOURNAL_PRIORITY, 10);
+    if (!tid)
+    {
+        rt_event_detach(&s_evt);
+        rt_mutex_detach(&s_lock);
+        return -RT_ENOMEM;
+    }
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED), journal_on_event, RT_NULL,
+                        EVENT_DELIVER_SYNC);
+    s_inited = 1;
+    rt_thread_startup(tid);
+    return RT_EOK;
+}
+
+/* ================== 命令 ================== */
+static const char *state_name(rt_uint8_t s)
+{
+    return (s == STOPWATCH_STATE_RUNNING) ? "running" : (s == STOPWATCH_STATE_PAUSED) ? "paused" : "idle";
+}
+
+static int cmd_sw_ckpt(int argc, char **argv)
+{
+    if (!s_inited)
+    {
+        rt_kprintf("sw_ckpt: journal unavailable\n");
+        return -RT_ERROR;
+    }
+    if (argc >= 2 && !strcmp(argv[1], "sync"))
+    {
+        rt_event_send(&s_evt, JNL_EV_CHANGED);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "stat"))
+    {
+        rt_kprintf("usage: sw_ckpt [stat]|sync\n");
+        return -RT_ERROR;
+    }
+
+    rt_mutex_take(&s_lock, RT_WAITING_FOREVER);
+    journal_t j = s_jnl;
+    rt_mutex_release(&s_lock);
+
+    rt_uint32_t now_s = 0;
+    rt_uint16_t now_ms = 0;
+    if (rtc_backup_now(&now_s, &now_ms) == RT_EOK)
+        rt_kprintf("rtc: %u.%03u s (%s)\n", (unsigned)now_s, (unsigned)now_ms,
+                   rtc_backup_continuous() ? "continuous" : "restarted this boot");
+    else
+        rt_kprintf("rtc: unavailable\n");
+
+    if (s_laps_merged >= 0)
+        rt_kprintf("boot: state from bkp (sw_hot), laps %s\n", s_laps_merged ? "merged" : "not merged");
+    else if (s_restore_ret == RT_EOK)
+        rt_kprintf("boot: restored %s at %u ms, downtime %d ms\n", state_name(s_restore_state),
+                   (unsigned)s_restore_total_ms, (int)s_downtime_ms);
+    else
+        rt_kprintf("boot: not restored (%d)\n", (int)s_restore_ret);
+
+    if (j.has_ckpt)
+        rt_kprintf("ckpt: session=%u %s total=%u ms laps=%u/%u rtc=%u.%03u%s\n", (unsigned)j.last.session,
+                   state_name(j.last.state), (unsigned)j.last.total_ms, (unsigned)j.last.lap_count,
+                   (unsigned)j.last.lap_total, (unsigned)j.last.rtc_s, (unsigned)j.last.rtc_ms,
+                   (j.last.flags & JOURNAL_CKPT_RTC) ? "" : " (no rtc)");
+    rt_kprintf("syncs=%u ckpts=%u laps=%u skipped=%u deferred=%u errors=%u\n", (unsigned)j.stats.syncs,
+               (unsigned)j.stats.ckpts, (unsigned)j.stats.laps, (unsigned)j.stats.skipped, (unsigned)j.stats.deferred,
+               (unsigned)j.stats.errors);
+    rt_kprintf("page=%u seq=%u free=%u gcs=%u erases=%u recovered=%u\n", (unsigned)j.kv.active, (unsigned)j.kv.seq,
+               (unsigned)kv_free_bytes(&j.kv), (unsigned)j.kv.stats.gcs, (unsigned)j.kv.stats.erases,
+               (unsigned)j.kv.stats.recovered);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_ckpt, sw_ckpt, Session_checkpoint_journal);
+
+/* ================== 模拟器：随机操作 + 随机掉电 ==================
+ * 用法：sw_ckpt_sim [rounds] [seed]
+ * 模型秒表执行随机的开始/暂停/圈速/清圈/复位，每隔 1~3 个操作同步一次日志；随机掉电后重新挂载恢复，
+ * 校验恢复结果是最后一次完整同步的状态，或正在同步的状态的一致前缀（圈用时逐一对照）。 */
+#define SIM_BASE        0x10000000UL
+#define SIM_LAPS_MAX    64
+
+typedef struct
+{
+    stopwatch_snapshot_t s;             /* accumulated_ms 即当前总用时 */
+    rt_uint32_t hist[SIM_LAPS_MAX];     /* 本会话各圈用时，下标为圈序号-1 */
+} sim_view_t;
+
+typedef struct
+{
+    journal_t  j;
+    sim_view_t model, committed, attempted;
+    sim_view_t upper;                   /* 已提交会话中最近一次尝试同步的视图（推迟的同步可能已写入部分圈） */
+    rt_uint32_t states;                 /* 上次提交以来尝试过的状态（位图），推迟的同步可能已写入其检查点 */
+    rt_uint8_t starts[SIM_LAPS_MAX + 1]; /* 上次提交以来尝试过的圈速环起点（圈序号），推迟的同步可能已写入其缺口检查点 */
+    stopwatch_snapshot_t got;
+} sim_ctx_t;
+
+static const kv_flash_ops_t s_sim_ops = { flash_sim_read, flash_sim_write, flash_sim_erase, RT_NULL, RT_NULL };
+static rt_uint32_t s_rng = 1;
+
+static rt_uint32_t sim_rand(void)
+{
+    s_rng = s_rng * 1103515245UL + 12345UL;
+    return s_rng >> 8;
+}
+
+/* 对模型执行一个随机操作，返回 1 表示发生复位 */
+static int sim_step(sim_view_t *m)
+{
+    stopwatch_snapshot_t *s = &m->s;
+    rt_uint32_t op = sim_rand() % 20;
+
+    if (s->state == STOPWATCH_STATE_RUNNING) s->accumulated_ms += sim_rand() % 5000;
+    if (op == 0 || s->lap_total >= SIM_LAPS_MAX)
+    {
+        rt_memset(m, 0, sizeof(*m));
+        return 1;
+    }
+    if (op < 4) s->state = STOPWATCH_STATE_RUNNING;
+    else if (op < 6) s->state = (s->state == STOPWATCH_STATE_RUNNING) ? STOPWATCH_STATE_PAUSED : s->state;
+    else if (op == 6)
+    {
+        s->lap_count = 0;
+        s->last_lap_total_ms = s->accumulated_ms;
+    }
+    else if (op < 14)
+    {
+        rt_uint32_t lap_ms = s->accumulated_ms - s->last_lap_total_ms;
+        push_lap(s, lap_ms);
+        s->last_lap_total_ms = s->accumulated_ms;
+        m->hist[s->lap_total++] = lap_ms;
+    }
+    return 0;
+}
+
+/* got 是否为视图 v 的一致状态：圈数/总用时在 [min, v] 内，恢复的每一圈与 v 的记录一致 */
+static rt_bool_t sim_match(const sim_view_t *v, const stopwatch_snapshot_t *got, rt_uint32_t min_laps, rt_uint32_t min_total)
+{
+    if (got->lap_total < min_laps || got->lap_total > v->s.lap_total) return RT_FALSE;
+    if (got->accumulated_ms < min_total || got->accumulated_ms > v->s.accumulated_ms) return RT_FALSE;
+    if (got->lap_count > got->lap_total) return RT_FALSE;
+    for (rt_uint16_t k = 0; k < got->lap_count; k++)
+    {
+        rt_uint32_t index = got->lap_total - got->lap_count + 1 + k;
+        if (got->lap_durations_ms[k] != v->hist[index - 1]) return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+/* 圈数：检查点 base 之后逐圈补上（超出圈速环时丢弃最早的），或从 starts 中某个圈速环起点（缺口检查点）
+ * 逐圈补上，或与完整写入的 a 相同 */
+static rt_bool_t sim_count_ok(const stopwatch_snapshot_t *base, const stopwatch_snapshot_t *a,
+                              const rt_uint8_t *starts, const stopwatch_snapshot_t *got)
+{
+    rt_uint32_t expect = base->lap_count + (got->lap_total - base->lap_total);
+    if (expect > STOPWATCH_MAX_LAPS) expect = STOPWATCH_MAX_LAPS;
+    if (got->lap_count == expect) return RT_TRUE;
+    if (got->lap_count <= got->lap_total && got->lap_total - got->lap_count <= SIM_LAPS_MAX &&
+        starts[got->lap_total - got->lap_count])
+        return RT_TRUE;
+    return (got->lap_total == a->lap_total && got->lap_count == a->lap_count) ? RT_TRUE : RT_FALSE;
+}
+
+/* 运行中掉电：不停表逐圈同步后断电，恢复须为运行态且含已写入的每一圈。模拟 Flash 不预擦，
+ * 第二次换页起目标页未空白，之后的圈推迟（-RT_EBUSY），恢复到推迟前最后写入的圈 */
+static rt_bool_t sim_running_cut(sim_ctx_t *x, rt_uint32_t laps)
+{
+    sim_view_t *m = &x->model;
+    rt_uint32_t written = 0, deferred = 0;
+    rt_bool_t ok = RT_FALSE;
+
+    rt_memset(m, 0, sizeof(*m));
+    m->s.state = STOPWATCH_STATE_RUNNING;
+    if (journal_sync(&x->j, &m->s, 0, 0, 0, 0, RT_TRUE) != RT_EOK) return RT_FALSE;
+    for (rt_uint32_t i = 0; i < laps && m->s.lap_total < SIM_LAPS_MAX; i++)
+    {
+        m->s.accumulated_ms += 20000 + sim_rand() % 60000;
+        rt_uint32_t lap_ms = m->s.accumulated_ms - m->s.last_lap_total_ms;
+        push_lap(&m->s, lap_ms);
+        m->s.last_lap_total_ms = m->s.accumulated_ms;
+        m->hist[m->s.lap_total++] = lap_ms;
+
+        rt_err_t r = journal_sync(&x->j, &m->s, m->s.accumulated_ms, 0, 0, 0, RT_FALSE);
+        if (r == -RT_EBUSY) deferred++;
+        else if (r != RT_EOK) return RT_FALSE;
+    }
+    written = x->j.written_laps;
+
+    flash_sim_power_cycle();
+    if (journal_open(&x->j, &s_sim_ops, SIM_BASE, SESSION_JOURNAL_PAGE_SIZE, SESSION_JOURNAL_PAGES) == RT_EOK &&
+        journal_load(&x->j, &x->got, RT_NULL) == RT_EOK)
+    {
+        rt_uint32_t ring = (written < STOPWATCH_MAX_LAPS) ? written : STOPWATCH_MAX_LAPS, end_ms = 0;
+        for (rt_uint32_t i = 0; i < written; i++) end_ms += m->hist[i];
+        ok = (written > 0 && x->got.state == STOPWATCH_STATE_RUNNING && x->got.lap_total == written &&
+              x->got.lap_count == ring && x->got.last_lap_total_ms == end_ms && sim_match(m, &x->got, written, 0))
+                 ? RT_TRUE : RT_FALSE;
+    }
+    rt_kprintf("running cut: %u laps, %u written before deferral, %u deferred syncs, recovered %u laps -> %s\n",
+               (unsigned)m->s.lap_total, (unsigned)written, (unsigned)deferred, (unsigned)x->got.lap_total,
+               ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+static int sim_fault(rt_uint32_t rounds)
+{
+    rt_uint32_t mismatches = 0, partial = 0, recovered = 0, syncs = 0;
+    sim_ctx_t *x = (sim_ctx_t *)rt_malloc(sizeof(sim_ctx_t));
+
+    if (!x || flash_sim_create(SIM_BASE, SESSION_JOURNAL_PAGE_SIZE, SESSION_JOURNAL_PAGES) != RT_EOK ||
+        journal_open(&x->j, &s_sim_ops, SIM_BASE, SESSION_JOURNAL_PAGE_SIZE, SESSION_JOURNAL_PAGES) != RT_EOK)
+    {
+        rt_kprintf("sw_ckpt_sim: no memory\n");
+        if (x) rt_free(x);
+        flash_sim_destroy();
+        return -RT_ENOMEM;
+    }
+    if (!sim_running_cut(x, SIM_LAPS_MAX)) mismatches++;
+    rt_memset(&x->model, 0, sizeof(x->model));
+    journal_sync(&x->j, &x->model.s, 0, 0, 0, 0, RT_FALSE);
+    x->committed = x->model;
+
+    x->upper = x->committed;
+    x->states = 1UL << x->committed.s.state;
+    rt_memset(x->starts, 0, sizeof(x->starts));
+
+    for (rt_uint32_t r = 0; r < rounds; r++)
+    {
+        /* 复位只通知一次（同实机事件）；起点检查点推迟时直到某次同步成功前都可能恢复出旧会话 */
+        rt_bool_t new_session = RT_FALSE;
+
+        flash_sim_cut_after((rt_int32_t)(sim_rand() % 400));
+        while (!flash_sim_is_cut())
+        {
+            rt_bool_t reset = RT_FALSE;
+            for (rt_uint32_t n = 1 + sim_rand() % 3; n; n--)
+            {
+                if (sim_step(&x->model)) reset = RT_TRUE;
+            }
+            if (reset) new_session = RT_TRUE;
+            x->attempted = x->model;
+            x->states |= 1UL << x->model.s.state;
+            x->starts[x->model.s.lap_total - x->model.s.lap_count] = 1;
+            syncs++;
+            rt_err_t sr = journal_sync(&x->j, &x->model.s, x->model.s.accumulated_ms, 0, 0, 0, reset);
+            if (flash_sim_is_cut()) break;
+            if (sr == RT_EOK)
+            {
+                x->committed = x->upper = x->attempted;
+                x->states = 1UL << x->committed.s.state;
+                rt_memset(x->starts, 0, sizeof(x->starts));
+                new_session = RT_FALSE;
+            }
+            else
+            {
+                /* 推迟前新会话起点检查点已写成：此后只会恢复出新会话，下限为其起点 */
+                if (new_session && !x->j.new_pending)
+                {
+                    rt_memset(&x->committed, 0, sizeof(x->committed));
+                    new_session = RT_FALSE;
+                }
+                if (!new_session) x->upper = x->attempted;
+            }
+        }
+
+        flash_sim_power_cycle();
+        rt_bool_t ok = RT_FALSE, newer = RT_FALSE;
+        if (journal_open(&x->j, &s_sim_ops, SIM_BASE, SESSION_JOURNAL_PAGE_SIZE, SESSION_JOURNAL_PAGES) == RT_EOK &&
+            journal_load(&x->j, &x->got, RT_NULL) == RT_EOK)
+        {
+            recovered += x->j.kv.stats.recovered;
+            const stopwatch_snapshot_t *c = &x->committed.s;
+            if (!(x->states & (1UL << x->got.state)))
+                ok = RT_FALSE;
+            else if (!new_session)
+                ok = newer = sim_match(&x->attempted, &x->got, c->lap_total, c->accumulated_ms) &&
+                             sim_count_ok(c, &x->attempted.s, x->starts, &x->got);
+            else if (sim_match(&x->upper, &x->got, c->lap_total, c->accumulated_ms) &&
+                     sim_count_ok(c, &x->upper.s, x->starts, &x->got))
+                ok = RT_TRUE;
+            else
+            {
+                /* 新会话起点检查点：0 圈 */
+                stopwatch_snapshot_t start;
+                rt_memset(&start, 0, sizeof(start));
+                ok = newer = sim_match(&x->attempted, &x->got, 0, 0) && sim_count_ok(&start, &x->attempted.s, x->starts, &x->got);
+            }
+        }
+        if (!ok)
+        {
+            mismatches++;
+            rt_kprintf("round %u: got %u laps %u ms, committed %u laps %u ms, attempted %u laps %u ms\n",
+                       (unsigned)r, (unsigned)x->got.lap_total, (unsigned)x->got.accumulated_ms,
+                       (unsigned)x->committed.s.lap_total, (unsigned)x->committed.s.accumulated_ms,
+                       (unsigned)x->attempted.s.lap_total, (unsigned)x->attempted.s.accumulated_ms);
+            break;
+        }
+
+        /* 以恢复结果继续：圈记录取自与之匹配的视图 */
+        x->model = newer ? x->attempted : x->upper;
+        if (newer && (new_session || x->got.lap_total != x->committed.s.lap_total ||
+                      x->got.accumulated_ms != x->committed.s.accumulated_ms || x->got.state != x->committed.s.state))
+            partial++;
+        x->model.s = x->got;
+        x->committed = x->upper = x->model;
+        x->states = 1UL << x->committed.s.state;
+        rt_memset(x->starts, 0, sizeof(x->starts));
+    }
+
+    flash_sim_stats_t st;
+    flash_sim_get_stats(&st);
+    rt_kprintf("rounds=%u syncs=%u cuts=%u recovered=%u newer_than_committed=%u erases=%u mismatches=%u -> %s\n",
+               (unsigned)rounds, (unsigned)syncs, (unsigned)st.cuts, (unsigned)recovered, (unsigned)partial,
+               (unsigned)st.erases, (unsigned)mismatches, mismatches ? "FAIL" : "PASS");
+    rt_free(x);
+    flash_sim_destroy();
+    return mismatches ? -RT_ERROR : 0;
+}
+
+static int cmd_sw_ckpt_sim(int argc, char **argv)
+{
+    s_rng = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 1;
+    return sim_fault((argc >= 2) ? (rt_uint32_t)atoi(argv[1]) : 200);
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_ckpt_sim, sw_ckpt_sim, Session_journal_power_loss_simulator);
@@ -0,0 +1,116 @@
+#ifndef APPLICATIONS_SESSION_JOURNAL_H_
+#define APPLICATIONS_SESSION_JOURNAL_H_
+
+#include <rtthread.h>
+#include "kv_store.h"
+#include "lap_board.h"
+#include "stopwatch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 秒表会话检查点日志：在独立的 kv_store 实例（两页轮转）中追加小记录——
+ * 键 0 为检查点（状态/总用时/圈数/RTC 时刻），键 1..STOPWATCH_MAX_LAPS 为按圈序号轮转的圈记录，
+ * 其后为圈速排行榜（秒表非运行时写入）。
+ * 只有后台线程写 Flash，状态事件回调只置标志；开机恢复最近一致的检查点及其后已写入的圈。
+ * 运行中照常追加新圈与周期检查点，只是换页不擦除（目标页未预擦时该次写入推迟到下次同步或停表）。 */
+
+/* 运行中周期检查点间隔（ms）：无 RTC 时掉电最多丢失这么长的计时 */
+#ifndef SESSION_JOURNAL_PERIOD_MS
+#define SESSION_JOURNAL_PERIOD_MS       60000U
+#endif
+#ifndef SESSION_JOURNAL_PAGES
+#define SESSION_JOURNAL_PAGES           2
+#endif
+#ifndef SESSION_JOURNAL_PAGE_SIZE
+#define SESSION_JOURNAL_PAGE_SIZE       1024
+#endif
+/* 紧挨参数区之下（链接脚本已从 ROM 中扣除） */
+#ifndef SESSION_JOURNAL_BASE
+#define SESSION_JOURNAL_BASE            (KV_STORE_BASE - SESSION_JOURNAL_PAGES * SESSION_JOURNAL_PAGE_SIZE)
+#endif
+/* 后台线程：低于 UI/事件总线，高于 shell */
+#ifndef SESSION_JOURNAL_PRIORITY
+#define SESSION_JOURNAL_PRIORITY        18
+#endif
+
+#define JOURNAL_KEY_CKPT                0
+#define JOURNAL_KEY_LAP(index)          ((rt_uint16_t)(1 + ((index) - 1) % STOPWATCH_MAX_LAPS))
+
+/* 圈速排行榜（lap_board）紧随圈记录之后 */
+#define JOURNAL_KEY_BOARD               ((rt_uint16_t)(1 + STOPWATCH_MAX_LAPS))
+
+#if STOPWATCH_MAX_LAPS + 1 > KV_MAX_KEYS
+#error "session journal needs STOPWATCH_MAX_LAPS + 1 kv keys"
+#endif
+#if LAP_BOARD_PERSIST && STOPWATCH_MAX_LAPS + 1 + LAP_BOARD_KEYS > KV_MAX_KEYS
+#error "session journal needs STOPWATCH_MAX_LAPS + 1 + LAP_BOARD_KEYS kv keys for the lap board"
+#endif
+
+#define JOURNAL_CKPT_RTC                0x01    /* rtc_s/rtc_ms 有效 */
+
+/* 检查点（键 0） */
+typedef struct
+{
+    rt_uint16_t session;            /* 复位一次加 1 */
+    rt_uint8_t  state;              /* stopwatch_state_t */
+    rt_uint8_t  flags;
+    rt_uint16_t lap_count;
+    rt_uint16_t rtc_ms;
+    rt_uint32_t total_ms;           /* 写入时刻的总用时 */
+    rt_uint32_t last_lap_total_ms;
+    rt_uint32_t lap_total;
+    rt_uint32_t rtc_s;              /* 写入时刻的 RTC 秒计数 */
+} journal_ckpt_t;
+
+/* 圈记录（键 JOURNAL_KEY_LAP(index)） */
+typedef struct
+{
+    rt_uint16_t session;
+    rt_uint16_t rsv;
+    rt_uint32_t index;              /* 圈序号，从 1 起 */
+    rt_uint32_t lap_ms;
+    rt_uint32_t total_ms;           /* 本圈结束时的总用时 */
+} journal_lap_t;
+
+typedef struct
+{
+    rt_uint32_t syncs;              /* 同步次数 */
+    rt_uint32_t ckpts;              /* 写入的检查点 */
+    rt_uint32_t laps;               /* 写入的圈记录 */
+    rt_uint32_t skipped;            /* 已被圈速环覆盖、来不及写入的圈 */
+    rt_uint32_t deferred;           /* 运行中换页需擦除而推迟的同步 */
+    rt_uint32_t errors;
+} journal_stats_t;
+
+/* 日志实例（纯逻辑，实机与模拟器共用） */
+typedef struct
+{
+    kv_store_t      kv;
+    rt_uint16_t     session;
+    rt_uint32_t     written_laps;   /* 本会话已写入的最大圈序号 */
+    rt_uint8_t      new_pending;    /* 已复位但新会话起点检查点尚未写成（运行中推迟），写成前不写新会话的圈 */
+    journal_ckpt_t  last;           /* 最近写入的检查点 */
+    rt_uint8_t      has_ckpt;
+    journal_stats_t stats;
+} journal_t;
+
+rt_err_t journal_open(journal_t *j, const kv_flash_ops_t *ops, rt_uint32_t base, rt_uint16_t page_size, rt_uint8_t pages);
+/* 读取最近一致的检查点并补上其后已写入的圈：out 的 accumulated_ms 为检查点时刻总用时（不早于最后一圈），
+ * state_start_us 为 0，由调用方决定运行态如何继续；无检查点返回 -RT_EEMPTY */
+rt_err_t journal_load(journal_t *j, stopwatch_snapshot_t *out, journal_ckpt_t *ckpt);
+/* 把快照相对上次同步的增量写入日志：先写新圈，再写检查点；total_ms 为快照在取 RTC 时刻的总用时，
+ * rtc_s/rtc_ms 仅在 flags 含 JOURNAL_CKPT_RTC 时有效；new_session 表示其间发生过复位。
+ * 快照为运行态时不擦除：换页需擦除时返回 -RT_EBUSY，此前已写入的圈保留，其余下次同步再写 */
+rt_err_t journal_sync(journal_t *j, const stopwatch_snapshot_t *s, rt_uint32_t total_ms,
+                      rt_uint8_t flags, rt_uint32_t rtc_s, rt_uint16_t rtc_ms, rt_bool_t new_session);
+
+/* 实机接口：挂载日志、启动后台线程并在线程中恢复上次会话 */
+rt_err_t session_journal_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_SESSION_JOURNAL_H_ */
@@ -0,0 +1,686 @@
+#include "session_recorder.h"
+#include <finsh.h>
+#include <rthw.h>
+#include <stdlib.h>
+#include <string.h>
+#include "event_bus.h"
+#include "rtc_backup.h"
+#include "stopwatch.h"
+#include "timebase.h"
+#if defined(RT_USING_DFS) && defined(RT_USING_DFS_ELMFAT)
+#include <dfs_fs.h>
+#include <dfs_posix.h>
+#define SESSION_RECORDER_USING_DFS  1
+#else
+#define SESSION_RECORDER_USING_DFS  0
+#endif
+
+#define DBG_TAG "rec"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define RING_MASK       (SESSION_RECORDER_RING - 1)
+#define BATCH_BYTES     (SESSION_RECORDER_BATCH_SECTORS * SESSION_RECORDER_SECTOR)
+
+/* 生产者：秒表服务线程的同步回调、写线程自身的采样（均经关中断临界区入队）；消费者：写线程 */
+static rec_record_t *s_ring = RT_NULL;
+static volatile rt_uint32_t s_head = 0;
+static volatile rt_uint32_t s_tail = 0;
+static volatile rt_uint8_t s_active = 0;        /* 回调是否入队 */
+static volatile rt_uint8_t s_flush_req = 0;
+static volatile rt_uint8_t s_quit = 0;
+static rt_uint8_t s_inited = 0;
+static const rec_sink_ops_t *s_ops = RT_NULL;   /* 非空表示写线程在运行 */
+static rt_uint32_t s_sample_ms = 0;
+static struct rt_semaphore s_wake;
+static struct rt_semaphore s_done;
+static rec_stats_t s_stats;
+
+/* 以下由回调维护（秒表服务线程独占），口径与秒表一致 */
+static rt_uint8_t s_running = 0;
+static rt_uint64_t s_seg_us = 0;
+static rt_uint32_t s_total_ms = 0;
+static rt_uint16_t s_laps = 0;
+
+/* 以下只由写线程访问 */
+static rt_uint8_t *s_batch = RT_NULL;
+static rt_uint8_t s_open = 0;
+static rt_uint8_t s_dirty = 0;                  /* 上次 fsync 之后有新记录 */
+static rt_uint32_t s_t0_ms = 0;
+static rt_uint32_t s_file_off = 0;              /* 批缓冲对应的文件偏移（扇区对齐） */
+static rt_uint32_t s_fill = 0;                  /* 批缓冲已用字节 */
+static rt_uint32_t s_alloc = 0;                 /* 已预分配长度 */
+static rt_tick_t s_last_sync = 0;
+
+static void ring_push(const rec_record_t *r)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    if (s_ring)
+    {
+        rt_uint32_t used = s_head - s_tail;
+        if (used >= SESSION_RECORDER_RING)
+        {
+            s_stats.dropped++;
+        }
+        else
+        {
+            s_ring[s_head & RING_MASK] = *r;
+            s_head++;
+            if (used + 1 > s_stats.ring_high) s_stats.ring_high = used + 1;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+static rt_uint32_t total_at(rt_uint64_t t_us)
+{
+    return s_total_ms + ((s_running && t_us > s_seg_us) ? (rt_uint32_t)((t_us - s_seg_us) / 1000ULL) : 0);
+}
+
+static void track_resume(void)
+{
+    stopwatch_snapshot_t snap;
+    stopwatch_get_snapshot(&snap);
+    s_running = (snap.state == STOPWATCH_STATE_RUNNING) ? 1 : 0;
+    s_seg_us = snap.state_start_us;
+    s_total_ms = snap.accumulated_ms;
+    s_laps = (rt_uint16_t)snap.lap_total;
+}
+
+static void recorder_on_event(const event_t *e, void *user)
+{
+    rec_record_t r;
+    (void)user;
+
+    r.t_ms = (rt_uint32_t)(e->t_us / 1000ULL);
+    if (e->topic == EVT_LAP_RECORDED)
+    {
+        s_laps = e->index;
+        r.type = REC_TYPE_LAP;
+        r.state = s_running ? STOPWATCH_STATE_RUNNING : STOPWATCH_STATE_PAUSED;
+        r.value = e->value;
+    }
+    else
+    {
+        switch (e->code)
+        {
+        case EVT_CAUSE_START:
+            s_running = 1;
+            s_seg_us = e->t_us;
+            r.type = REC_TYPE_START;
+            break;
+        case EVT_CAUSE_STOP:
+            s_total_ms = total_at(e->t_us);
+            s_running = 0;
+            r.type = REC_TYPE_STOP;
+            break;
+        case EVT_CAUSE_RESET:
+            /* 运行中复位：新会话从复位时刻继续计时 */
+            r.value = total_at(e->t_us);
+            s_total_ms = 0;
+            s_seg_us = e->t_us;
+            s_laps = 0;
+            r.type = REC_TYPE_RESET;
+            break;
+        case EVT_CAUSE_CLEAR_LAPS:
+            r.type = REC_TYPE_CLEAR_LAPS;
+            break;
+        case EVT_CAUSE_RESTORE:
+            track_resume();
+            r.type = REC_TYPE_RESTORE;
+            break;
+        default:
+            return;
+        }
+        r.state = (rt_uint8_t)e->value;
+        if (r.type != REC_TYPE_RESET) r.value = 0;
+    }
+    if (!s_active) return;
+
+    r.lap_idx = s_laps;
+    r.total_ms = total_at(e->t_us);
+    ring_push(&r);
+    /* 暂停/复位时落盘；圈速只入队，不做 IPC */
+    if (r.type == REC_TYPE_STOP || r.type == REC_TYPE_RESET)
+    {
+        s_flush_req = 1;
+        rt_sem_release(&s_wake);
+    }
+}
+
+/* ================== 写线程 ================== */
+
+static void write_batch(rt_uint32_t len)
+{
+    if (s_file_off + len > s_alloc)
+    {
+        s_alloc += SESSION_RECORDER_PREALLOC;
+        if (s_ops->reserve(s_alloc) != RT_EOK) s_stats.errors++;
+    }
+    rt_uint64_t t0 = timebase_get_us();
+    rt_err_t r = s_ops->write(s_file_off, s_batch, len);
+    rt_uint32_t dt = (rt_uint32_t)(timebase_get_us() - t0);
+    if (r != RT_EOK) s_stats.errors++;
+    s_stats.writes++;
+    s_stats.bytes += len;
+    s_stats.write_us += dt;
+    if (dt > s_stats.max_write_us) s_stats.max_write_us = dt;
+}
+
+static void batch_append(const void *rec)
+{
+    rt_memcpy(s_batch + s_fill, rec, sizeof(rec_record_t));
+    s_fill += sizeof(rec_record_t);
+    s_dirty = 1;
+    if (s_fill == BATCH_BYTES)
+    {
+        write_batch(BATCH_BYTES);
+        s_file_off += BATCH_BYTES;
+        s_fill = 0;
+    }
+}
+
+/* 未满的批按扇区补齐写出（之后继续追加时整批重写），再 fsync */
+static void file_flush(void)
+{
+    if (!s_open || !s_dirty) return;
+    if (s_fill)
+    {
+        rt_uint32_t len = (s_fill + SESSION_RECORDER_SECTOR - 1) & ~(rt_uint32_t)(SESSION_RECORDER_SECTOR - 1);
+        rt_memset(s_batch + s_fill, 0xFF, len - s_fill);
+        write_batch(len);
+    }
+    if (s_ops->sync() != RT_EOK) s_stats.errors++;
+    s_stats.syncs++;
+    s_dirty = 0;
+    s_last_sync = rt_tick_get();
+}
+
+static rt_err_t file_open(rt_uint32_t t0_ms)
+{
+    char name[32];
+    rec_header_t h;
+    rt_uint32_t rtc = 0;
+
+    rtc_backup_now(&rtc, RT_NULL);
+    /* 8.3 文件名：开始 RTC 秒（RTC 不可用时为开机 ms） */
+    rt_snprintf(name, sizeof(name), "%s/%08X.REC", SESSION_RECORDER_DIR, (unsigned)(rtc ? rtc : t0_ms));
+    if (s_ops->open(name) != RT_EOK)
+    {
+        s_stats.errors++;
+        LOG_W("open %s failed", name);
+        return -RT_EIO;
+    }
+    s_alloc = SESSION_RECORDER_PREALLOC;
+    if (s_ops->reserve(s_alloc) != RT_EOK) s_stats.errors++;
+    s_open = 1;
+    s_file_off = 0;
+    s_fill = 0;
+    s_t0_ms = t0_ms;
+    s_last_sync = rt_tick_get();
+    s_stats.files++;
+
+    h.type = REC_TYPE_HEADER;
+    h.version = REC_FILE_VERSION;
+    h.rec_size = sizeof(rec_record_t);
+    h.magic = REC_FILE_MAGIC;
+    h.start_rtc = rtc;
+    h.t0_ms = t0_ms;
+    batch_append(&h);
+    return RT_EOK;
+}
+
+static void file_close(void)
+{
+    if (!s_open) return;
+    file_flush();
+    if (s_ops->close(s_file_off + s_fill) != RT_EOK) s_stats.errors++;
+    s_open = 0;
+}
+
+static void drain(void)
+{
+    while (s_tail != s_head)
+    {
+        rec_record_t r = s_ring[s_tail & RING_MASK];
+        s_tail++;
+        if (!s_open)
+        {
+            /* 没有打开的文件时，复位/清圈无会话可记 */
+            if (r.type == REC_TYPE_RESET || r.type == REC_TYPE_CLEAR_LAPS) continue;
+            if (file_open(r.t_ms) != RT_EOK) continue;
+        }
+        r.t_ms -= s_t0_ms;
+        batch_append(&r);
+        s_stats.records++;
+        if (r.type == REC_TYPE_RESET) file_close();
+    }
+}
+
+static void push_sample(void)
+{
+    stopwatch_snapshot_t snap;
+    rec_record_t r;
+    rt_uint64_t now = timebase_get_us();
+
+    stopwatch_get_snapshot(&snap);
+    if (snap.state != STOPWATCH_STATE_RUNNING) return;
+    r.type = REC_TYPE_SAMPLE;
+    r.state = (rt_uint8_t)snap.state;
+    r.lap_idx = (rt_uint16_t)snap.lap_total;
+    r.t_ms = (rt_uint32_t)(now / 1000ULL);
+    r.total_ms = stopwatch_snapshot_total_ms(&snap, now);
+    r.value = 0;
+    ring_push(&r);
+}
+
+static void recorder_thread_entry(void *parameter)
+{
+    rt_tick_t next_sample = rt_tick_get();
+    (void)parameter;
+
+    while (1)
+    {
+        rt_int32_t wait = rt_tick_from_millisecond(SESSION_RECORDER_POLL_MS);
+        if (s_sample_ms)
+        {
+            rt_int32_t left = (rt_int32_t)(next_sample - rt_tick_get());
+            if (left < wait) wait = (left > 0) ? left : 0;
+        }
+        rt_sem_take(&s_wake, wait);
+
+        if (s_sample_ms && (rt_int32_t)(rt_tick_get() - next_sample) >= 0)
+        {
+            push_sample();
+            next_sample += rt_tick_from_millisecond((rt_int32_t)s_sample_ms);
+            /* 落后超过一个周期时不补采 */
+            if ((rt_int32_t)(rt_tick_get() - next_sample) >= 0) next_sample = rt_tick_get() + rt_tick_from_millisecond((rt_int32_t)s_sample_ms);
+        }
+        /* 先取标志再取队列：标志置位前对应记录已入队；取与清在关中断下完成，取后到清前置位的请求不会丢 */
+        rt_base_t level = rt_hw_interrupt_disable();
+        rt_uint8_t flush = s_flush_req;
+        s_flush_req = 0;
+        rt_hw_interrupt_enable(level);
+        rt_uint8_t quit = s_quit;
+        drain();
+        if (flush || (s_dirty && rt_tick_get() - s_last_sync >= rt_tick_from_millisecond(SESSION_RECORDER_SYNC_MS)))
+            file_flush();
+        if (quit)
+        {
+            drain();
+            file_close();
+            break;
+        }
+    }
+    rt_sem_release(&s_done);
+}
+
+/* 分配缓冲并启动写线程；live 为 0 时不接收秒表事件（基准自行入队） */
+static rt_err_t recorder_begin(const rec_sink_ops_t *ops, rt_uint32_t sample_ms, rt_bool_t live)
+{
+    if (s_ops) return -RT_EBUSY;
+    s_ring = RT_NULL;
+    rec_record_t *ring = (rec_record_t *)rt_malloc(SESSION_RECORDER_RING * sizeof(rec_record_t));
+    s_batch = (rt_uint8_t *)rt_malloc(BATCH_BYTES);
+    if (!ring || !s_batch)
+    {
+        if (ring) rt_free(ring);
+        if (s_batch) rt_free(s_batch);
+        s_batch = RT_NULL;
+        return -RT_ENOMEM;
+    }
+    rt_memset(&s_stats, 0, sizeof(s_stats));
+    s_head = s_tail = 0;
+    s_open = 0;
+    s_quit = 0;
+    s_flush_req = 0;
+    s_sample_ms = sample_ms;
+    s_ops = ops;
+    rt_sem_init(&s_wake, "rec", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&s_done, "recd", 0, RT_IPC_FLAG_FIFO);
+
+    rt_thread_t tid = rt_thread_create("swrec", recorder_thread_entry, RT_NULL, SESSION_RECORDER_STACK, SESSION_RECORDER_PRIORITY, 10);
+    if (!tid)
+    {
+        rt_sem_detach(&s_wake);
+        rt_sem_detach(&s_done);
+        rt_free(ring);
+        rt_free(s_batch);
+        s_batch = RT_NULL;
+        s_ops = RT_NULL;
+        return -RT_ENOMEM;
+    }
+    rt_base_t level = rt_hw_interrupt_disable();
+    s_ring = ring;
+    s_active = live ? 1 : 0;
+    rt_hw_interrupt_enable(level);
+    rt_thread_startup(tid);
+    return RT_EOK;
+}
+
+static void recorder_end(void)
+{
+    if (!s_ops) return;
+    rt_base_t level = rt_hw_interrupt_disable();
+    s_active = 0;
+    rt_hw_interrupt_enable(level);
+    s_quit = 1;
+    rt_sem_release(&s_wake);
+    rt_sem_take(&s_done, RT_WAITING_FOREVER);
+
+    level = rt_hw_interrupt_disable();
+    rec_record_t *ring = s_ring;
+    s_ring = RT_NULL;
+    rt_hw_interrupt_enable(level);
+    rt_free(ring);
+    rt_free(s_batch);
+    s_batch = RT_NULL;
+    rt_sem_detach(&s_wake);
+    rt_sem_detach(&s_done);
+    s_ops = RT_NULL;
+}
+
+/* ================== DFS 后端（elmfat） ================== */
+#if SESSION_RECORDER_USING_DFS
+static int s_fd = -1;
+
+static rt_err_t dfs_sink_open(const char *name)
+{
+    s_fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0);
+    return (s_fd >= 0) ? RT_EOK : -RT_EIO;
+}
+
+/* elmfat 的 ftruncate 加长即 f_lseek 扩展并分配簇，之后写入不再改 FAT */
+static rt_err_t dfs_sink_reserve(rt_uint32_t size)
+{
+    return (ftruncate(s_fd, (off_t)size) == 0) ? RT_EOK : -RT_EIO;
+}
+
+static rt_err_t dfs_sink_write(rt_uint32_t off, const void *buf, rt_size_t len)
+{
+    if (lseek(s_fd, (off_t)off, SEEK_SET) != (off_t)off) return -RT_EIO;
+    return (write(s_fd, buf, len) == (int)len) ? RT_EOK : -RT_EIO;
+}
+
+static rt_err_t dfs_sink_sync(void)
+{
+    return (fsync(s_fd) == 0) ? RT_EOK : -RT_EIO;
+}
+
+static rt_err_t dfs_sink_close(rt_uint32_t length)
+{
+    rt_err_t r = (ftruncate(s_fd, (off_t)length) == 0) ? RT_EOK : -RT_EIO;
+    close(s_fd);
+    s_fd = -1;
+    return r;
+}
+
+static const rec_sink_ops_t s_dfs_ops =
+{
+    dfs_sink_open, dfs_sink_reserve, dfs_sink_write, dfs_sink_sync, dfs_sink_close,
+};
+#endif
+
+/* ================== RAM 磁盘映像后端（基准/模拟） ================== */
+static rt_uint8_t *s_sim_img = RT_NULL;
+static rt_uint32_t s_sim_len = 0;
+static rt_uint32_t s_sim_delay_ms = 0;
+
+static rt_err_t sim_sink_open(const char *name)
+{
+    (void)name;
+    rt_memset(s_sim_img, 0xFF, SESSION_RECORDER_SIM_IMAGE);
+    s_sim_len = 0;
+    return RT_EOK;
+}
+
+static rt_err_t sim_sink_reserve(rt_uint32_t size)
+{
+    (void)size;
+    return RT_EOK;
+}
+
+/* 超出映像容量的部分只计数不保存；delay 模拟 SD 卡写入忙 */
+static rt_err_t sim_sink_write(rt_uint32_t off, const void *buf, rt_size_t len)
+{
+    if (off < SESSION_RECORDER_SIM_IMAGE)
+    {
+        rt_size_t n = (off + len <= SESSION_RECORDER_SIM_IMAGE) ? len : (SESSION_RECORDER_SIM_IMAGE - off);
+        rt_memcpy(s_sim_img + off, buf, n);
+    }
+    if (s_sim_delay_ms) rt_thread_mdelay((rt_int32_t)s_sim_delay_ms);
+    return RT_EOK;
+}
+
+static rt_err_t sim_sink_sync(void)
+{
+    return RT_EOK;
+}
+
+static rt_err_t sim_sink_close(rt_uint32_t length)
+{
+    s_sim_len = length;
+    return RT_EOK;
+}
+
+static const rec_sink_ops_t s_sim_ops =
+{
+    sim_sink_open, sim_sink_reserve, sim_sink_write, sim_sink_sync, sim_sink_close,
+};
+
+/* ================== 接口 ================== */
+
+rt_err_t session_recorder_init(void)
+{
+    if (s_inited) return RT_EOK;
+    track_resume();
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED), recorder_on_event, RT_NULL,
+                        EVENT_DELIVER_SYNC);
+    s_inited = 1;
+    return RT_EOK;
+}
+
+rt_err_t session_recorder_start(rt_uint32_t sample_ms)
+{
+#if SESSION_RECORDER_USING_DFS
+    if (!s_inited) return -RT_ERROR;
+    if (dfs_filesystem_lookup("/") == RT_NULL && dfs_mount(SESSION_RECORDER_BLKDEV, "/", "elm", 0, 0) != 0)
+    {
+        LOG_W("mount %s failed", SESSION_RECORDER_BLKDEV);
+        return -RT_EIO;
+    }
+    mkdir(SESSION_RECORDER_DIR, 0);
+    rt_err_t r = recorder_begin(&s_dfs_ops, sample_ms, RT_TRUE);
+    if (r == RT_EOK && stopwatch_get_state() != STOPWATCH_STATE_IDLE)
+    {
+        /* 会话进行中开启：先写一条采样作为起点 */
+        push_sample();
+    }
+    return r;
+#else
+    (void)sample_ms;
+    return -RT_ENOSYS;
+#endif
+}
+
+void session_recorder_stop(void)
+{
+    if (s_ops && s_active) recorder_end();
+}
+
+rt_bool_t session_recorder_active(void)
+{
+    return s_active ? RT_TRUE : RT_FALSE;
+}
+
+void session_recorder_get_stats(rec_stats_t *out)
+{
+    if (out) *out = s_stats;
+}
+
+/* ================== 命令 ================== */
+
+static void print_stats(const rec_stats_t *st)
+{
+    rt_kprintf("records=%u dropped=%u ring_high=%u/%u files=%u errors=%u\n", (unsigned)st->records,
+               (unsigned)st->dropped, (unsigned)st->ring_high, SESSION_RECORDER_RING, (unsigned)st->files,
+               (unsigned)st->errors);
+    rt_kprintf("writes=%u bytes=%u syncs=%u write_time=%u us max_write=%u us\n", (unsigned)st->writes,
+               (unsigned)st->bytes, (unsigned)st->syncs, (unsigned)st->write_us, (unsigned)st->max_write_us);
+}
+
+static rt_uint32_t s_bench_n = 0;
+static rt_uint32_t s_bench_period = 0;
+static rt_uint32_t s_bench_max_cyc = 0;
+static rt_uint64_t s_bench_sum_cyc = 0;
+static struct rt_semaphore s_bench_done;
+
+/* 模拟秒表服务线程：同优先级按周期入队圈速记录，统计入队耗时（含计时本身开销） */
+static void bench_producer_entry(void *parameter)
+{
+    rec_record_t r;
+    (void)parameter;
+    for (rt_uint32_t i = 1; i <= s_bench_n + 1; i++)
+    {
+        rt_uint64_t now = timebase_get_us();
+        r.type = (i <= s_bench_n) ? REC_TYPE_LAP : REC_TYPE_RESET;
+        r.state = STOPWATCH_STATE_RUNNING;
+        r.lap_idx = (rt_uint16_t)i;
+        r.t_ms = (rt_uint32_t)(now / 1000ULL);
+        r.total_ms = i * s_bench_period;
+        r.value = s_bench_period;
+        rt_uint64_t c0 = timebase_get_cycles();
+        ring_push(&r);
+        rt_uint32_t cyc = (rt_uint32_t)(timebase_get_cycles() - c0);
+        if (cyc > s_bench_max_cyc) s_bench_max_cyc = cyc;
+        s_bench_sum_cyc += cyc;
+        if (s_bench_period) rt_thread_mdelay((rt_int32_t)s_bench_period);
+    }
+    rt_sem_release(&s_bench_done);
+}
+
+/* 按文件格式解析 RAM 映像：文件头、圈序号连续、以复位结束 */
+static rt_uint32_t bench_verify(rt_uint32_t n, rt_bool_t *ok)
+{
+    rt_uint32_t len = (s_sim_len < SESSION_RECORDER_SIM_IMAGE) ? s_sim_len : SESSION_RECORDER_SIM_IMAGE;
+    rec_header_t h;
+    rt_uint32_t got = 0;
+
+    *ok = RT_FALSE;
+    if (len < sizeof(h)) return 0;
+    rt_memcpy(&h, s_sim_img, sizeof(h));
+    if (h.type != REC_TYPE_HEADER || h.magic != REC_FILE_MAGIC || h.rec_size != sizeof(rec_record_t)) return 0;
+    for (rt_uint32_t off = sizeof(h); off + sizeof(rec_record_t) <= len; off += sizeof(rec_record_t))
+    {
+        rec_record_t r;
+        rt_memcpy(&r, s_sim_img + off, sizeof(r));
+        if (r.lap_idx != (rt_uint16_t)(got + 1)) return got;
+        got++;
+    }
+    /* 映像容量以内的记录完整有序；全部装下时还须以复位结束且长度一致 */
+    if (s_sim_len <= SESSION_RECORDER_SIM_IMAGE)
+        *ok = (got == n + 1 && s_sim_img[s_sim_len - sizeof(rec_record_t)] == REC_TYPE_RESET) ? RT_TRUE : RT_FALSE;
+    else
+        *ok = (got == (len - sizeof(h)) / sizeof(rec_record_t)) ? RT_TRUE : RT_FALSE;
+    return got;
+}
+
+static int recorder_bench(rt_uint32_t n, rt_uint32_t delay_ms, rt_uint32_t period_ms)
+{
+    rt_err_t r;
+    rt_bool_t ok;
+
+    if (s_ops)
+    {
+        rt_kprintf("recorder busy, sw_rec off first\n");
+        return -1;
+    }
+    s_sim_img = (rt_uint8_t *)rt_malloc(SESSION_RECORDER_SIM_IMAGE);
+    if (!s_sim_img)
+    {
+        rt_kprintf("no memory\n");
+        return -1;
+    }
+    s_sim_delay_ms = delay_ms;
+    s_sim_len = 0;
+    s_bench_n = n;
+    s_bench_period = period_ms;
+    s_bench_max_cyc = 0;
+    s_bench_sum_cyc = 0;
+    rt_sem_init(&s_bench_done, "recb", 0, RT_IPC_FLAG_FIFO);
+
+    r = recorder_begin(&s_sim_ops, 0, RT_FALSE);
+    if (r != RT_EOK)
+    {
+        rt_kprintf("start failed (%d)\n", (int)r);
+        rt_sem_detach(&s_bench_done);
+        rt_free(s_sim_img);
+        s_sim_img = RT_NULL;
+        return -1;
+    }
+    rt_uint64_t t0 = timebase_get_us();
+    rt_thread_t tid = rt_thread_create("recb", bench_producer_entry, RT_NULL, 512, STOPWATCH_SERVICE_PRIORITY, 10);
+    if (tid)
+    {
+        rt_thread_startup(tid);
+        rt_sem_take(&s_bench_done, RT_WAITING_FOREVER);
+    }
+    recorder_end();
+    rt_uint32_t us = (rt_uint32_t)(timebase_get_us() - t0);
+    rt_sem_detach(&s_bench_done);
+    if (!tid)
+    {
+        rt_kprintf("no memory\n");
+        rt_free(s_sim_img);
+        s_sim_img = RT_NULL;
+        return -1;
+    }
+
+    rt_uint32_t got = bench_verify(n, &ok);
+    rt_kprintf("sw_rec bench: %u laps, period %u ms, sink delay %u ms/write, %u us\n", (unsigned)n,
+               (unsigned)period_ms, (unsigned)delay_ms, (unsigned)us);
+    print_stats(&s_stats);
+    rt_kprintf("file %u B, sink %u B/s while writing, %u B/s sustained\n", (unsigned)s_sim_len,
+               s_stats.write_us ? (unsigned)((rt_uint64_t)s_stats.bytes * 1000000ULL / s_stats.write_us) : 0,
+               us ? (unsigned)((rt_uint64_t)s_sim_len * 1000000ULL / us) : 0);
+    rt_kprintf("push (stopwatch side): max %u cyc, avg %u cyc\n", (unsigned)s_bench_max_cyc,
+               (unsigned)(s_bench_sum_cyc / (n + 1)));
+    rt_kprintf("verify: %u records in order -> %s\n", (unsigned)got, (ok && s_stats.dropped == 0) ? "PASS" : "FAIL");
+    rt_free(s_sim_img);
+    s_sim_img = RT_NULL;
+    return (ok && s_stats.dropped == 0) ? 0 : -1;
+}
+
+static int cmd_sw_rec(int argc, char **argv)
+{
+    const char *sub = (argc >= 2) ? argv[1] : "stat";
+
+    if (!strcmp(sub, "on"))
+    {
+        rt_err_t r = session_recorder_start((argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 0);
+        if (r == -RT_ENOSYS) rt_kprintf("no filesystem (needs RT_USING_DFS + RT_USING_DFS_ELMFAT)\n");
+        else if (r != RT_EOK) rt_kprintf("start failed (%d)\n", (int)r);
+        return (r == RT_EOK) ? 0 : -1;
+    }
+    if (!strcmp(sub, "off"))
+    {
+        session_recorder_stop();
+        return 0;
+    }
+    if (!strcmp(sub, "bench"))
+    {
+        return recorder_bench((argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 240,
+                              (argc >= 4) ? (rt_uint32_t)atoi(argv[3]) : 20,
+                              (argc >= 5) ? (rt_uint32_t)atoi(argv[4]) : 2);
+    }
+    if (!strcmp(sub, "stat"))
+    {
+        rt_kprintf("recorder %s, backend %s, sample %u ms, file %s\n", s_active ? "on" : "off",
+                   SESSION_RECORDER_USING_DFS ? "dfs/elm" : "none", (unsigned)s_sample_ms, s_open ? "open" : "closed");
+        print_stats(&s_stats);
+        return 0;
+    }
+    rt_kprintf("usage: sw_rec on [sample_ms]|off|stat|bench [laps] [sink_delay_ms] [period_ms]\n");
+    return -1;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_rec, sw_rec, Session_recorder_to_file);
@@ -0,0 +1,133 @@
+#ifndef APPLICATIONS_SESSION_RECORDER_H_
+#define APPLICATIONS_SESSION_RECORDER_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 会话记录器（可选）：把每个事件（开始/暂停/圈速/复位）与可选的周期采样写成定长二进制记录文件，
+ * 不受 20 圈上限限制。秒表服务线程的同步回调只把 16 字节记录拷进环形队列（关中断几条指令、无 IPC），
+ * 后台线程 `swrec` 凑满整扇区批量写入、按块预分配文件长度，暂停/复位时补齐扇区并 fsync，复位时关闭文件。
+ * 存储后端为接口：实机经 DFS + elmfat（SD 卡），模拟/基准用 RAM 磁盘映像并可注入写延迟。 */
+
+#ifndef SESSION_RECORDER_PRIORITY
+#define SESSION_RECORDER_PRIORITY       21
+#endif
+/* elmfat 写路径（f_write/f_sync）栈占用较大 */
+#ifndef SESSION_RECORDER_STACK
+#define SESSION_RECORDER_STACK          1536
+#endif
+/* 环形队列记录数（2 的幂），只在记录期间分配 */
+#ifndef SESSION_RECORDER_RING
+#define SESSION_RECORDER_RING           64
+#endif
+#define SESSION_RECORDER_SECTOR         512
+/* 每次批量写入的扇区数 */
+#ifndef SESSION_RECORDER_BATCH_SECTORS
+#define SESSION_RECORDER_BATCH_SECTORS  2
+#endif
+/* 文件预分配步长（字节，扇区整数倍），写到末尾时再扩展一步 */
+#ifndef SESSION_RECORDER_PREALLOC
+#define SESSION_RECORDER_PREALLOC       (64 * 1024)
+#endif
+/* 后台线程轮询队列的周期，以及无暂停/复位时的定期 fsync 周期 */
+#ifndef SESSION_RECORDER_POLL_MS
+#define SESSION_RECORDER_POLL_MS        50
+#endif
+#ifndef SESSION_RECORDER_SYNC_MS
+#define SESSION_RECORDER_SYNC_MS        10000
+#endif
+/* DFS 后端：文件目录与未挂载时尝试挂载的块设备（drv_sdio 注册为 sd0） */
+#ifndef SESSION_RECORDER_DIR
+#define SESSION_RECORDER_DIR            "/rec"
+#endif
+#ifndef SESSION_RECORDER_BLKDEV
+#define SESSION_RECORDER_BLKDEV         "sd0"
+#endif
+/* 基准用 RAM 磁盘映像容量（字节） */
+#ifndef SESSION_RECORDER_SIM_IMAGE
+#define SESSION_RECORDER_SIM_IMAGE      4096
+#endif
+
+#if (SESSION_RECORDER_RING & (SESSION_RECORDER_RING - 1)) != 0
+#error "SESSION_RECORDER_RING must be a power of 2"
+#endif
+
+/* 文件格式（小端）：首条为文件头，其后为 16 字节记录；未写满的末扇区以 0xFF 填充（掉电时可能残留） */
+#define REC_FILE_MAGIC                  0x31435253UL    /* "SRC1" */
+#define REC_FILE_VERSION                1
+
+enum
+{
+    REC_TYPE_START = 1,
+    REC_TYPE_STOP,
+    REC_TYPE_LAP,               /* value=圈时 ms */
+    REC_TYPE_RESET,             /* 会话结束，文件随之关闭；value=结束时总用时 */
+    REC_TYPE_CLEAR_LAPS,
+    REC_TYPE_RESTORE,           /* 开机从检查点恢复 */
+    REC_TYPE_SAMPLE,            /* 周期采样 */
+    REC_TYPE_HEADER = 0x80,
+    REC_TYPE_PAD = 0xFF,
+};
+
+typedef struct
+{
+    rt_uint8_t  type;
+    rt_uint8_t  state;          /* 事件后的秒表状态 */
+    rt_uint16_t lap_idx;        /* LAP 为圈序号，其他为已记录圈数 */
+    rt_uint32_t t_ms;           /* 相对文件头 t0_ms */
+    rt_uint32_t total_ms;       /* 事件时刻的总用时 */
+    rt_uint32_t value;
+} rec_record_t;
+
+typedef struct
+{
+    rt_uint8_t  type;           /* REC_TYPE_HEADER */
+    rt_uint8_t  version;
+    rt_uint16_t rec_size;       /* 16 */
+    rt_uint32_t magic;
+    rt_uint32_t start_rtc;      /* 备份域 RTC 秒，0 为未知 */
+    rt_uint32_t t0_ms;          /* 开机以来 ms */
+} rec_header_t;
+
+/* 存储后端，与 kv_flash_ops_t 一样无上下文参数（同一时刻只有一个记录文件） */
+typedef struct
+{
+    rt_err_t (*open)(const char *name);
+    rt_err_t (*reserve)(rt_uint32_t size);                      /* 预分配到 size 字节 */
+    rt_err_t (*write)(rt_uint32_t off, const void *buf, rt_size_t len);   /* off/len 为扇区整数倍 */
+    rt_err_t (*sync)(void);
+    rt_err_t (*close)(rt_uint32_t length);                      /* 截断到实际长度并关闭 */
+} rec_sink_ops_t;
+
+typedef struct
+{
+    rt_uint32_t records;        /* 已写入文件的记录 */
+    rt_uint32_t dropped;        /* 队满丢弃 */
+    rt_uint32_t ring_high;      /* 队列最高占用 */
+    rt_uint32_t writes;         /* 批量写入次数 */
+    rt_uint32_t bytes;          /* 写入字节（含重写的末扇区） */
+    rt_uint32_t syncs;
+    rt_uint32_t files;
+    rt_uint32_t errors;
+    rt_uint32_t write_us;       /* 写入累计耗时 */
+    rt_uint32_t max_write_us;   /* 单次写入最长耗时 */
+} rec_stats_t;
+
+/* 订阅秒表事件（不分配缓冲，不创建线程）；须在 event_bus_init 之后 */
+rt_err_t  session_recorder_init(void);
+/* 开始记录（分配队列与批缓冲、创建 swrec 线程）；sample_ms 为 0 时只记事件。
+ * 未开启 DFS + elmfat 时返回 -RT_ENOSYS */
+rt_err_t  session_recorder_start(rt_uint32_t sample_ms);
+/* 停止记录：写完队列、关闭文件并释放缓冲 */
+void      session_recorder_stop(void);
+rt_bool_t session_recorder_active(void);
+void      session_recorder_get_stats(rec_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_SESSION_RECORDER_H_ */
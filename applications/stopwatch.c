@@ -1,40 +1,349 @@
 #include "stopwatch.h"
 #include <rtdevice.h>
+#include <finsh.h>
 #include <stdlib.h>
 #include <string.h>
+#include "board.h"
 #include "timebase.h"
+#include "event_bus.h"
 
 #define DBG_TAG "sw"
 #define DBG_LVL DBG_INFO
 #include <rtdbg.h>
 
+/* 命令经消息队列交给单一服务线程按批处理，服务线程是唯一写者；
+ * 读者通过序号锁（seqlock）拷贝一致的快照，永不阻塞在互斥量上。
+ * STOPWATCH_USING_SERVICE=0 时退化为调用方在互斥量内直接执行（旧行为），发布期间关中断。 */
+
+typedef enum
+{
+    SW_CMD_START = 0,
+    SW_CMD_STOP,
+    SW_CMD_LAP,
+    SW_CMD_RESET,
+    SW_CMD_CLEAR,
+    SW_CMD_NOP,         /* 仅用于吞吐基准 */
+    SW_CMD_RESTORE,     /* 开机恢复检查点，快照经 reply 传入 */
+} sw_cmd_t;
+
 typedef struct
 {
-    stopwatch_state_t state;
-    rt_tick_t         state_start_tick;   /* 最近一次 start 的 tick */
-    rt_uint32_t       accumulated_ms;     /* 历史累计毫秒（不含本次运行段） */
+    struct rt_semaphore done;
+    rt_err_t            err;
+    rt_uint32_t         lap_ms;
+    const stopwatch_snapshot_t *restore;
+} sw_reply_t;
 
-    rt_uint64_t       state_start_us;     /* 最近一次 start 的 us 基准（高精度） */
+typedef struct
+{
+    rt_uint8_t   cmd;
+    rt_uint32_t  order;     /* 入队序号，同一时间戳下保持先后 */
+    rt_uint64_t  t_us;      /* 调用方捕获的时间戳 */
+    sw_reply_t  *reply;     /* 需要结果时非空（仅线程上下文） */
+} sw_msg_t;
 
-    rt_uint32_t       last_lap_total_ms;  /* 上一次 lap 时的累计毫秒 */
-    rt_uint32_t       lap_durations_ms[STOPWATCH_MAX_LAPS];
-    rt_uint16_t       lap_count;
+static stopwatch_snapshot_t g_sw;           /* 发布区，仅写者修改 */
+static volatile rt_uint32_t g_snap_seq = 0; /* 奇数表示正在写 */
+static rt_uint8_t g_inited = 0;
+static rt_uint8_t g_restored = 0;           /* 开机第一条命令是恢复 */
+static volatile rt_uint32_t g_order = 0;
+static stopwatch_service_stats_t g_stats;
 
-    rt_mutex_t        lock;
-} stopwatch_ctx_t;
+#if STOPWATCH_USING_SERVICE
+static struct rt_messagequeue g_sw_mq;
+static rt_uint8_t g_sw_mq_pool[STOPWATCH_MQ_DEPTH * (RT_ALIGN(sizeof(sw_msg_t), RT_ALIGN_SIZE) + sizeof(void *))];
+static rt_thread_t g_sw_thread;
+#else
+static rt_mutex_t g_sw_lock;
+#endif
 
-static stopwatch_ctx_t g_sw;
-static rt_uint8_t g_inited = 0;
+/* ================== 快照读写 ================== */
+static void snap_write_begin(void)
+{
+    g_snap_seq++;
+    __DMB();
+}
 
-static rt_uint32_t get_now_total_ms_unsafe(void)
+static void snap_write_end(void)
 {
-    if (g_sw.state == STOPWATCH_STATE_RUNNING && g_sw.state_start_us != 0)
+    __DMB();
+    g_snap_seq++;
+}
+
+/* 读者在服务线程之下的优先级运行，重试只发生在被一次发布打断时；
+ * 无服务线程时发布在关中断下完成，读者看不到奇数序号 */
+#define SNAP_READ(stmt)                                     \
+    do {                                                    \
+        rt_uint32_t _s;                                     \
+        do {                                                \
+            while ((_s = g_snap_seq) & 1U) rt_thread_yield(); \
+            __DMB();                                        \
+            stmt;                                           \
+            __DMB();                                        \
+        } while (_s != g_snap_seq);                         \
+    } while (0)
+
+rt_uint32_t stopwatch_snapshot_total_ms(const stopwatch_snapshot_t *s, rt_uint64_t t_us)
+{
+    if (s->state == STOPWATCH_STATE_RUNNING && s->state_start_us != 0)
     {
-        uint64_t now_us = timebase_get_us();
-        uint64_t delta_us = now_us - g_sw.state_start_us;
-        return g_sw.accumulated_ms + (rt_uint32_t)(delta_us / 1000ULL);
+        uint64_t delta_us = (t_us > s->state_start_us) ? (t_us - s->state_start_us) : 0;
+        return s->accumulated_ms + (rt_uint32_t)(delta_us / 1000ULL);
+    }
+    return s->accumulated_ms;
+}
+
+void stopwatch_get_snapshot(stopwatch_snapshot_t *out)
+{
+    SNAP_READ(memcpy(out, &g_sw, sizeof(*out)));
+}
+
+/* ================== 命令执行（仅写者） ================== */
+/* 执行一条命令；产生事件时填写 ev 并返回 1（事件在快照发布后统一发出） */
+static int apply_cmd(const sw_msg_t *m, event_t *ev)
+{
+    int has_ev = 0;
+    ev->t_us = m->t_us;
+    ev->index = 0;
+    ev->topic = EVT_STATE_CHANGED;
+
+    switch (m->cmd)
+    {
+    case SW_CMD_START:
+        if (g_sw.state != STOPWATCH_STATE_RUNNING)
+        {
+            g_sw.state_start_us = m->t_us;
+            g_sw.state = STOPWATCH_STATE_RUNNING;
+            ev->code = EVT_CAUSE_START;
+            has_ev = 1;
+        }
+        break;
+    case SW_CMD_STOP:
+        if (g_sw.state == STOPWATCH_STATE_RUNNING)
+        {
+            if (g_sw.state_start_us != 0)
+            {
+                g_sw.accumulated_ms = stopwatch_snapshot_total_ms(&g_sw, m->t_us);
+                g_sw.state_start_us = 0;
+            }
+            g_sw.state = STOPWATCH_STATE_PAUSED;
+            ev->code = EVT_CAUSE_STOP;
+            has_ev = 1;
+        }
+        break;
+    case SW_CMD_LAP:
+    {
+        rt_uint32_t total_ms = stopwatch_snapshot_total_ms(&g_sw, m->t_us);
+        if (total_ms < g_sw.last_lap_total_ms)
+        {
+            /* 捕获时间早于上一圈（多个来源交错），按 0 处理，不回退圈起点 */
+            total_ms = g_sw.last_lap_total_ms;
+        }
+        rt_uint32_t lap_ms = total_ms - g_sw.last_lap_total_ms;
+
+        if (g_sw.lap_count < STOPWATCH_MAX_LAPS)
+        {
+            g_sw.lap_durations_ms[g_sw.lap_count] = lap_ms;
+            g_sw.lap_count++;
+        }
+        else
+        {
+            /* 达到上限，丢弃最早一圈，右移 */
+            memmove(&g_sw.lap_durations_ms[0], &g_sw.lap_durations_ms[1], sizeof(rt_uint32_t) * (STOPWATCH_MAX_LAPS - 1));
+            g_sw.lap_durations_ms[STOPWATCH_MAX_LAPS - 1] = lap_ms;
+        }
+        g_sw.last_lap_total_ms = total_ms;
+        g_sw.lap_total++;
+        if (m->reply) { m->reply->lap_ms = lap_ms; }
+        ev->topic = EVT_LAP_RECORDED;
+        ev->index = (rt_uint16_t)g_sw.lap_total;
+        ev->value = lap_ms;
+        has_ev = 1;
+        break;
+    }
+    case SW_CMD_RESET:
+        g_sw.accumulated_ms = 0;
+        g_sw.last_lap_total_ms = 0;
+        g_sw.lap_count = 0;
+        g_sw.lap_total = 0;
+        memset(g_sw.lap_durations_ms, 0, sizeof(g_sw.lap_durations_ms));
+        if (g_sw.state == STOPWATCH_STATE_RUNNING)
+        {
+            g_sw.state_start_us = m->t_us;
+        }
+        else
+        {
+            g_sw.state = STOPWATCH_STATE_IDLE;
+            g_sw.state_start_us = 0;
+        }
+        ev->code = EVT_CAUSE_RESET;
+        has_ev = 1;
+        break;
+    case SW_CMD_CLEAR:
+        g_sw.lap_count = 0;
+        g_sw.last_lap_total_ms = stopwatch_snapshot_total_ms(&g_sw, m->t_us);
+        memset(g_sw.lap_durations_ms, 0, sizeof(g_sw.lap_durations_ms));
+        ev->code = EVT_CAUSE_CLEAR_LAPS;
+        has_ev = 1;
+        break;
+    case SW_CMD_RESTORE:
+    {
+        const stopwatch_snapshot_t *r = m->reply ? m->reply->restore : RT_NULL;
+        /* 已由备份寄存器恢复且其后无其他命令：检查点与之对得上时只补圈速环，状态与总用时以先恢复的为准 */
+        if (r && g_restored && g_sw.seq == 1 && g_sw.lap_count == 0 && r->lap_total == g_sw.lap_total &&
+            r->last_lap_total_ms == g_sw.last_lap_total_ms)
+        {
+            g_sw.lap_count = (r->lap_count < STOPWATCH_MAX_LAPS) ? r->lap_count : STOPWATCH_MAX_LAPS;
+            memcpy(g_sw.lap_durations_ms, r->lap_durations_ms, sizeof(g_sw.lap_durations_ms));
+            break;
+        }
+        /* 只在开机后尚未处理任何命令时生效：恢复完成前用户已操作，则以用户操作为准 */
+        if (!r || g_sw.seq != 0)
+        {
+            if (m->reply) m->reply->err = -RT_EBUSY;
+            break;
+        }
+        g_restored = 1;
+        g_sw.state = r->state;
+        g_sw.accumulated_ms = r->accumulated_ms;
+        g_sw.state_start_us = (r->state == STOPWATCH_STATE_RUNNING) ? m->t_us : 0;
+        g_sw.last_lap_total_ms = r->last_lap_total_ms;
+        g_sw.lap_count = (r->lap_count < STOPWATCH_MAX_LAPS) ? r->lap_count : STOPWATCH_MAX_LAPS;
+        memcpy(g_sw.lap_durations_ms, r->lap_durations_ms, sizeof(g_sw.lap_durations_ms));
+        g_sw.lap_total = r->lap_total;
+        ev->code = EVT_CAUSE_RESTORE;
+        has_ev = 1;
+        break;
+    }
+    default:
+        break;
+    }
+    if (ev->topic == EVT_STATE_CHANGED) ev->value = (rt_uint32_t)g_sw.state;
+    g_sw.seq++;
+    return has_ev;
+}
+
+/* 一批命令在同一次发布内生效：按捕获时间排序（同刻按入队序），保证多来源并发时顺序确定 */
+static void apply_batch(sw_msg_t *batch, rt_size_t n)
+{
+    for (rt_size_t i = 1; i < n; i++)
+    {
+        sw_msg_t m = batch[i];
+        rt_size_t j = i;
+        while (j > 0 && (batch[j - 1].t_us > m.t_us ||
+                         (batch[j - 1].t_us == m.t_us && (rt_int32_t)(batch[j - 1].order - m.order) > 0)))
+        {
+            batch[j] = batch[j - 1];
+            j--;
+        }
+        batch[j] = m;
+    }
+
+    event_t evs[STOPWATCH_BATCH_MAX];
+    rt_size_t nev = 0;
+
+    for (rt_size_t i = 0; i < n; i++)
+    {
+        if (batch[i].reply) batch[i].reply->err = RT_EOK;
+    }
+
+#if !STOPWATCH_USING_SERVICE
+    /* 写者是任意优先级的调用线程：若允许被抢占，高优先级读者会在奇数序号上让出 CPU 却永远等不到低优先级写者 */
+    rt_base_t level = rt_hw_interrupt_disable();
+#endif
+    snap_write_begin();
+    for (rt_size_t i = 0; i < n; i++)
+    {
+        if (apply_cmd(&batch[i], &evs[nev])) nev++;
+    }
+    snap_write_end();
+#if !STOPWATCH_USING_SERVICE
+    rt_hw_interrupt_enable(level);
+#endif
+
+    /* 快照已发布，订阅者读到的是新状态 */
+    for (rt_size_t i = 0; i < nev; i++)
+    {
+        event_bus_publish(&evs[i]);
+    }
+
+    g_stats.batches++;
+    g_stats.commands += n;
+    if (n > g_stats.max_batch) g_stats.max_batch = n;
+
+    for (rt_size_t i = 0; i < n; i++)
+    {
+        if (batch[i].reply)
+        {
+            rt_sem_release(&batch[i].reply->done);
+        }
+    }
+}
+
+#if STOPWATCH_USING_SERVICE
+static void stopwatch_service_entry(void *parameter)
+{
+    (void)parameter;
+    sw_msg_t batch[STOPWATCH_BATCH_MAX];
+    while (1)
+    {
+        rt_size_t n = 0;
+        if (rt_mq_recv(&g_sw_mq, &batch[n], sizeof(sw_msg_t), RT_WAITING_FOREVER) != RT_EOK)
+        {
+            continue;
+        }
+        n++;
+        while (n < STOPWATCH_BATCH_MAX && rt_mq_recv(&g_sw_mq, &batch[n], sizeof(sw_msg_t), 0) == RT_EOK)
+        {
+            n++;
+        }
+        apply_batch(batch, n);
+    }
+}
+#endif
+
+/* 提交命令：服务模式下只入队，队满返回 -RT_EFULL 而不等待 */
+static rt_err_t sw_submit(rt_uint8_t cmd, rt_uint64_t t_us, sw_reply_t *reply)
+{
+    if (!g_inited) { rt_err_t r = stopwatch_init(); if (r != RT_EOK) return r; }
+
+    sw_msg_t m;
+    m.cmd = cmd;
+    m.t_us = t_us;
+    m.reply = reply;
+    rt_base_t level = rt_hw_interrupt_disable();
+    m.order = g_order++;
+    rt_hw_interrupt_enable(level);
+
+#if STOPWATCH_USING_SERVICE
+    if (rt_mq_send(&g_sw_mq, &m, sizeof(m)) != RT_EOK)
+    {
+        g_stats.dropped++;
+        return -RT_EFULL;
     }
-    return g_sw.accumulated_ms;
+    return RT_EOK;
+#else
+    rt_mutex_take(g_sw_lock, RT_WAITING_FOREVER);
+    apply_batch(&m, 1);
+    rt_mutex_release(g_sw_lock);
+    return RT_EOK;
+#endif
+}
+
+/* 需要结果的命令（如返回本圈用时）：入队后等待本命令被处理 */
+static rt_err_t sw_submit_wait(rt_uint8_t cmd, rt_uint64_t t_us, sw_reply_t *reply)
+{
+    rt_err_t r;
+    rt_sem_init(&reply->done, "swrep", 0, RT_IPC_FLAG_FIFO);
+    reply->err = -RT_ERROR;
+    r = sw_submit(cmd, t_us, reply);
+    if (r == RT_EOK)
+    {
+        rt_sem_take(&reply->done, RT_WAITING_FOREVER);
+        r = reply->err;
+    }
+    rt_sem_detach(&reply->done);
+    return r;
 }
 
 rt_err_t stopwatch_init(void)
@@ -45,13 +354,30 @@ rt_err_t stopwatch_init(void)
     }
     memset(&g_sw, 0, sizeof(g_sw));
     g_sw.state = STOPWATCH_STATE_IDLE;
-    g_sw.lock = rt_mutex_create("swlock", RT_IPC_FLAG_PRIO);
-    if (!g_sw.lock)
+    timebase_init();
+
+#if STOPWATCH_USING_SERVICE
+    rt_err_t ret = rt_mq_init(&g_sw_mq, "swcmd", g_sw_mq_pool, sizeof(sw_msg_t),
+                              sizeof(g_sw_mq_pool), RT_IPC_FLAG_FIFO);
+    if (ret != RT_EOK)
+    {
+        return ret;
+    }
+    g_sw_thread = rt_thread_create("swsvc", stopwatch_service_entry, RT_NULL, 768, STOPWATCH_SERVICE_PRIORITY, 5);
+    if (!g_sw_thread)
     {
+        rt_mq_detach(&g_sw_mq);
         return -RT_ENOMEM;
     }
+    rt_thread_startup(g_sw_thread);
+#else
+    g_sw_lock = rt_mutex_create("swlock", RT_IPC_FLAG_PRIO);
+    if (!g_sw_lock)
+    {
+        return -RT_ENOMEM;
+    }
+#endif
 
-    timebase_init();
     g_inited = 1;
     /* 初始化日志可去除以节省ROM */
     return RT_EOK;
@@ -59,143 +385,181 @@ rt_err_t stopwatch_init(void)
 
 void stopwatch_start(void)
 {
-    if (!g_inited) { if (stopwatch_init() != RT_EOK) return; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    if (g_sw.state == STOPWATCH_STATE_RUNNING)
-    {
-        rt_mutex_release(g_sw.lock);
-        return;
-    }
-    g_sw.state_start_tick = rt_tick_get();
-    g_sw.state_start_us = timebase_get_us();
-    g_sw.state = STOPWATCH_STATE_RUNNING;
-    rt_mutex_release(g_sw.lock);
+    stopwatch_start_at(timebase_get_us());
+}
+
+void stopwatch_start_at(rt_uint64_t t_us)
+{
+    sw_submit(SW_CMD_START, t_us, RT_NULL);
 }
 
 void stopwatch_stop(void)
 {
-    if (!g_inited) { if (stopwatch_init() != RT_EOK) return; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    if (g_sw.state == STOPWATCH_STATE_RUNNING)
-    {
-        if (g_sw.state_start_us != 0)
-        {
-            uint64_t now_us = timebase_get_us();
-            g_sw.accumulated_ms += (rt_uint32_t)((now_us - g_sw.state_start_us) / 1000ULL);
-            g_sw.state_start_us = 0;
-        }
-        g_sw.state = STOPWATCH_STATE_PAUSED;
-    }
-    rt_mutex_release(g_sw.lock);
+    stopwatch_stop_at(timebase_get_us());
+}
+
+void stopwatch_stop_at(rt_uint64_t t_us)
+{
+    sw_submit(SW_CMD_STOP, t_us, RT_NULL);
 }
 
 void stopwatch_reset(void)
 {
-    if (!g_inited) { if (stopwatch_init() != RT_EOK) return; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    g_sw.accumulated_ms = 0;
-    g_sw.last_lap_total_ms = 0;
-    g_sw.lap_count = 0;
-    memset(g_sw.lap_durations_ms, 0, sizeof(g_sw.lap_durations_ms));
-    if (g_sw.state == STOPWATCH_STATE_RUNNING)
-    {
-        g_sw.state_start_tick = rt_tick_get();
-        g_sw.state_start_us = timebase_get_us();
-    }
-    else
-    {
-        g_sw.state = STOPWATCH_STATE_IDLE;
-        g_sw.state_start_us = 0;
-    }
-    rt_mutex_release(g_sw.lock);
+    sw_submit(SW_CMD_RESET, timebase_get_us(), RT_NULL);
 }
 
 rt_err_t stopwatch_lap(rt_uint32_t *out_lap_ms)
 {
-    if (!g_inited) { rt_err_t r = stopwatch_init(); if (r != RT_EOK) return r; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    rt_uint32_t total_ms = get_now_total_ms_unsafe();
-    rt_uint32_t lap_ms = total_ms - g_sw.last_lap_total_ms;
+    return stopwatch_lap_at(timebase_get_us(), out_lap_ms);
+}
 
-    if (g_sw.lap_count < STOPWATCH_MAX_LAPS)
-    {
-        g_sw.lap_durations_ms[g_sw.lap_count] = lap_ms;
-        g_sw.lap_count++;
-    }
-    else
+rt_err_t stopwatch_lap_at(rt_uint64_t t_us, rt_uint32_t *out_lap_ms)
+{
+    if (!out_lap_ms)
     {
-        /* 达到上限，丢弃最早一圈，右移 */
-        memmove(&g_sw.lap_durations_ms[0], &g_sw.lap_durations_ms[1], sizeof(rt_uint32_t) * (STOPWATCH_MAX_LAPS - 1));
-        g_sw.lap_durations_ms[STOPWATCH_MAX_LAPS - 1] = lap_ms;
+        return sw_submit(SW_CMD_LAP, t_us, RT_NULL);
     }
-    g_sw.last_lap_total_ms = total_ms;
+    sw_reply_t reply;
+    rt_err_t r = sw_submit_wait(SW_CMD_LAP, t_us, &reply);
+    if (r == RT_EOK) { *out_lap_ms = reply.lap_ms; }
+    return r;
+}
 
-    if (out_lap_ms) { *out_lap_ms = lap_ms; }
-    rt_mutex_release(g_sw.lock);
-    return RT_EOK;
+rt_err_t stopwatch_restore(const stopwatch_snapshot_t *snap)
+{
+    if (!snap) return -RT_EINVAL;
+    sw_reply_t reply;
+    reply.restore = snap;
+    return sw_submit_wait(SW_CMD_RESTORE, timebase_get_us(), &reply);
+}
+
+void stopwatch_clear_laps(void)
+{
+    if (!g_inited) return;
+    sw_submit(SW_CMD_CLEAR, timebase_get_us(), RT_NULL);
 }
 
 stopwatch_state_t stopwatch_get_state(void)
 {
-    if (!g_inited) { return STOPWATCH_STATE_IDLE; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    stopwatch_state_t s = g_sw.state;
-    rt_mutex_release(g_sw.lock);
+    stopwatch_state_t s;
+    SNAP_READ(s = g_sw.state);
     return s;
 }
 
 rt_uint32_t stopwatch_get_total_ms(void)
 {
-    if (!g_inited) { return 0; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    rt_uint32_t v = get_now_total_ms_unsafe();
-    rt_mutex_release(g_sw.lock);
-    return v;
+    stopwatch_state_t state;
+    rt_uint32_t acc;
+    rt_uint64_t start_us;
+    SNAP_READ(state = g_sw.state; acc = g_sw.accumulated_ms; start_us = g_sw.state_start_us);
+    if (state == STOPWATCH_STATE_RUNNING && start_us != 0)
+    {
+        uint64_t now_us = timebase_get_us();
+        uint64_t delta_us = (now_us > start_us) ? (now_us - start_us) : 0;
+        return acc + (rt_uint32_t)(delta_us / 1000ULL);
+    }
+    return acc;
 }
 
 rt_uint16_t stopwatch_get_lap_count(void)
 {
-    if (!g_inited) { return 0; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    rt_uint16_t c = g_sw.lap_count;
-    rt_mutex_release(g_sw.lock);
+    rt_uint16_t c;
+    SNAP_READ(c = g_sw.lap_count);
     return c;
 }
 
 rt_uint32_t stopwatch_get_lap_ms(rt_uint16_t index)
 {
-    if (!g_inited) { return 0; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    rt_uint32_t v = 0;
-    if (index < g_sw.lap_count)
-    {
-        v = g_sw.lap_durations_ms[index];
-    }
-    rt_mutex_release(g_sw.lock);
+    rt_uint32_t v;
+    SNAP_READ(v = (index < g_sw.lap_count) ? g_sw.lap_durations_ms[index] : 0);
     return v;
 }
 
 rt_uint32_t stopwatch_get_latest_lap_ms(void)
 {
-    if (!g_inited) { return 0; }
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    rt_uint32_t v = 0;
-    if (g_sw.lap_count > 0)
-    {
-        v = g_sw.lap_durations_ms[g_sw.lap_count - 1];
-    }
-    rt_mutex_release(g_sw.lock);
+    rt_uint32_t v;
+    SNAP_READ(v = (g_sw.lap_count > 0) ? g_sw.lap_durations_ms[g_sw.lap_count - 1] : 0);
     return v;
 }
 
-void stopwatch_clear_laps(void)
+void stopwatch_get_service_stats(stopwatch_service_stats_t *out)
 {
-    if (!g_inited) return;
-    rt_mutex_take(g_sw.lock, RT_WAITING_FOREVER);
-    g_sw.lap_count = 0;
-    g_sw.last_lap_total_ms = get_now_total_ms_unsafe();
-    memset(g_sw.lap_durations_ms, 0, sizeof(g_sw.lap_durations_ms));
-    rt_mutex_release(g_sw.lock);
+    *out = g_stats;
 }
 
+#if STOPWATCH_USING_SERVICE
+/* ================== 吞吐基准 ==================
+ * 多个生产者线程并发投递 NOP 命令（走完整入队/批处理/发布路径但不改秒表状态），
+ * 报告每秒处理命令数与平均批大小。用法：sw_svc_bench [producers] [cmds_per_producer] */
+#define BENCH_MAX_PRODUCERS 8
 
+static struct rt_semaphore s_bench_done;
+static rt_uint32_t s_bench_per;
+static volatile rt_uint32_t s_bench_retries;
+
+static void bench_producer_entry(void *parameter)
+{
+    (void)parameter;
+    for (rt_uint32_t i = 0; i < s_bench_per; i++)
+    {
+        while (sw_submit(SW_CMD_NOP, timebase_get_us(), RT_NULL) != RT_EOK)
+        {
+            s_bench_retries++;
+            rt_thread_yield();
+        }
+    }
+    rt_sem_release(&s_bench_done);
+}
+
+static int cmd_sw_svc_bench(int argc, char **argv)
+{
+    rt_uint32_t producers = (argc >= 2) ? (rt_uint32_t)atoi(argv[1]) : 4U;
+    rt_uint32_t per = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : 1000U;
+    if (producers < 1) producers = 1;
+    if (producers > BENCH_MAX_PRODUCERS) producers = BENCH_MAX_PRODUCERS;
+    if (per < 1) per = 1;
+
+    if (stopwatch_init() != RT_EOK) return -RT_ERROR;
+
+    stopwatch_service_stats_t before = g_stats;
+    rt_uint32_t seq0;
+    SNAP_READ(seq0 = g_sw.seq);
+    rt_uint32_t target = seq0 + producers * per;
+
+    s_bench_per = per;
+    s_bench_retries = 0;
+    rt_sem_init(&s_bench_done, "swbch", 0, RT_IPC_FLAG_FIFO);
+
+    rt_uint64_t t0 = timebase_get_us();
+    rt_uint32_t started = 0;
+    for (rt_uint32_t i = 0; i < producers; i++)
+    {
+        rt_thread_t t = rt_thread_create("swprod", bench_producer_entry, RT_NULL, 512, 15, 2);
+        if (t) { rt_thread_startup(t); started++; }
+    }
+    for (rt_uint32_t i = 0; i < started; i++)
+    {
+        rt_sem_take(&s_bench_done, RT_WAITING_FOREVER);
+    }
+    target = seq0 + started * per;
+    rt_uint32_t seq;
+    do
+    {
+        SNAP_READ(seq = g_sw.seq);
+        if ((rt_int32_t)(seq - target) < 0) rt_thread_mdelay(1);
+    } while ((rt_int32_t)(seq - target) < 0);
+    rt_uint64_t t1 = timebase_get_us();
+    rt_sem_detach(&s_bench_done);
+
+    rt_uint32_t total = started * per;
+    rt_uint32_t batches = g_stats.batches - before.batches;
+    rt_uint64_t us = t1 - t0;
+    rt_kprintf("sw_svc_bench: producers=%u cmds=%u time=%u us\n", (unsigned)started, (unsigned)total, (unsigned)us);
+    rt_kprintf("  throughput: %u cmds/s, batches=%u, avg batch=%u.%02u, max batch=%u, queue-full retries=%u\n",
+               (unsigned)(us ? ((rt_uint64_t)total * 1000000ULL / us) : 0), (unsigned)batches,
+               (unsigned)(batches ? total / batches : 0), (unsigned)(batches ? (total * 100U / batches) % 100U : 0),
+               (unsigned)g_stats.max_batch, (unsigned)s_bench_retries);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_svc_bench, sw_svc_bench, Stopwatch_service_throughput_benchmark);
+#endif
@@ -11,6 +11,22 @@ extern "C" {
 #define STOPWATCH_MAX_LAPS  20
 #endif
 
+/* 1：命令入队由服务线程批处理（默认）；0：调用方在互斥量内直接执行（命令接口只能在线程上下文调用） */
+#ifndef STOPWATCH_USING_SERVICE
+#define STOPWATCH_USING_SERVICE     1
+#endif
+/* 命令队列深度 / 每批最多处理条数 */
+#ifndef STOPWATCH_MQ_DEPTH
+#define STOPWATCH_MQ_DEPTH          16
+#endif
+#ifndef STOPWATCH_BATCH_MAX
+#define STOPWATCH_BATCH_MAX         8
+#endif
+/* 服务线程优先级：高于读者（UI/CLI/LED/软定时器线程），读者拷贝快照时不会被长时间打断 */
+#ifndef STOPWATCH_SERVICE_PRIORITY
+#define STOPWATCH_SERVICE_PRIORITY  3
+#endif
+
 typedef enum
 {
     STOPWATCH_STATE_IDLE = 0,
@@ -18,23 +34,63 @@ typedef enum
     STOPWATCH_STATE_PAUSED = 2,
 } stopwatch_state_t;
 
+/* 秒表状态快照（服务线程每处理完一批命令发布一次） */
+typedef struct
+{
+    stopwatch_state_t state;
+    rt_uint32_t accumulated_ms;      /* 不含当前运行段 */
+    rt_uint64_t state_start_us;      /* 当前运行段起点（timebase us），非运行为 0 */
+    rt_uint32_t last_lap_total_ms;   /* 上一圈结束时的总用时 */
+    rt_uint32_t lap_durations_ms[STOPWATCH_MAX_LAPS];
+    rt_uint16_t lap_count;
+    rt_uint32_t lap_total;           /* 复位以来记录的圈数（含已被覆盖的） */
+    rt_uint32_t seq;                 /* 已处理命令总数 */
+} stopwatch_snapshot_t;
+
+typedef struct
+{
+    rt_uint32_t batches;             /* 已发布批次 */
+    rt_uint32_t commands;            /* 已处理命令 */
+    rt_uint32_t max_batch;           /* 最大批大小 */
+    rt_uint32_t dropped;             /* 队满被拒绝的命令 */
+} stopwatch_service_stats_t;
+
 rt_err_t stopwatch_init(void);
 
 void stopwatch_start(void);
 void stopwatch_stop(void);
 void stopwatch_reset(void);
 
-/* 记录一圈；如 out_lap_ms 非空返回本圈用时 */
+/* 以下命令接口只入队不等待（队满时丢弃并计数），服务模式下可在中断中调用（STOPWATCH_USING_SERVICE=0 时不可）；
+ * 记录一圈时如 out_lap_ms 非空则等待服务线程处理并返回本圈用时（仅线程上下文） */
 rt_err_t stopwatch_lap(rt_uint32_t *out_lap_ms);
 void     stopwatch_clear_laps(void);
 
-/* 查询接口（线程安全，快照） */
+/* 开机恢复（线程上下文，等待服务线程处理）：按快照设置状态、总用时与圈速，运行态从处理时刻继续计时；
+ * 开机后已处理过其他命令时返回 -RT_EBUSY 且不改变状态。
+ * 例外：开机第一条命令是一次不含圈速的恢复（hot_state）且其后无其他命令时，再次调用只补圈速环，
+ * 要求 lap_total 与 last_lap_total_ms 一致，不一致返回 -RT_EBUSY；此时不发布事件 */
+rt_err_t stopwatch_restore(const stopwatch_snapshot_t *snap);
+
+/* 带捕获时间戳的版本（timebase us），用于按键 ISR 等已在事件发生时打点的来源（中断中调用的条件同上）；
+ * 同一批内的命令按捕获时间排序执行；时间戳早于本次运行段起点时按起点处理 */
+void     stopwatch_start_at(rt_uint64_t t_us);
+void     stopwatch_stop_at(rt_uint64_t t_us);
+rt_err_t stopwatch_lap_at(rt_uint64_t t_us, rt_uint32_t *out_lap_ms);
+
+/* 查询接口（线程上下文，读取已发布快照，不加锁） */
 stopwatch_state_t stopwatch_get_state(void);
 rt_uint32_t       stopwatch_get_total_ms(void);
 rt_uint16_t       stopwatch_get_lap_count(void);
 rt_uint32_t       stopwatch_get_lap_ms(rt_uint16_t index);
 rt_uint32_t       stopwatch_get_latest_lap_ms(void);
 
+/* 一次性拷贝完整快照，避免多次查询之间状态变化 */
+void        stopwatch_get_snapshot(stopwatch_snapshot_t *out);
+/* 由快照计算指定时刻的总用时 */
+rt_uint32_t stopwatch_snapshot_total_ms(const stopwatch_snapshot_t *s, rt_uint64_t t_us);
+void        stopwatch_get_service_stats(stopwatch_service_stats_t *out);
+
 #ifdef __cplusplus
 }
 #endif
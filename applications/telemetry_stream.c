@@ -0,0 +1,608 @@
+#include "telemetry_stream.h"
+#include <rthw.h>
+#include <rtdevice.h>
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+#include "crc_service.h"
+#include "stopwatch.h"
+#include "timebase.h"
+
+#define DBG_TAG "tlm"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 遥测流水线：软定时器回调只拍快照写入无锁环形队列（单生产者/单消费者），
+ * 低优先级写线程批量格式化（CSV 文本或二进制帧）到两块缓冲之一，每块一次 rt_device_write 写出。
+ * 定时器线程从不等待串口；串口跟不上时环形队列满，采样被抽稀丢弃，
+ * 丢弃数记在下一条入队记录的 skipped 中，主机亦可由 seq 缺口得出。
+ * 背压：队列占用到达高水位后采样按窗口聚合（min/max/last）为一条记录入队，
+ * 回落到低水位后冲刷未满窗口并恢复逐条输出。 */
+
+#define TLM_RING_MASK   (TELEMETRY_RING_SIZE - 1U)
+#define TLM_LINE_MAX    112
+#define TLM_EVT_DATA    (1U << 0)
+
+#if (TELEMETRY_RING_SIZE & (TELEMETRY_RING_SIZE - 1)) != 0
+#error "TELEMETRY_RING_SIZE must be a power of 2"
+#endif
+#if TELEMETRY_LOW_WATERMARK >= TELEMETRY_HIGH_WATERMARK || TELEMETRY_HIGH_WATERMARK > TELEMETRY_RING_SIZE
+#error "telemetry watermarks must satisfy LOW < HIGH <= RING_SIZE"
+#endif
+
+static telemetry_sample_t s_ring[TELEMETRY_RING_SIZE];
+static volatile rt_uint32_t s_head = 0;    /* 仅定时器回调写 */
+static volatile rt_uint32_t s_tail = 0;    /* 仅写线程写 */
+
+static char s_buf[2][TELEMETRY_BUF_SIZE];
+static rt_uint8_t s_buf_idx = 0;
+static struct rt_semaphore s_buf_free;     /* 空闲缓冲数 */
+static struct rt_event s_tlm_evt;
+
+static rt_device_t s_dev = RT_NULL;
+static rt_thread_t s_writer = RT_NULL;
+static rt_timer_t s_timer = RT_NULL;
+static rt_uint32_t s_period_ms = 200;
+static rt_uint32_t s_seq = 0;
+static rt_uint16_t s_skipped = 0;          /* 尚未随记录报告的丢弃数 */
+static telemetry_sample_t s_win;           /* 聚合窗口（agg_n=0 表示空） */
+static rt_uint64_t s_mode_since_us = 0;    /* 当前模式起始时刻 */
+static telemetry_stats_t s_stats;
+static rt_uint8_t s_inited = 0;
+
+static volatile rt_uint8_t s_mode = TELEMETRY_MODE_CSV;
+static volatile rt_bool_t csv_header = 0;
+static rt_bool_t csv_human = 0; /* 0: ms, 1: human mm:ss.mmm */
+
+/* ================== 无锁环形队列 ================== */
+static int ring_push(const telemetry_sample_t *smp)
+{
+    rt_uint32_t h = s_head;
+    if (h - s_tail >= TELEMETRY_RING_SIZE) return 0;
+    s_ring[h & TLM_RING_MASK] = *smp;
+    __DMB();
+    s_head = h + 1;
+    return 1;
+}
+
+static int ring_peek(telemetry_sample_t *out)
+{
+    rt_uint32_t t = s_tail;
+    if (t == s_head) return 0;
+    __DMB();
+    *out = s_ring[t & TLM_RING_MASK];
+    return 1;
+}
+
+static int ring_pop(telemetry_sample_t *out)
+{
+    rt_uint32_t t = s_tail;
+    if (t == s_head) return 0;
+    __DMB();
+    *out = s_ring[t & TLM_RING_MASK];
+    __DMB();
+    s_tail = t + 1;
+    return 1;
+}
+
+/* ================== 采样（软定时器线程） ================== */
+static void emit_sample(telemetry_sample_t *smp)
+{
+    smp->skipped = s_skipped;
+    if (ring_push(smp))
+    {
+        s_stats.captured++;
+        if (smp->agg_n > 1) s_stats.agg_records++;
+        s_skipped = 0;
+    }
+    else
+    {
+        s_stats.dropped += smp->agg_n;
+        s_skipped = (s_skipped + smp->agg_n > 0xFFFFU) ? 0xFFFFU : (rt_uint16_t)(s_skipped + smp->agg_n);
+    }
+}
+
+static void account_mode(rt_uint64_t now_us)
+{
+    if (s_stats.aggregating) s_stats.agg_us += now_us - s_mode_since_us;
+    else s_stats.full_us += now_us - s_mode_since_us;
+    s_mode_since_us = now_us;
+}
+
+static void set_aggregating(rt_uint8_t on, rt_uint64_t now_us)
+{
+    account_mode(now_us);
+    if (!on && s_win.agg_n)
+    {
+        emit_sample(&s_win);
+        s_win.agg_n = 0;
+    }
+    s_stats.aggregating = on;
+    s_stats.mode_switches++;
+}
+
+static void csv_timer_cb(void *parameter)
+{
+    (void)parameter;
+    static stopwatch_snapshot_t snap;
+    telemetry_sample_t smp;
+
+    stopwatch_get_snapshot(&snap);
+    smp.t_us = timebase_get_us();
+    smp.seq = s_seq++;
+    smp.total_ms = stopwatch_snapshot_total_ms(&snap, smp.t_us);
+    smp.lap_idx = snap.lap_count;
+    smp.lap_ms = (snap.lap_count > 0) ? snap.lap_durations_ms[snap.lap_count - 1] : 0;
+    smp.state = (rt_uint8_t)snap.state;
+    smp.agg_n = 1;
+    smp.min_ms = smp.max_ms = smp.total_ms;
+
+    rt_uint32_t fill = s_head - s_tail;
+    if (!s_stats.aggregating && fill >= TELEMETRY_HIGH_WATERMARK) set_aggregating(1, smp.t_us);
+    else if (s_stats.aggregating && fill <= TELEMETRY_LOW_WATERMARK) set_aggregating(0, smp.t_us);
+
+    if (s_stats.aggregating)
+    {
+        if (s_win.agg_n == 0)
+        {
+            s_win = smp;
+        }
+        else
+        {
+            rt_uint32_t mn = (smp.total_ms < s_win.min_ms) ? smp.total_ms : s_win.min_ms;
+            rt_uint32_t mx = (smp.total_ms > s_win.max_ms) ? smp.total_ms : s_win.max_ms;
+            rt_uint16_t n = s_win.agg_n + 1;
+            s_win = smp;
+            s_win.agg_n = n;
+            s_win.min_ms = mn;
+            s_win.max_ms = mx;
+        }
+        if (s_win.agg_n < TELEMETRY_AGG_WINDOW) return;
+        emit_sample(&s_win);
+        s_win.agg_n = 0;
+    }
+    else
+    {
+        emit_sample(&smp);
+    }
+    rt_event_send(&s_tlm_evt, TLM_EVT_DATA);
+}
+
+/* ================== 格式化与写出（写线程） ================== */
+static void format_time(rt_uint32_t total_ms, char *buf, rt_size_t buf_len)
+{
+    rt_uint32_t ms = total_ms % 1000U;
+    rt_uint32_t sec = (total_ms / 1000U) % 60U;
+    rt_uint32_t min = (total_ms / 60000U) % 60U;
+    rt_uint32_t hr  = (total_ms / 3600000U);
+    if (hr > 0)
+        rt_snprintf(buf, buf_len, "%02u:%02u:%02u.%03u", (unsigned)hr, (unsigned)min, (unsigned)sec, (unsigned)ms);
+    else
+        rt_snprintf(buf, buf_len, "%02u:%02u.%03u", (unsigned)min, (unsigned)sec, (unsigned)ms);
+}
+
+/* rt_kprintf 未开 RT_PRINTF_LONGLONG，64 位 us 时间戳拆成两段打印 */
+static rt_size_t format_u64(char *buf, rt_size_t size, rt_uint64_t v)
+{
+    rt_uint32_t hi = (rt_uint32_t)(v / 1000000000ULL);
+    rt_uint32_t lo = (rt_uint32_t)(v % 1000000000ULL);
+    if (hi) return rt_snprintf(buf, size, "%u%09u", (unsigned)hi, (unsigned)lo);
+    return rt_snprintf(buf, size, "%u", (unsigned)lo);
+}
+
+/* seq,t_us,lap_idx,lap_ms,total,skipped；聚合记录追加 ,n,min,max */
+static rt_size_t format_record(char *buf, rt_size_t size, const telemetry_sample_t *smp)
+{
+    char ub[24];
+    rt_size_t len;
+    format_u64(ub, sizeof(ub), smp->t_us);
+    if (!csv_human)
+    {
+        len = rt_snprintf(buf, size, "%u,%s,%u,%u,%u,%u", (unsigned)smp->seq, ub, (unsigned)smp->lap_idx,
+                          (unsigned)smp->lap_ms, (unsigned)smp->total_ms, (unsigned)smp->skipped);
+        if (smp->agg_n > 1)
+        {
+            len += rt_snprintf(buf + len, size - len, ",%u,%u,%u", (unsigned)smp->agg_n,
+                               (unsigned)smp->min_ms, (unsigned)smp->max_ms);
+        }
+    }
+    else
+    {
+        char tb[16], lb[16];
+        format_time(smp->total_ms, tb, sizeof(tb));
+        format_time(smp->lap_ms, lb, sizeof(lb));
+        len = rt_snprintf(buf, size, "%u,%s,%u,%s,%s,%u", (unsigned)smp->seq, ub, (unsigned)smp->lap_idx,
+                          lb, tb, (unsigned)smp->skipped);
+        if (smp->agg_n > 1)
+        {
+            format_time(smp->min_ms, tb, sizeof(tb));
+            format_time(smp->max_ms, lb, sizeof(lb));
+            len += rt_snprintf(buf + len, size - len, ",%u,%s,%s", (unsigned)smp->agg_n, tb, lb);
+        }
+    }
+    len += rt_snprintf(buf + len, size - len, "\n");
+    return len;
+}
+
+/* ================== 二进制帧 ==================
+ * 帧 = COBS(帧头 + n 条定长记录 + CRC16) + 0x00，全部小端。
+ * 时间戳与序号相对上一条记录差分编码；序号跳变（队满丢弃）超过 255 时另起一帧。 */
+/* 缓冲需容纳：同步字节 + COBS 开销(每 254B 一字节 + 首码) + 分隔符 + 帧头 + 记录 + CRC */
+#define TLM_BIN_RAW_MAX     (TELEMETRY_BUF_SIZE - TELEMETRY_BUF_SIZE / 254 - 3)
+/* 记录区上限（字节）：普通记录定长，聚合记录带扩展 */
+#define TLM_BIN_BODY_MAX    (TLM_BIN_RAW_MAX - TELEMETRY_BIN_HDR_SIZE - 2)
+
+static rt_uint8_t s_bin_raw[TLM_BIN_RAW_MAX];
+static volatile rt_bool_t s_bin_sync = 0;   /* 首帧前补一个 0x00，切断之前的 shell 文本 */
+
+static rt_uint8_t *put_u16(rt_uint8_t *p, rt_uint16_t v)
+{
+    p[0] = (rt_uint8_t)v; p[1] = (rt_uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static rt_uint8_t *put_u32(rt_uint8_t *p, rt_uint32_t v)
+{
+    p = put_u16(p, (rt_uint16_t)v);
+    return put_u16(p, (rt_uint16_t)(v >> 16));
+}
+
+static rt_uint8_t *put_u64(rt_uint8_t *p, rt_uint64_t v)
+{
+    p = put_u32(p, (rt_uint32_t)v);
+    return put_u32(p, (rt_uint32_t)(v >> 32));
+}
+
+/* COBS 编码并追加 0x00 分隔符，返回输出长度 */
+static rt_size_t cobs_encode(const rt_uint8_t *in, rt_size_t len, rt_uint8_t *out)
+{
+    rt_uint8_t *code_p = out;
+    rt_uint8_t *o = out + 1;
+    rt_uint8_t code = 1;
+
+    for (rt_size_t i = 0; i < len; i++)
+    {
+        if (in[i] == 0)
+        {
+            *code_p = code;
+            code_p = o++;
+            code = 1;
+            continue;
+        }
+        *o++ = in[i];
+        if (++code == 0xFF)
+        {
+            *code_p = code;
+            code_p = o++;
+            code = 1;
+        }
+    }
+    *code_p = code;
+    *o++ = 0x00;
+    return (rt_size_t)(o - out);
+}
+
+static rt_size_t build_bin_frame(rt_uint8_t *out, rt_uint32_t *out_n)
+{
+    telemetry_sample_t smp;
+    rt_uint8_t *p = s_bin_raw + TELEMETRY_BIN_HDR_SIZE;
+    rt_uint32_t n = 0, prev_seq = 0;
+    rt_uint64_t prev_t = 0;
+
+    while (n < 0xFFU && ring_peek(&smp))
+    {
+        rt_size_t rec_size = TELEMETRY_BIN_REC_SIZE + ((smp.agg_n > 1) ? TELEMETRY_BIN_AGG_EXT_SIZE : 0);
+        if ((rt_size_t)(p - s_bin_raw) - TELEMETRY_BIN_HDR_SIZE + rec_size > TLM_BIN_BODY_MAX) break;
+        if (n == 0)
+        {
+            s_bin_raw[0] = TELEMETRY_BIN_VERSION;
+            put_u32(&s_bin_raw[2], smp.seq);
+            put_u64(&s_bin_raw[6], smp.t_us);
+            prev_seq = smp.seq;
+            prev_t = smp.t_us;
+        }
+        rt_uint32_t dseq = smp.seq - prev_seq;
+        rt_uint64_t dt = smp.t_us - prev_t;
+        if (dseq > 0xFFU || dt > 0xFFFFFFFFULL) break;
+        ring_pop(&smp);
+
+        *p++ = (rt_uint8_t)dseq;
+        p = put_u32(p, (rt_uint32_t)dt);
+        p = put_u32(p, smp.total_ms);
+        p = put_u32(p, smp.lap_ms);
+        p = put_u16(p, smp.lap_idx);
+        *p++ = smp.state | ((smp.agg_n > 1) ? TELEMETRY_BIN_STATE_AGG : 0);
+        if (smp.agg_n > 1)
+        {
+            p = put_u16(p, smp.agg_n);
+            p = put_u32(p, smp.min_ms);
+            p = put_u32(p, smp.max_ms);
+        }
+        prev_seq = smp.seq;
+        prev_t = smp.t_us;
+        n++;
+    }
+    s_bin_raw[1] = (rt_uint8_t)n;
+    p = put_u16(p, crc16_ccitt(s_bin_raw, (rt_size_t)(p - s_bin_raw)));
+    *out_n = n;
+    return cobs_encode(s_bin_raw, (rt_size_t)(p - s_bin_raw), out);
+}
+
+#if TELEMETRY_USING_DMA_TX
+static rt_err_t tlm_tx_done(rt_device_t dev, void *buffer)
+{
+    (void)dev;
+    /* 同口的控制台输出也会回调，只认自己的缓冲 */
+    if (buffer == s_buf[0] || buffer == s_buf[1])
+    {
+        rt_sem_release(&s_buf_free);
+    }
+    return RT_EOK;
+}
+#endif
+
+static void telemetry_writer_entry(void *parameter)
+{
+    (void)parameter;
+    rt_uint32_t recved;
+    telemetry_sample_t smp;
+
+    while (1)
+    {
+        rt_event_recv(&s_tlm_evt, TLM_EVT_DATA, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_FOREVER, &recved);
+
+        while (s_tail != s_head)
+        {
+            rt_sem_take(&s_buf_free, RT_WAITING_FOREVER);
+            char *buf = s_buf[s_buf_idx];
+            rt_size_t len = 0;
+            rt_uint32_t n = 0;
+
+            if (s_mode == TELEMETRY_MODE_BIN)
+            {
+                if (s_bin_sync)
+                {
+                    buf[len++] = 0x00;
+                    s_bin_sync = 0;
+                }
+                len += build_bin_frame((rt_uint8_t *)buf + len, &n);
+                s_stats.frames++;
+            }
+            else
+            {
+                if (csv_header)
+                {
+                    len += rt_snprintf(buf, TELEMETRY_BUF_SIZE, "seq,t_us,lap_idx,lap_ms,total,skipped\n");
+                    csv_header = 0; /* 只打一遍 */
+                }
+                while (len + TLM_LINE_MAX <= TELEMETRY_BUF_SIZE && ring_pop(&smp))
+                {
+                    len += format_record(buf + len, TELEMETRY_BUF_SIZE - len, &smp);
+                    n++;
+                }
+            }
+
+            if (s_mode == TELEMETRY_MODE_BIN)
+            {
+                /* 控制台以 STREAM 方式打开，轮询发送会把 0x0A 扩成 0x0D 0x0A，二进制帧须临时去掉。
+                 * 只在关中断下改 STREAM 一位：其他线程（console_rx 等）同时改接收标志时不被旧值覆盖；
+                 * 期间抢占的 rt_kprintf 自行置位并恢复成本处的值 */
+                rt_base_t level = rt_hw_interrupt_disable();
+                rt_uint16_t stream = s_dev->open_flag & RT_DEVICE_FLAG_STREAM;
+                s_dev->open_flag &= ~RT_DEVICE_FLAG_STREAM;
+                rt_hw_interrupt_enable(level);
+                rt_device_write(s_dev, 0, buf, len);
+                level = rt_hw_interrupt_disable();
+                s_dev->open_flag |= stream;
+                rt_hw_interrupt_enable(level);
+            }
+            else
+            {
+                rt_device_write(s_dev, 0, buf, len);
+            }
+            if (!s_stats.dma)
+            {
+                /* 轮询发送返回即发完，缓冲立即可复用 */
+                rt_sem_release(&s_buf_free);
+            }
+            s_buf_idx ^= 1U;
+
+            s_stats.written += n;
+            s_stats.bytes += len;
+            s_stats.writes++;
+            if (n > s_stats.max_batch) s_stats.max_batch = n;
+        }
+    }
+}
+
+static rt_tick_t ms_to_ticks(rt_uint32_t ms)
+{
+    /* 计算向上取整，避免 0 tick */
+    rt_uint64_t ticks = ((rt_uint64_t)ms * RT_TICK_PER_SECOND + 999ULL) / 1000ULL;
+    if (ticks == 0) ticks = 1;
+    return (rt_tick_t)ticks;
+}
+
+rt_err_t telemetry_init(void)
+{
+    if (s_inited) return RT_EOK;
+
+    s_dev = rt_device_find(TELEMETRY_DEVICE_NAME);
+    if (!s_dev) return -RT_EEMPTY;
+
+#if TELEMETRY_USING_DMA_TX
+    /* 保留已打开的中断接收/流模式标志，只追加 DMA 发送 */
+    if (rt_device_open(s_dev, s_dev->open_flag | RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_DMA_TX) == RT_EOK)
+    {
+        s_stats.dma = 1;
+        rt_device_set_tx_complete(s_dev, tlm_tx_done);
+    }
+    else
+#endif
+    if (s_dev->ref_count == 0 && rt_device_open(s_dev, RT_DEVICE_OFLAG_RDWR) != RT_EOK)
+    {
+        return -RT_EIO;
+    }
+
+    rt_sem_init(&s_buf_free, "tlmbuf", 2, RT_IPC_FLAG_FIFO);
+    rt_event_init(&s_tlm_evt, "tlm", RT_IPC_FLAG_FIFO);
+    s_writer = rt_thread_create("tlm_wr", telemetry_writer_entry, RT_NULL, 768, TELEMETRY_WRITER_PRIORITY, 10);
+    if (!s_writer)
+    {
+        rt_sem_detach(&s_buf_free);
+        rt_event_detach(&s_tlm_evt);
+        return -RT_ENOMEM;
+    }
+    rt_thread_startup(s_writer);
+    s_inited = 1;
+    LOG_D("telemetry on %s, dma=%d", TELEMETRY_DEVICE_NAME, s_stats.dma);
+    return RT_EOK;
+}
+
+rt_err_t telemetry_start(telemetry_mode_t mode, rt_uint32_t period_ms)
+{
+    rt_err_t r = telemetry_init();
+    if (r != RT_EOK) return r;
+
+    s_mode = (rt_uint8_t)mode;
+    if (mode == TELEMETRY_MODE_BIN) s_bin_sync = 1;
+    s_period_ms = period_ms;
+    s_mode_since_us = timebase_get_us();
+    rt_tick_t t = ms_to_ticks(s_period_ms);
+    if (s_timer == RT_NULL)
+    {
+        s_timer = rt_timer_create("swcsv", csv_timer_cb, RT_NULL, t, RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_SOFT_TIMER);
+        if (s_timer == RT_NULL) return -RT_ENOMEM;
+    }
+    else
+    {
+        rt_timer_control(s_timer, RT_TIMER_CTRL_SET_TIME, &t);
+    }
+    return rt_timer_start(s_timer);
+}
+
+void telemetry_stop(void)
+{
+    if (s_timer == RT_NULL || rt_timer_stop(s_timer) != RT_EOK) return;
+    /* 定时器已停，生产者不再运行：记账并冲刷未满窗口 */
+    account_mode(timebase_get_us());
+    if (s_win.agg_n)
+    {
+        emit_sample(&s_win);
+        s_win.agg_n = 0;
+    }
+    s_stats.aggregating = 0;
+    rt_event_send(&s_tlm_evt, TLM_EVT_DATA);
+}
+
+void telemetry_get_stats(telemetry_stats_t *out)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    *out = s_stats;
+    rt_hw_interrupt_enable(level);
+    /* 计入当前模式尚未记账的时长（仅在运行中） */
+    if (s_timer && (s_timer->parent.flag & RT_TIMER_FLAG_ACTIVATED))
+    {
+        rt_uint64_t d = timebase_get_us() - s_mode_since_us;
+        if (out->aggregating) out->agg_us += d;
+        else out->full_us += d;
+    }
+}
+
+rt_bool_t telemetry_active(void)
+{
+    return (s_timer && (s_timer->parent.flag & RT_TIMER_FLAG_ACTIVATED)) ? RT_TRUE : RT_FALSE;
+}
+
+/* ================== 命令 ================== */
+static int cmd_sw_csv(int argc, char **argv)
+{
+    if (argc >= 2 && !strcmp(argv[1], "on"))
+    {
+        rt_uint32_t period = s_period_ms;
+        if (argc >= 3)
+        {
+            period = (rt_uint32_t)atoi(argv[2]);
+            if (period < 1) period = 1;
+        }
+        rt_err_t r = telemetry_start(TELEMETRY_MODE_CSV, period);
+        if (r != RT_EOK)
+        {
+            rt_kprintf("sw.csv: start failed (%d)\n", (int)r);
+            return r;
+        }
+        rt_kprintf("sw.csv: on, %u ms\n", (unsigned)s_period_ms);
+        return 0;
+    }
+    else if (argc >= 2 && !strcmp(argv[1], "off"))
+    {
+        telemetry_stop();
+        rt_kprintf("sw.csv: off\n");
+        return 0;
+    }
+    else if (argc >= 2 && !strcmp(argv[1], "stat"))
+    {
+        telemetry_stats_t st;
+        telemetry_get_stats(&st);
+        rt_kprintf("captured=%u dropped=%u written=%u bytes=%u writes=%u frames=%u max_batch=%u tx=%s\n",
+                   (unsigned)st.captured, (unsigned)st.dropped, (unsigned)st.written, (unsigned)st.bytes,
+                   (unsigned)st.writes, (unsigned)st.frames, (unsigned)st.max_batch, st.dma ? "dma" : "poll");
+        rt_kprintf("mode=%s switches=%u agg_records=%u full_ms=%u agg_ms=%u (hwm=%u lwm=%u win=%u)\n",
+                   st.aggregating ? "agg" : "full", (unsigned)st.mode_switches, (unsigned)st.agg_records,
+                   (unsigned)(st.full_us / 1000U), (unsigned)(st.agg_us / 1000U),
+                   (unsigned)TELEMETRY_HIGH_WATERMARK, (unsigned)TELEMETRY_LOW_WATERMARK,
+                   (unsigned)TELEMETRY_AGG_WINDOW);
+        return 0;
+    }
+    rt_kprintf("usage: sw.csv on [period_ms]|off|stat\n");
+    return -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_csv, sw_csv, Periodic_CSV_stream);
+
+static int cmd_sw_csv_header(int argc, char **argv)
+{
+    if (argc < 2) { rt_kprintf("usage: sw_csv_header on|off\n"); return -RT_ERROR; }
+    if (!strcmp(argv[1], "on")) { csv_header = 1; rt_kprintf("sw_csv_header: on\n"); return 0; }
+    if (!strcmp(argv[1], "off")) { csv_header = 0; rt_kprintf("sw_csv_header: off\n"); return 0; }
+    rt_kprintf("usage: sw_csv_header on|off\n"); return -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_csv_header, sw_csv_header, CSV_header_once_switch);
+
+static int cmd_sw_timefmt(int argc, char **argv)
+{
+    if (argc < 2) { rt_kprintf("usage: sw_timefmt human|ms\n"); return -RT_ERROR; }
+    if (!strcmp(argv[1], "human")) { csv_human = 1; rt_kprintf("sw_timefmt: human\n"); return 0; }
+    if (!strcmp(argv[1], "ms")) { csv_human = 0; rt_kprintf("sw_timefmt: ms\n"); return 0; }
+    rt_kprintf("usage: sw_timefmt human|ms\n"); return -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_timefmt, sw_timefmt, CSV_time_format_switch);
+
+/* 二进制流：sw_stream bin [period_ms] | off
+ * 115200bps 下每条约 16B，1ms 周期接近链路上限；更高采样率请提高波特率 */
+static int cmd_sw_stream(int argc, char **argv)
+{
+    if (argc >= 2 && !strcmp(argv[1], "bin"))
+    {
+        rt_uint32_t period = (argc >= 3) ? (rt_uint32_t)atoi(argv[2]) : s_period_ms;
+        if (period < 1) period = 1;
+        rt_err_t r = telemetry_start(TELEMETRY_MODE_BIN, period);
+        if (r != RT_EOK)
+        {
+            rt_kprintf("sw_stream: start failed (%d)\n", (int)r);
+            return r;
+        }
+        /* 此行之后串口上是二进制帧，宿主以 0x00 为帧界重同步 */
+        rt_kprintf("sw_stream: bin, %u ms\n", (unsigned)s_period_ms);
+        return 0;
+    }
+    if (argc >= 2 && !strcmp(argv[1], "off"))
+    {
+        telemetry_stop();
+        rt_kprintf("sw_stream: off\n");
+        return 0;
+    }
+    rt_kprintf("usage: sw_stream bin [period_ms]|off\n");
+    return -RT_ERROR;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_stream, sw_stream, Binary_telemetry_stream);
@@ -0,0 +1,108 @@
+#ifndef APPLICATIONS_TELEMETRY_STREAM_H_
+#define APPLICATIONS_TELEMETRY_STREAM_H_
+
+#include <rtthread.h>
+#include "async_console.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 输出串口（默认与控制台同口；启用异步控制台时经其发送缓冲输出，与 shell 输出不交错） */
+#ifndef TELEMETRY_DEVICE_NAME
+#if ASYNC_CONSOLE_ENABLE
+#define TELEMETRY_DEVICE_NAME       ASYNC_CONSOLE_DEVICE_NAME
+#else
+#define TELEMETRY_DEVICE_NAME       RT_CONSOLE_DEVICE_NAME
+#endif
+#endif
+/* 1：以 RT_DEVICE_FLAG_DMA_TX 打开串口（需 RT_SERIAL_USING_DMA 与 BSP_UART1_TX_USING_DMA）。
+ * 与控制台同口时 rt_kprintf 的静态缓冲也会走 DMA 异步发送，须使用独立串口；同口请改用异步控制台（二者不可同时开启） */
+#ifndef TELEMETRY_USING_DMA_TX
+#define TELEMETRY_USING_DMA_TX      0
+#endif
+#if TELEMETRY_USING_DMA_TX && ASYNC_CONSOLE_ENABLE
+#error "TELEMETRY_USING_DMA_TX conflicts with ASYNC_CONSOLE_ENABLE (one tx_complete per UART)"
+#endif
+/* 采样环形队列深度（2 的幂） */
+#ifndef TELEMETRY_RING_SIZE
+#define TELEMETRY_RING_SIZE         32
+#endif
+/* 单个格式化缓冲大小（共两块交替使用） */
+#ifndef TELEMETRY_BUF_SIZE
+#define TELEMETRY_BUF_SIZE          256
+#endif
+/* 背压水位（队列占用条数）：到达高水位切换为窗口聚合，回落到低水位恢复逐条输出 */
+#ifndef TELEMETRY_HIGH_WATERMARK
+#define TELEMETRY_HIGH_WATERMARK    (TELEMETRY_RING_SIZE * 3 / 4)
+#endif
+#ifndef TELEMETRY_LOW_WATERMARK
+#define TELEMETRY_LOW_WATERMARK     (TELEMETRY_RING_SIZE / 4)
+#endif
+/* 聚合模式下每个窗口合并的采样数 */
+#ifndef TELEMETRY_AGG_WINDOW
+#define TELEMETRY_AGG_WINDOW        8
+#endif
+#ifndef TELEMETRY_WRITER_PRIORITY
+#define TELEMETRY_WRITER_PRIORITY   (RT_THREAD_PRIORITY_MAX - 5)
+#endif
+
+typedef enum
+{
+    TELEMETRY_MODE_CSV = 0,     /* 文本 CSV 行 */
+    TELEMETRY_MODE_BIN,         /* 二进制帧：COBS 分隔 + CRC16，见 PROJECT_STOPWATCH.md */
+} telemetry_mode_t;
+
+/* 二进制帧格式版本（帧首字节）；记录 state 最高位置 1 表示聚合记录，其后追加窗口扩展 */
+#define TELEMETRY_BIN_VERSION       0x02
+/* 帧头：ver(1) n(1) seq0(4) t0_us(8)；每条记录：dseq(1) dt_us(4) total_ms(4) lap_ms(4) lap_idx(2) state(1) */
+#define TELEMETRY_BIN_HDR_SIZE      14
+#define TELEMETRY_BIN_REC_SIZE      16
+#define TELEMETRY_BIN_STATE_AGG     0x80
+/* 聚合记录扩展：agg_n(2) min_total_ms(4) max_total_ms(4)，与 CSV 聚合行的 ,n,min,max 对应 */
+#define TELEMETRY_BIN_AGG_EXT_SIZE  10
+
+/* 一条采样（由定时器回调捕获，写线程格式化） */
+typedef struct
+{
+    rt_uint32_t seq;
+    rt_uint64_t t_us;           /* 捕获时刻 */
+    rt_uint32_t total_ms;
+    rt_uint32_t lap_ms;         /* 最近一圈 */
+    rt_uint16_t lap_idx;        /* 当前圈数 */
+    rt_uint8_t  state;
+    rt_uint16_t skipped;        /* 与上一条入队记录之间因队满丢弃的采样数 */
+    rt_uint16_t agg_n;          /* 本记录合并的采样数，1 为逐条采样；>1 时其余字段取窗口内最后一个 */
+    rt_uint32_t min_ms;         /* 窗口内 total_ms 最小/最大值 */
+    rt_uint32_t max_ms;
+} telemetry_sample_t;
+
+typedef struct
+{
+    rt_uint32_t captured;       /* 入队采样数 */
+    rt_uint32_t dropped;        /* 队满丢弃（抽稀掉的采样） */
+    rt_uint32_t written;        /* 已写出记录数 */
+    rt_uint32_t bytes;          /* 已写出字节 */
+    rt_uint32_t writes;         /* rt_device_write 次数 */
+    rt_uint32_t max_batch;      /* 单次写出的最大记录数 */
+    rt_uint32_t frames;         /* 二进制帧数 */
+    rt_uint32_t agg_records;    /* 聚合记录数 */
+    rt_uint32_t mode_switches;  /* 逐条/聚合切换次数 */
+    rt_uint64_t full_us;        /* 逐条模式累计时长 */
+    rt_uint64_t agg_us;         /* 聚合模式累计时长 */
+    rt_uint8_t  aggregating;    /* 当前是否处于聚合模式 */
+    rt_uint8_t  dma;            /* 是否 DMA 发送 */
+} telemetry_stats_t;
+
+rt_err_t telemetry_init(void);
+rt_err_t telemetry_start(telemetry_mode_t mode, rt_uint32_t period_ms);
+void     telemetry_stop(void);
+void     telemetry_get_stats(telemetry_stats_t *out);
+/* 定时采样是否在运行（运行中串口被遥测输出占用） */
+rt_bool_t telemetry_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_TELEMETRY_STREAM_H_ */
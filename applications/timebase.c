@@ -36,15 +36,34 @@ uint64_t timebase_get_us(void)
 {
     if (dwt_ok)
     {
+        /* 累计量为共享状态，关中断保护后可在 ISR（如按键 EXTI）中调用 */
+        rt_base_t level = rt_hw_interrupt_disable();
         uint32_t cur = DWT->CYCCNT;
         uint32_t delta = (uint32_t)(cur - last_cyc); /* 包含回绕 */
         last_cyc = cur;
         total_cyc += delta;
-        return (total_cyc * 1000000ULL) / cpu_hz;
+        uint64_t cyc = total_cyc;
+        rt_hw_interrupt_enable(level);
+        return (cyc * 1000000ULL) / cpu_hz;
     }
     /* 回退：tick 转换为 us */
     uint32_t ticks = rt_tick_get();
     return ((uint64_t)ticks * 1000000ULL) / RT_TICK_PER_SECOND;
 }
 
+uint64_t timebase_get_cycles(void)
+{
+    if (dwt_ok)
+    {
+        rt_base_t level = rt_hw_interrupt_disable();
+        uint32_t cur = DWT->CYCCNT;
+        total_cyc += (uint32_t)(cur - last_cyc);
+        last_cyc = cur;
+        uint64_t cyc = total_cyc;
+        rt_hw_interrupt_enable(level);
+        return cyc;
+    }
+    return ((uint64_t)rt_tick_get() * cpu_hz) / RT_TICK_PER_SECOND;
+}
+
 
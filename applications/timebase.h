@@ -11,9 +11,12 @@ extern "C" {
 /* 初始化高精度计时基准（优先使用 DWT CYCCNT）。 */
 rt_err_t timebase_init(void);
 
-/* 获取自初始化以来的单调微秒时间（us）。 */
+/* 获取自初始化以来的单调微秒时间（us），线程与中断上下文均可调用。 */
 uint64_t timebase_get_us(void);
 
+/* 获取自初始化以来的 CPU 周期数（DWT 不可用时由 tick 折算），供微基准统计 bytes/cycle。 */
+uint64_t timebase_get_cycles(void);
+
 #ifdef __cplusplus
 }
 #endif
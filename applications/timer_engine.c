@@ -0,0 +1,396 @@
+#include "timer_engine.h"
+#include <rtdevice.h>
+#include <rthw.h>
+#include <finsh.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timebase.h"
+#include "event_bus.h"
+
+#define DBG_TAG "tmr"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/* 倒计时/间歇训练引擎：所有程序的截止时刻为绝对时间，始终只给定时器编程最近的一个；
+ * 到期在定时器中断中处理并发布事件，不做轮询。 */
+
+/* ================== 纯逻辑 ================== */
+int timer_engine_add(timer_engine_t *te, timer_kind_t kind, rt_uint32_t work_ms,
+                     rt_uint32_t rest_ms, rt_uint16_t rounds, rt_uint64_t now_us)
+{
+    if (kind == TIMER_KIND_FREE || work_ms == 0) return -RT_EINVAL;
+    if (kind == TIMER_KIND_COUNTDOWN) { rest_ms = 0; rounds = 1; }
+    if (rounds == 0) rounds = 1;
+
+    for (int i = 0; i < TIMER_ENGINE_MAX; i++)
+    {
+        timer_slot_t *s = &te->slot[i];
+        if (s->kind != TIMER_KIND_FREE) continue;
+        s->phase = TIMER_EVT_WORK;
+        s->round = 1;
+        s->rounds = rounds;
+        s->work_ms = work_ms;
+        s->rest_ms = rest_ms;
+        s->deadline_us = now_us + (rt_uint64_t)work_ms * 1000ULL;
+        s->kind = (rt_uint8_t)kind;
+        return i;
+    }
+    return -RT_EFULL;
+}
+
+rt_err_t timer_engine_remove(timer_engine_t *te, int id)
+{
+    if (id < 0 || id >= TIMER_ENGINE_MAX || te->slot[id].kind == TIMER_KIND_FREE) return -RT_EINVAL;
+    te->slot[id].kind = TIMER_KIND_FREE;
+    return RT_EOK;
+}
+
+/* 推进一个已到期槽位，返回产生的事件码 */
+static rt_uint8_t slot_advance(timer_slot_t *s)
+{
+    if (s->phase == TIMER_EVT_WORK)
+    {
+        if (s->round >= s->rounds)
+        {
+            s->kind = TIMER_KIND_FREE;
+            return TIMER_EVT_DONE;
+        }
+        if (s->rest_ms > 0)
+        {
+            s->phase = TIMER_EVT_REST;
+            s->deadline_us += (rt_uint64_t)s->rest_ms * 1000ULL;
+            return TIMER_EVT_REST;
+        }
+    }
+    /* 休息结束（或无休息段）：进入下一轮运动 */
+    s->round++;
+    s->phase = TIMER_EVT_WORK;
+    s->deadline_us += (rt_uint64_t)s->work_ms * 1000ULL;
+    return TIMER_EVT_WORK;
+}
+
+rt_size_t timer_engine_expire(timer_engine_t *te, rt_uint64_t now_us, timer_fire_t *out, rt_size_t max_out)
+{
+    rt_size_t n = 0;
+    /* 每轮取最早到期者，多程序同时落后时按截止时刻先后产生事件 */
+    while (n < max_out)
+    {
+        int best = -1;
+        for (int i = 0; i < TIMER_ENGINE_MAX; i++)
+        {
+            const timer_slot_t *s = &te->slot[i];
+            if (s->kind == TIMER_KIND_FREE || s->deadline_us > now_us) continue;
+            if (best < 0 || s->deadline_us < te->slot[best].deadline_us) best = i;
+        }
+        if (best < 0) break;
+
+        timer_slot_t *s = &te->slot[best];
+        rt_uint64_t deadline = s->deadline_us;
+        rt_uint32_t late = (rt_uint32_t)(now_us - deadline);
+        te->stats.fired++;
+        te->stats.sum_late_us += late;
+        if (late > te->stats.max_late_us) te->stats.max_late_us = late;
+        if (late > TIMER_ENGINE_MISS_US) te->stats.missed++;
+
+        out[n].id = (rt_uint8_t)best;
+        out[n].deadline_us = deadline;
+        out[n].code = slot_advance(s);
+        out[n].round = s->round;
+        n++;
+    }
+    return n;
+}
+
+rt_uint64_t timer_engine_next_deadline(const timer_engine_t *te)
+{
+    rt_uint64_t next = 0;
+    for (int i = 0; i < TIMER_ENGINE_MAX; i++)
+    {
+        const timer_slot_t *s = &te->slot[i];
+        if (s->kind == TIMER_KIND_FREE) continue;
+        if (next == 0 || s->deadline_us < next) next = s->deadline_us;
+    }
+    return next;
+}
+
+/* ================== 实机：定时器后端 ================== */
+#define TIMER_FIRE_BATCH 4
+
+static timer_engine_t s_te;
+static rt_uint8_t s_inited = 0;
+static struct rt_timer s_fallback_timer;
+
+#if defined(RT_USING_HWTIMER) && defined(TIMER_ENGINE_HWTIMER_DEV)
+#include <drivers/hwtimer.h>
+static rt_device_t s_hw = RT_NULL;
+#endif
+
+static void timer_engine_service(void);
+
+/* 为最近截止时刻编程单次定时；须在关中断下调用 */
+static void timer_arm_locked(void)
+{
+    rt_uint64_t next = timer_engine_next_deadline(&s_te);
+
+#if defined(RT_USING_HWTIMER) && defined(TIMER_ENGINE_HWTIMER_DEV)
+    if (s_hw)
+    {
+        if (next == 0)
+        {
+            rt_device_control(s_hw, HWTIMER_CTRL_STOP, RT_NULL);
+            return;
+        }
+        rt_uint64_t now = timebase_get_us();
+        rt_uint64_t delta = (next > now) ? (next - now) : 10U; /* 已过期则尽快触发 */
+        rt_hwtimerval_t tv;
+        tv.sec = (rt_int32_t)(delta / 1000000ULL);
+        tv.usec = (rt_int32_t)(delta % 1000000ULL);
+        rt_device_write(s_hw, 0, &tv, sizeof(tv));
+        return;
+    }
+#endif
+
+    rt_timer_stop(&s_fallback_timer);
+    if (next == 0) return;
+    rt_uint64_t now = timebase_get_us();
+    /* 向下取整：tick 边界与 timebase 不同相，可能提前到达，提前时由 service 重新编程剩余量 */
+    rt_uint64_t ticks = (next > now) ? ((next - now) * RT_TICK_PER_SECOND / 1000000ULL) : 0;
+    rt_tick_t t = (ticks == 0) ? 1 : (rt_tick_t)ticks;
+    rt_timer_control(&s_fallback_timer, RT_TIMER_CTRL_SET_TIME, &t);
+    rt_timer_start(&s_fallback_timer);
+}
+
+/* 定时器中断上下文：处理所有已到期截止时刻并重新编程，事件在开中断后发布 */
+static void timer_engine_service(void)
+{
+    timer_fire_t fires[TIMER_FIRE_BATCH];
+    rt_size_t n;
+
+    do
+    {
+        rt_base_t level = rt_hw_interrupt_disable();
+        n = timer_engine_expire(&s_te, timebase_get_us(), fires, TIMER_FIRE_BATCH);
+        if (n < TIMER_FIRE_BATCH) timer_arm_locked();
+        rt_hw_interrupt_enable(level);
+
+        for (rt_size_t i = 0; i < n; i++)
+        {
+            event_t e;
+            e.topic = EVT_TIMER_EXPIRED;
+            e.code = fires[i].code;
+            e.index = fires[i].id;
+            e.value = fires[i].round;
+            e.t_us = fires[i].deadline_us;
+            event_bus_publish(&e);
+        }
+    } while (n == TIMER_FIRE_BATCH);
+}
+
+static void fallback_timeout(void *parameter)
+{
+    (void)parameter;
+    timer_engine_service();
+}
+
+#if defined(RT_USING_HWTIMER) && defined(TIMER_ENGINE_HWTIMER_DEV)
+static rt_err_t hw_timeout(rt_device_t dev, rt_size_t size)
+{
+    (void)dev; (void)size;
+    timer_engine_service();
+    return RT_EOK;
+}
+#endif
+
+rt_err_t timer_engine_init(void)
+{
+    if (s_inited) return RT_EOK;
+    memset(&s_te, 0, sizeof(s_te));
+    timebase_init();
+    /* 硬定时器：在 tick 中断中回调，不经过软定时器线程 */
+    rt_timer_init(&s_fallback_timer, "tmreng", fallback_timeout, RT_NULL, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+
+#if defined(RT_USING_HWTIMER) && defined(TIMER_ENGINE_HWTIMER_DEV)
+    s_hw = rt_device_find(TIMER_ENGINE_HWTIMER_DEV);
+    if (s_hw && rt_device_open(s_hw, RT_DEVICE_OFLAG_RDWR) == RT_EOK)
+    {
+        rt_hwtimer_mode_t mode = HWTIMER_MODE_ONESHOT;
+        rt_uint32_t freq = 1000000;
+        rt_device_set_rx_indicate(s_hw, hw_timeout);
+        rt_device_control(s_hw, HWTIMER_CTRL_FREQ_SET, &freq);
+        rt_device_control(s_hw, HWTIMER_CTRL_MODE_SET, &mode);
+        LOG_I("using hwtimer %s", TIMER_ENGINE_HWTIMER_DEV);
+    }
+    else
+    {
+        s_hw = RT_NULL;
+        LOG_W("hwtimer %s unavailable, fallback to tick timer", TIMER_ENGINE_HWTIMER_DEV);
+    }
+#endif
+
+    s_inited = 1;
+    return RT_EOK;
+}
+
+static int timer_start(timer_kind_t kind, rt_uint32_t work_ms, rt_uint32_t rest_ms, rt_uint16_t rounds)
+{
+    if (timer_engine_init() != RT_EOK) return -RT_ERROR;
+    rt_base_t level = rt_hw_interrupt_disable();
+    int id = timer_engine_add(&s_te, kind, work_ms, rest_ms, rounds, timebase_get_us());
+    if (id >= 0) timer_arm_locked();
+    rt_hw_interrupt_enable(level);
+    return id;
+}
+
+int timer_countdown_start(rt_uint32_t ms)
+{
+    return timer_start(TIMER_KIND_COUNTDOWN, ms, 0, 1);
+}
+
+int timer_interval_start(rt_uint32_t work_ms, rt_uint32_t rest_ms, rt_uint16_t rounds)
+{
+    return timer_start(TIMER_KIND_INTERVAL, work_ms, rest_ms, rounds);
+}
+
+rt_err_t timer_cancel(int id)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_err_t r = timer_engine_remove(&s_te, id);
+    if (r == RT_EOK) timer_arm_locked();
+    rt_hw_interrupt_enable(level);
+    return r;
+}
+
+/* ================== 命令 ================== */
+static const char *fire_name(rt_uint8_t code)
+{
+    switch (code)
+    {
+    case TIMER_EVT_WORK: return "work";
+    case TIMER_EVT_REST: return "rest";
+    case TIMER_EVT_DONE: return "done";
+    default:             return "?";
+    }
+}
+
+static void print_stats(const timer_stats_t *st)
+{
+    rt_kprintf("fired=%u missed(>%uus)=%u max_late=%u us avg_late=%u us\n",
+               (unsigned)st->fired, (unsigned)TIMER_ENGINE_MISS_US, (unsigned)st->missed,
+               (unsigned)st->max_late_us, (unsigned)(st->fired ? st->sum_late_us / st->fired : 0));
+}
+
+static int cmd_sw_cd(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        rt_kprintf("usage: sw_cd <ms>\n");
+        return -RT_ERROR;
+    }
+    int id = timer_countdown_start((rt_uint32_t)atoi(argv[1]));
+    if (id < 0)
+    {
+        rt_kprintf("sw_cd: failed (%d)\n", id);
+        return -RT_ERROR;
+    }
+    rt_kprintf("sw_cd: timer %d, %u ms\n", id, (unsigned)atoi(argv[1]));
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_cd, sw_cd, Start_countdown_ms);
+
+static int cmd_sw_iv(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        rt_kprintf("usage: sw_iv <work_ms> <rest_ms> <rounds>\n");
+        return -RT_ERROR;
+    }
+    int id = timer_interval_start((rt_uint32_t)atoi(argv[1]), (rt_uint32_t)atoi(argv[2]), (rt_uint16_t)atoi(argv[3]));
+    if (id < 0)
+    {
+        rt_kprintf("sw_iv: failed (%d)\n", id);
+        return -RT_ERROR;
+    }
+    rt_kprintf("sw_iv: timer %d, work=%u rest=%u rounds=%u\n", id,
+               (unsigned)atoi(argv[1]), (unsigned)atoi(argv[2]), (unsigned)atoi(argv[3]));
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_iv, sw_iv, Start_interval_program);
+
+/* 用法：sw_tmr [list]|cancel <id>|stats */
+static int cmd_sw_tmr(int argc, char **argv)
+{
+    if (argc >= 3 && !strcmp(argv[1], "cancel"))
+    {
+        rt_err_t r = timer_cancel(atoi(argv[2]));
+        rt_kprintf("sw_tmr: cancel %s\n", (r == RT_EOK) ? "ok" : "failed");
+        return (r == RT_EOK) ? 0 : -RT_ERROR;
+    }
+    if (argc >= 2 && !strcmp(argv[1], "stats"))
+    {
+        timer_stats_t st = s_te.stats;
+        print_stats(&st);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "list"))
+    {
+        rt_kprintf("usage: sw_tmr [list]|cancel <id>|stats\n");
+        return -RT_ERROR;
+    }
+
+    rt_uint64_t now = timebase_get_us();
+    int shown = 0;
+    for (int i = 0; i < TIMER_ENGINE_MAX; i++)
+    {
+        timer_slot_t s;
+        rt_base_t level = rt_hw_interrupt_disable();
+        s = s_te.slot[i];
+        rt_hw_interrupt_enable(level);
+        if (s.kind == TIMER_KIND_FREE) continue;
+        rt_uint32_t remain = (s.deadline_us > now) ? (rt_uint32_t)((s.deadline_us - now) / 1000ULL) : 0;
+        if (s.kind == TIMER_KIND_COUNTDOWN)
+            rt_kprintf("%d: countdown remain=%u ms\n", i, (unsigned)remain);
+        else
+            rt_kprintf("%d: interval %s round %u/%u remain=%u ms\n", i, fire_name(s.phase),
+                       (unsigned)s.round, (unsigned)s.rounds, (unsigned)remain);
+        shown++;
+    }
+    if (!shown) rt_kprintf("no active timers\n");
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_tmr, sw_tmr, List_or_cancel_timers);
+
+/* 虚拟时间模拟：同一套纯逻辑，以虚拟时钟推进到各截止时刻并叠加确定性抖动，
+ * 打印触发序列与错过统计。用法：sw_tmr_sim [max_jitter_us] */
+static int cmd_sw_tmr_sim(int argc, char **argv)
+{
+    static timer_engine_t te;
+    rt_uint32_t jitter = (argc >= 2) ? (rt_uint32_t)atoi(argv[1]) : 0U;
+    timer_fire_t fires[TIMER_FIRE_BATCH];
+    rt_uint64_t now = 0;
+    rt_uint32_t step = 0;
+
+    memset(&te, 0, sizeof(te));
+    timer_engine_add(&te, TIMER_KIND_COUNTDOWN, 1500, 0, 1, now);
+    timer_engine_add(&te, TIMER_KIND_INTERVAL, 1000, 500, 3, now);
+    timer_engine_add(&te, TIMER_KIND_INTERVAL, 700, 0, 4, now + 100000);
+    rt_kprintf("sw_tmr_sim: cd 1500ms; iv 1000/500 x3; iv 700/0 x4 @100ms; jitter<=%u us\n", (unsigned)jitter);
+
+    rt_uint64_t next;
+    while ((next = timer_engine_next_deadline(&te)) != 0)
+    {
+        /* 抖动用线性同余序列生成，结果可复现 */
+        step = step * 1103515245U + 12345U;
+        now = next + (jitter ? ((step >> 8) % (jitter + 1U)) : 0U);
+        rt_size_t n = timer_engine_expire(&te, now, fires, TIMER_FIRE_BATCH);
+        for (rt_size_t i = 0; i < n; i++)
+        {
+            rt_kprintf("  %8u us: timer %u %s round %u (late %u us)\n", (unsigned)fires[i].deadline_us,
+                       (unsigned)fires[i].id, fire_name(fires[i].code), (unsigned)fires[i].round,
+                       (unsigned)(now - fires[i].deadline_us));
+        }
+    }
+    print_stats(&te.stats);
+    return 0;
+}
+MSH_CMD_EXPORT_ALIAS(cmd_sw_tmr_sim, sw_tmr_sim, Timer_engine_virtual_time_simulation);
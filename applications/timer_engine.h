@@ -0,0 +1,89 @@
+#ifndef APPLICATIONS_TIMER_ENGINE_H_
+#define APPLICATIONS_TIMER_ENGINE_H_
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 可同时运行的倒计时/间歇程序数量 */
+#ifndef TIMER_ENGINE_MAX
+#define TIMER_ENGINE_MAX        8
+#endif
+/* 到期延迟超过该值记为一次错过（us） */
+#ifndef TIMER_ENGINE_MISS_US
+#define TIMER_ENGINE_MISS_US    2000U
+#endif
+/* 硬件定时器设备名（需 RT_USING_HWTIMER 且 board.h 打开对应 BSP_USING_TIMx）；
+ * 未定义或打开失败时退回 1 tick 精度的硬定时器 */
+/* #define TIMER_ENGINE_HWTIMER_DEV "timer3" */
+
+typedef enum
+{
+    TIMER_KIND_FREE = 0,
+    TIMER_KIND_COUNTDOWN,
+    TIMER_KIND_INTERVAL,
+} timer_kind_t;
+
+/* EVT_TIMER_EXPIRED 事件的 code */
+enum
+{
+    TIMER_EVT_WORK = 0,     /* 进入运动段（value=第几轮） */
+    TIMER_EVT_REST,         /* 进入休息段（value=第几轮） */
+    TIMER_EVT_DONE,         /* 倒计时/间歇程序结束 */
+};
+
+typedef struct
+{
+    rt_uint8_t  kind;
+    rt_uint8_t  phase;          /* TIMER_EVT_WORK / TIMER_EVT_REST */
+    rt_uint16_t round;          /* 当前轮，从 1 起 */
+    rt_uint16_t rounds;
+    rt_uint32_t work_ms;        /* 倒计时时长 / 运动段时长 */
+    rt_uint32_t rest_ms;
+    rt_uint64_t deadline_us;    /* 下一次到期的绝对时刻（timebase us） */
+} timer_slot_t;
+
+typedef struct
+{
+    rt_uint32_t fired;          /* 到期处理次数 */
+    rt_uint32_t missed;         /* 延迟超过 TIMER_ENGINE_MISS_US 的次数 */
+    rt_uint32_t max_late_us;
+    rt_uint64_t sum_late_us;
+} timer_stats_t;
+
+/* 引擎状态（纯逻辑，时间由调用方给出，实机与虚拟时间模拟共用） */
+typedef struct
+{
+    timer_slot_t  slot[TIMER_ENGINE_MAX];
+    timer_stats_t stats;
+} timer_engine_t;
+
+typedef struct
+{
+    rt_uint8_t  id;
+    rt_uint8_t  code;           /* TIMER_EVT_* */
+    rt_uint16_t round;
+    rt_uint64_t deadline_us;
+} timer_fire_t;
+
+/* 纯逻辑接口：添加返回槽号（<0 为失败）；到期处理每个截止时刻产生一条 fire，
+ * 下一截止时刻由上一截止时刻累加（不随处理延迟漂移） */
+int         timer_engine_add(timer_engine_t *te, timer_kind_t kind, rt_uint32_t work_ms,
+                             rt_uint32_t rest_ms, rt_uint16_t rounds, rt_uint64_t now_us);
+rt_err_t    timer_engine_remove(timer_engine_t *te, int id);
+rt_size_t   timer_engine_expire(timer_engine_t *te, rt_uint64_t now_us, timer_fire_t *out, rt_size_t max_out);
+rt_uint64_t timer_engine_next_deadline(const timer_engine_t *te);
+
+/* 实机接口：到期时发布 EVT_TIMER_EXPIRED（蜂鸣器/LED 订阅） */
+rt_err_t timer_engine_init(void);
+int      timer_countdown_start(rt_uint32_t ms);
+int      timer_interval_start(rt_uint32_t work_ms, rt_uint32_t rest_ms, rt_uint16_t rounds);
+rt_err_t timer_cancel(int id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APPLICATIONS_TIMER_ENGINE_H_ */
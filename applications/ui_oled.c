@@ -2,6 +2,9 @@
 #include <rtdevice.h>
 #include <rtdbg.h>
 #include "stopwatch.h"
+#include "event_bus.h"
+#include "lap_board.h"
+#include "lap_stats.h"
 #include "board.h"
 #include <string.h>
 
@@ -13,8 +16,15 @@
 static rt_thread_t s_ui_thread;
 static rt_bool_t s_oled_enabled = 1;
 static rt_uint16_t s_refresh_ms = 10; /* 默认 10ms 尝试，若不稳可改为 20ms */
+static rt_uint16_t s_user_refresh_ms = 10; /* 用户设置值，环境变亮时恢复 */
 static rt_uint8_t s_page_drawn = 0; /* 页面静态元素是否已绘制 */
 
+/* 事件驱动刷新：仅主界面且秒表运行时按周期重绘，其余情况等待事件唤醒 */
+#define UI_EVT_WAKE     (1U << 0)
+#define UI_DARK_REFRESH_MS  300
+static struct rt_event s_ui_evt;
+static volatile stopwatch_state_t s_sw_state = STOPWATCH_STATE_IDLE;
+
 static void format_time_ms(rt_uint32_t total_ms, char *buf, rt_size_t buf_len)
 {
     rt_uint32_t cs = (total_ms / 10U) % 100U;          /* 厘秒，两位 00-99 */
@@ -82,37 +92,97 @@ static void draw_laps_page(void)
         rt_snprintf(line, sizeof(line), "#%u %s", (unsigned)(idx+1), tbuf);
         OLED_ShowString(0, 8*(i+1), line, OLED_6X8);
     }
-    /* 底部显示统计：min/max/avg（若有数据） */
-    if (cnt > 0)
+    /* 底部显示本会话统计：均值、标准差、中位数（流式统计，含已移出圈速环的圈） */
+    lap_stats_summary_t sum;
+    lap_stats_get_summary(&sum);
+    if (sum.n > 0)
     {
-        rt_uint32_t min_ms = 0xFFFFFFFFu, max_ms = 0, sum_ms = 0;
-        for (rt_uint16_t i = 0; i < cnt; i++)
-        {
-            rt_uint32_t v = stopwatch_get_lap_ms(i);
-            if (v < min_ms) min_ms = v;
-            if (v > max_ms) max_ms = v;
-            sum_ms += v;
-        }
         char stat[24];
-        rt_uint32_t avg_ms = sum_ms / cnt;
-        rt_snprintf(stat, sizeof(stat), "m%u M%u a%u", (unsigned)min_ms, (unsigned)max_ms, (unsigned)avg_ms);
+        rt_snprintf(stat, sizeof(stat), "a%u s%u.%u p%u", (unsigned)sum.mean_ms, (unsigned)(sum.std_x10 / 10),
+                    (unsigned)(sum.std_x10 % 10), (unsigned)sum.p50_ms);
         OLED_ShowString(0, 56, stat, OLED_6X8);
     }
     OLED_Update();
 }
 
-static rt_uint8_t s_page = 0; /* 0: main, 1: laps */
+/* 排行页：最快 6 圈（名次、圈序号、圈时），底行为最慢一圈；只读排行榜，不读圈速环 */
+static void draw_best_page(void)
+{
+    lap_board_t b;
+    lap_board_entry_t e[6];
+    char line[24];
+    char tbuf[16];
+
+    lap_board_get(&b);
+    OLED_Clear();
+    rt_snprintf(line, sizeof(line), "Best of %u", (unsigned)b.upto);
+    OLED_ShowString(0, 0, line, OLED_6X8);
+    rt_uint8_t n = lap_board_sorted(&b, RT_FALSE, e, 6);
+    for (rt_uint8_t i = 0; i < n; i++)
+    {
+        format_time_ms(e[i].lap_ms, tbuf, sizeof(tbuf));
+        rt_snprintf(line, sizeof(line), "%u #%-4u %s", (unsigned)(i + 1), (unsigned)e[i].index, tbuf);
+        OLED_ShowString(0, 8 * (i + 1), line, OLED_6X8);
+    }
+    if (lap_board_sorted(&b, RT_TRUE, e, 1))
+    {
+        format_time_ms(e[0].lap_ms, tbuf, sizeof(tbuf));
+        rt_snprintf(line, sizeof(line), "W #%-4u %s", (unsigned)e[0].index, tbuf);
+        OLED_ShowString(0, 56, line, OLED_6X8);
+    }
+    OLED_Update();
+}
+
+static rt_uint8_t s_page = UI_PAGE_MAIN;
+
+static void ui_wake(void)
+{
+    rt_event_send(&s_ui_evt, UI_EVT_WAKE);
+}
+
+static void ui_on_event(const event_t *e, void *user)
+{
+    (void)user;
+    switch (e->topic)
+    {
+    case EVT_STATE_CHANGED:
+        s_sw_state = (stopwatch_state_t)e->value;
+        break;
+    case EVT_ENV_DARK:
+        s_refresh_ms = UI_DARK_REFRESH_MS;
+        break;
+    case EVT_ENV_LIGHT:
+        s_refresh_ms = s_user_refresh_ms;
+        break;
+    case EVT_SETTINGS_CHANGED:
+        if (e->code == EVT_SET_OLED_RATE) ui_oled_set_refresh_ms((rt_uint16_t)e->value);
+        else if (e->code == EVT_SET_PAGE) ui_oled_set_page((rt_uint8_t)e->value);
+        break;
+    default:
+        break;
+    }
+    ui_wake();
+}
 
 static void ui_entry(void *parameter)
 {
     (void)parameter;
+    rt_uint32_t recved;
     while (1)
     {
         if (s_oled_enabled)
         {
-            if (s_page == 0) draw_main_page(); else draw_laps_page();
+            if (s_page == UI_PAGE_MAIN) draw_main_page();
+            else if (s_page == UI_PAGE_LAPS) draw_laps_page();
+            else draw_best_page();
         }
-        rt_thread_mdelay(s_refresh_ms);
+        rt_int32_t timeout = RT_WAITING_FOREVER;
+        if (s_page == UI_PAGE_MAIN && s_sw_state == STOPWATCH_STATE_RUNNING)
+        {
+            timeout = rt_tick_from_millisecond(s_refresh_ms);
+            if (timeout <= 0) timeout = 1;
+        }
+        rt_event_recv(&s_ui_evt, UI_EVT_WAKE, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, timeout, &recved);
     }
 }
 
@@ -126,6 +196,13 @@ rt_err_t ui_oled_init(void)
     OLED_ShowString(0, 16, "Stopwatch", OLED_8X16);
     OLED_Update();
 
+    rt_event_init(&s_ui_evt, "ui", RT_IPC_FLAG_FIFO);
+    s_sw_state = stopwatch_get_state();
+    event_bus_subscribe(EVT_MASK(EVT_STATE_CHANGED) | EVT_MASK(EVT_LAP_RECORDED) |
+                        EVT_MASK(EVT_ENV_DARK) | EVT_MASK(EVT_ENV_LIGHT) |
+                        EVT_MASK(EVT_SETTINGS_CHANGED),
+                        ui_on_event, RT_NULL, EVENT_DELIVER_SYNC);
+
     s_ui_thread = rt_thread_create("ui_oled", ui_entry, RT_NULL, 1024, RT_THREAD_PRIORITY_MAX - 4, 10);
     if (!s_ui_thread)
     {
@@ -138,34 +215,41 @@ rt_err_t ui_oled_init(void)
 void ui_oled_set_refresh_ms(rt_uint16_t ms)
 {
     if (ms < 10) ms = 10;
+    s_user_refresh_ms = ms;
     s_refresh_ms = ms;
+    ui_wake();
 }
 
 void ui_oled_set_enabled(rt_bool_t enabled)
 {
     s_oled_enabled = enabled ? 1 : 0;
+    ui_wake();
 }
 
 void ui_oled_set_page(rt_uint8_t page)
 {
-    s_page = (page != 0) ? 1 : 0;
+    s_page = (page < UI_PAGE_COUNT) ? page : UI_PAGE_MAIN;
     s_page_drawn = 0; /* 切页后触发静态区域重绘 */
+    ui_wake();
 }
 
 void ui_oled_laps_prev(void)
 {
     if (s_laps_offset >= 6) s_laps_offset -= 6; else s_laps_offset = 0;
+    ui_wake();
 }
 
 void ui_oled_laps_next(void)
 {
     rt_uint16_t cnt = stopwatch_get_lap_count();
     if (s_laps_offset + 6 < cnt) s_laps_offset += 6;
+    ui_wake();
 }
 
 void ui_oled_laps_reset(void)
 {
     s_laps_offset = 0;
+    ui_wake();
 }
 
 
@@ -7,10 +7,19 @@
 extern "C" {
 #endif
 
+/* 页面（EVT_SET_PAGE 的取值） */
+enum
+{
+    UI_PAGE_MAIN = 0,
+    UI_PAGE_LAPS,
+    UI_PAGE_BEST,       /* 圈速排行榜（lap_board） */
+    UI_PAGE_COUNT,
+};
+
 rt_err_t ui_oled_init(void);
 void ui_oled_set_refresh_ms(rt_uint16_t ms);
 void ui_oled_set_enabled(rt_bool_t enabled);
-void ui_oled_set_page(rt_uint8_t page); /* 0: main, 1: laps */
+void ui_oled_set_page(rt_uint8_t page); /* UI_PAGE_*，越界按主界面 */
 void ui_oled_laps_prev(void);
 void ui_oled_laps_next(void);
 void ui_oled_laps_reset(void);
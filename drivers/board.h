@@ -360,10 +360,25 @@ extern "C"
  *
  */
 
-/*#define BSP_USING_ON_CHIP_FLASH*/
+#define BSP_USING_ON_CHIP_FLASH
 
 /*-------------------------- ON_CHIP_FLASH CONFIG END --------------------------*/
 
+/*-------------------------- HARDWARE CRYPTO CONFIG BEGIN --------------------------*/
+
+/** if you want to use the CRC unit through the hwcrypto framework you can use the following instructions.
+ *
+ * STEP 1, enable RT_USING_HWCRYPTO and RT_HWCRYPTO_USING_CRC in rtconfig.h
+ *
+ * STEP 2, define macro related to the crc unit
+ *                 such as    BSP_USING_CRC
+ *
+ */
+
+#define BSP_USING_CRC
+
+/*-------------------------- HARDWARE CRYPTO CONFIG END --------------------------*/
+
 #ifdef __cplusplus
 }
 #endif
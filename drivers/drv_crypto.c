@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2006-2018, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-18     stopwatch    CRC unit only (STM32F1 has no RNG/AES/HASH)
+ *
+ */
+
+#include "board.h"
+
+#if defined(BSP_USING_CRC) && defined(RT_USING_HWCRYPTO) && defined(RT_HWCRYPTO_USING_CRC)
+#include <rtdevice.h>
+
+//#define DRV_DEBUG
+#define LOG_TAG                "drv.crypto"
+#include <drv_log.h>
+
+/*
+ * The F1 CRC unit is fixed to CRC-32/MPEG-2: poly 0x04C11DB7, reset value
+ * 0xFFFFFFFF, 32-bit input fed MSB first, no reflection and no output xor.
+ * Any other configuration is rejected (update returns 0).
+ *
+ * There is no INIT register on F1, so a context continuing from last_val is
+ * resumed by feeding one "preload" word W chosen so that the unit ends up
+ * holding last_val: CRC = shift32(0xFFFFFFFF ^ W) = last_val, i.e.
+ * W = unshift32(last_val) ^ 0xFFFFFFFF. Bytes are packed big-endian so the
+ * result equals a byte-wise MSB-first CRC; the 0..3 tail bytes are finished
+ * in software from the unit's result.
+ */
+
+#define CRC32_POLY      0x04C11DB7UL
+
+struct stm32_hwcrypto_device
+{
+    struct rt_hwcrypto_device dev;
+    struct rt_mutex mutex;
+};
+
+static struct stm32_hwcrypto_device stm32_hw_dev;
+
+static rt_uint32_t crc32_unshift32(rt_uint32_t crc)
+{
+    /* inverse of 32 steps of crc = (crc & 0x80000000) ? (crc << 1) ^ poly : crc << 1 */
+    for (int i = 0; i < 32; i++)
+    {
+        crc = (crc & 1) ? (((crc ^ CRC32_POLY) >> 1) | 0x80000000UL) : (crc >> 1);
+    }
+    return crc;
+}
+
+static rt_uint32_t _crc_update(struct hwcrypto_crc *ctx, const rt_uint8_t *in, rt_size_t length)
+{
+    struct hwcrypto_crc_cfg *cfg = &ctx->crc_cfg;
+    rt_uint32_t crc;
+
+    if (cfg->poly != CRC32_POLY || cfg->width != 32 || (cfg->flags & (CRC_FLAG_REFIN | CRC_FLAG_REFOUT)))
+    {
+        LOG_E("crc config not supported: poly 0x%08x width %d flags 0x%x", cfg->poly, cfg->width, cfg->flags);
+        return 0;
+    }
+
+    rt_mutex_take(&stm32_hw_dev.mutex, RT_WAITING_FOREVER);
+
+    CRC->CR = CRC_CR_RESET;
+    if (cfg->last_val != 0xFFFFFFFFUL)
+    {
+        CRC->DR = crc32_unshift32(cfg->last_val) ^ 0xFFFFFFFFUL;
+    }
+    while (length >= 4)
+    {
+        CRC->DR = ((rt_uint32_t)in[0] << 24) | ((rt_uint32_t)in[1] << 16) | ((rt_uint32_t)in[2] << 8) | in[3];
+        in += 4;
+        length -= 4;
+    }
+    crc = CRC->DR;
+
+    rt_mutex_release(&stm32_hw_dev.mutex);
+
+    while (length--)
+    {
+        crc ^= (rt_uint32_t)(*in++) << 24;
+        for (int i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x80000000UL) ? ((crc << 1) ^ CRC32_POLY) : (crc << 1);
+        }
+    }
+
+    cfg->last_val = crc;
+    return crc ^ cfg->xorout;
+}
+
+static const struct hwcrypto_crc_ops crc_ops =
+{
+    .update = _crc_update,
+};
+
+static rt_err_t _crypto_create(struct rt_hwcrypto_ctx *ctx)
+{
+    switch (ctx->type & HWCRYPTO_MAIN_TYPE_MASK)
+    {
+    case HWCRYPTO_TYPE_CRC:
+        ((struct hwcrypto_crc *)ctx)->ops = &crc_ops;
+        ctx->contex = RT_NULL;
+        return RT_EOK;
+    default:
+        return -RT_ENOSYS;
+    }
+}
+
+static void _crypto_destroy(struct rt_hwcrypto_ctx *ctx)
+{
+    ctx->contex = RT_NULL;
+}
+
+static rt_err_t _crypto_clone(struct rt_hwcrypto_ctx *des, const struct rt_hwcrypto_ctx *src)
+{
+    /* no per-context hardware state: the CRC value lives in crc_cfg.last_val */
+    des->contex = RT_NULL;
+    return RT_EOK;
+}
+
+static void _crypto_reset(struct rt_hwcrypto_ctx *ctx)
+{
+    if ((ctx->type & HWCRYPTO_MAIN_TYPE_MASK) == HWCRYPTO_TYPE_CRC)
+    {
+        ((struct hwcrypto_crc *)ctx)->crc_cfg.last_val = 0xFFFFFFFFUL;
+    }
+}
+
+static const struct rt_hwcrypto_ops _ops =
+{
+    .create = _crypto_create,
+    .destroy = _crypto_destroy,
+    .copy = _crypto_clone,
+    .reset = _crypto_reset,
+};
+
+int stm32_hw_crypto_device_init(void)
+{
+    rt_err_t result;
+
+    __HAL_RCC_CRC_CLK_ENABLE();
+
+    stm32_hw_dev.dev.ops = &_ops;
+    stm32_hw_dev.dev.id = ((rt_uint64_t)(*(rt_uint32_t *)UID_BASE) << 32) | *(rt_uint32_t *)(UID_BASE + 4);
+    stm32_hw_dev.dev.user_data = &stm32_hw_dev;
+
+    rt_mutex_init(&stm32_hw_dev.mutex, "crc", RT_IPC_FLAG_PRIO);
+
+    result = rt_hwcrypto_register(&stm32_hw_dev.dev, RT_HWCRYPTO_DEFAULT_NAME);
+    if (result != RT_EOK)
+    {
+        LOG_E("hw crypto register err code: %d", result);
+        rt_mutex_detach(&stm32_hw_dev.mutex);
+        return result;
+    }
+    return RT_EOK;
+}
+INIT_DEVICE_EXPORT(stm32_hw_crypto_device_init);
+
+#endif /* BSP_USING_CRC && RT_USING_HWCRYPTO && RT_HWCRYPTO_USING_CRC */
@@ -7,6 +7,7 @@
  * Date           Author       Notes
  * 2018-12-5      SummerGift   first version
  * 2020-03-05     redoc        support stm32f103vg
+ * 2026-10-18     stopwatch    add stm32_flash_program for batched half-word programming
  *
  */
 
@@ -123,6 +124,87 @@ int stm32_flash_write(rt_uint32_t addr, const rt_uint8_t *buf, size_t size)
     return size;
 }
 
+/**
+ * Program a run of half-words with a single unlock/lock.
+ * @note This operation must after erase. @see flash_erase.
+ * @note Half-words that are still 0xFFFF in buf are skipped (already erased value).
+ *       The run is verified once after the flash is locked again instead of
+ *       reading back every word while the controller is unlocked.
+ * @note The CPU fetches code from the same bank, so every program stalls
+ *       execution and interrupt entry until BSY clears.
+ *
+ * @param addr flash address, 2-byte aligned
+ * @param buf the write data buffer
+ * @param size write bytes size, even
+ * @param max_busy optional, receives the longest single program time in
+ *        DWT cycles (needs CYCCNT enabled, otherwise 0)
+ *
+ * @return result
+ */
+int stm32_flash_program(rt_uint32_t addr, const rt_uint8_t *buf, size_t size, rt_uint32_t *max_busy)
+{
+    rt_err_t result = RT_EOK;
+    rt_uint32_t start = addr;
+    rt_uint32_t longest = 0;
+    size_t i;
+
+    if ((addr % 2 != 0) || (size % 2 != 0))
+    {
+        LOG_E("program addr and size must be 2-byte alignment");
+        return -RT_EINVAL;
+    }
+
+    if ((addr + size) > STM32_FLASH_END_ADDRESS)
+    {
+        LOG_E("program outrange flash size! addr is (0x%p)", (void *)(addr + size));
+        return -RT_EINVAL;
+    }
+
+    HAL_FLASH_Unlock();
+
+    for (i = 0; i < size; i += 2, addr += 2)
+    {
+        rt_uint16_t hw = (rt_uint16_t)(buf[i] | (buf[i + 1] << 8));
+        rt_uint32_t t0, busy;
+
+        if (hw == 0xFFFF)
+        {
+            continue;
+        }
+
+        t0 = DWT->CYCCNT;
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, addr, hw) != HAL_OK)
+        {
+            result = -RT_ERROR;
+            break;
+        }
+        busy = DWT->CYCCNT - t0;
+        if (busy > longest)
+        {
+            longest = busy;
+        }
+    }
+
+    HAL_FLASH_Lock();
+
+    if (max_busy)
+    {
+        *max_busy = longest;
+    }
+
+    if (result == RT_EOK && rt_memcmp((const void *)start, buf, size) != 0)
+    {
+        result = -RT_ERROR;
+    }
+
+    if (result != RT_EOK)
+    {
+        return result;
+    }
+
+    return size;
+}
+
 /**
  * Erase data on flash with bank.
  * @note This operation is irreversible.
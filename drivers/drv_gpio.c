@@ -335,6 +335,46 @@ static void stm32_pin_write(rt_device_t dev, rt_base_t pin, rt_base_t value)
     HAL_GPIO_WritePin(index->gpio, index->pin, (GPIO_PinState)value);
 }
 
+static rt_err_t stm32_pin_write_mask(rt_device_t dev, rt_base_t port, rt_uint32_t set_mask, rt_uint32_t clr_mask)
+{
+    const struct pin_index *index;
+
+    if (port < 0 || port > 0x0F)
+    {
+        return -RT_EINVAL;
+    }
+    index = get_pin(port * 16);
+    if (index == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    /* BSRR: low half sets, high half resets, one atomic store for the whole port */
+    index->gpio->BSRR = ((clr_mask & 0xFFFFU) << 16) | (set_mask & 0xFFFFU);
+
+    return RT_EOK;
+}
+
+static rt_err_t stm32_pin_get_handle(rt_device_t dev, rt_base_t pin, struct rt_pin_handle *handle)
+{
+    const struct pin_index *index;
+
+    index = get_pin(pin);
+    if (index == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    handle->set_reg  = (volatile rt_uint32_t *)&index->gpio->BSRR;
+    handle->set_mask = index->pin;
+    handle->clr_reg  = (volatile rt_uint32_t *)&index->gpio->BSRR;
+    handle->clr_mask = (rt_uint32_t)index->pin << 16;
+    handle->in_reg   = (volatile rt_uint32_t *)&index->gpio->IDR;
+    handle->in_mask  = index->pin;
+
+    return RT_EOK;
+}
+
 static int stm32_pin_read(rt_device_t dev, rt_base_t pin)
 {
     int value;
@@ -636,6 +676,9 @@ const static struct rt_pin_ops _stm32_pin_ops =
     stm32_pin_attach_irq,
     stm32_pin_dettach_irq,
     stm32_pin_irq_enable,
+    RT_NULL,
+    stm32_pin_write_mask,
+    stm32_pin_get_handle,
 };
 
 rt_inline void pin_irq_hdr(int irqno)
@@ -31,6 +31,10 @@ void _Error_Handler(char *s, int num);
 
 #define __STM32_PORT(port)  GPIO##port##_BASE
 #define GET_PIN(PORTx,PIN) (rt_base_t)((16 * ( ((rt_base_t)__STM32_PORT(PORTx) - (rt_base_t)GPIOA_BASE)/(0x0400UL) )) + PIN)
+/* port index and bit mask for rt_pin_write_mask() */
+#define GET_PORT(PORTx)    (rt_base_t)(GET_PIN(PORTx, 0) / 16)
+#define PIN_PORT(pin)      ((rt_base_t)(pin) / 16)
+#define PIN_MASK(pin)      (1UL << ((rt_base_t)(pin) % 16))
 #define STM32_FLASH_START_ADRESS       ROM_START
 #define STM32_FLASH_SIZE               ROM_SIZE
 #define STM32_FLASH_END_ADDRESS        ROM_END
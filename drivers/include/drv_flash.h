@@ -6,6 +6,7 @@
  * Change Logs:
  * Date           Author       Notes
  * 2018-12-5      SummerGift   first version
+ * 2026-10-18     stopwatch    add stm32_flash_program
  */
 
 #ifndef __DRV_FLASH_H__
@@ -23,6 +24,7 @@ extern "C" {
 int stm32_flash_read(rt_uint32_t addr, rt_uint8_t *buf, size_t size);
 int stm32_flash_write(rt_uint32_t addr, const rt_uint8_t *buf, size_t size);
 int stm32_flash_erase(rt_uint32_t addr, size_t size);
+int stm32_flash_program(rt_uint32_t addr, const rt_uint8_t *buf, size_t size, rt_uint32_t *max_busy);
 
 #ifdef __cplusplus
 }
@@ -56,6 +56,17 @@ struct rt_device_pin_status
     rt_uint16_t pin;
     rt_uint16_t status;
 };
+/* pre-resolved pin: register addresses and masks are decoded once by the
+ * driver, so writes through the handle skip the ops table and index lookup */
+struct rt_pin_handle
+{
+    volatile rt_uint32_t *set_reg;
+    rt_uint32_t           set_mask;
+    volatile rt_uint32_t *clr_reg;
+    rt_uint32_t           clr_mask;
+    volatile rt_uint32_t *in_reg;
+    rt_uint32_t           in_mask;
+};
 struct rt_pin_irq_hdr
 {
     rt_int16_t        pin;
@@ -75,6 +86,10 @@ struct rt_pin_ops
     rt_err_t (*pin_detach_irq)(struct rt_device *device, rt_int32_t pin);
     rt_err_t (*pin_irq_enable)(struct rt_device *device, rt_base_t pin, rt_uint32_t enabled);
     rt_base_t (*pin_get)(const char *name);
+
+    /* optional fast path */
+    rt_err_t (*pin_write_mask)(struct rt_device *device, rt_base_t port, rt_uint32_t set_mask, rt_uint32_t clr_mask);
+    rt_err_t (*pin_get_handle)(struct rt_device *device, rt_base_t pin, struct rt_pin_handle *handle);
 };
 
 int rt_device_pin_register(const char *name, const struct rt_pin_ops *ops, void *user_data);
@@ -89,6 +104,24 @@ rt_err_t rt_pin_attach_irq(rt_int32_t pin, rt_uint32_t mode,
 rt_err_t rt_pin_detach_irq(rt_int32_t pin);
 rt_err_t rt_pin_irq_enable(rt_base_t pin, rt_uint32_t enabled);
 
+/* set and clear several pins of one port with a single register write;
+ * -RT_ENOSYS if the driver lacks the op, -RT_EINVAL for an invalid port */
+rt_err_t rt_pin_write_mask(rt_base_t port, rt_uint32_t set_mask, rt_uint32_t clr_mask);
+rt_err_t rt_pin_get_handle(rt_base_t pin, struct rt_pin_handle *handle);
+
+rt_inline void rt_pin_handle_write(const struct rt_pin_handle *handle, rt_base_t value)
+{
+    if (value)
+        *handle->set_reg = handle->set_mask;
+    else
+        *handle->clr_reg = handle->clr_mask;
+}
+
+rt_inline int rt_pin_handle_read(const struct rt_pin_handle *handle)
+{
+    return (*handle->in_reg & handle->in_mask) ? PIN_HIGH : PIN_LOW;
+}
+
 #ifdef __cplusplus
 }
 #endif
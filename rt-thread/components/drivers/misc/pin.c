@@ -152,6 +152,27 @@ int  rt_pin_read(rt_base_t pin)
 }
 FINSH_FUNCTION_EXPORT_ALIAS(rt_pin_read, pinRead, read status from hardware pin);
 
+rt_err_t rt_pin_write_mask(rt_base_t port, rt_uint32_t set_mask, rt_uint32_t clr_mask)
+{
+    RT_ASSERT(_hw_pin.ops != RT_NULL);
+    if (_hw_pin.ops->pin_write_mask == RT_NULL)
+    {
+        return -RT_ENOSYS;
+    }
+    return _hw_pin.ops->pin_write_mask(&_hw_pin.parent, port, set_mask, clr_mask);
+}
+
+rt_err_t rt_pin_get_handle(rt_base_t pin, struct rt_pin_handle *handle)
+{
+    RT_ASSERT(_hw_pin.ops != RT_NULL);
+    RT_ASSERT(handle != RT_NULL);
+    if (_hw_pin.ops->pin_get_handle == RT_NULL)
+    {
+        return -RT_ENOSYS;
+    }
+    return _hw_pin.ops->pin_get_handle(&_hw_pin.parent, pin, handle);
+}
+
 rt_base_t rt_pin_get(const char *name)
 {
     RT_ASSERT(_hw_pin.ops != RT_NULL);
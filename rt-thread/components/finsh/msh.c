@@ -190,7 +190,7 @@ static int msh_split(char *cmd, rt_size_t length, char *argv[FINSH_ARG_MAX])
     return argc;
 }
 
-static cmd_function_t msh_get_cmd(char *cmd, int size)
+static cmd_function_t msh_get_cmd_linear(const char *cmd, int size)
 {
     struct finsh_syscall *index;
     cmd_function_t cmd_func = RT_NULL;
@@ -212,6 +212,131 @@ static cmd_function_t msh_get_cmd(char *cmd, int size)
     return cmd_func;
 }
 
+#ifdef RT_USING_HEAP
+/* command index built once from the symbol table:
+ * - msh_cmd_sorted: "__cmd_" entries sorted by name (auto-complete walks a prefix range)
+ * - msh_cmd_hash: open addressing table of (sorted position + 1), 0 marks an empty slot */
+static struct finsh_syscall **msh_cmd_sorted = RT_NULL;
+static rt_uint16_t *msh_cmd_hash = RT_NULL;
+static rt_uint16_t msh_cmd_count = 0;
+static rt_uint16_t msh_cmd_hash_mask = 0;
+
+static rt_uint32_t msh_cmd_hash_name(const char *name, int size)
+{
+    rt_uint32_t h = 2166136261UL;   /* FNV-1a */
+
+    while (size-- > 0 && *name)
+    {
+        h ^= (rt_uint8_t)*name++;
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+static void msh_cmd_index_free(void)
+{
+    if (msh_cmd_sorted) rt_free(msh_cmd_sorted);
+    if (msh_cmd_hash) rt_free(msh_cmd_hash);
+    msh_cmd_sorted = RT_NULL;
+    msh_cmd_hash = RT_NULL;
+    msh_cmd_count = 0;
+    msh_cmd_hash_mask = 0;
+}
+
+void msh_cmd_index_build(void)
+{
+    struct finsh_syscall *index;
+    rt_uint32_t count = 0, slots = 4, i, j;
+
+    msh_cmd_index_free();
+
+    for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index))
+    {
+        if (strncmp(index->name, "__cmd_", 6) == 0) count ++;
+    }
+    if (count == 0 || count > 0x7fff) return;
+
+    /* load factor <= 1/2 keeps probe sequences short */
+    while (slots < count * 2) slots <<= 1;
+
+    msh_cmd_sorted = (struct finsh_syscall **)rt_malloc(count * sizeof(struct finsh_syscall *));
+    msh_cmd_hash = (rt_uint16_t *)rt_calloc(slots, sizeof(rt_uint16_t));
+    if (msh_cmd_sorted == RT_NULL || msh_cmd_hash == RT_NULL)
+    {
+        /* fall back to linear lookup */
+        msh_cmd_index_free();
+        return;
+    }
+
+    /* stable insertion sort, so duplicated names resolve like the linear scan */
+    i = 0;
+    for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index))
+    {
+        if (strncmp(index->name, "__cmd_", 6) != 0) continue;
+
+        for (j = i; j > 0 && strcmp(&msh_cmd_sorted[j - 1]->name[6], &index->name[6]) > 0; j --)
+            msh_cmd_sorted[j] = msh_cmd_sorted[j - 1];
+        msh_cmd_sorted[j] = index;
+        i ++;
+    }
+
+    msh_cmd_count = (rt_uint16_t)count;
+    msh_cmd_hash_mask = (rt_uint16_t)(slots - 1);
+    for (i = 0; i < count; i ++)
+    {
+        const char *name = &msh_cmd_sorted[i]->name[6];
+
+        j = msh_cmd_hash_name(name, rt_strlen(name)) & msh_cmd_hash_mask;
+        while (msh_cmd_hash[j] != 0) j = (j + 1) & msh_cmd_hash_mask;
+        msh_cmd_hash[j] = (rt_uint16_t)(i + 1);
+    }
+}
+
+static cmd_function_t msh_get_cmd_indexed(const char *cmd, int size)
+{
+    rt_uint32_t slot = msh_cmd_hash_name(cmd, size) & msh_cmd_hash_mask;
+
+    while (msh_cmd_hash[slot] != 0)
+    {
+        struct finsh_syscall *call = msh_cmd_sorted[msh_cmd_hash[slot] - 1];
+
+        if (strncmp(&call->name[6], cmd, size) == 0 && call->name[6 + size] == '\0')
+            return (cmd_function_t)call->func;
+        slot = (slot + 1) & msh_cmd_hash_mask;
+    }
+
+    return RT_NULL;
+}
+
+int msh_cmd_index_size(void)
+{
+    return msh_cmd_count;
+}
+#else
+void msh_cmd_index_build(void)
+{
+}
+
+int msh_cmd_index_size(void)
+{
+    return 0;
+}
+#endif /* RT_USING_HEAP */
+
+void *msh_find_cmd(const char *cmd, int size, rt_bool_t use_index)
+{
+#ifdef RT_USING_HEAP
+    if (use_index && msh_cmd_hash != RT_NULL)
+        return (void *)msh_get_cmd_indexed(cmd, size);
+#endif
+    return (void *)msh_get_cmd_linear(cmd, size);
+}
+
+static cmd_function_t msh_get_cmd(char *cmd, int size)
+{
+    return (cmd_function_t)msh_find_cmd(cmd, size, RT_TRUE);
+}
+
 #if defined(RT_USING_MODULE) && defined(RT_USING_DFS)
 /* Return 0 on module executed. Other value indicate error.
  */
@@ -369,6 +494,33 @@ static int _msh_exec_lwp(char *cmd, rt_size_t length)
 }
 #endif
 
+/* line timestamps: the serial layer overrides msh_line_timestamp_pop() and returns
+ * one arrival time per line terminator, in reception order */
+static rt_uint64_t msh_line_ts = 0;
+static rt_thread_t msh_line_thread = RT_NULL;
+
+RT_WEAK rt_uint64_t msh_line_timestamp_pop(void)
+{
+    return 0;
+}
+
+void msh_mark_line_end(void)
+{
+    msh_line_ts = msh_line_timestamp_pop();
+    msh_line_thread = rt_thread_self();
+}
+
+rt_uint64_t msh_get_line_timestamp(void)
+{
+    return (rt_thread_self() == msh_line_thread) ? msh_line_ts : 0;
+}
+
+/* for commands that run other commands later within the same line */
+void msh_clear_line_timestamp(void)
+{
+    msh_line_ts = 0;
+}
+
 int msh_exec(char *cmd, rt_size_t length)
 {
     int cmd_ret;
@@ -608,6 +760,39 @@ void msh_auto_complete(char *prefix)
 #endif
 
     /* checks in internal command */
+#ifdef RT_USING_HEAP
+    if (msh_cmd_sorted != RT_NULL)
+    {
+        int lo = 0, hi = msh_cmd_count, plen = strlen(prefix);
+
+        /* first command not less than the prefix, then walk the matching range */
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+
+            if (strcmp(&msh_cmd_sorted[mid]->name[6], prefix) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        for (; lo < msh_cmd_count; lo ++)
+        {
+            cmd_name = (const char *) &msh_cmd_sorted[lo]->name[6];
+            if (strncmp(prefix, cmd_name, plen) != 0) break;
+
+            if (min_length == 0)
+            {
+                name_ptr = cmd_name;
+                min_length = strlen(name_ptr);
+            }
+
+            length = str_common(name_ptr, cmd_name);
+            if (length < min_length)
+                min_length = length;
+
+            rt_kprintf("%s\n", cmd_name);
+        }
+    }
+    else
+#endif
     {
         for (index = _syscall_table_begin; index < _syscall_table_end; FINSH_NEXT_SYSCALL(index))
         {
@@ -17,6 +17,20 @@ rt_bool_t msh_is_used(void);
 int msh_exec(char *cmd, rt_size_t length);
 void msh_auto_complete(char *prefix);
 
+/* command lookup index (hash for dispatch, sorted table for auto-complete),
+ * rebuilt by finsh_system_function_init(); lookup falls back to a linear scan
+ * of the symbol table when the index is not available */
+void msh_cmd_index_build(void);
+int msh_cmd_index_size(void);
+void *msh_find_cmd(const char *cmd, int size, rt_bool_t use_index);
+
+/* arrival time (timebase us) of the line terminator of the command line being
+ * executed by the shell thread; 0 if unknown or called from another thread */
+rt_uint64_t msh_get_line_timestamp(void);
+void msh_clear_line_timestamp(void);
+void msh_mark_line_end(void);
+rt_uint64_t msh_line_timestamp_pop(void);
+
 int msh_exec_module(const char *cmd_line, int size);
 int msh_exec_script(const char *cmd_line, int size);
 
@@ -691,6 +691,9 @@ void finsh_thread_entry(void *parameter)
         /* handle end of line, break */
         if (ch == '\r' || ch == '\n')
         {
+#ifdef FINSH_USING_MSH
+            msh_mark_line_end();
+#endif
 #ifdef FINSH_USING_HISTORY
             shell_push_history(shell);
 #endif
@@ -764,6 +767,9 @@ void finsh_system_function_init(const void *begin, const void *end)
 {
     _syscall_table_begin = (struct finsh_syscall *) begin;
     _syscall_table_end = (struct finsh_syscall *) end;
+#ifdef FINSH_USING_MSH
+    msh_cmd_index_build();
+#endif
 }
 
 void finsh_system_var_init(const void *begin, const void *end)
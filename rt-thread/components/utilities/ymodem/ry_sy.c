@@ -136,7 +136,7 @@ static enum rym_code _rym_send_data(
         ctx->stage = 4;
     }
 
-    return RYM_CODE_SOH;
+    return RYM_CODE_STX;
 }
 
 static enum rym_code _rym_send_end(
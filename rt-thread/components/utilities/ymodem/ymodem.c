@@ -8,6 +8,7 @@
  * Date           Author       Notes
  * 2013-04-14     Grissiom     initial implementation
  * 2019-12-09     Steven Liu   add YMODEM send protocol
+ * 2026-10-18     stopwatch    send 1K (STX) packets, resend on NAK/timeout
  */
 
 #include <rthw.h>
@@ -141,6 +142,7 @@ static rt_size_t _rym_read_data(
     return readlen;
 }
 
+/* the packet size follows the code: SOH carries 128 bytes, STX 1024 bytes */
 static rt_err_t _rym_send_packet(
     struct rym_ctx *ctx,
     enum rym_code code,
@@ -149,20 +151,22 @@ static rt_err_t _rym_send_packet(
     rt_uint16_t send_crc;
     rt_uint8_t index_inv = ~index;
     rt_size_t writelen = 0;
+    rt_size_t data_sz = (code == RYM_CODE_STX) ? 1024 : 128;
+    rt_size_t pkg_sz = data_sz + 5;
 
-    send_crc = CRC16(ctx->buf + 3, _RYM_SOH_PKG_SZ - 5);
+    send_crc = CRC16(ctx->buf + 3, data_sz);
     ctx->buf[0] = code;
     ctx->buf[1] = index;
     ctx->buf[2] = index_inv;
-    ctx->buf[131] = (rt_uint8_t)(send_crc >> 8);
-    ctx->buf[132] = (rt_uint8_t)send_crc & 0xff;
+    ctx->buf[3 + data_sz] = (rt_uint8_t)(send_crc >> 8);
+    ctx->buf[4 + data_sz] = (rt_uint8_t)send_crc & 0xff;
 
     do
     {
         writelen += rt_device_write(ctx->dev, 0, ctx->buf + writelen,
-                                    _RYM_SOH_PKG_SZ - writelen);
+                                    pkg_sz - writelen);
     }
-    while (writelen < _RYM_SOH_PKG_SZ);
+    while (writelen < pkg_sz);
 
     return RT_EOK;
 }
@@ -173,17 +177,57 @@ static rt_size_t _rym_putchar(struct rym_ctx *ctx, rt_uint8_t code)
     return 1;
 }
 
-static rt_size_t _rym_getchar(struct rym_ctx *ctx)
+/* returns RYM_CODE_NONE if nothing arrives within timeout */
+static rt_uint8_t _rym_getchar(struct rym_ctx *ctx, rt_tick_t timeout)
 {
     rt_uint8_t getc_ack;
 
     while (rt_device_read(ctx->dev, 0, &getc_ack, 1) != 1)
     {
-        rt_sem_take(&ctx->sem, RT_WAITING_FOREVER);
+        if (rt_sem_take(&ctx->sem, timeout) != RT_EOK)
+            return RYM_CODE_NONE;
     }
     return getc_ack;
 }
 
+/* drop stale answers (repeated C, a late ACK, line noise) so that the next
+ * answer read belongs to the packet about to be sent. */
+static void _rym_flush_rx(struct rym_ctx *ctx)
+{
+    rt_uint8_t c;
+
+    while (rt_device_read(ctx->dev, 0, &c, 1) == 1)
+        ;
+}
+
+/* send the packet held in ctx->buf and wait for its ACK. A NAK, a C (the
+ * receiver is still asking for packet 0), garbage or a timeout causes the
+ * packet to be sent again, up to RYM_SEND_RETRY times. */
+static rt_err_t _rym_send_packet_ack(
+    struct rym_ctx *ctx,
+    enum rym_code code,
+    rt_uint8_t index)
+{
+    rt_size_t retry;
+    rt_uint8_t getc_ack;
+
+    for (retry = 0; retry <= RYM_SEND_RETRY; retry++)
+    {
+        if (retry)
+            ctx->resend++;
+        _rym_flush_rx(ctx);
+        _rym_send_packet(ctx, code, index);
+
+        getc_ack = _rym_getchar(ctx, RYM_WAIT_PKG_TICK);
+        if (getc_ack == RYM_CODE_ACK)
+            return RT_EOK;
+        if (getc_ack == RYM_CODE_CAN)
+            return -RYM_ERR_CAN;
+    }
+
+    return -RYM_ERR_ACK;
+}
+
 static rt_err_t _rym_do_handshake(
     struct rym_ctx *ctx,
     int tm_sec)
@@ -255,6 +299,7 @@ static rt_err_t _rym_do_send_handshake(
     rt_size_t data_sz;
     rt_uint8_t index = 0;
     rt_uint8_t getc_ack;
+    rt_err_t err;
 
     ctx->stage = RYM_STAGE_ESTABLISHING;
     data_sz = _RYM_SOH_PKG_SZ;
@@ -279,17 +324,12 @@ static rt_err_t _rym_do_send_handshake(
         return -RYM_ERR_CODE;
 
     code = RYM_CODE_SOH;
-    _rym_send_packet(ctx, code, index);
-
     rt_device_set_rx_indicate(ctx->dev, _rym_rx_ind);
-    getc_ack = _rym_getchar(ctx);
-
-    if (getc_ack != RYM_CODE_ACK)
-    {
-        return -RYM_ERR_ACK;
-    }
+    err = _rym_send_packet_ack(ctx, code, index);
+    if (err != RT_EOK)
+        return err;
 
-    getc_ack = _rym_getchar(ctx);
+    getc_ack = _rym_getchar(ctx, RYM_WAIT_PKG_TICK);
 
     if (getc_ack != RYM_CODE_C)
     {
@@ -400,27 +440,23 @@ static rt_err_t _rym_do_send_trans(struct rym_ctx *ctx)
     enum rym_code code;
     rt_size_t data_sz;
     rt_uint32_t index = 1;
-    rt_uint8_t getc_ack;
+    rt_err_t err;
 
-    data_sz = _RYM_SOH_PKG_SZ;
+    data_sz = _RYM_STX_PKG_SZ;
 
     while (1)
     {
-        if (ctx->on_data && ctx->on_data(ctx, ctx->buf + 3, data_sz - 5) != RYM_CODE_SOH)
+        if (!ctx->on_data)
+            return -RYM_ERR_CODE;
+        code = ctx->on_data(ctx, ctx->buf + 3, data_sz - 5);
+        if (code != RYM_CODE_SOH && code != RYM_CODE_STX)
             return -RYM_ERR_CODE;
 
-        code = RYM_CODE_SOH;
-
-        _rym_send_packet(ctx, code, index);
-        index++;
         rt_device_set_rx_indicate(ctx->dev, _rym_rx_ind);
-
-        getc_ack = _rym_getchar(ctx);
-
-        if (getc_ack != RYM_CODE_ACK)
-        {
-            return -RYM_ERR_ACK;
-        }
+        err = _rym_send_packet_ack(ctx, code, (rt_uint8_t)index);
+        if (err != RT_EOK)
+            return err;
+        index++;
 
         if (ctx->stage == RYM_STAGE_FINISHING)
             break;
@@ -498,27 +534,31 @@ static rt_err_t _rym_do_send_fin(struct rym_ctx *ctx)
     rt_size_t data_sz;
     rt_uint8_t index = 0;
     rt_uint8_t getc_ack;
+    rt_size_t retry;
+    rt_err_t err;
 
     data_sz = _RYM_SOH_PKG_SZ;
     rt_device_set_rx_indicate(ctx->dev, _rym_rx_ind);
 
-    _rym_putchar(ctx, RYM_CODE_EOT);
-    getc_ack = _rym_getchar(ctx);
-
-    if (getc_ack != RYM_CODE_NAK)
+    /* the receiver NAKs the first EOT and ACKs the second one; some receivers
+     * ACK the first EOT directly, so keep sending EOT until it is ACKed. */
+    for (retry = 0; ; retry++)
     {
-        return -RYM_ERR_ACK;
-    }
+        if (retry > RYM_SEND_RETRY)
+            return -RYM_ERR_ACK;
 
-    _rym_putchar(ctx, RYM_CODE_EOT);
-    getc_ack = _rym_getchar(ctx);
+        _rym_putchar(ctx, RYM_CODE_EOT);
+        getc_ack = _rym_getchar(ctx, RYM_WAIT_PKG_TICK);
 
-    if (getc_ack != RYM_CODE_ACK)
-    {
-        return -RYM_ERR_ACK;
+        if (getc_ack == RYM_CODE_ACK)
+            break;
+        if (getc_ack == RYM_CODE_CAN)
+            return -RYM_ERR_CAN;
+        if (getc_ack != RYM_CODE_NAK)
+            ctx->resend++;
     }
 
-    getc_ack = _rym_getchar(ctx);
+    getc_ack = _rym_getchar(ctx, RYM_WAIT_PKG_TICK);
 
     if (getc_ack != RYM_CODE_C)
     {
@@ -530,7 +570,11 @@ static rt_err_t _rym_do_send_fin(struct rym_ctx *ctx)
 
     code = RYM_CODE_SOH;
 
-    _rym_send_packet(ctx, code, index);
+    /* the receiver ACKs the empty packet 0; wait for it so that the ACK does
+     * not leak to whoever reads the device next. */
+    err = _rym_send_packet_ack(ctx, code, index);
+    if (err != RT_EOK)
+        return err;
 
     ctx->stage = RYM_STAGE_FINISHED;
 
@@ -585,6 +629,7 @@ static rt_err_t _rym_do_send(
     rt_err_t err;
 
     ctx->stage = RYM_STAGE_NONE;
+    ctx->resend = 0;
 
     ctx->buf = rt_malloc(_RYM_STX_PKG_SZ);
     if (ctx->buf == RT_NULL)
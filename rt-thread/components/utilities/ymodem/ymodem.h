@@ -8,6 +8,7 @@
  * Date           Author       Notes
  * 2013-04-14     Grissiom     initial implementation
  * 2019-12-09     Steven Liu   add YMODEM send protocol
+ * 2026-10-18     stopwatch    send 1K (STX) packets, resend on NAK/timeout
  */
 
 #ifndef __YMODEM_H__
@@ -70,6 +71,12 @@ enum rym_code
 #define RYM_END_SESSION_SEND_CAN_NUM  0x07
 #endif
 
+/* how many times the sender re-sends a packet (or EOT) that is answered with
+ * NAK, C, garbage or nothing within RYM_WAIT_PKG_TICK. */
+#ifndef RYM_SEND_RETRY
+#define RYM_SEND_RETRY 10
+#endif
+
 enum rym_stage
 {
     RYM_STAGE_NONE,
@@ -117,6 +124,9 @@ struct rym_ctx
     struct rt_semaphore sem;
 
     rt_device_t dev;
+
+    /* how many packets have been re-sent, only counted when sending */
+    rt_uint32_t resend;
 };
 
 /* recv a file on device dev with ymodem session ctx.
@@ -158,8 +168,10 @@ rt_err_t rym_recv_on_device(struct rym_ctx *ctx, rt_device_t dev, rt_uint16_t of
  * on_begin can not be NULL.
  *
  * @param on_data The callback will be invoked when the data packets is sent.
- * The callback should read file system and prepare the data packets. The
- * on_data can not be NULL.
+ * The callback should read file system and prepare the data packets. The len
+ * is 1024: return RYM_CODE_STX to send the whole buf as a 1K packet, or
+ * RYM_CODE_SOH to send only the first 128 bytes of it. Set ctx->stage to
+ * RYM_STAGE_FINISHING on the last packet. The on_data can not be NULL.
  *
  * @param on_end The callback will be invoked when one transmission is
  * finished. The data should be 128 bytes of NULL. The on_end can not be NULL.
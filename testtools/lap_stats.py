@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+RT-Thread Stopwatch 项目 - 圈速流式统计（sw_stats）主机端参考实现与自测
+算法与 applications/lap_stats.c 逐步一致（全整数，除法按 C 语义向零截断）：
+  均值/标准差  Welford：M2 += (x - 旧均值)(x - 新均值)，均值 Q8 = (和 << 8) // 圈数，乘积 Q16 四舍五入累加到 ms²
+  p50/p90      P² 估计，标记高度 Q4 ms，期望位置以 1/2000 为单位精确比较
+  直方图       对数-线性分格，每个二进制数量级 8 格（SUB_BITS=3），小于 16 ms 逐毫秒一格
+用法：
+  python lap_stats.py --selftest [--laps 2000 --seed 1]   与精确值（排序分位、总体标准差、逐圈分格）对照
+  python lap_stats.py --sim 1000 [--seed 1]               输出与设备 `sw_stats sim 1000 1` 相同的文本（逐行可比）
+  python lap_stats.py laps.csv                            统计 CSV（如 sw_export laps 的 LAPS.CSV）第二列圈时
+"""
+
+import argparse
+import csv
+import math
+import random
+import statistics
+import sys
+from typing import List
+
+SUB_BITS = 3
+SUB = 1 << SUB_BITS
+MAX_MS = 1 << 23
+BUCKETS = (23 - SUB_BITS + 1) * SUB
+
+
+def tdiv(a: int, b: int) -> int:
+    """C 整数除法：向零截断"""
+    q = abs(a) // abs(b)
+    return q if (a >= 0) == (b > 0) else -q
+
+
+def bucket(ms: int) -> int:
+    ms = min(ms, MAX_MS - 1)
+    if ms < 2 * SUB:
+        return ms
+    shift = ms.bit_length() - 1 - SUB_BITS
+    return (shift + 1) * SUB + ((ms >> shift) - SUB)
+
+
+def bucket_low(b: int) -> int:
+    if b < 2 * SUB:
+        return b
+    return (SUB + b % SUB) << (b // SUB - 1)
+
+
+class P2:
+    def __init__(self, permille: int):
+        self.p = permille
+        self.q = [0] * 5
+        self.n = [0] * 5
+
+    def add(self, count: int, ms: int):
+        x = ms << 4
+        q, n = self.q, self.n
+        if count < 5:
+            i = count
+            while i > 0 and q[i - 1] > x:
+                q[i] = q[i - 1]
+                i -= 1
+            q[i] = x
+            if count == 4:
+                self.n = [1, 2, 3, 4, 5]
+            return
+        if x < q[0]:
+            q[0] = x
+            k = 0
+        elif x >= q[4]:
+            q[4] = x
+            k = 3
+        else:
+            k = 0
+            while x >= q[k + 1]:
+                k += 1
+        for i in range(k + 1, 5):
+            n[i] += 1
+        num = (0, self.p, 2 * self.p, 1000 + self.p, 2000)
+        for i in (1, 2, 3):
+            d = 2000 + count * num[i] - 2000 * n[i]
+            if not ((d >= 2000 and n[i + 1] - n[i] > 1) or (d <= -2000 and n[i - 1] - n[i] < -1)):
+                continue
+            s = 1 if d >= 0 else -1
+            t1 = tdiv((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]), n[i + 1] - n[i])
+            t2 = tdiv((n[i + 1] - n[i] - s) * (q[i] - q[i - 1]), n[i] - n[i - 1])
+            qp = q[i] + tdiv(s * (t1 + t2), n[i + 1] - n[i - 1])
+            if q[i - 1] < qp < q[i + 1]:
+                q[i] = qp
+            else:
+                q[i] += tdiv((q[i + s] - q[i]) * s, n[i + s] - n[i])
+            n[i] += s
+
+    def value(self, count: int) -> int:
+        if count == 0:
+            return 0
+        if count <= 5:
+            return self.q[((count - 1) * self.p + 500) // 1000] >> 4
+        return (self.q[2] + 8) >> 4
+
+
+class LapStats:
+    def __init__(self):
+        self.n = 0
+        self.min_ms = 0
+        self.max_ms = 0
+        self.sum_ms = 0
+        self.m2 = 0
+        self.p50 = P2(500)
+        self.p90 = P2(900)
+        self.hist = [0] * BUCKETS
+
+    def add(self, lap_ms: int):
+        x = min(lap_ms, MAX_MS - 1)
+        if self.n == 0 or lap_ms < self.min_ms:
+            self.min_ms = lap_ms
+        self.max_ms = max(self.max_ms, lap_ms)
+        xq = x << 8
+        mean_old = (self.sum_ms << 8) // self.n if self.n else xq
+        self.sum_ms += x
+        mean_new = (self.sum_ms << 8) // (self.n + 1)
+        prod = (xq - mean_old) * (xq - mean_new)
+        if prod > 0:
+            self.m2 += (prod + 32768) >> 16
+        self.p50.add(self.n, x)
+        self.p90.add(self.n, x)
+        self.n += 1
+        b = bucket(x)
+        self.hist[b] = min(self.hist[b] + 1, 0xFFFF)
+
+    def summary(self) -> dict:
+        if self.n == 0:
+            return dict(n=0, min=0, max=0, mean=0, std_x10=0, p50=0, p90=0)
+        var_x100 = (self.m2 // self.n) * 100 + (self.m2 % self.n) * 100 // self.n
+        return dict(n=self.n, min=self.min_ms, max=self.max_ms, mean=(self.sum_ms + self.n // 2) // self.n,
+                    std_x10=math.isqrt(var_x100), p50=self.p50.value(self.n), p90=self.p90.value(self.n))
+
+    def report(self) -> List[str]:
+        s = self.summary()
+        lines = ['laps=%u min=%u max=%u mean=%u std=%u.%u p50=%u p90=%u' % (
+            s['n'], s['min'], s['max'], s['mean'], s['std_x10'] // 10, s['std_x10'] % 10, s['p50'], s['p90'])]
+        peak = max(self.hist)
+        for b, c in enumerate(self.hist):
+            if c:
+                lines.append('  %7u..%-7u %5u %s' % (bucket_low(b), bucket_low(b + 1), c, '#' * ((c * 30 + peak - 1) // peak)))
+        return lines
+
+
+def sim_laps(count: int, seed: int) -> List[int]:
+    """与固件 sw_stats sim 相同的 LCG 序列"""
+    rng = seed & 0xFFFFFFFF
+
+    def rand():
+        nonlocal rng
+        rng = (rng * 1103515245 + 12345) & 0xFFFFFFFF
+        return rng >> 8
+
+    laps = []
+    for _ in range(count):
+        slow = rand() % 16 == 0
+        ms = 58000 + rand() % 4000
+        if slow:
+            ms += rand() % 15000
+        laps.append(ms)
+    return laps
+
+
+def exact_quantile(sorted_laps: List[int], p: float) -> float:
+    """线性插值分位（P² 的目标定义）"""
+    h = (len(sorted_laps) - 1) * p
+    lo = math.floor(h)
+    hi = min(lo + 1, len(sorted_laps) - 1)
+    return sorted_laps[lo] + (sorted_laps[hi] - sorted_laps[lo]) * (h - lo)
+
+
+def check(name: str, laps: List[int], q_tol: float) -> bool:
+    st = LapStats()
+    for v in laps:
+        st.add(v)
+    s = st.summary()
+    xs = sorted(min(v, MAX_MS - 1) for v in laps)
+    ok = True
+    errs = []
+
+    if s['n'] != len(laps) or s['min'] != min(laps) or s['max'] != max(laps):
+        errs.append('count/min/max')
+    if s['mean'] != (sum(xs) + len(xs) // 2) // len(xs):
+        errs.append('mean %u' % s['mean'])
+    std_ref = statistics.pstdev(xs)
+    std_err = abs(s['std_x10'] / 10 - std_ref)
+    if std_err > 0.1 + std_ref * 1e-4:
+        errs.append('std %.1f vs %.3f' % (s['std_x10'] / 10, std_ref))
+
+    # P² 为估计值：误差以该分位附近的数据间距（0.05~0.95 四分位距）归一
+    spread = max(exact_quantile(xs, 0.95) - exact_quantile(xs, 0.05), 1)
+    q_err = []
+    for key, p in (('p50', 0.5), ('p90', 0.9)):
+        ref = exact_quantile(xs, p)
+        e = abs(s[key] - ref) / spread
+        q_err.append('%s=%u ref=%.1f err=%.2f%%' % (key, s[key], ref, e * 100))
+        if len(xs) <= 5:
+            if s[key] != xs[((len(xs) - 1) * int(p * 1000) + 500) // 1000]:
+                errs.append(key)
+        elif e > q_tol:
+            errs.append('%s err %.3f' % (key, e))
+
+    ref_hist = [0] * BUCKETS
+    for v in xs:
+        # 独立求格号：按格下界二分
+        lo, hi = 0, BUCKETS - 1
+        while lo < hi:
+            mid = (lo + hi + 1) // 2
+            if bucket_low(mid) <= v:
+                lo = mid
+            else:
+                hi = mid - 1
+        ref_hist[lo] += 1
+    if st.hist != [min(c, 0xFFFF) for c in ref_hist]:
+        errs.append('histogram')
+
+    if errs:
+        ok = False
+    print('%-12s n=%-6u std=%.1f(ref %.3f) %s  %s' % (name, len(laps), s['std_x10'] / 10, std_ref, ' '.join(q_err),
+                                                    'OK' if ok else 'FAIL ' + ','.join(errs)))
+    return ok
+
+
+def selftest(nlaps: int, seed: int) -> bool:
+    rnd = random.Random(seed)
+    ok = True
+
+    # 分格：下界单调、相邻格首尾相接、格号往返
+    for b in range(BUCKETS - 1):
+        if not bucket_low(b) < bucket_low(b + 1) or bucket(bucket_low(b)) != b or bucket(bucket_low(b + 1) - 1) != b:
+            print('bucket %u broken' % b)
+            ok = False
+    if bucket(MAX_MS + 5) != BUCKETS - 1 or bucket_low(BUCKETS) != MAX_MS:
+        print('bucket range broken')
+        ok = False
+
+    cases = [
+        ('tiny', [61234, 59000, 60500], 0),
+        ('five', [5, 1, 4, 2, 3], 0),
+        ('constant', [60000] * nlaps, 0.0),
+        ('uniform', [rnd.randint(55000, 65000) for _ in range(nlaps)], 0.02),
+        ('normal', [max(1, int(rnd.gauss(60000, 1500))) for _ in range(nlaps)], 0.02),
+        ('skewed', [int(40000 + rnd.expovariate(1 / 8000)) for _ in range(nlaps)], 0.03),
+        ('sim', sim_laps(nlaps, seed), 0.03),
+        # 整场单调变快：P² 假设分布平稳，只要求量级正确
+        ('drift', [60000 - i * 5 + rnd.randint(-300, 300) for i in range(nlaps)], 0.15),
+        ('short', [rnd.randint(1, 40) for _ in range(nlaps)], 0.05),
+        ('clamped', [rnd.choice([MAX_MS + 1000, 9000000, 100]) for _ in range(200)], 0.05),
+    ]
+    for name, laps, tol in cases:
+        ok &= check(name, laps, tol)
+    return ok
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description='streaming lap statistics (sw_stats) reference')
+    ap.add_argument('file', nargs='?', help='CSV with lap times (ms) in the second column')
+    ap.add_argument('--selftest', action='store_true')
+    ap.add_argument('--sim', type=int, metavar='LAPS')
+    ap.add_argument('--laps', type=int, default=2000)
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    if args.selftest:
+        ok = selftest(args.laps, args.seed)
+        print('ALL PASS' if ok else 'FAILED')
+        return 0 if ok else 1
+    if args.sim is not None:
+        st = LapStats()
+        for v in sim_laps(args.sim, args.seed):
+            st.add(v)
+        print('sim: laps=%u seed=%u' % (args.sim, args.seed))
+        print('\n'.join(st.report()))
+        return 0
+    if args.file:
+        st = LapStats()
+        with open(args.file, newline='') as f:
+            for row in csv.reader(f):
+                if len(row) >= 2 and row[1].strip().isdigit():
+                    st.add(int(row[1]))
+        print('\n'.join(st.report()))
+        return 0
+    ap.print_help()
+    return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
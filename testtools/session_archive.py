@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+RT-Thread Stopwatch 项目 - 历史会话归档（sw_hist）主机端工具
+格式与 applications/session_archive.c 一致，全部小端：
+  页   = magic('SAR2') seq ~seq + 记录...；页环形使用，seq 最大的为当前页
+  记录 = 头(36) + 圈数据(补齐到 4) + crc32(头与圈数据，多项式 0x04C11DB7，初值 0xFFFFFFFF，不反射)
+  头   = len(u16) id(u16) start_rtc(u32) total_ms(u32) lap_total(u16) lap_count(u16) blob_len(u16)
+         flags(u16) min_ms(u32) max_ms(u32) avg_ms(u32) first_lap(u16) rsv(u16)
+         lap_total 为会话总圈数，圈数据从第 first_lap 圈开始（开机恢复的会话大于 1）
+  圈数据 = 每圈与上一圈（首圈与 0）的差值，zigzag 后按 7 位一组变长编码
+用法：
+  python session_archive.py --selftest [--sessions 40 --laps 20 --seed 1]   编解码往返、压缩率与查询耗时
+  python session_archive.py --dump dump.txt                                 解析 sw_hist dump 的输出
+  python session_archive.py --port COM5                                     从设备读取并列出会话
+"""
+
+import argparse
+import bisect
+import random
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+from typing import Dict, List, Optional, Tuple
+
+PAGE_MAGIC = 0x32524153
+PAGE_HDR = struct.Struct('<III')
+REC_HDR = struct.Struct('<HHIIHHHHIIIHH')
+PAGE_SIZE = 1024
+PAGES = 4
+BLOB_MAX = 128
+NO_LAP = 0xFFFFFFFF
+FLAG_TRUNCATED = 0x0001
+FLAG_PARTIAL = 0x0002
+
+
+def crc32_mpeg2(data: bytes) -> int:
+    crc = 0xFFFFFFFF
+    for b in data:
+        crc ^= b << 24
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x04C11DB7) if crc & 0x80000000 else (crc << 1)
+            crc &= 0xFFFFFFFF
+    return crc
+
+
+def encode_laps(laps: List[int], blob_max: int = BLOB_MAX) -> Tuple[bytes, int]:
+    """返回 (圈数据, 保存的圈数)；超出 blob_max 的圈不保存，与固件一致"""
+    out = bytearray()
+    prev = 0
+    for n, ms in enumerate(laps):
+        d = (ms - prev + 0x80000000) % 0x100000000 - 0x80000000
+        z = ((d << 1) ^ (d >> 31)) & 0xFFFFFFFF
+        enc = bytearray()
+        while True:
+            b = z & 0x7F
+            z >>= 7
+            enc.append(b | (0x80 if z else 0))
+            if not z:
+                break
+        if len(out) + len(enc) > blob_max:
+            return bytes(out), n
+        out += enc
+        prev = ms
+    return bytes(out), len(laps)
+
+
+def decode_laps(blob: bytes, count: int) -> List[int]:
+    laps, prev, pos = [], 0, 0
+    for _ in range(count):
+        z, shift = 0, 0
+        while True:
+            if pos >= len(blob) or shift > 28:
+                raise ValueError('lap data truncated')
+            b = blob[pos]
+            pos += 1
+            z |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        d = (z >> 1) ^ -(z & 1)
+        prev = (prev + d) & 0xFFFFFFFF
+        laps.append(prev)
+    return laps
+
+
+@dataclass
+class Session:
+    id: int
+    start_rtc: int
+    total_ms: int
+    lap_total: int
+    flags: int
+    min_ms: int
+    max_ms: int
+    avg_ms: int
+    first_lap: int = 1
+    laps: List[int] = field(default_factory=list)
+    blob_len: int = 0
+    offset: int = 0
+
+
+def rec_size(blob_len: int) -> int:
+    return REC_HDR.size + ((blob_len + 3) & ~3) + 4
+
+
+def build_record(sid: int, start_rtc: int, total_ms: int, laps: List[int], first_lap: int = 1) -> bytes:
+    blob, stored = encode_laps(laps)
+    size = rec_size(len(blob))
+    flags = FLAG_TRUNCATED if stored < len(laps) else 0
+    if first_lap > 1:
+        flags |= FLAG_PARTIAL
+    mn = min(laps) if laps else NO_LAP
+    mx = max(laps) if laps else 0
+    avg = sum(laps) // len(laps) if laps else 0
+    hdr = REC_HDR.pack(size, sid, start_rtc, total_ms, min(first_lap - 1 + len(laps), 0xFFFF), stored, len(blob), flags,
+                       mn, mx, avg, min(first_lap, 0xFFFF), 0)
+    body = hdr + blob
+    rec = body + b'\xff' * (size - 4 - len(body))
+    return rec + struct.pack('<I', crc32_mpeg2(body))
+
+
+class ArchiveImage:
+    """按固件规则写入的归档区镜像（页满换页，擦除最旧一页）"""
+
+    def __init__(self, page_size: int = PAGE_SIZE, pages: int = PAGES):
+        self.page_size, self.pages = page_size, pages
+        self.data = bytearray(b'\xff' * page_size * pages)
+        self.active, self.seq, self.next_id = 0, 1, 1
+        self._commit(0, 1)
+        self.wr = PAGE_HDR.size
+
+    def _commit(self, page: int, seq: int):
+        o = page * self.page_size
+        self.data[o:o + self.page_size] = b'\xff' * self.page_size
+        self.data[o:o + PAGE_HDR.size] = PAGE_HDR.pack(PAGE_MAGIC, seq, seq ^ 0xFFFFFFFF)
+
+    def append(self, start_rtc: int, total_ms: int, laps: List[int], first_lap: int = 1) -> int:
+        rec = build_record(self.next_id, start_rtc, total_ms, laps, first_lap)
+        if self.wr + len(rec) > self.page_size:
+            self.active = (self.active + 1) % self.pages
+            self.seq += 1
+            self._commit(self.active, self.seq)
+            self.wr = PAGE_HDR.size
+        o = self.active * self.page_size + self.wr
+        self.data[o:o + len(rec)] = rec
+        self.wr += len(rec)
+        self.next_id += 1
+        return self.next_id - 1
+
+
+def parse_image(data: bytes, page_size: int = PAGE_SIZE) -> List[Session]:
+    """按写入顺序返回所有完整会话（残缺记录之后的内容忽略）"""
+    pages = len(data) // page_size
+    valid: Dict[int, int] = {}
+    for p in range(pages):
+        magic, seq, nseq = PAGE_HDR.unpack_from(data, p * page_size)
+        if magic == PAGE_MAGIC and seq ^ nseq == 0xFFFFFFFF:
+            valid[p] = seq
+    if not valid:
+        return []
+    newest = max(valid, key=lambda p: valid[p])
+    out = []
+    for k in range(1, pages + 1):
+        p = (newest + k) % pages
+        if p not in valid:
+            continue
+        off = PAGE_HDR.size
+        while off + REC_HDR.size <= page_size:
+            base = p * page_size + off
+            f = REC_HDR.unpack_from(data, base)
+            size, blob_len = f[0], f[6]
+            if size == 0xFFFF:
+                break
+            if blob_len > BLOB_MAX or size != rec_size(blob_len) or off + size > page_size:
+                break
+            body = bytes(data[base:base + REC_HDR.size + blob_len])
+            if crc32_mpeg2(body) != struct.unpack_from('<I', data, base + size - 4)[0]:
+                break
+            s = Session(id=f[1], start_rtc=f[2], total_ms=f[3], lap_total=f[4], flags=f[7],
+                        min_ms=f[8], max_ms=f[9], avg_ms=f[10], first_lap=f[11], blob_len=blob_len, offset=base)
+            s.laps = decode_laps(body[REC_HDR.size:], f[5])
+            out.append(s)
+            off += size
+    return out
+
+
+class ArchiveIndex:
+    """与固件 RAM 索引相同：(id, 偏移, 最快圈)，按 id 有序"""
+
+    def __init__(self, data: bytes, sessions: List[Session]):
+        self.data = data
+        self.ids = [s.id for s in sessions]
+        self.offs = [s.offset for s in sessions]
+        self.best = [s.min_ms for s in sessions]
+
+    def read(self, pos: int) -> Session:
+        base = self.offs[pos]
+        f = REC_HDR.unpack_from(self.data, base)
+        s = Session(id=f[1], start_rtc=f[2], total_ms=f[3], lap_total=f[4], flags=f[7],
+                    min_ms=f[8], max_ms=f[9], avg_ms=f[10], first_lap=f[11], blob_len=f[6], offset=base)
+        s.laps = decode_laps(bytes(self.data[base + REC_HDR.size:base + REC_HDR.size + f[6]]), f[5])
+        return s
+
+    def find(self, sid: int) -> Optional[Session]:
+        pos = bisect.bisect_left(self.ids, sid)
+        return self.read(pos) if pos < len(self.ids) and self.ids[pos] == sid else None
+
+    def best_session(self) -> Optional[Session]:
+        cand = [i for i, b in enumerate(self.best) if b != NO_LAP]
+        return self.read(min(cand, key=lambda i: self.best[i])) if cand else None
+
+
+def fmt_ms(ms: int) -> str:
+    return '-' if ms == NO_LAP else f'{ms / 1000:.3f}'
+
+
+def print_sessions(sessions: List[Session]):
+    print(f"{'id':>5} {'start_rtc':>10} {'total':>10} {'laps':>5} {'best':>9} {'avg':>9}")
+    for s in sessions:
+        mark = ' *' if s.flags & (FLAG_TRUNCATED | FLAG_PARTIAL) else ''
+        print(f"#{s.id:<4} {s.start_rtc:>10} {fmt_ms(s.total_ms):>10} {s.lap_total:>5} "
+              f"{fmt_ms(s.min_ms):>9} {fmt_ms(s.avg_ms if s.min_ms != NO_LAP else NO_LAP):>9}{mark}")
+
+
+def parse_dump(text: str) -> bytes:
+    """sw_hist dump 输出：每行 'oooo:hex...'"""
+    chunks = {}
+    for line in text.splitlines():
+        line = line.strip()
+        if len(line) > 5 and line[4] == ':':
+            try:
+                chunks[int(line[:4], 16)] = bytes.fromhex(line[5:])
+            except ValueError:
+                continue
+    data = bytearray()
+    for off in sorted(chunks):
+        data[off:off + len(chunks[off])] = chunks[off]
+    return bytes(data)
+
+
+def selftest(sessions: int, laps: int, seed: int, queries: int = 2000) -> bool:
+    rng = random.Random(seed)
+    img = ArchiveImage()
+    expect: Dict[int, List[int]] = {}
+    firsts: Dict[int, int] = {}
+    mins: Dict[int, int] = {}
+    raw = enc = 0
+    for n in range(sessions):
+        base_ms = rng.randint(20000, 80000)
+        seq = [base_ms + rng.randint(-1500, 1499) for _ in range(laps)]
+        # 每 5 个会话模拟一次开机恢复：圈数据从更后的圈开始
+        first = 1 + rng.randint(1, 50) if n % 5 == 4 else 1
+        sid = img.append(n * 600, sum(seq), seq, first)
+        blob, stored = encode_laps(seq)
+        expect[sid] = seq[:stored]
+        firsts[sid] = first
+        mins[sid] = min(seq) if seq else NO_LAP
+        raw += 4 * stored
+        enc += len(blob)
+
+    data = bytes(img.data)
+    t0 = time.perf_counter()
+    parsed = parse_image(data)
+    t_mount = time.perf_counter() - t0
+    ok = bool(parsed)
+    for s in parsed:
+        if s.laps != expect[s.id] or s.first_lap != firsts[s.id] or s.lap_total != firsts[s.id] - 1 + laps:
+            print(f"session #{s.id}: round-trip mismatch")
+            ok = False
+
+    idx = ArchiveIndex(data, parsed)
+    ids = [s.id for s in parsed]
+    t0 = time.perf_counter()
+    for _ in range(queries):
+        s = idx.find(rng.choice(ids))
+        ok &= s is not None and s.laps == expect[s.id]
+    t_index = (time.perf_counter() - t0) / queries
+    t0 = time.perf_counter()
+    for _ in range(max(1, queries // 20)):
+        sid = rng.choice(ids)
+        ok &= any(s.id == sid for s in parse_image(data))
+    t_scan = (time.perf_counter() - t0) / max(1, queries // 20)
+
+    best = idx.best_session()
+    ok &= best is not None and best.min_ms == min(mins[i] for i in ids)
+    print(f"sessions={sessions} laps={laps} kept={len(parsed)} (ids {ids[0]}..{ids[-1]})" if parsed else "no sessions")
+    if enc:
+        print(f"lap data: {raw} bytes raw -> {enc} bytes encoded, {enc * 4 / raw:.2f} bytes/lap (x{raw / enc:.2f})")
+    print(f"mount+index {t_mount * 1e3:.2f} ms, query by index {t_index * 1e6:.1f} us, query by full scan {t_scan * 1e6:.1f} us")
+    print('PASS' if ok else 'FAIL')
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Stopwatch 历史会话归档解析与自测')
+    parser.add_argument('--selftest', action='store_true', help='编解码往返、压缩率与查询耗时自测')
+    parser.add_argument('--sessions', type=int, default=40)
+    parser.add_argument('--laps', type=int, default=20)
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--dump', help='sw_hist dump 输出的文本文件')
+    parser.add_argument('--port', help='串口号，直接从设备读取 sw_hist dump')
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--show', type=int, help='打印指定会话的各圈')
+    args = parser.parse_args()
+
+    if args.selftest:
+        ok = selftest(args.sessions, args.laps, args.seed)
+        # 圈数超过圈数据上限时只保存前面的圈
+        ok &= selftest(8, 300, args.seed + 1)
+        sys.exit(0 if ok else 1)
+
+    if args.dump:
+        with open(args.dump, encoding='utf-8', errors='ignore') as f:
+            text = f.read()
+    elif args.port:
+        try:
+            import serial
+        except ImportError:
+            print("错误: 缺少 pyserial 模块")
+            print("请安装: pip install pyserial")
+            sys.exit(1)
+        with serial.Serial(args.port, args.baud, timeout=0.5) as ser:
+            time.sleep(1)
+            ser.reset_input_buffer()
+            ser.write(b"sw_hist dump\n")
+            buf = bytearray()
+            while True:
+                chunk = ser.read(4096)
+                if not chunk:
+                    break
+                buf += chunk
+        text = buf.decode(errors='ignore')
+    else:
+        parser.print_help()
+        sys.exit(1)
+
+    sessions = parse_image(parse_dump(text))
+    print_sessions(sessions)
+    if args.show is not None:
+        for s in sessions:
+            if s.id == args.show:
+                for i, ms in enumerate(s.laps, s.first_lap):
+                    print(f"  lap {i:3} {fmt_ms(ms)}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+RT-Thread Stopwatch 项目 - 会话记录文件（sw_rec，*.REC）主机端解析
+格式与 applications/session_recorder.c 一致，全部小端，每条 16 字节：
+  文件头 = type(u8)=0x80 version(u8)=1 rec_size(u16)=16 magic(u32)='SRC1' start_rtc(u32) t0_ms(u32)
+  记录   = type(u8) state(u8) lap_idx(u16) t_ms(u32, 相对 t0_ms) total_ms(u32) value(u32)
+  type: 1 开始 2 暂停 3 圈速(value=圈时) 4 复位(value=结束总用时) 5 清圈 6 恢复 7 采样；0xFF 为末扇区填充
+用法：
+  python session_recorder.py 0001E240.REC [--csv out.csv]   列出汇总与圈速，可导出 CSV
+  python session_recorder.py --selftest [--laps 500 --seed 1]  生成同格式文件（含扇区填充）并往返核对
+"""
+
+import argparse
+import csv
+import random
+import struct
+import sys
+from dataclasses import dataclass, field
+from typing import List
+
+HDR = struct.Struct('<BBHIII')
+REC = struct.Struct('<BBHIII')
+MAGIC = 0x31435253
+SECTOR = 512
+TYPE_NAMES = {1: 'start', 2: 'stop', 3: 'lap', 4: 'reset', 5: 'clear', 6: 'restore', 7: 'sample'}
+STATE_NAMES = {0: 'idle', 1: 'running', 2: 'paused'}
+
+
+@dataclass
+class Record:
+    type: int
+    state: int
+    lap_idx: int
+    t_ms: int
+    total_ms: int
+    value: int
+
+
+@dataclass
+class RecFile:
+    start_rtc: int
+    t0_ms: int
+    records: List[Record] = field(default_factory=list)
+    padded: bool = False       # 遇到 0xFF 填充即结束（掉电时末扇区可能残留填充）
+
+    @property
+    def laps(self) -> List[Record]:
+        return [r for r in self.records if r.type == 3]
+
+
+def parse(data: bytes) -> RecFile:
+    if len(data) < HDR.size:
+        raise ValueError('file too short')
+    typ, ver, size, magic, rtc, t0 = HDR.unpack_from(data, 0)
+    if typ != 0x80 or magic != MAGIC or size != REC.size:
+        raise ValueError('bad header')
+    if ver != 1:
+        raise ValueError('unsupported version %d' % ver)
+    f = RecFile(rtc, t0)
+    for off in range(HDR.size, len(data) - REC.size + 1, REC.size):
+        r = Record(*REC.unpack_from(data, off))
+        if r.type == 0xFF:
+            f.padded = True
+            break
+        f.records.append(r)
+    return f
+
+
+def fmt_ms(ms: int) -> str:
+    return '%d.%03d' % (ms // 1000, ms % 1000)
+
+
+def summary(f: RecFile) -> str:
+    laps = [r.value for r in f.laps]
+    end = f.records[-1] if f.records else None
+    total = end.value if end and end.type == 4 else (end.total_ms if end else 0)
+    s = 'start_rtc=%d records=%d laps=%d total=%s' % (f.start_rtc, len(f.records), len(laps), fmt_ms(total))
+    if laps:
+        s += ' best=%s worst=%s avg=%s' % (fmt_ms(min(laps)), fmt_ms(max(laps)), fmt_ms(sum(laps) // len(laps)))
+    if not end or end.type != 4:
+        s += ' (not closed)'
+    return s
+
+
+def write_csv(f: RecFile, path: str):
+    with open(path, 'w', newline='') as fp:
+        w = csv.writer(fp)
+        w.writerow(['t_ms', 'type', 'state', 'lap_idx', 'total_ms', 'value'])
+        for r in f.records:
+            w.writerow([r.t_ms, TYPE_NAMES.get(r.type, r.type), STATE_NAMES.get(r.state, r.state),
+                        r.lap_idx, r.total_ms, r.value])
+
+
+def build(laps: List[int], rtc: int, t0: int, close: bool, pad: bool) -> bytes:
+    """按固件规则生成文件：开始、各圈、（可选）复位；pad 模拟未关闭文件末扇区的 0xFF 填充"""
+    out = bytearray(HDR.pack(0x80, 1, REC.size, MAGIC, rtc, t0))
+    t = total = 0
+    out += REC.pack(1, 1, 0, t, total, 0)
+    for i, ms in enumerate(laps, 1):
+        t += ms
+        total += ms
+        out += REC.pack(3, 1, i, t, total, ms)
+    if close:
+        out += REC.pack(4, 1, 0, t + 1, 0, total)
+    if pad and len(out) % SECTOR:
+        out += b'\xff' * (SECTOR - len(out) % SECTOR)
+    return bytes(out)
+
+
+def selftest(nlaps: int, seed: int) -> bool:
+    rng = random.Random(seed)
+    ok = True
+    for close, pad in ((True, False), (False, True)):
+        laps = [rng.randint(200, 120000) for _ in range(nlaps)]
+        data = build(laps, 0x1E240, 5000, close, pad)
+        f = parse(data)
+        got = [r.value for r in f.laps]
+        idx_ok = all(r.lap_idx == i for i, r in enumerate(f.laps, 1))
+        case_ok = got == laps and idx_ok and (f.records[-1].type == 4) == close and f.padded == (pad and len(data) > 16 * (nlaps + 2))
+        print('%-10s %6d B  %s  -> %s' % ('closed' if close else 'unclosed', len(data), summary(f), 'PASS' if case_ok else 'FAIL'))
+        ok = ok and case_ok
+    return ok
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description='session recorder file (*.REC) decoder')
+    ap.add_argument('file', nargs='?')
+    ap.add_argument('--csv')
+    ap.add_argument('--selftest', action='store_true')
+    ap.add_argument('--laps', type=int, default=500)
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    if args.selftest:
+        return 0 if selftest(args.laps, args.seed) else 1
+    if not args.file:
+        ap.print_help()
+        return 2
+    with open(args.file, 'rb') as fp:
+        f = parse(fp.read())
+    print(summary(f))
+    for r in f.laps:
+        print('  lap %4d %10s  total %10s' % (r.lap_idx, fmt_ms(r.value), fmt_ms(r.total_ms)))
+    if args.csv:
+        write_csv(f, args.csv)
+        print('csv -> %s' % args.csv)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -2,7 +2,7 @@
 # -*- coding: utf-8 -*-
 """
 RT-Thread Stopwatch 项目 - 完整自动化测试套件
-测试项目：计时精度、圈速功能、CSV周期、命令响应、长时间稳定性
+测试项目：计时精度、圈速功能、CSV周期、二进制流、设备端定时脚本、命令响应、长时间稳定性
 """
 
 import argparse
@@ -16,6 +16,8 @@ from datetime import datetime
 from pathlib import Path
 from typing import List, Optional, Dict, Any
 
+from telemetry_decoder import capture as capture_bin_stream
+
 try:
     import serial
 except ImportError:
@@ -53,13 +55,39 @@ class CSVStabilityResult:
     sample_count: int
     mean_interval_ms: float
     std_dev_ms: float
-    min_interval_ms: int
-    max_interval_ms: int
+    min_interval_ms: float
+    max_interval_ms: float
     jitter_percent: float
     packet_loss_count: int
     passed: bool
 
 
+@dataclass
+class BinStreamResult:
+    """二进制遥测流测试结果（间隔取设备端 us 时间戳）"""
+    target_period_ms: int
+    record_count: int
+    rate_hz: float
+    lost_count: int
+    bad_frames: int
+    mean_interval_us: float
+    std_dev_us: float
+    max_interval_us: int
+    passed: bool
+
+
+@dataclass
+class ScriptResult:
+    """设备端定时脚本测试结果（圈速由脚本按固定偏移触发，不受串口往返影响）"""
+    lap_interval_ms: int
+    lap_count: int
+    min_lap_ms: int
+    max_lap_ms: int
+    max_late_us: int
+    avg_late_us: int
+    passed: bool
+
+
 @dataclass
 class CommandResponseResult:
     """命令响应测试结果"""
@@ -89,6 +117,8 @@ class TestReport:
     timing_accuracy: Optional[TimingAccuracyResult] = None
     lap_test: Optional[LapTestResult] = None
     csv_stability: Optional[CSVStabilityResult] = None
+    bin_stream: Optional[BinStreamResult] = None
+    script: Optional[ScriptResult] = None
     command_tests: List[CommandResponseResult] = field(default_factory=list)
     long_run: Optional[LongRunResult] = None
     summary: Dict[str, Any] = field(default_factory=dict)
@@ -311,7 +341,7 @@ class StopwatchTester:
 
     # ==================== 测试3: CSV周期稳定性 ====================
     def test_csv_stability(self, period_ms: int = 100, duration_s: int = 15) -> CSVStabilityResult:
-        """测试CSV周期稳定性（周期 ≥100ms）"""
+        """测试CSV周期稳定性（按记录中的设备端 us 时间戳与序号统计，周期 1ms 起）"""
         print(f"\n{'='*60}")
         print(f"测试 3: CSV周期稳定性 ({period_ms}ms, {duration_s}秒)")
         print(f"{'='*60}")
@@ -324,7 +354,7 @@ class StopwatchTester:
         
         print(f"[INFO] 采集CSV数据 {duration_s} 秒...")
         
-        timestamps = []
+        samples = []  # (seq, t_us, n)，n>1 为设备端背压聚合记录
         start_time = time.time()
         header_seen = False
         buffer = ""
@@ -341,15 +371,16 @@ class StopwatchTester:
                     if not line or 'msh >' in line:
                         continue
                     
-                    if not header_seen and line.startswith('t,'):
+                    if not header_seen and line.startswith('seq,'):
                         header_seen = True
                         continue
                     
+                    # seq,t_us,lap_idx,lap_ms,total,skipped[,n,min,max]
                     parts = line.split(',')
-                    if len(parts) >= 4:
+                    if len(parts) >= 6:
                         try:
-                            t_ms = int(parts[0])
-                            timestamps.append(t_ms)
+                            n = int(parts[6]) if len(parts) >= 9 else 1
+                            samples.append((int(parts[0]), int(parts[1]), n))
                         except ValueError:
                             continue
             
@@ -358,8 +389,8 @@ class StopwatchTester:
         self.send_command("sw_csv off")
         self.send_command("sw_stop")
         
-        if len(timestamps) < 3:
-            print(f"[错误] CSV采样不足: {len(timestamps)} 条")
+        if len(samples) < 3:
+            print(f"[错误] CSV采样不足: {len(samples)} 条")
             return CSVStabilityResult(
                 target_period_ms=period_ms,
                 sample_count=0,
@@ -372,32 +403,46 @@ class StopwatchTester:
                 passed=False
             )
         
-        intervals = [timestamps[i+1] - timestamps[i] for i in range(len(timestamps) - 1)]
+        # 只用序号相邻的逐条记录计算间隔；聚合记录覆盖 n 个采样，其余序号缺口即设备端丢弃的采样
+        intervals = []
+        packet_loss = 0
+        aggregated = 0
+        for (s0, t0, _), (s1, t1, n1) in zip(samples, samples[1:]):
+            gap = (s1 - s0) & 0xFFFFFFFF
+            if n1 > 1:
+                aggregated += 1
+            if gap == 1 and n1 == 1:
+                intervals.append((t1 - t0) / 1000.0)
+            elif gap > n1:
+                packet_loss += gap - n1
+        if not intervals:
+            intervals = [0.0]
+        total_samples = sum(n for _, _, n in samples) + packet_loss
+        
         mean_interval = statistics.mean(intervals)
         std_dev = statistics.stdev(intervals) if len(intervals) > 1 else 0
         min_interval = min(intervals)
         max_interval = max(intervals)
         jitter_pct = (std_dev / period_ms) * 100 if period_ms > 0 else 0
-        packet_loss = sum(1 for x in intervals if x > period_ms * 1.5)
         
         # 通过标准: 平均误差<10%, 抖动<15%, 丢包<5%
         passed = (
             abs(mean_interval - period_ms) / period_ms < 0.10 and
             jitter_pct < 15 and
-            packet_loss / len(intervals) < 0.05
+            packet_loss / total_samples < 0.05
         )
         
-        print(f"[结果] 样本数: {len(timestamps)}")
+        print(f"[结果] 样本数: {len(samples)}")
         print(f"[结果] 平均间隔: {mean_interval:.2f} ms (目标: {period_ms} ms)")
         print(f"[结果] 标准差: {std_dev:.2f} ms")
-        print(f"[结果] 范围: {min_interval} - {max_interval} ms")
+        print(f"[结果] 范围: {min_interval:.3f} - {max_interval:.3f} ms")
         print(f"[结果] 抖动率: {jitter_pct:.2f}%")
-        print(f"[结果] 丢包数: {packet_loss}/{len(intervals)}")
+        print(f"[结果] 丢包数: {packet_loss}/{total_samples}, 聚合记录: {aggregated}")
         print(f"[结果] {'✅ 通过' if passed else '❌ 失败'}")
         
         return CSVStabilityResult(
             target_period_ms=period_ms,
-            sample_count=len(timestamps),
+            sample_count=len(samples),
             mean_interval_ms=mean_interval,
             std_dev_ms=std_dev,
             min_interval_ms=min_interval,
@@ -407,6 +452,107 @@ class StopwatchTester:
             passed=passed
         )
 
+    # ==================== 测试3b: 二进制流 ====================
+    def test_bin_stream(self, period_ms: int = 2, duration_s: int = 10) -> BinStreamResult:
+        """测试二进制遥测流（sw_stream bin），按序号检测丢包，按设备时间戳统计抖动"""
+        print(f"\n{'='*60}")
+        print(f"测试 3b: 二进制流 ({period_ms}ms, {duration_s}秒)")
+        print(f"{'='*60}")
+
+        self.send_command("sw_reset")
+        self.send_command("sw_start")
+
+        print(f"[INFO] 采集二进制帧 {duration_s} 秒...")
+        res = capture_bin_stream(self.ser, period_ms, duration_s)
+        self.ser.reset_input_buffer()
+        self.send_command("sw_stop")
+
+        records = res['records']
+        lost = res['lost']
+        bad = res['bad_crc'] + res['bad_frame']
+        mean_iv = res.get('mean_interval_us', 0.0)
+        std_iv = res.get('std_dev_us', 0.0)
+        max_iv = res.get('max_interval_us', 0)
+        target_us = period_ms * 1000
+
+        # 通过标准: 平均误差<5%, 丢包<1%, 坏帧不超过首帧前的 shell 残留
+        passed = (
+            records > 0 and
+            abs(mean_iv - target_us) / target_us < 0.05 and
+            lost / (records + lost) < 0.01 and
+            bad <= 1
+        )
+
+        print(f"[结果] 记录数: {records} ({res['rate_hz']:.1f} Hz)")
+        print(f"[结果] 平均间隔: {mean_iv:.1f} us (目标: {target_us} us)")
+        print(f"[结果] 标准差: {std_iv:.1f} us, 最大间隔: {max_iv} us")
+        print(f"[结果] 丢失: {lost}, 坏帧: {bad}")
+        print(f"[结果] {'✅ 通过' if passed else '❌ 失败'}")
+
+        return BinStreamResult(
+            target_period_ms=period_ms,
+            record_count=records,
+            rate_hz=res['rate_hz'],
+            lost_count=lost,
+            bad_frames=bad,
+            mean_interval_us=mean_iv,
+            std_dev_us=std_iv,
+            max_interval_us=max_iv,
+            passed=passed
+        )
+
+    # ==================== 测试3c: 设备端定时脚本 ====================
+    def test_script(self, interval_ms: int = 500, lap_count: int = 8) -> ScriptResult:
+        """上传 sw_script 定时脚本，由设备按 timebase 偏移派发 sw_start/sw_lap/sw_stop，检查圈速与派发延迟"""
+        print(f"\n{'='*60}")
+        print(f"测试 3c: 设备端定时脚本 ({lap_count}圈 × {interval_ms}ms)")
+        print(f"{'='*60}")
+
+        self.send_command("sw_script clear")
+        self.send_command("sw_script add 0 sw_reset")
+        self.send_command("sw_script add 0 sw_start")
+        for i in range(1, lap_count + 1):
+            self.send_command(f"sw_script add {i * interval_ms} sw_lap")
+        self.send_command(f"sw_script add {lap_count * interval_ms} sw_stop")
+        self.send_command("sw_script run")
+
+        time.sleep(lap_count * interval_ms / 1000.0 + 0.5)
+        self.ser.reset_input_buffer()
+        log_lines = self.send_command("sw_script log")
+        status = self.parse_status_output(self.send_command("sw_status"))
+
+        max_late = avg_late = -1
+        for line in log_lines:
+            m = re.search(r'max_late=(\d+) us avg_late=(\d+) us', line)
+            if m:
+                max_late, avg_late = int(m.group(1)), int(m.group(2))
+
+        laps = status.get('lap_count', 0)
+        min_lap = status.get('min_ms', 0)
+        max_lap = status.get('max_ms', 0)
+
+        # 通过标准: 圈数正确, 每圈误差 ≤1ms（ms 取整）, 派发延迟 < 2ms
+        passed = (
+            laps == lap_count and
+            abs(min_lap - interval_ms) <= 1 and
+            abs(max_lap - interval_ms) <= 1 and
+            0 <= max_late < 2000
+        )
+
+        print(f"[结果] 圈数: {laps}/{lap_count}, 圈速范围: {min_lap} - {max_lap} ms (目标: {interval_ms} ms)")
+        print(f"[结果] 派发延迟: 最大 {max_late} us, 平均 {avg_late} us")
+        print(f"[结果] {'✅ 通过' if passed else '❌ 失败'}")
+
+        return ScriptResult(
+            lap_interval_ms=interval_ms,
+            lap_count=laps,
+            min_lap_ms=min_lap,
+            max_lap_ms=max_lap,
+            max_late_us=max_late,
+            avg_late_us=avg_late,
+            passed=passed
+        )
+
     # ==================== 测试4: 命令响应 ====================
     def test_command_response(self) -> List[CommandResponseResult]:
         """测试命令响应速度"""
@@ -530,6 +676,16 @@ def generate_report(report: TestReport, output_file: Optional[Path] = None):
         if report.csv_stability.passed:
             passed_tests += 1
     
+    if report.bin_stream:
+        total_tests += 1
+        if report.bin_stream.passed:
+            passed_tests += 1
+    
+    if report.script:
+        total_tests += 1
+        if report.script.passed:
+            passed_tests += 1
+    
     if report.long_run:
         total_tests += 1
         if report.long_run.passed:
@@ -554,6 +710,14 @@ def generate_report(report: TestReport, output_file: Optional[Path] = None):
         print(f"CSV周期: ≥{report.csv_stability.target_period_ms} ms " +
               f"(抖动 {report.csv_stability.jitter_percent:.1f}%)")
     
+    if report.bin_stream:
+        print(f"二进制流: {report.bin_stream.rate_hz:.0f} Hz " +
+              f"(丢失 {report.bin_stream.lost_count}, 间隔标准差 {report.bin_stream.std_dev_us:.0f} us)")
+    
+    if report.script:
+        print(f"脚本派发: 最大延迟 {report.script.max_late_us} us " +
+              f"(圈速 {report.script.min_lap_ms}-{report.script.max_lap_ms} ms / 目标 {report.script.lap_interval_ms} ms)")
+    
     # 保存JSON
     if output_file:
         report_dict = asdict(report)
@@ -571,7 +735,7 @@ def main():
     parser.add_argument('--port', required=True, help='串口号 (如 COM5 或 /dev/ttyUSB0)')
     parser.add_argument('--baud', type=int, default=115200, help='波特率 (默认: 115200)')
     parser.add_argument('--tests', nargs='+', 
-                       choices=['timing', 'lap', 'csv', 'cmd', 'longrun', 'all'],
+                       choices=['timing', 'lap', 'csv', 'bin', 'script', 'cmd', 'longrun', 'all'],
                        default=['all'],
                        help='要执行的测试项目')
     parser.add_argument('--timing-duration', type=int, default=60, 
@@ -579,9 +743,15 @@ def main():
     parser.add_argument('--lap-count', type=int, default=20, 
                        help='圈速测试数量, 默认20')
     parser.add_argument('--csv-period', type=int, default=100, 
-                       help='CSV测试周期(ms), 默认100')
+                       help='CSV测试周期(ms, ≥1), 默认100')
     parser.add_argument('--csv-duration', type=int, default=15, 
                        help='CSV测试时长(秒), 默认15')
+    parser.add_argument('--bin-period', type=int, default=2, 
+                       help='二进制流采样周期(ms), 默认2')
+    parser.add_argument('--bin-duration', type=int, default=10, 
+                       help='二进制流测试时长(秒), 默认10')
+    parser.add_argument('--script-interval', type=int, default=500, 
+                       help='定时脚本圈间隔(ms), 默认500')
     parser.add_argument('--longrun-duration', type=int, default=5, 
                        help='长时间运行测试(分钟), 默认5')
     parser.add_argument('--output', type=Path, help='输出报告文件(JSON)')
@@ -602,7 +772,7 @@ def main():
     
     tests_to_run = args.tests
     if 'all' in tests_to_run:
-        tests_to_run = ['timing', 'lap', 'csv', 'cmd', 'longrun']
+        tests_to_run = ['timing', 'lap', 'csv', 'bin', 'script', 'cmd', 'longrun']
     
     try:
         # 执行测试
@@ -615,6 +785,12 @@ def main():
         if 'csv' in tests_to_run:
             report.csv_stability = tester.test_csv_stability(args.csv_period, args.csv_duration)
         
+        if 'bin' in tests_to_run:
+            report.bin_stream = tester.test_bin_stream(args.bin_period, args.bin_duration)
+        
+        if 'script' in tests_to_run:
+            report.script = tester.test_script(args.script_interval)
+        
         if 'cmd' in tests_to_run:
             report.command_tests = tester.test_command_response()
         
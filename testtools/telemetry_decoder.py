@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+RT-Thread Stopwatch 项目 - 二进制遥测流解码器
+对应固件命令 sw_stream bin [period_ms]，帧格式见 PROJECT_STOPWATCH.md：
+  帧 = COBS(载荷) + 0x00
+  载荷 = ver(u8) n(u8) seq0(u32) t0_us(u64) + n × 记录 + crc16(u16)，全部小端
+  记录 = dseq(u8) dt_us(u32) total_ms(u32) lap_ms(u32) lap_idx(u16) state(u8)
+  state 最高位为 1 表示背压聚合记录（其余字段取窗口内最后一个采样），其序号缺口不计丢失；
+  版本 2 起聚合记录后追加 agg_n(u16) min_total_ms(u32) max_total_ms(u32)
+  crc16 = CRC-16/CCITT-FALSE，覆盖 crc 之前的全部载荷
+"""
+
+import argparse
+import statistics
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+from typing import List, Optional
+
+BIN_VERSION = 0x02
+STATE_AGG = 0x80
+HDR = struct.Struct('<BBIQ')
+REC = struct.Struct('<BIIIHB')
+AGG_EXT = struct.Struct('<HII')
+MAX_FRAME = 512  # 超长视为噪声，丢弃
+
+
+@dataclass
+class Record:
+    seq: int
+    t_us: int
+    total_ms: int
+    lap_ms: int
+    lap_idx: int
+    state: int
+    aggregated: bool = False
+    agg_n: int = 1              # 聚合的采样数（版本 1 的帧不带，为 0）
+    min_total_ms: Optional[int] = None
+    max_total_ms: Optional[int] = None
+
+
+@dataclass
+class StreamStats:
+    frames: int = 0
+    bad_crc: int = 0
+    bad_frame: int = 0          # COBS 错误/长度不符/版本不符
+    records: int = 0
+    lost: int = 0               # 由序号跳变推断的丢失条数
+    aggregated: int = 0         # 设备端聚合记录数
+    intervals_us: List[int] = field(default_factory=list)
+
+
+def crc16_ccitt(data: bytes, crc: int = 0xFFFF) -> int:
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(data: bytes) -> Optional[bytes]:
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        code = data[i]
+        if code == 0:
+            return None
+        i += 1
+        end = i + code - 1
+        if end > n:
+            return None
+        out += data[i:end]
+        i = end
+        if code != 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+class StreamDecoder:
+    """流式解码：可喂入任意切分的字节块，帧间的 shell 文本会被当作坏帧丢弃"""
+
+    def __init__(self):
+        self.stats = StreamStats()
+        self._buf = bytearray()
+        self._last_seq: Optional[int] = None
+        self._last_t: Optional[int] = None
+
+    def feed(self, chunk: bytes) -> List[Record]:
+        out: List[Record] = []
+        self._buf += chunk
+        while True:
+            idx = self._buf.find(b'\x00')
+            if idx < 0:
+                if len(self._buf) > MAX_FRAME:
+                    self._buf.clear()
+                break
+            frame = bytes(self._buf[:idx])
+            del self._buf[:idx + 1]
+            if frame:
+                out.extend(self._parse(frame))
+        return out
+
+    def _parse(self, frame: bytes) -> List[Record]:
+        raw = cobs_decode(frame) if len(frame) <= MAX_FRAME else None
+        if raw is None or len(raw) < HDR.size + 2:
+            self.stats.bad_frame += 1
+            return []
+        body, crc = raw[:-2], struct.unpack_from('<H', raw, len(raw) - 2)[0]
+        if crc16_ccitt(body) != crc:
+            self.stats.bad_crc += 1
+            return []
+        ver, n, seq, t_us = HDR.unpack_from(body, 0)
+        if ver not in (1, BIN_VERSION):
+            self.stats.bad_frame += 1
+            return []
+
+        recs: List[Record] = []
+        off = HDR.size
+        for _ in range(n):
+            if off + REC.size > len(body):
+                break
+            dseq, dt_us, total_ms, lap_ms, lap_idx, state = REC.unpack_from(body, off)
+            off += REC.size
+            seq = (seq + dseq) & 0xFFFFFFFF
+            t_us += dt_us
+            r = Record(seq, t_us, total_ms, lap_ms, lap_idx, state & ~STATE_AGG & 0xFF, bool(state & STATE_AGG))
+            if r.aggregated:
+                r.agg_n = 0
+                if ver >= 2:
+                    if off + AGG_EXT.size > len(body):
+                        break
+                    r.agg_n, r.min_total_ms, r.max_total_ms = AGG_EXT.unpack_from(body, off)
+                    off += AGG_EXT.size
+            recs.append(r)
+        if len(recs) != n or off != len(body):
+            self.stats.bad_frame += 1
+            return []
+
+        self.stats.frames += 1
+
+        for r in recs:
+            if self._last_seq is not None:
+                gap = (r.seq - self._last_seq) & 0xFFFFFFFF
+                if r.aggregated:
+                    # 聚合记录覆盖 agg_n 个采样，超出部分才是设备端丢弃（版本 1 不带 agg_n，不计）
+                    self.stats.aggregated += 1
+                    if r.agg_n and gap > r.agg_n:
+                        self.stats.lost += gap - r.agg_n
+                elif gap > 1:
+                    self.stats.lost += gap - 1
+                elif gap == 1:
+                    self.stats.intervals_us.append(r.t_us - self._last_t)
+            self._last_seq = r.seq
+            self._last_t = r.t_us
+        self.stats.records += len(recs)
+        return recs
+
+
+def summarize(stats: StreamStats, period_ms: float, elapsed_s: float) -> dict:
+    iv = stats.intervals_us
+    result = {
+        'records': stats.records,
+        'frames': stats.frames,
+        'bad_crc': stats.bad_crc,
+        'bad_frame': stats.bad_frame,
+        'lost': stats.lost,
+        'aggregated': stats.aggregated,
+        'rate_hz': stats.records / elapsed_s if elapsed_s > 0 else 0.0,
+        'loss_percent': stats.lost * 100.0 / (stats.records + stats.lost) if stats.records else 0.0,
+    }
+    if len(iv) >= 2:
+        result.update({
+            'mean_interval_us': statistics.mean(iv),
+            'std_dev_us': statistics.stdev(iv),
+            'min_interval_us': min(iv),
+            'max_interval_us': max(iv),
+            'jitter_percent': statistics.stdev(iv) / (period_ms * 10.0) if period_ms > 0 else 0.0,
+        })
+    return result
+
+
+def capture(ser, period_ms: int, duration_s: float) -> dict:
+    """在已打开的串口上启动二进制流，采集 duration_s 秒后停止并返回统计"""
+    dec = StreamDecoder()
+    ser.reset_input_buffer()
+    ser.write(f"sw_stream bin {period_ms}\n".encode())
+    ser.flush()
+    start = time.time()
+    while time.time() - start < duration_s:
+        n = ser.in_waiting
+        if n:
+            dec.feed(ser.read(n))
+        else:
+            time.sleep(0.002)
+    elapsed = time.time() - start
+    ser.write(b"sw_stream off\n")
+    ser.flush()
+    time.sleep(0.2)
+    dec.feed(ser.read(ser.in_waiting))
+    return summarize(dec.stats, period_ms, elapsed)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Stopwatch 二进制遥测流采集与校验')
+    parser.add_argument('--port', required=True, help='串口号 (如 COM5 或 /dev/ttyUSB0)')
+    parser.add_argument('--baud', type=int, default=115200, help='波特率 (默认: 115200)')
+    parser.add_argument('--period', type=int, default=2, help='采样周期(ms), 默认2')
+    parser.add_argument('--duration', type=float, default=10, help='采集时长(秒), 默认10')
+    args = parser.parse_args()
+
+    try:
+        import serial
+    except ImportError:
+        print("错误: 缺少 pyserial 模块")
+        print("请安装: pip install pyserial")
+        sys.exit(1)
+
+    with serial.Serial(args.port, args.baud, timeout=0.1) as ser:
+        time.sleep(1)
+        res = capture(ser, args.period, args.duration)
+    for k, v in res.items():
+        print(f"{k:>18}: {v:.2f}" if isinstance(v, float) else f"{k:>18}: {v}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,484 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+RT-Thread Stopwatch 项目 - sw_export 的 YMODEM 接收端
+协议与 rt-thread/components/utilities/ymodem（本项目已扩展 1K 包与重发）一致：
+  接收端每秒发 'C' -> 包 0（文件名 NUL 长度）ACK 'C' -> 数据包 STX(1024)/SOH(128) 逐包 ACK
+  -> EOT NAK EOT ACK 'C' -> 空包 0 ACK
+  包 = SOH|STX seq ~seq 数据 CRC16（XMODEM：多项式 0x1021，初值 0，大端）
+  校验错、包不完整或超时 NAK（包 0 阶段回 'C'），重复包（ACK 丢失后发送端重发）只 ACK 不保存
+  包之间的杂散字节（shell 提示、其他线程的日志）跳过；传输结束后读取 sw_export 的汇总行，核对 CRC-32
+用法：
+  python ymodem_receiver.py --port COM5 [--cmd "sw_export archive"] [--out .] [--decode]
+  python ymodem_receiver.py --stdio --out rx/                       经标准输入输出收发（接 socat 等）
+  python ymodem_receiver.py --selftest [--size 8192 --noise 0.05 --seed 1 --baud 115200]
+"""
+
+import argparse
+import os
+import queue
+import random
+import re
+import select
+import struct
+import sys
+import threading
+import time
+from typing import List, Optional, Tuple
+
+SOH, STX, EOT, ACK, NAK, CAN, CPMEOF = 0x01, 0x02, 0x04, 0x06, 0x15, 0x18, 0x1A
+C = 0x43
+TIMEOUT, BAD = -1, -2
+REPORT = re.compile(r'sw_export: (\d+) B in (\d+) ms, (\d+) B/s = (\d+)% of (\d+) baud, (\d+) blocks, '
+                    r'(\d+) resent, crc32 0x([0-9a-f]{8})')
+
+
+def crc16_xmodem(data: bytes) -> int:
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def crc32_mpeg2(data: bytes) -> int:
+    crc = 0xFFFFFFFF
+    for b in data:
+        crc ^= b << 24
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x04C11DB7) & 0xFFFFFFFF if crc & 0x80000000 else (crc << 1) & 0xFFFFFFFF
+    return crc
+
+
+def build_packet(code: int, seq: int, payload: bytes) -> bytes:
+    """包 0 以 0 补齐，数据包以 CPMEOF 补齐"""
+    size = 1024 if code == STX else 128
+    data = payload.ljust(size, b'\0' if seq == 0 else bytes([CPMEOF]))
+    return bytes([code, seq & 0xFF, 0xFF - (seq & 0xFF)]) + data + struct.pack('>H', crc16_xmodem(data))
+
+
+class ProtocolError(Exception):
+    pass
+
+
+# ================== 链路 ==================
+class Link:
+    """字节流链路：_recv 返回 timeout 内到达的数据（可能为空）"""
+
+    def __init__(self):
+        self.buf = bytearray()
+
+    def _recv(self, timeout: float) -> bytes:
+        raise NotImplementedError
+
+    def write(self, data: bytes):
+        raise NotImplementedError
+
+    def read(self, n: int, timeout: float) -> bytes:
+        """读满 n 字节，或空闲超过 timeout（有数据到达即重新计时）"""
+        while len(self.buf) < n:
+            chunk = self._recv(timeout)
+            if not chunk:
+                break
+            self.buf += chunk
+        out = bytes(self.buf[:n])
+        del self.buf[:n]
+        return out
+
+    def purge(self, idle: float):
+        """丢弃缓冲与线路上的剩余字节，直到空闲 idle 秒"""
+        self.buf.clear()
+        while self._recv(idle):
+            pass
+
+
+class SerialLink(Link):
+    def __init__(self, port: str, baud: int):
+        super().__init__()
+        import serial  # 仅实机需要 pyserial
+        self.ser = serial.Serial(port, baud, timeout=0.1)
+
+    def _recv(self, timeout):
+        self.ser.timeout = timeout
+        return self.ser.read(max(1, self.ser.in_waiting))
+
+    def write(self, data):
+        self.ser.write(data)
+
+
+class StdioLink(Link):
+    def __init__(self):
+        super().__init__()
+        self.rfd, self.wfd = sys.stdin.fileno(), sys.stdout.fileno()
+
+    def _recv(self, timeout):
+        r, _, _ = select.select([self.rfd], [], [], timeout)
+        return os.read(self.rfd, 4096) if r else b''
+
+    def write(self, data):
+        os.write(self.wfd, data)
+
+
+class QueueLink(Link):
+    """自测用：两个队列构成全双工线路，写入经 noise 处理，按波特率计发送耗时"""
+
+    def __init__(self, rx: queue.Queue, tx: queue.Queue, noise=None, baud: int = 0):
+        super().__init__()
+        self.rx, self.tx, self.noise, self.baud = rx, tx, noise, baud
+        self.wire = 0
+
+    def _recv(self, timeout):
+        try:
+            return self.rx.get(timeout=timeout) if timeout > 0 else self.rx.get_nowait()
+        except queue.Empty:
+            return b''
+
+    def write(self, data):
+        self.wire += len(data)
+        if self.baud:
+            time.sleep(len(data) * 10.0 / self.baud)
+        if self.noise:
+            data = self.noise(data)
+        if data:
+            self.tx.put(data)
+
+
+# ================== 接收端 ==================
+class Receiver:
+    def __init__(self, link: Link, timeout: float = 1.0, handshake: int = 60, retries: int = 10):
+        self.link = link
+        self.timeout = timeout
+        self.handshake = handshake
+        self.retries = retries
+        self.blocks = self.naks = self.dups = 0
+        self.text = bytearray()      # 包之间的杂散字节
+        self.elapsed = 0.0
+
+    def _packet(self, timeout: float) -> Tuple[int, int, bytes]:
+        while True:
+            b = self.link.read(1, timeout)
+            if not b:
+                return TIMEOUT, 0, b''
+            c = b[0]
+            if c in (SOH, STX):
+                break
+            if c == EOT:
+                return EOT, 0, b''
+            if c == CAN and self.link.read(1, self.timeout) == bytes([CAN]):
+                return CAN, 0, b''
+            self.text.append(c)
+        size = 128 if c == SOH else 1024
+        body = self.link.read(size + 4, self.timeout)
+        if len(body) < size + 4 or body[0] ^ body[1] != 0xFF:
+            return BAD, 0, b''
+        data = body[2:2 + size]
+        if crc16_xmodem(data) != struct.unpack('>H', body[2 + size:])[0]:
+            return BAD, 0, b''
+        return c, body[0], data
+
+    def _answer(self, code: int):
+        """出错时先等线路空闲再回 NAK/'C'，避免应答夹在半个包中间"""
+        self.link.purge(min(0.05, self.timeout))
+        self.link.write(bytes([code]))
+        self.naks += 1
+
+    def _cancel(self, why: str):
+        self.link.write(bytes([CAN] * 5))
+        raise ProtocolError(why)
+
+    def _header(self, first_c: bool) -> bytes:
+        tries = self.handshake if first_c else self.retries
+        for i in range(tries):
+            if first_c or i:
+                self.link.write(bytes([C]))
+            code, seq, data = self._packet(self.timeout)
+            if code in (SOH, STX) and seq == 0:
+                return data
+            if code == CAN:
+                raise ProtocolError('cancelled by sender')
+            if code == EOT:
+                # 上一个文件 EOT 的 ACK 丢失，发送端重发了 EOT
+                self.link.write(bytes([ACK]))
+            elif code == BAD:
+                self.link.purge(min(0.05, self.timeout))
+        raise ProtocolError('no header packet')
+
+    def _data(self) -> bytearray:
+        out = bytearray()
+        expect, errors, eots = 1, 0, 0
+        while True:
+            code, seq, data = self._packet(self.timeout)
+            if code in (TIMEOUT, BAD):
+                errors += 1
+                if errors > self.retries:
+                    self._cancel('too many errors')
+                self._answer(NAK)
+                continue
+            if code == CAN:
+                raise ProtocolError('cancelled by sender')
+            if code == EOT:
+                if eots == 0:
+                    eots = 1
+                    self.link.write(bytes([NAK]))
+                    continue
+                self.link.write(bytes([ACK, C]))
+                return out
+            errors = 0
+            if seq == expect & 0xFF:
+                out += data
+                expect += 1
+                self.blocks += 1
+                self.link.write(bytes([ACK]))
+            elif seq == (expect - 1) & 0xFF:
+                # 重复包：上次的 ACK 丢了；包 0 重发时还要再要一次数据
+                self.dups += 1
+                self.link.write(bytes([ACK, C]) if expect == 1 else bytes([ACK]))
+            else:
+                self._cancel('sequence error: got %d expected %d' % (seq, expect & 0xFF))
+
+    def _linger(self):
+        """空包 0 的 ACK 若丢失发送端会重发，再 ACK 一次；同时收下 sw_export 的汇总行"""
+        while True:
+            code, seq, _ = self._packet(min(0.3, self.timeout))
+            if code == TIMEOUT:
+                return
+            if code in (SOH, STX) and seq == 0:
+                self.link.write(bytes([ACK]))
+
+    def receive(self) -> List[Tuple[str, bytes]]:
+        files = []
+        t0 = None
+        first_c = True
+        while True:
+            hdr = self._header(first_c)
+            if t0 is None:
+                t0 = time.monotonic()
+            name, _, rest = hdr.partition(b'\0')
+            if not name:
+                self.link.write(bytes([ACK]))
+                break
+            m = re.match(rb'\d+', rest)
+            size = int(m.group()) if m else -1
+            self.link.write(bytes([ACK, C]))
+            data = self._data()
+            files.append((name.decode(errors='replace'), bytes(data[:size] if size >= 0 else data)))
+            first_c = False
+        self.elapsed = time.monotonic() - t0
+        self._linger()
+        return files
+
+    def report(self) -> Optional[dict]:
+        m = REPORT.search(self.text.decode(errors='replace'))
+        if not m:
+            return None
+        k = ('bytes', 'ms', 'bps', 'pct', 'baud', 'blocks', 'resent')
+        r = dict(zip(k, map(int, m.groups()[:7])))
+        r['crc'] = int(m.group(8), 16)
+        return r
+
+
+# ================== 模拟发送端（与固件 ymodem.c 行为一致） ==================
+class SimSender(threading.Thread):
+    def __init__(self, link: QueueLink, name: str, data: bytes, ack_timeout: float, block: int = 1024,
+                 retry: int = 10):
+        super().__init__(daemon=True)
+        self.link, self.name, self.data = link, name, data
+        self.ack_timeout, self.block, self.retry = ack_timeout, block, retry
+        self.resends = 0
+        self.blocks = 0
+        self.error = None
+
+    def _getc(self, timeout):
+        b = self.link.read(1, timeout)
+        return b[0] if b else None
+
+    def _send_ack(self, code, seq, payload):
+        for r in range(self.retry + 1):
+            if r:
+                self.resends += 1
+            self.link.purge(0)
+            self.link.write(build_packet(code, seq, payload))
+            a = self._getc(self.ack_timeout)
+            if a == ACK:
+                return
+            if a == CAN:
+                raise ProtocolError('cancelled')
+        raise ProtocolError('retries exhausted')
+
+    def run(self):
+        try:
+            self._send()
+        except ProtocolError as e:
+            self.error = e
+
+    def _send(self):
+        self.link.write(b'sw_export: archive, start the YMODEM receiver now\r\n')
+        for _ in range(20):
+            if self._getc(self.ack_timeout * 3) == C:
+                break
+        else:
+            raise ProtocolError('handshake timeout')
+        t0 = time.monotonic()
+        self._send_ack(SOH, 0, self.name.encode() + b'\0' + str(len(self.data)).encode())
+        if self._getc(self.ack_timeout) != C:
+            raise ProtocolError('no C after header')
+        off, seq = 0, 1
+        while True:
+            left = len(self.data) - off
+            code = STX if (self.block == 1024 and left > 128) else SOH
+            n = min(left, 1024 if code == STX else 128)
+            self._send_ack(code, seq, self.data[off:off + n])
+            off += n
+            seq += 1
+            self.blocks += 1
+            if off >= len(self.data):
+                break
+        for r in range(self.retry + 2):
+            if r > self.retry:
+                raise ProtocolError('EOT not acked')
+            self.link.write(bytes([EOT]))
+            a = self._getc(self.ack_timeout)
+            if a == ACK:
+                break
+            if a != NAK:
+                self.resends += 1
+        if self._getc(self.ack_timeout) != C:
+            raise ProtocolError('no C after EOT')
+        self._send_ack(SOH, 0, b'')
+        ms = int((time.monotonic() - t0) * 1000)
+        bps = len(self.data) * 1000 // ms if ms else 0
+        baud = self.link.baud or 115200
+        self.link.write(('sw_export: %u B in %u ms, %u B/s = %u%% of %u baud, %u blocks, %u resent, crc32 0x%08x\r\n'
+                         % (len(self.data), ms, bps, bps * 1000 // baud, baud, self.blocks, self.resends,
+                            crc32_mpeg2(self.data))).encode())
+
+
+def make_noise(rng: random.Random, p_corrupt: float, p_drop: float, p_ack: float):
+    """发送端方向：整包翻转一个字节或截断；接收端方向：只打坏 ACK（与实机中日志插入设备输出的情形相近）"""
+    def dev_to_host(data: bytes) -> bytes:
+        if len(data) < 100:
+            return data
+        x = rng.random()
+        if x < p_drop:
+            return data[:len(data) // 2]
+        if x < p_drop + p_corrupt:
+            b = bytearray(data)
+            b[rng.randrange(3, len(b))] ^= 1 << rng.randrange(8)
+            return bytes(b)
+        return data
+
+    def host_to_dev(data: bytes) -> bytes:
+        return bytes(0x00 if c == ACK and rng.random() < p_ack else c for c in data)
+    return dev_to_host, host_to_dev
+
+
+def sim_transfer(data: bytes, block: int, noise: float, seed: int, baud: int, timeout: float):
+    rng = random.Random(seed)
+    a, b = queue.Queue(), queue.Queue()
+    d2h, h2d = make_noise(rng, noise, noise / 2, noise / 2)
+    dev = QueueLink(rx=b, tx=a, noise=d2h, baud=baud)
+    host = QueueLink(rx=a, tx=b, noise=h2d)
+    tx = SimSender(dev, 'ARCHIVE.SAR', data, ack_timeout=timeout * 3, block=block)
+    rx = Receiver(host, timeout=timeout, handshake=10)
+    tx.start()
+    files = rx.receive()
+    tx.join(5)
+    return files, rx, tx, dev.wire
+
+
+def selftest(size: int, noise: float, seed: int, baud: int) -> bool:
+    rng = random.Random(seed)
+    data = bytes(rng.randrange(256) for _ in range(size))
+    ok = True
+    print('%-6s %-6s %7s %7s %6s %6s %5s %5s %9s %5s  %s' % ('block', 'noise', 'bytes', 'wire', 'blocks', 'resent',
+                                                           'naks', 'dups', 'B/s', 'line', 'result'))
+    for block, p in ((128, 0.0), (1024, 0.0), (1024, noise), (128, noise)):
+        files, rx, tx, wire = sim_transfer(data, block, p, seed, baud, timeout=0.2)
+        rep = rx.report()
+        good = (tx.error is None and len(files) == 1 and files[0][1] == data and rep is not None
+                and rep['crc'] == crc32_mpeg2(files[0][1]) and rep['bytes'] == size)
+        bps = int(size / rx.elapsed) if rx.elapsed else 0
+        print('%-6d %-6.2f %7d %7d %6d %6d %5d %5d %9d %4d%%  %s' % (
+            block, p, size, wire, tx.blocks, tx.resends, rx.naks, rx.dups, bps, bps * 1000 // baud,
+            'PASS' if good else 'FAIL %s' % (tx.error or '')))
+        ok = ok and good
+    # 杂散文本 + 空文件 + 恰好 1K 的边界
+    for n in (0, 128, 1024, 1025):
+        files, rx, tx, _ = sim_transfer(data[:n], 1024, 0.0, seed, 0, timeout=0.1)
+        good = tx.error is None and files == [('ARCHIVE.SAR', data[:n])]
+        print('edge   size %-5d -> %s' % (n, 'PASS' if good else 'FAIL'))
+        ok = ok and good
+    return ok
+
+
+# ================== 命令行 ==================
+def decode(name: str, data: bytes):
+    here = os.path.dirname(os.path.abspath(__file__))
+    sys.path.insert(0, here)
+    up = name.upper()
+    if up.endswith('.SAR'):
+        import session_archive
+        session_archive.print_sessions(session_archive.parse_image(data))
+    elif up.endswith('.REC'):
+        import session_recorder
+        print(session_recorder.summary(session_recorder.parse(data)))
+    elif up.endswith('.CSV'):
+        print(data.decode(errors='replace'), end='')
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description='YMODEM receiver for sw_export')
+    ap.add_argument('--port', help='串口号')
+    ap.add_argument('--baud', type=int, default=115200, help='串口波特率（自测时为模拟线路速率）')
+    ap.add_argument('--cmd', default='sw_export archive', help='先向设备发送的命令，空串则不发')
+    ap.add_argument('--stdio', action='store_true', help='经标准输入输出收发')
+    ap.add_argument('--out', default='.', help='保存目录')
+    ap.add_argument('--timeout', type=float, default=1.0)
+    ap.add_argument('--decode', action='store_true', help='按扩展名解析收到的文件（.SAR/.REC/.CSV）')
+    ap.add_argument('--selftest', action='store_true')
+    ap.add_argument('--size', type=int, default=8192)
+    ap.add_argument('--noise', type=float, default=0.05)
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    if args.selftest:
+        return 0 if selftest(args.size, args.noise, args.seed, args.baud) else 1
+    if args.stdio:
+        link = StdioLink()
+        log = sys.stderr
+    elif args.port:
+        link = SerialLink(args.port, args.baud)
+        if args.cmd:
+            link.write(args.cmd.encode() + b'\r\n')
+        log = sys.stdout
+    else:
+        ap.print_help()
+        return 2
+
+    rx = Receiver(link, timeout=args.timeout)
+    try:
+        files = rx.receive()
+    except ProtocolError as e:
+        print('receive failed: %s' % e, file=log)
+        return 1
+    rep = rx.report()
+    for name, data in files:
+        path = os.path.join(args.out, os.path.basename(name))
+        with open(path, 'wb') as fp:
+            fp.write(data)
+        crc = crc32_mpeg2(data)
+        check = '' if rep is None else (' (device crc32 %s)' % ('match' if rep['crc'] == crc else 'MISMATCH'))
+        print('%s: %d B, %d blocks, %d NAK, %d dup, %.0f B/s, crc32 0x%08x%s' % (
+            path, len(data), rx.blocks, rx.naks, rx.dups, len(data) / rx.elapsed if rx.elapsed else 0, crc, check),
+            file=log)
+        if rep:
+            print('device: %d ms, %d B/s = %d%% of %d baud, %d resent' % (
+                rep['ms'], rep['bps'], rep['pct'], rep['baud'], rep['resent']), file=log)
+        if args.decode:
+            decode(name, data)
+    return 0 if rep is None or all(crc32_mpeg2(d) == rep['crc'] for _, d in files) else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())